@@ -1,39 +1,85 @@
-import sys, os, struct, json, argparse
-from decimal import Decimal
+import sys, os, struct, argparse
+from hashlittle import hashlittle
 
 parser = argparse.ArgumentParser(description='Build namehash lookup files for jc-model-renderer')
-parser.add_argument('--pretty', help='Pretty print output JSON', action='store_true')
+parser.add_argument('--verbose', help='Print namehash collisions', action='store_true')
 args = parser.parse_args()
 
 ROOT = os.path.dirname(os.path.realpath(sys.argv[0]))
-GENERATED_HASHES = "%s\\assets\\namehashlookup_generated.txt" % ROOT
-CUSTOM_HASHES = "%s\\assets\\namehashlookup_custom.txt" % ROOT
-JC4_HASHES = "%s\\assets\\namehashlookup_jc4.txt" % ROOT
-OUT_PATH = "%s\\assets\\" % ROOT
-DATA = []
+GENERATED_HASHES = os.path.join(ROOT, "assets", "namehashlookup_generated.txt")
+CUSTOM_HASHES = os.path.join(ROOT, "assets", "namehashlookup_custom.txt")
+JC4_HASHES = os.path.join(ROOT, "assets", "namehashlookup_jc4.txt")
+OUTPUT_FILE = os.path.join(ROOT, "assets", "namehashlookup.bin")
+
+# must match name_hash_lookup.cc
+MAGIC = 0x544C484E # NHLT
+VERSION = 1
+BLOCK_SIZE = 16 # names per front-coded block
+DATA = {}
 
 print ("Generating namehash lookup...")
 
 def load_hints(filename):
   with open(filename, "r") as file:
     # skip empty lines
-    lines = (line.rstrip() for line in file) 
+    lines = (line.rstrip() for line in file)
     lines = list(line for line in lines if line)
 
     for line in lines:
-      DATA.append(line)
+      namehash = hashlittle(line)
+      if args.verbose and namehash in DATA and DATA[namehash] != line:
+        print("  0x%08X collision '%s' replaces '%s'" % (namehash, line, DATA[namehash]))
+
+      # later files win, same as the old json table
+      DATA[namehash] = line
+
+def write_varint(out, value):
+  while value >= 0x80:
+    out.append((value & 0x7F) | 0x80)
+    value >>= 7
+  out.append(value)
+
+def common_prefix(a, b):
+  length = 0
+  while length < min(len(a), len(b)) and a[length] == b[length]:
+    length += 1
+  return length
 
 # load hints
 load_hints(GENERATED_HASHES)
 load_hints(CUSTOM_HASHES)
 load_hints(JC4_HASHES)
 
-# write the output
-OUTPUT_FILE = os.path.join(OUT_PATH, "namehashlookup.json")
-with open(OUTPUT_FILE, "w") as file:
-  if args.pretty:
-    file.write(json.dumps(DATA, indent=4, sort_keys=True))
+# names are sorted so neighbours share prefixes. every block starts with a full name, the rest of the names in the
+# block store the length of the prefix shared with the previous name and the remaining suffix.
+names = sorted(set(DATA.values()), key=lambda name: name.encode("latin-1"))
+name_index = {name: index for index, name in enumerate(names)}
+
+strings = bytearray()
+block_offsets = []
+for index, name in enumerate(names):
+  encoded = name.encode("latin-1")
+  if index % BLOCK_SIZE == 0:
+    block_offsets.append(len(strings))
+    write_varint(strings, len(encoded))
   else:
-    json.dump(DATA, file)
+    previous = names[index - 1].encode("latin-1")
+    prefix = common_prefix(previous, encoded)
+    write_varint(strings, prefix)
+    write_varint(strings, len(encoded) - prefix)
+    encoded = encoded[prefix:]
+  strings += encoded
+
+hashes = sorted(DATA.keys())
+
+# write the output
+with open(OUTPUT_FILE, "wb") as file:
+  file.write(struct.pack("<6I", MAGIC, VERSION, len(hashes), BLOCK_SIZE, len(block_offsets), len(strings)))
+  file.write(struct.pack("<%dI" % len(hashes), *hashes))
+  file.write(struct.pack("<%dI" % len(hashes), *(name_index[DATA[namehash]] for namehash in hashes)))
+  file.write(struct.pack("<%dI" % len(block_offsets), *block_offsets))
+  file.write(strings)
 
-print ("Finished. Wrote namehash lookup to '%s'." % os.path.abspath(OUTPUT_FILE))
\ No newline at end of file
+raw_size = sum(len(name) + 1 for name in names)
+print ("Finished. Wrote %d names (%d bytes of strings, %d before front coding) to '%s'." % (len(hashes), len(strings),
+       raw_size, os.path.abspath(OUTPUT_FILE)))
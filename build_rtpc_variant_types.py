@@ -0,0 +1,172 @@
+import sys, os, fnmatch, argparse
+from hashlittle import hashlittle
+
+parser = argparse.ArgumentParser(description='Build the runtime container variant datatype table for jc-model-renderer')
+parser.add_argument('--verbose', help='Print every classified variant', action='store_true')
+args = parser.parse_args()
+
+ROOT = os.path.dirname(os.path.realpath(sys.argv[0]))
+INPUT_FILE = os.path.join(ROOT, "assets", "rtpc_variant_types.txt")
+NAMEHASH_FILES = [
+  os.path.join(ROOT, "assets", "namehashlookup_generated.txt"),
+  os.path.join(ROOT, "assets", "namehashlookup_custom.txt"),
+  os.path.join(ROOT, "assets", "namehashlookup_jc4.txt"),
+]
+OUTPUT_FILE = os.path.join(ROOT, "src", "game", "formats", "runtime_container_variant_types.generated.h")
+
+DATATYPES = {
+  "hash": "RuntimeContainer::VARIANT_DATATYPE_HASH",
+  "guid": "RuntimeContainer::VARIANT_DATATYPE_GUID",
+  "colour": "RuntimeContainer::VARIANT_DATATYPE_COLOUR",
+}
+
+# empty slots, get_variant_datatype returns this for unknown variants
+DATATYPE_EMPTY = "RuntimeContainer::VARIANT_DATATYPE_COUNT"
+
+# must match variant_types::get_slot in runtime_container_variant_types.h
+SLOT_MULTIPLIER = 0x9E3779B1
+KEYS_PER_BUCKET = 4
+
+def load_rules(filename):
+  rules = []
+  with open(filename, "r") as file:
+    for number, line in enumerate(file, 1):
+      line = line.split("#", 1)[0].strip()
+      if not line:
+        continue
+
+      parts = line.split(None, 1)
+      if len(parts) != 2 or parts[0] not in DATATYPES:
+        sys.exit("%s:%d: expected '<%s> <name>'" % (filename, number, "|".join(DATATYPES)))
+
+      rules.append((parts[0], parts[1]))
+
+  return rules
+
+def load_names(filenames):
+  names = set()
+  for filename in filenames:
+    with open(filename, "r", encoding="latin-1") as file:
+      names.update(line.rstrip("\r\n") for line in file if line.strip())
+
+  return sorted(names)
+
+def classify(rules, names):
+  result = {}
+
+  def add(name, datatype):
+    namehash = hashlittle(name)
+    if namehash in result and result[namehash][0] != name:
+      # two different names with the same hash, the first rule wins
+      print("WARNING: '%s' and '%s' have the same namehash (0x%08X)" % (result[namehash][0], name, namehash))
+      return
+
+    result.setdefault(namehash, (name, datatype))
+
+  # first matching rule wins, rules are applied in file order
+  for datatype, pattern in rules:
+    if "*" in pattern or "?" in pattern:
+      for name in names:
+        if fnmatch.fnmatch(name.lower(), pattern.lower()):
+          add(name, datatype)
+    else:
+      add(pattern, datatype)
+
+  return result
+
+def slot_for(namehash, seed, table_bits):
+  return (((namehash ^ seed) * SLOT_MULTIPLIER) & 0xFFFFFFFF) >> (32 - table_bits)
+
+# hash and displace: keys are split into buckets, then each bucket (largest first) searches for a seed which places
+# all of its keys into free slots.
+def build_perfect_hash(keys):
+  table_bits = 1
+  while (1 << table_bits) < max(2, len(keys) * 5 // 4):
+    table_bits += 1
+
+  num_buckets = max(1, len(keys) // KEYS_PER_BUCKET)
+
+  while True:
+    buckets = [[] for _ in range(num_buckets)]
+    for key in keys:
+      buckets[key % num_buckets].append(key)
+
+    slots = [None] * (1 << table_bits)
+    seeds = [0] * num_buckets
+    success = True
+
+    for bucket_index in sorted(range(num_buckets), key=lambda i: -len(buckets[i])):
+      bucket = buckets[bucket_index]
+      if not bucket:
+        continue
+
+      for seed in range(1, 1 << 16):
+        positions = [slot_for(key, seed, table_bits) for key in bucket]
+        if len(set(positions)) == len(positions) and all(slots[p] is None for p in positions):
+          for key, position in zip(bucket, positions):
+            slots[position] = key
+          seeds[bucket_index] = seed
+          break
+      else:
+        success = False
+        break
+
+    if success:
+      return table_bits, seeds, slots
+
+    # couldn't place a bucket, grow the table and try again
+    table_bits += 1
+
+print ("Generating runtime container variant types...")
+
+rules = load_rules(INPUT_FILE)
+names = load_names(NAMEHASH_FILES)
+classified = classify(rules, names)
+
+table_bits, seeds, slots = build_perfect_hash(sorted(classified.keys()))
+
+if args.verbose:
+  for namehash, (name, datatype) in sorted(classified.items(), key=lambda item: item[1][0].lower()):
+    print("  0x%08X %-8s %s" % (namehash, datatype, name))
+
+def format_array(values, per_line):
+  lines = []
+  for i in range(0, len(values), per_line):
+    lines.append("    " + " ".join(values[i:i + per_line]))
+  return "\n".join(lines)
+
+keys = ["0x%08X," % (key if key is not None else 0) for key in slots]
+datatypes = [(DATATYPES[classified[key][1]] if key is not None else DATATYPE_EMPTY) + "," for key in slots]
+comments = ["// 0x%08X %s %s" % (key, classified[key][1], classified[key][0]) for key in slots if key is not None]
+
+with open(OUTPUT_FILE, "w", newline="\n") as file:
+  file.write("""// generated by build_rtpc_variant_types.py from assets/rtpc_variant_types.txt - do not edit!
+#ifndef JCMR_FORMATS_RUNTIME_CONTAINER_VARIANT_TYPES_GENERATED_H_HEADER_GUARD
+#define JCMR_FORMATS_RUNTIME_CONTAINER_VARIANT_TYPES_GENERATED_H_HEADER_GUARD
+
+namespace jcmr::game::format::variant_types
+{
+// %d known variants
+%s
+
+static constexpr u32 TABLE_BITS  = %d;
+static constexpr u32 NUM_BUCKETS = %d;
+
+static constexpr u32 s_seeds[NUM_BUCKETS] = {
+%s
+};
+
+static constexpr u32 s_keys[1 << TABLE_BITS] = {
+%s
+};
+
+static constexpr u8 s_datatypes[1 << TABLE_BITS] = {
+%s
+};
+} // namespace jcmr::game::format::variant_types
+
+#endif // JCMR_FORMATS_RUNTIME_CONTAINER_VARIANT_TYPES_GENERATED_H_HEADER_GUARD
+""" % (len(classified), "\n".join(comments), table_bits, len(seeds), format_array(["%d," % seed for seed in seeds], 16),
+       format_array(keys, 8), "\n".join("    " + datatype for datatype in datatypes)))
+
+print ("Finished. Wrote %d variant types to '%s'." % (len(classified), os.path.abspath(OUTPUT_FILE)))
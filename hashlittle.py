@@ -0,0 +1,56 @@
+# shared by the build_*.py scripts
+
+def rot(x, k):
+  return ((x << k) | (x >> (32 - k))) & 0xFFFFFFFF
+
+# lookup3 hashlittle, same as ava::hashlittle
+def hashlittle(string, initval = 0):
+  data = string.encode("latin-1")
+  length = len(data)
+  a = b = c = (0xdeadbeef + length + initval) & 0xFFFFFFFF
+
+  def mix(a, b, c):
+    a = (a - c) & 0xFFFFFFFF; a ^= rot(c, 4);  c = (c + b) & 0xFFFFFFFF
+    b = (b - a) & 0xFFFFFFFF; b ^= rot(a, 6);  a = (a + c) & 0xFFFFFFFF
+    c = (c - b) & 0xFFFFFFFF; c ^= rot(b, 8);  b = (b + a) & 0xFFFFFFFF
+    a = (a - c) & 0xFFFFFFFF; a ^= rot(c, 16); c = (c + b) & 0xFFFFFFFF
+    b = (b - a) & 0xFFFFFFFF; b ^= rot(a, 19); a = (a + c) & 0xFFFFFFFF
+    c = (c - b) & 0xFFFFFFFF; c ^= rot(b, 4);  b = (b + a) & 0xFFFFFFFF
+    return a, b, c
+
+  def final(a, b, c):
+    c ^= b; c = (c - rot(b, 14)) & 0xFFFFFFFF
+    a ^= c; a = (a - rot(c, 11)) & 0xFFFFFFFF
+    b ^= a; b = (b - rot(a, 25)) & 0xFFFFFFFF
+    c ^= b; c = (c - rot(b, 16)) & 0xFFFFFFFF
+    a ^= c; a = (a - rot(c, 4)) & 0xFFFFFFFF
+    b ^= a; b = (b - rot(a, 14)) & 0xFFFFFFFF
+    c ^= b; c = (c - rot(b, 24)) & 0xFFFFFFFF
+    return a, b, c
+
+  def word(offset, count):
+    return int.from_bytes(data[offset:offset + count], "little")
+
+  offset = 0
+  while length > 12:
+    a = (a + word(offset, 4)) & 0xFFFFFFFF
+    b = (b + word(offset + 4, 4)) & 0xFFFFFFFF
+    c = (c + word(offset + 8, 4)) & 0xFFFFFFFF
+    a, b, c = mix(a, b, c)
+    length -= 12
+    offset += 12
+
+  if length == 0:
+    return c
+
+  a = (a + word(offset, min(length, 4))) & 0xFFFFFFFF
+  if length > 4:
+    b = (b + word(offset + 4, min(length - 4, 4))) & 0xFFFFFFFF
+  if length > 8:
+    c = (c + word(offset + 8, length - 8)) & 0xFFFFFFFF
+
+  a, b, c = final(a, b, c)
+  return c
+
+assert hashlittle("") == 0xdeadbeef
+assert hashlittle("Four score and seven years ago") == 0x17770551
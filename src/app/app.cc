@@ -129,6 +129,10 @@ struct AppImpl final : App {
             m_renderer->frame();
         }
 
+        if (m_current_game) {
+            m_current_game->update();
+        }
+
         // update format handlers
         for (auto& handler : m_format_handlers) {
             handler.second->update();
@@ -271,6 +275,9 @@ struct AppImpl final : App {
     void register_file_read_handler(FileHandler_t callback) override { m_file_read_handlers.emplace_back(callback); }
     const std::vector<FileHandler_t>& get_file_read_handlers() const override { return m_file_read_handlers; }
 
+    void notify_loaded_state_changed() override { ++m_loaded_state_revision; }
+    u32  get_loaded_state_revision() const override { return m_loaded_state_revision; }
+
     Settings& get_settings() override { return m_settings; }
     Renderer& get_renderer() override { return *m_renderer; }
     UI&       get_ui() override { return m_renderer->get_ui(); }
@@ -288,6 +295,7 @@ struct AppImpl final : App {
 
     std::unordered_map<u32, game::IFormat*> m_format_handlers;
     std::vector<FileHandler_t>              m_file_read_handlers;
+    u32                                     m_loaded_state_revision = 0;
 };
 
 App* App::create()
@@ -301,28 +309,35 @@ void App::destroy(App* app)
 }
 
 ByteArray App::load_internal_resource(i32 resource_id)
+{
+    u64       size = 0;
+    const u8* data = map_internal_resource(resource_id, &size);
+    if (!data) {
+        return {};
+    }
+
+    return ByteArray(data, (data + size));
+}
+
+const u8* App::map_internal_resource(i32 resource_id, u64* out_size)
 {
     const auto handle = GetModuleHandle(nullptr);
 
     const auto resource_info = FindResource(handle, MAKEINTRESOURCE(resource_id), RT_RCDATA);
     if (!resource_info) {
         DEBUG_BREAK();
-        LOG_ERROR("App : load_internal_resource {} failed! (FindResource)", resource_id);
-        return {};
+        LOG_ERROR("App : map_internal_resource {} failed! (FindResource)", resource_id);
+        return nullptr;
     }
 
     const auto resource_data = LoadResource(handle, resource_info);
     if (!resource_data) {
         DEBUG_BREAK();
-        LOG_ERROR("App : load_internal_resource {} failed! (LoadResource)", resource_id);
-        return {};
+        LOG_ERROR("App : map_internal_resource {} failed! (LoadResource)", resource_id);
+        return nullptr;
     }
 
-    const void* ptr  = LockResource(resource_data);
-    auto        size = SizeofResource(handle, resource_info);
-
-    ByteArray result(size);
-    std::memcpy(result.data(), ptr, size);
-    return result;
+    *out_size = SizeofResource(handle, resource_info);
+    return static_cast<const u8*>(LockResource(resource_data));
 }
 } // namespace jcmr
\ No newline at end of file
@@ -48,12 +48,19 @@ struct App {
     virtual void                              register_file_read_handler(FileHandler_t callback) = 0;
     virtual const std::vector<FileHandler_t>& get_file_read_handlers() const                     = 0;
 
+    // formats call this when a file is loaded or unloaded, so anything caching is_loaded() knows to refresh
+    virtual void notify_loaded_state_changed()     = 0;
+    virtual u32  get_loaded_state_revision() const = 0;
+
     virtual Settings& get_settings() = 0;
     virtual Renderer& get_renderer() = 0;
     virtual UI&       get_ui()       = 0;
     virtual IGame*    get_game()     = 0;
 
     static ByteArray load_internal_resource(i32 resource_id);
+
+    // points directly into the executable image, valid for the lifetime of the process. returns nullptr on failure.
+    static const u8* map_internal_resource(i32 resource_id, u64* out_size);
 };
 } // namespace jcmr
 
@@ -0,0 +1,1096 @@
+#include "pch.h"
+
+#include "cli.h"
+
+#include "app/app.h"
+#include "app/hashing.h"
+#include "app/image_reader.h"
+#include "app/image_writer.h"
+#include "app/jobs.h"
+#include "app/texture_decoder.h"
+#include "app/texture_encoder.h"
+
+#include "game/avtx.h"
+#include "game/content_search.h"
+#include "game/dependency_graph.h"
+#include "game/game.h"
+#include "game/hash_cracker.h"
+#include "game/name_harvester.h"
+#include "game/name_hash_lookup.h"
+#include "game/resource_manager.h"
+#include "game/runtime_container_diff.h"
+#include "game/runtime_container_index.h"
+#include "game/texture_export.h"
+#include "game/texture_import.h"
+#include "game/texture_streamer.h"
+
+#include "render/texture_cache.h"
+
+#include <argparse.h>
+#include <chrono>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <random>
+
+namespace jcmr::cli
+{
+struct Command {
+    const char* name;
+    const char* description;
+    i32 (*callback)(App& app, i32 argc, const char** argv);
+};
+
+// returns false if the command shouldn't continue (bad arguments, or help was printed)
+static bool parse_arguments(argparse::ArgumentParser& parser, i32 argc, const char** argv, i32* out_exit_code)
+{
+    parser.enable_help();
+
+    auto result = parser.parse(argc, argv);
+    if (result) {
+        LOG_ERROR("{}", result.what());
+        parser.print_help();
+        *out_exit_code = 1;
+        return false;
+    }
+
+    if (parser.exists("help")) {
+        parser.print_help();
+        *out_exit_code = 0;
+        return false;
+    }
+
+    return true;
+}
+
+static bool get_game(argparse::ArgumentParser& parser, EGame* out_game)
+{
+    const auto name = (parser.exists("game") ? parser.get<std::string>("game") : std::string("jc3"));
+    if (name == "jc3") {
+        *out_game = EGame::EGAME_JUSTCAUSE3;
+        return true;
+    } else if (name == "jc4") {
+        *out_game = EGame::EGAME_JUSTCAUSE4;
+        return true;
+    }
+
+    LOG_ERROR("unknown game \"{}\" (expected jc3 or jc4)", name);
+    return false;
+}
+
+static const char* get_game_short_name(EGame game)
+{
+    return (game == EGame::EGAME_JUSTCAUSE4 ? "jc4" : "jc3");
+}
+
+// accepts "0x" prefixed hex, decimal or a string which is hashed
+static u32 parse_namehash(const std::string& value)
+{
+    if (value.size() > 2 && value[0] == '0' && (value[1] == 'x' || value[1] == 'X')) {
+        return static_cast<u32>(std::stoul(value.substr(2), nullptr, 16));
+    }
+
+    if (!value.empty() && std::all_of(value.begin(), value.end(), [](char ch) { return isdigit(ch) || ch == '-'; })) {
+        return static_cast<u32>(std::stoll(value));
+    }
+
+    return ava::hashlittle(value.c_str());
+}
+
+static std::filesystem::path get_rtpc_index_path(argparse::ArgumentParser& parser, EGame game)
+{
+    if (parser.exists("index")) {
+        return parser.get<std::string>("index");
+    }
+
+    return std::filesystem::path("cache") / fmt::format("{}.rtpcindex", get_game_short_name(game));
+}
+
+static std::filesystem::path get_dependency_graph_path(argparse::ArgumentParser& parser, EGame game)
+{
+    if (parser.exists("graph")) {
+        return parser.get<std::string>("graph");
+    }
+
+    return std::filesystem::path("cache") / fmt::format("{}.depgraph", get_game_short_name(game));
+}
+
+static bool read_binary_file(const std::filesystem::path& filename, ByteArray* out_buffer)
+{
+    std::ifstream stream(filename, std::ios::binary);
+    if (stream.fail()) {
+        LOG_ERROR("failed to open \"{}\"", filename.generic_string());
+        return false;
+    }
+
+    out_buffer->resize(std::filesystem::file_size(filename));
+    stream.read(reinterpret_cast<char*>(out_buffer->data()), out_buffer->size());
+    return !stream.fail();
+}
+
+// non-empty lines, trailing carriage returns are removed
+static bool read_lines(const std::filesystem::path& filename, std::vector<std::string>* out_lines)
+{
+    std::ifstream stream(filename);
+    if (stream.fail()) {
+        LOG_ERROR("failed to open \"{}\"", filename.generic_string());
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(stream, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (!line.empty()) out_lines->push_back(std::move(line));
+    }
+
+    return true;
+}
+
+static bool read_runtime_container(const std::filesystem::path& filename,
+                                   ava::RuntimePropertyContainer::Container* out_container)
+{
+    ByteArray buffer;
+    if (!read_binary_file(filename, &buffer)) return false;
+
+    if (!AVA_FL_SUCCEEDED(ava::RuntimePropertyContainer::Parse(buffer, out_container))) {
+        LOG_ERROR("\"{}\" is not a runtime container", filename.generic_string());
+        return false;
+    }
+
+    return true;
+}
+
+static i32 rtpc_index(App& app, i32 argc, const char** argv)
+{
+    argparse::ArgumentParser parser(argv[0], "Index every runtime container in the game archives");
+    parser.add_argument("-g", "--game", "game to index (jc3, jc4)", false);
+    parser.add_argument("-i", "--index", "index output filename", false);
+
+    i32 exit_code = 0;
+    if (!parse_arguments(parser, argc, argv, &exit_code)) return exit_code;
+
+    EGame game;
+    if (!get_game(parser, &game)) return 1;
+
+    auto* resource_manager = IGame::create_resource_manager(game, app);
+    if (!resource_manager) return 1;
+
+    const auto filename = get_rtpc_index_path(parser, game);
+
+    RuntimeContainerIndex index;
+    const bool success = (index.build(*resource_manager) && index.save(filename));
+    ResourceManager::destroy(resource_manager);
+
+    if (!success) {
+        LOG_ERROR("rtpc-index : failed to build index \"{}\"", filename.generic_string());
+        return 1;
+    }
+
+    LOG_INFO("rtpc-index : saved \"{}\"", filename.generic_string());
+    return 0;
+}
+
+static i32 rtpc_query(App& app, i32 argc, const char** argv)
+{
+    argparse::ArgumentParser parser(argv[0], "Find runtime container variants by name and/or value");
+    parser.add_argument("-g", "--game", "game to query (jc3, jc4)", false);
+    parser.add_argument("-i", "--index", "index filename", false);
+    parser.add_argument("-n", "--name", "variant name or namehash", false);
+    parser.add_argument("-v", "--value", "variant value (int, namehash or string)", false);
+    parser.add_argument("-l", "--limit", "maximum number of results", false);
+
+    i32 exit_code = 0;
+    if (!parse_arguments(parser, argc, argv, &exit_code)) return exit_code;
+
+    EGame game;
+    if (!get_game(parser, &game)) return 1;
+
+    RuntimeContainerIndex::Query query;
+    if (parser.exists("name")) query.m_NameHash = parse_namehash(parser.get<std::string>("name"));
+    if (parser.exists("value")) query.m_Value = parse_namehash(parser.get<std::string>("value"));
+    if (parser.exists("limit")) query.m_Limit = parser.get<u32>("limit");
+
+    if (!query.m_NameHash.has_value() && !query.m_Value.has_value()) {
+        LOG_ERROR("rtpc-query : --name and/or --value is required.");
+        return 1;
+    }
+
+    const auto            filename = get_rtpc_index_path(parser, game);
+    RuntimeContainerIndex index;
+    if (!index.load(filename)) {
+        LOG_ERROR("rtpc-query : failed to load index \"{}\" (run rtpc-index first)", filename.generic_string());
+        return 1;
+    }
+
+    const auto start   = std::chrono::high_resolution_clock::now();
+    const auto results = index.query(query);
+    const auto end     = std::chrono::high_resolution_clock::now();
+
+    for (const auto* record : results) {
+        std::string name(find_in_namehash_lookup_table(record->m_NameHash));
+        if (name.empty()) name = fmt::format("0x{:X}", record->m_NameHash);
+
+        fmt::print("{} : {} : {} ({}) = 0x{:08X}\n", index.get_filename(*record), index.get_container_path(*record),
+                   name,
+                   ava::RuntimePropertyContainer::VariantTypeToString(
+                       static_cast<ava::RuntimePropertyContainer::EVariantType>(record->m_Type)),
+                   record->m_Value);
+    }
+
+    LOG_INFO("rtpc-query : {} results ({} files, {} variants indexed) in {}us", results.size(),
+             index.get_num_files(), index.get_num_records(),
+             std::chrono::duration_cast<std::chrono::microseconds>(end - start).count());
+    return 0;
+}
+
+static i32 rtpc_diff(App& app, i32 argc, const char** argv)
+{
+    argparse::ArgumentParser parser(argv[0], "Create a patch with the differences between two runtime containers");
+    parser.add_argument("-b", "--base", "original .blo/.epe filename", true);
+    parser.add_argument("-t", "--target", "modified .blo/.epe filename", true);
+    parser.add_argument("-o", "--output", "patch output filename", true);
+
+    i32 exit_code = 0;
+    if (!parse_arguments(parser, argc, argv, &exit_code)) return exit_code;
+
+    ava::RuntimePropertyContainer::Container base;
+    ava::RuntimePropertyContainer::Container target;
+    if (!read_runtime_container(parser.get<std::string>("base"), &base)
+        || !read_runtime_container(parser.get<std::string>("target"), &target)) {
+        return 1;
+    }
+
+    ByteArray                     patch;
+    runtime_container_diff::Stats stats;
+
+    const auto start = std::chrono::high_resolution_clock::now();
+    runtime_container_diff::diff(base, target, &patch, &stats);
+    const auto end = std::chrono::high_resolution_clock::now();
+
+    const std::filesystem::path filename = parser.get<std::string>("output");
+    if (!app.write_binary_file(filename, patch)) {
+        LOG_ERROR("rtpc-diff : failed to write \"{}\"", filename.generic_string());
+        return 1;
+    }
+
+    LOG_INFO("rtpc-diff : variants {} changed, {} added, {} removed. containers {} added, {} removed. ({} bytes, "
+             "{}us)",
+             stats.m_NumChangedVariants, stats.m_NumAddedVariants, stats.m_NumRemovedVariants,
+             stats.m_NumAddedContainers, stats.m_NumRemovedContainers, patch.size(),
+             std::chrono::duration_cast<std::chrono::microseconds>(end - start).count());
+    return 0;
+}
+
+static i32 rtpc_patch(App& app, i32 argc, const char** argv)
+{
+    argparse::ArgumentParser parser(argv[0], "Apply a patch created by rtpc-diff to a runtime container");
+    parser.add_argument("-b", "--base", "original .blo/.epe filename", true);
+    parser.add_argument("-p", "--patch", "patch filename", true);
+    parser.add_argument("-o", "--output", "patched .blo/.epe output filename", true);
+
+    i32 exit_code = 0;
+    if (!parse_arguments(parser, argc, argv, &exit_code)) return exit_code;
+
+    ava::RuntimePropertyContainer::Container container;
+    ByteArray                                patch;
+    if (!read_runtime_container(parser.get<std::string>("base"), &container)
+        || !read_binary_file(parser.get<std::string>("patch"), &patch)) {
+        return 1;
+    }
+
+    if (!runtime_container_diff::apply(patch, &container)) {
+        LOG_ERROR("rtpc-patch : failed to apply patch.");
+        return 1;
+    }
+
+    ByteArray buffer;
+    if (!AVA_FL_SUCCEEDED(ava::RuntimePropertyContainer::Write(container, 1, &buffer))) {
+        LOG_ERROR("rtpc-patch : failed to write runtime container.");
+        return 1;
+    }
+
+    const std::filesystem::path filename = parser.get<std::string>("output");
+    if (!app.write_binary_file(filename, buffer)) {
+        LOG_ERROR("rtpc-patch : failed to write \"{}\"", filename.generic_string());
+        return 1;
+    }
+
+    LOG_INFO("rtpc-patch : saved \"{}\"", filename.generic_string());
+    return 0;
+}
+
+static i32 deps_index(App& app, i32 argc, const char** argv)
+{
+    argparse::ArgumentParser parser(argv[0], "Build the graph of which files every file depends on");
+    parser.add_argument("-g", "--game", "game to index (jc3, jc4)", false);
+    parser.add_argument("-i", "--graph", "graph output filename", false);
+
+    i32 exit_code = 0;
+    if (!parse_arguments(parser, argc, argv, &exit_code)) return exit_code;
+
+    EGame game;
+    if (!get_game(parser, &game)) return 1;
+
+    auto* resource_manager = IGame::create_resource_manager(game, app);
+    if (!resource_manager) return 1;
+
+    const auto filename = get_dependency_graph_path(parser, game);
+
+    DependencyGraph graph;
+    const bool      success = (graph.build(*resource_manager) && graph.save(filename));
+    ResourceManager::destroy(resource_manager);
+
+    if (!success) {
+        LOG_ERROR("deps-index : failed to build graph \"{}\"", filename.generic_string());
+        return 1;
+    }
+
+    LOG_INFO("deps-index : saved \"{}\"", filename.generic_string());
+    return 0;
+}
+
+static i32 deps(App& app, i32 argc, const char** argv)
+{
+    argparse::ArgumentParser parser(argv[0], "List the files a file depends on, or the files which depend on it");
+    parser.add_argument("-g", "--game", "game to query (jc3, jc4)", false);
+    parser.add_argument("-i", "--graph", "graph filename", false);
+    parser.add_argument("-f", "--file", "filename or namehash", true);
+    parser.add_argument("-r", "--reverse", "list the files which depend on --file instead", false);
+    parser.add_argument("-a", "--all", "follow dependencies of dependencies", false);
+    parser.add_argument("-l", "--limit", "maximum number of results with --all", false);
+
+    i32 exit_code = 0;
+    if (!parse_arguments(parser, argc, argv, &exit_code)) return exit_code;
+
+    EGame game;
+    if (!get_game(parser, &game)) return 1;
+
+    const auto      filename = get_dependency_graph_path(parser, game);
+    DependencyGraph graph;
+    if (!graph.load(filename)) {
+        LOG_ERROR("deps : failed to load graph \"{}\" (run deps-index first)", filename.generic_string());
+        return 1;
+    }
+
+    const auto namehash = parse_namehash(parser.get<std::string>("file"));
+    const bool reverse  = parser.exists("reverse");
+    const u32  limit    = (parser.exists("limit") ? parser.get<u32>("limit") : 0);
+
+    std::vector<u32> results;
+    if (parser.exists("all")) {
+        results = (reverse ? graph.get_all_referrers(namehash, limit) : graph.get_all_dependencies(namehash, limit));
+    } else {
+        results = (reverse ? graph.get_referrers(namehash) : graph.get_dependencies(namehash));
+    }
+
+    for (const auto result : results) {
+        const auto name = find_in_namehash_lookup_table(result);
+        if (name.empty()) {
+            fmt::print("0x{:08X}\n", result);
+        } else {
+            fmt::print("{}\n", name);
+        }
+    }
+
+    LOG_INFO("deps : {} {} ({} files, {} edges indexed)", results.size(), (reverse ? "referrers" : "dependencies"),
+             graph.get_num_nodes(), graph.get_num_edges());
+    return 0;
+}
+
+static i32 grep(App& app, i32 argc, const char** argv)
+{
+    argparse::ArgumentParser parser(argv[0], "Find files in the game archives which contain a string, hash or bytes");
+    parser.add_argument("-g", "--game", "game to search (jc3, jc4)", false);
+    parser.add_argument("-s", "--string", "string to find", false);
+    parser.add_argument("-i", "--ignore-case", "match --string ignoring ascii case", false);
+    parser.add_argument("-n", "--hash", "namehash to find (name, decimal or 0x hex), stored little endian", false);
+    parser.add_argument("-x", "--bytes", "hex bytes to find (\"DEADBEEF\" or \"DE AD BE EF\")", false);
+    parser.add_argument("-e", "--extension", "only search files with this extension", false);
+    parser.add_argument("-m", "--max-per-file", "maximum number of matches per file (default 16, 0 for all)", false);
+
+    i32 exit_code = 0;
+    if (!parse_arguments(parser, argc, argv, &exit_code)) return exit_code;
+
+    EGame game;
+    if (!get_game(parser, &game)) return 1;
+
+    content_search::Options  options;
+    std::vector<std::string> labels; // per pattern
+
+    if (parser.exists("string")) {
+        const auto value = parser.get<std::string>("string");
+        options.m_Patterns.push_back(content_search::make_string_pattern(value, parser.exists("ignore-case")));
+        labels.push_back(fmt::format("\"{}\"", value));
+    }
+
+    if (parser.exists("hash")) {
+        const auto namehash = parse_namehash(parser.get<std::string>("hash"));
+        options.m_Patterns.push_back(content_search::make_u32_pattern(namehash));
+        labels.push_back(fmt::format("0x{:08X}", namehash));
+    }
+
+    if (parser.exists("bytes")) {
+        const auto              value = parser.get<std::string>("bytes");
+        content_search::Pattern pattern;
+        if (!content_search::parse_hex_pattern(value, &pattern)) {
+            LOG_ERROR("grep : \"{}\" isn't a valid byte pattern.", value);
+            return 1;
+        }
+
+        options.m_Patterns.push_back(std::move(pattern));
+        labels.push_back(value);
+    }
+
+    if (options.m_Patterns.empty()) {
+        LOG_ERROR("grep : at least one of --string, --hash or --bytes is required.");
+        return 1;
+    }
+
+    if (parser.exists("extension")) options.m_Extension = parser.get<std::string>("extension");
+    if (parser.exists("max-per-file")) options.m_MaxMatchesPerFile = parser.get<u32>("max-per-file");
+
+    auto* resource_manager = IGame::create_resource_manager(game, app);
+    if (!resource_manager) return 1;
+
+    // matches are printed as they are found, so the order isn't stable between runs
+    std::mutex               print_mutex;
+    content_search::Progress progress;
+
+    const auto start = std::chrono::high_resolution_clock::now();
+    content_search::search(*resource_manager, options, &progress,
+                           [&](const std::string& filename, u32 pattern, u64 offset) {
+                               std::lock_guard<decltype(print_mutex)> _lock(print_mutex);
+                               fmt::print("{} : 0x{:X} : {}\n", filename, offset, labels[pattern]);
+                           });
+    const auto end = std::chrono::high_resolution_clock::now();
+
+    ResourceManager::destroy(resource_manager);
+
+    LOG_INFO("grep : {} matches in {} files ({} MB) in {}ms", progress.m_NumMatches.load(),
+             progress.m_NumFilesSearched.load(), (progress.m_NumBytesSearched.load() / (1024 * 1024)),
+             std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count());
+    return 0;
+}
+
+static i32 harvest_names(App& app, i32 argc, const char** argv)
+{
+    argparse::ArgumentParser parser(argv[0], "Find names for unknown namehashes in strings from the game archives");
+    parser.add_argument("-g", "--game", "game to harvest (jc3, jc4)", false);
+    parser.add_argument("-e", "--extension", "only scan files with this extension for strings", false);
+    parser.add_argument("-l", "--min-length", "shortest string which is considered (default 3)", false);
+    parser.add_argument("-o", "--output", "file to add names to (default assets/namehashlookup_generated.txt)", false);
+    parser.add_argument("-d", "--dry-run", "print the names without writing them", false);
+
+    i32 exit_code = 0;
+    if (!parse_arguments(parser, argc, argv, &exit_code)) return exit_code;
+
+    EGame game;
+    if (!get_game(parser, &game)) return 1;
+
+    name_harvester::Options options;
+    if (parser.exists("extension")) options.m_Extension = parser.get<std::string>("extension");
+    if (parser.exists("min-length")) options.m_MinLength = parser.get<u32>("min-length");
+
+    auto* resource_manager = IGame::create_resource_manager(game, app);
+    if (!resource_manager) return 1;
+
+    name_harvester::Result result;
+    const auto             start = std::chrono::high_resolution_clock::now();
+    const bool             ok    = name_harvester::harvest(*resource_manager, options, &result);
+    const auto             end   = std::chrono::high_resolution_clock::now();
+
+    ResourceManager::destroy(resource_manager);
+    if (!ok) return 1;
+
+    for (const auto& [namehash, name] : result.m_Names) {
+        fmt::print("0x{:08X} : {}\n", namehash, name);
+    }
+
+    LOG_INFO("harvest-names : {} of {} unknown namehashes named in {}ms", result.m_Names.size(),
+             result.m_NumUnknownHashes, std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count());
+
+    if (parser.exists("dry-run") || result.m_Names.empty()) {
+        return 0;
+    }
+
+    const std::filesystem::path filename =
+        (parser.exists("output") ? parser.get<std::string>("output") : "assets/namehashlookup_generated.txt");
+
+    std::vector<std::string> names;
+    for (const auto& [namehash, name] : result.m_Names) {
+        names.push_back(name);
+    }
+
+    u32 num_added = 0;
+    if (!append_to_namehash_lookup_source(filename, std::move(names), &num_added)) {
+        return 1;
+    }
+
+    LOG_INFO("harvest-names : added {} names to \"{}\", run build_namehashlookup.py to rebuild the lookup table.",
+             num_added, filename.generic_string());
+    return 0;
+}
+
+static i32 crack(App& app, i32 argc, const char** argv)
+{
+    argparse::ArgumentParser parser(argv[0], "Find names for unknown namehashes and object ids from name templates");
+    parser.add_argument("-H", "--hashes", "file with the hashes to find, one per line (decimal or 0x hex)", true);
+    parser.add_argument("-t", "--template", "name template, e.g. \"models/{word}/{word}_{n:2}.rbm\"", false);
+    parser.add_argument("-T", "--templates", "file with one name template per line", false);
+    parser.add_argument("-w", "--words", "file with the values for {word}, one per line", false);
+    parser.add_argument("-n", "--max-number", "values for {n} are [0, max-number) (default 100)", false);
+    parser.add_argument("-o", "--output", "file to add names to (default assets/namehashlookup_generated.txt)", false);
+    parser.add_argument("-O", "--object-id-output",
+                        "file to add object id names to (default assets/objectidlookup_generated.txt)", false);
+    parser.add_argument("-p", "--progress", "file to save progress to (default <hashes>.progress)", false);
+    parser.add_argument("-d", "--dry-run", "print the names without writing them", false);
+
+    i32 exit_code = 0;
+    if (!parse_arguments(parser, argc, argv, &exit_code)) return exit_code;
+
+    const std::filesystem::path hashes_filename = parser.get<std::string>("hashes");
+
+    hash_cracker::Targets targets;
+    if (!hash_cracker::load_targets(hashes_filename, &targets)) return 1;
+
+    hash_cracker::Options options;
+    if (parser.exists("template")) options.m_Templates.push_back(parser.get<std::string>("template"));
+    if (parser.exists("templates") && !read_lines(parser.get<std::string>("templates"), &options.m_Templates)) {
+        return 1;
+    }
+
+    if (parser.exists("words") && !read_lines(parser.get<std::string>("words"), &options.m_Words)) return 1;
+    if (parser.exists("max-number")) options.m_MaxNumber = parser.get<u32>("max-number");
+
+    options.m_ProgressFile = (parser.exists("progress") ? std::filesystem::path(parser.get<std::string>("progress"))
+                                                        : (hashes_filename.string() + ".progress"));
+
+    if (options.m_Templates.empty()) {
+        LOG_ERROR("crack : at least one of --template or --templates is required.");
+        return 1;
+    }
+
+    u64 num_candidates = 0;
+    for (const auto& name_template : options.m_Templates) {
+        num_candidates += hash_cracker::count_candidates(name_template, options);
+    }
+
+    LOG_INFO("crack : {} namehashes, {} object ids, {} candidates", targets.m_NameHashes.size(),
+             targets.m_ObjectIds.size(), num_candidates);
+
+    // names are added after every round, before the progress file moves past them. object ids are a different hash
+    // (murmur3), so their names are kept out of the namehash lookup sources.
+    const bool                  dry_run  = parser.exists("dry-run");
+    const std::filesystem::path filename = (parser.exists("output") ? parser.get<std::string>("output")
+                                                                    : "assets/namehashlookup_generated.txt");
+    const std::filesystem::path object_id_filename =
+        (parser.exists("object-id-output") ? parser.get<std::string>("object-id-output")
+                                           : "assets/objectidlookup_generated.txt");
+
+    u32  num_found            = 0;
+    u32  num_added            = 0;
+    u32  num_object_ids_added = 0;
+    auto on_matches           = [&](const std::vector<hash_cracker::Match>& matches) {
+        std::vector<std::string> names;
+        std::vector<std::string> object_id_names;
+        for (const auto& match : matches) {
+            if (match.m_IsObjectId) {
+                fmt::print("0x{:016X} : {}\n", match.m_Hash, match.m_Name);
+                object_id_names.push_back(match.m_Name);
+            } else {
+                fmt::print("0x{:08X} : {}\n", match.m_Hash, match.m_Name);
+                names.push_back(match.m_Name);
+            }
+        }
+
+        num_found += static_cast<u32>(matches.size());
+        if (dry_run) return true;
+
+        u32 num_round_added = 0;
+        if (!names.empty() && !append_to_namehash_lookup_source(filename, std::move(names), &num_round_added)) {
+            return false;
+        }
+
+        num_added += num_round_added;
+
+        num_round_added = 0;
+        if (!object_id_names.empty()
+            && !append_to_namehash_lookup_source(object_id_filename, std::move(object_id_names), &num_round_added)) {
+            return false;
+        }
+
+        num_object_ids_added += num_round_added;
+        return true;
+    };
+
+    const auto start = std::chrono::high_resolution_clock::now();
+    const bool ok    = hash_cracker::crack(targets, options, on_matches);
+    const auto end   = std::chrono::high_resolution_clock::now();
+
+    LOG_INFO("crack : {} names found in {}ms", num_found,
+             std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count());
+
+    if (num_added > 0) {
+        LOG_INFO("crack : added {} names to \"{}\", run build_namehashlookup.py to rebuild the lookup table.",
+                 num_added, filename.generic_string());
+    }
+
+    if (num_object_ids_added > 0) {
+        LOG_INFO("crack : added {} object id names to \"{}\"", num_object_ids_added,
+                 object_id_filename.generic_string());
+    }
+
+    return (ok ? 0 : 1);
+}
+
+static i32 export_texture(App& app, i32 argc, const char** argv)
+{
+    argparse::ArgumentParser parser(argv[0], "Decode a texture and save it as an image");
+    parser.add_argument("-g", "--game", "game to read from (jc3, jc4)", false);
+    parser.add_argument("-f", "--file", "texture filename (.ddsc)", true);
+    parser.add_argument("-o", "--output", "output directory (default current directory)", false);
+    parser.add_argument("-t", "--type", "image type, png or tga (default png)", false);
+
+    i32 exit_code = 0;
+    if (!parse_arguments(parser, argc, argv, &exit_code)) return exit_code;
+
+    EGame game;
+    if (!get_game(parser, &game)) return 1;
+
+    auto type = image_writer::E_IMAGE_TYPE_PNG;
+    if (parser.exists("type") && !image_writer::parse_type(parser.get<std::string>("type"), &type)) {
+        LOG_ERROR("texture-export : unknown image type \"{}\" (expected png or tga)", parser.get<std::string>("type"));
+        return 1;
+    }
+
+    auto* resource_manager = IGame::create_resource_manager(game, app);
+    if (!resource_manager) return 1;
+
+    const auto            filename = parser.get<std::string>("file");
+    std::filesystem::path output   = (parser.exists("output") ? parser.get<std::string>("output") : ".");
+    output /= std::filesystem::path(filename).filename();
+    output.replace_extension(image_writer::get_extension(type));
+
+    const auto start   = std::chrono::high_resolution_clock::now();
+    const bool success = texture_export::export_to(*resource_manager, filename, output, type);
+    const auto end     = std::chrono::high_resolution_clock::now();
+    ResourceManager::destroy(resource_manager);
+
+    if (!success) return 1;
+
+    LOG_INFO("texture-export : saved \"{}\" in {}ms", output.generic_string(),
+             std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count());
+    return 0;
+}
+
+static i32 export_model(App& app, i32 argc, const char** argv)
+{
+    argparse::ArgumentParser parser(argv[0], "Save a model with every texture it uses as images");
+    parser.add_argument("-g", "--game", "game to read from (jc3, jc4)", false);
+    parser.add_argument("-f", "--file", "model filename (.rbm or .modelc)", true);
+    parser.add_argument("-o", "--output", "output directory (default current directory)", false);
+    parser.add_argument("-t", "--type", "image type, png or tga (default png)", false);
+
+    i32 exit_code = 0;
+    if (!parse_arguments(parser, argc, argv, &exit_code)) return exit_code;
+
+    EGame game;
+    if (!get_game(parser, &game)) return 1;
+
+    auto type = image_writer::E_IMAGE_TYPE_PNG;
+    if (parser.exists("type") && !image_writer::parse_type(parser.get<std::string>("type"), &type)) {
+        LOG_ERROR("model-export : unknown image type \"{}\" (expected png or tga)", parser.get<std::string>("type"));
+        return 1;
+    }
+
+    auto* resource_manager = IGame::create_resource_manager(game, app);
+    if (!resource_manager) return 1;
+
+    const std::filesystem::path output = (parser.exists("output") ? parser.get<std::string>("output") : ".");
+
+    texture_export::BatchStats stats;
+    const bool success = texture_export::export_model(*resource_manager, parser.get<std::string>("file"), output, type,
+                                                      &stats);
+    ResourceManager::destroy(resource_manager);
+
+    texture_export::log_batch_stats(stats);
+    return (success ? 0 : 1);
+}
+
+static i32 import_texture(App& app, i32 argc, const char** argv)
+{
+    argparse::ArgumentParser parser(argv[0], "Build .ddsc and .hmddsc textures from png, tga or dds images");
+    parser.add_argument("-i", "--input", "image, or a directory of images which is imported recursively", true);
+    parser.add_argument("-o", "--output", "output .ddsc, or directory when --input is a directory", true);
+    parser.add_argument("-f", "--format", "bc1, bc3, bc4, bc5 or bc7 (default bc7)", false);
+    parser.add_argument("-q", "--quality", "fast, normal or high (default normal)", false);
+    parser.add_argument("-m", "--mip-filter", "box or kaiser (default box)", false);
+    parser.add_argument("-s", "--source-mips", "largest mips written to the .hmddsc (default 1, 0 for none)", false);
+
+    i32 exit_code = 0;
+    if (!parse_arguments(parser, argc, argv, &exit_code)) return exit_code;
+
+    texture_import::Options options;
+    if (parser.exists("format")
+        && !texture_encoder::parse_format(parser.get<std::string>("format"), &options.m_Format)) {
+        LOG_ERROR("texture-import : unknown format \"{}\"", parser.get<std::string>("format"));
+        return 1;
+    }
+
+    if (parser.exists("quality")
+        && !texture_encoder::parse_quality(parser.get<std::string>("quality"), &options.m_Quality)) {
+        LOG_ERROR("texture-import : unknown quality \"{}\"", parser.get<std::string>("quality"));
+        return 1;
+    }
+
+    if (parser.exists("mip-filter")
+        && !texture_encoder::parse_mip_filter(parser.get<std::string>("mip-filter"), &options.m_MipFilter)) {
+        LOG_ERROR("texture-import : unknown mip filter \"{}\"", parser.get<std::string>("mip-filter"));
+        return 1;
+    }
+
+    if (parser.exists("source-mips")) options.m_NumSourceMips = parser.get<u32>("source-mips");
+
+    // input and output pairs, a directory keeps its layout under the output directory
+    const std::filesystem::path input  = parser.get<std::string>("input");
+    const std::filesystem::path output = parser.get<std::string>("output");
+
+    std::vector<std::pair<std::filesystem::path, std::filesystem::path>> files;
+    if (std::filesystem::is_directory(input)) {
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(input)) {
+            if (!entry.is_regular_file() || !image_reader::is_supported(entry.path())) continue;
+
+            auto out_filename = (output / std::filesystem::relative(entry.path(), input));
+            out_filename.replace_extension(".ddsc");
+            files.emplace_back(entry.path(), std::move(out_filename));
+        }
+    } else {
+        files.emplace_back(input, output);
+    }
+
+    // textures are imported one at a time, the blocks of each one are spread across the workers
+    u32        num_failed = 0;
+    const auto start      = std::chrono::high_resolution_clock::now();
+    for (const auto& [filename, out_filename] : files) {
+        if (!texture_import::import_file(filename, out_filename, options)) {
+            LOG_ERROR("texture-import : failed to import \"{}\"", filename.generic_string());
+            ++num_failed;
+            continue;
+        }
+
+        LOG_INFO("texture-import : \"{}\" -> \"{}\"", filename.generic_string(), out_filename.generic_string());
+    }
+
+    const auto end = std::chrono::high_resolution_clock::now();
+    LOG_INFO("texture-import : imported {} of {} textures as {} in {}ms", (files.size() - num_failed), files.size(),
+             texture_decoder::get_format_name(options.m_Format),
+             std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count());
+    return (num_failed > 0 ? 1 : 0);
+}
+
+static i32 texture_stats(App& app, i32 argc, const char** argv)
+{
+    static constexpr double MEGABYTE = (1024.0 * 1024.0);
+
+    argparse::ArgumentParser parser(argv[0], "Estimate the texture memory a file needs against the texture budgets");
+    parser.add_argument("-g", "--game", "game to read from (jc3, jc4)", false);
+    parser.add_argument("-i", "--graph", "graph filename", false);
+    parser.add_argument("-f", "--file", "filename or namehash, its textures are found with the dependency graph", true);
+    parser.add_argument("-l", "--limit", "maximum number of dependencies to follow", false);
+    parser.add_argument("-q", "--quality", "full, half, quarter or a maximum size (default texture_quality)", false);
+
+    i32 exit_code = 0;
+    if (!parse_arguments(parser, argc, argv, &exit_code)) return exit_code;
+
+    EGame game;
+    if (!get_game(parser, &game)) return 1;
+
+    const std::string quality_name = (parser.exists("quality") ? parser.get<std::string>("quality")
+                                                               : app.get_settings().get("texture_quality", "full"));
+    avtx::Quality     quality;
+    if (!avtx::parse_quality(quality_name, &quality)) {
+        LOG_ERROR("texture-stats : unknown quality \"{}\"", quality_name);
+        return 1;
+    }
+
+    const auto      graph_filename = get_dependency_graph_path(parser, game);
+    DependencyGraph graph;
+    if (!graph.load(graph_filename)) {
+        LOG_ERROR("texture-stats : failed to load graph \"{}\" (run deps-index first)",
+                  graph_filename.generic_string());
+        return 1;
+    }
+
+    auto* resource_manager = IGame::create_resource_manager(game, app);
+    if (!resource_manager) return 1;
+
+    const auto namehash   = parse_namehash(parser.get<std::string>("file"));
+    const u32  limit      = (parser.exists("limit") ? parser.get<u32>("limit") : 0);
+    auto       namehashes = graph.get_all_dependencies(namehash, limit);
+    namehashes.push_back(namehash);
+
+    // the .ddsc streams are resident as soon as the texture is created, the source stream the quality wants is what
+    // streaming it in adds
+    struct Entry {
+        std::string_view m_Name;
+        u32              m_Width;
+        u32              m_Height;
+        u32              m_Format;
+        u64              m_Size;
+        u64              m_SourceSize;
+    };
+
+    std::vector<Entry> entries;
+    ByteArray          buffer;
+    for (const auto texture_namehash : namehashes) {
+        const auto name = find_in_namehash_lookup_table(texture_namehash);
+        if (name.size() < 5 || name.substr(name.size() - 5) != ".ddsc") continue;
+
+        avtx::StreamView stream;
+        if (!resource_manager->read(texture_namehash, &buffer, ResourceManager::E_READ_FLAG_QUIET)
+            || !avtx::get_best_stream(buffer, {}, &stream, quality)) {
+            LOG_ERROR("texture-stats : failed to read \"{}\"", name);
+            continue;
+        }
+
+        entries.push_back({name, stream.m_Width, stream.m_Height, stream.m_Format, stream.m_Size,
+                           avtx::get_source_stream_size(buffer, quality)});
+    }
+
+    ResourceManager::destroy(resource_manager);
+
+    // the streamer upgrades the biggest first when nothing has been drawn yet
+    std::sort(entries.begin(), entries.end(),
+              [](const Entry& lhs, const Entry& rhs) { return lhs.m_SourceSize > rhs.m_SourceSize; });
+
+    auto&     settings          = app.get_settings();
+    const u64 texture_budget_mb = settings.get<u32>("texture_budget_mb", TextureCache::DEFAULT_BUDGET_MB);
+    const u64 stream_budget_mb  = settings.get<u32>("texture_stream_budget_mb", TextureStreamer::DEFAULT_BUDGET_MB);
+    const u64 texture_budget    = (texture_budget_mb * 1024 * 1024);
+    const u64 stream_budget     = (stream_budget_mb * 1024 * 1024);
+
+    u64 size         = 0;
+    u64 source_size  = 0;
+    u64 streamed     = 0;
+    u32 num_upgrades = 0;
+    u32 num_streamed = 0;
+    for (const auto& entry : entries) {
+        fmt::print("{:>10.1f} KB {:>10.1f} KB  {:>5}x{:<5} {:<6} {}\n", (entry.m_Size / 1024.0),
+                   (entry.m_SourceSize / 1024.0), entry.m_Width, entry.m_Height,
+                   texture_decoder::get_format_name(entry.m_Format), entry.m_Name);
+
+        size += entry.m_Size;
+        if (entry.m_SourceSize == 0) continue;
+
+        source_size += entry.m_SourceSize;
+        ++num_upgrades;
+        if ((streamed + entry.m_SourceSize) <= stream_budget) {
+            streamed += entry.m_SourceSize;
+            ++num_streamed;
+        }
+    }
+
+    LOG_INFO("texture-stats : {} textures at {} quality, {:.1f} MB from the .ddsc files, {:.1f} MB more fully streamed",
+             entries.size(), quality_name, (size / MEGABYTE), (source_size / MEGABYTE));
+    LOG_INFO("texture-stats : {} of {} upgrades fit the {:.0f} MB stream budget, {:.1f} of {:.0f} MB texture budget",
+             num_streamed, num_upgrades, (stream_budget / MEGABYTE), ((size + streamed) / MEGABYTE),
+             (texture_budget / MEGABYTE));
+    return 0;
+}
+
+// runs callback iterations times and returns the fastest run in milliseconds
+template <typename Callback> static double time_fastest(u32 iterations, Callback&& callback)
+{
+    double best = std::numeric_limits<double>::max();
+    for (u32 i = 0; i < iterations; ++i) {
+        const auto start = std::chrono::high_resolution_clock::now();
+        callback();
+        const auto end = std::chrono::high_resolution_clock::now();
+        best           = std::min(best, std::chrono::duration<double, std::milli>(end - start).count());
+    }
+
+    return best;
+}
+
+static i32 bench_hash(App& app, i32 argc, const char** argv)
+{
+    argparse::ArgumentParser parser(argv[0], "Check and time the batched string hashes against AvaFormatLib");
+    parser.add_argument("-g", "--game", "game dictionary to hash (jc3, jc4)", false);
+    parser.add_argument("-n", "--iterations", "number of runs, the fastest is reported (default 10)", false);
+
+    i32 exit_code = 0;
+    if (!parse_arguments(parser, argc, argv, &exit_code)) return exit_code;
+
+    EGame game;
+    if (!get_game(parser, &game)) return 1;
+
+    const u32 iterations = (parser.exists("iterations") ? std::max(1u, parser.get<u32>("iterations")) : 10);
+
+    const auto start            = std::chrono::high_resolution_clock::now();
+    auto*      resource_manager = IGame::create_resource_manager(game, app);
+    const auto end              = std::chrono::high_resolution_clock::now();
+    if (!resource_manager) return 1;
+
+    // the dictionary names, and the kind of strings a cracking run tries (every name with a numbered suffix)
+    std::vector<std::string> dictionary;
+    resource_manager->enumerate_dictionary([&](u32, const std::string& filename) { dictionary.push_back(filename); });
+    ResourceManager::destroy(resource_manager);
+
+    std::vector<std::string> candidates;
+    candidates.reserve(dictionary.size() * 10);
+    for (const auto& filename : dictionary) {
+        for (u32 i = 0; i < 10; ++i) {
+            candidates.push_back(fmt::format("{}_{}", filename, i));
+        }
+    }
+
+    LOG_INFO("bench-hash : dictionary loaded in {}ms, batches use {}",
+             std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count(),
+             hashing::get_batch_implementation_name());
+
+    u32 num_mismatches = 0;
+    for (const auto* workload : {&dictionary, &candidates}) {
+        const auto                    name  = (workload == &dictionary ? "dictionary" : "candidates");
+        const auto                    count = static_cast<u32>(workload->size());
+        std::vector<std::string_view> views(workload->begin(), workload->end());
+        std::vector<u32>              expected32(count), hashes32(count);
+        std::vector<u64>              expected64(count), hashes64(count);
+
+        const auto ava32 = time_fastest(iterations, [&] {
+            for (u32 i = 0; i < count; ++i) expected32[i] = ava::hashlittle((*workload)[i].c_str());
+        });
+        const auto batch32 = time_fastest(iterations, [&] {
+            hashing::hashlittle_batch(views.data(), count, hashes32.data());
+        });
+        const auto ava64 = time_fastest(iterations, [&] {
+            for (u32 i = 0; i < count; ++i) expected64[i] = ava::HashString64((*workload)[i].c_str());
+        });
+        const auto batch64 = time_fastest(iterations, [&] {
+            hashing::hash_string_64_batch(views.data(), count, hashes64.data());
+        });
+
+        // the batches have to be bit exact
+        for (u32 i = 0; i < count; ++i) {
+            if (hashes32[i] != expected32[i] || hashes64[i] != expected64[i]) {
+                if (num_mismatches++ < 10) LOG_ERROR("bench-hash : mismatch for \"{}\"", (*workload)[i]);
+            }
+        }
+
+        fmt::print("{:<10} {:>8} strings : hashlittle {:.2f}ms -> {:.2f}ms ({:.2f}x)", name, count, ava32, batch32,
+                   (ava32 / batch32));
+        fmt::print(", HashString64 {:.2f}ms -> {:.2f}ms ({:.2f}x)\n", ava64, batch64, (ava64 / batch64));
+    }
+
+    if (num_mismatches > 0) {
+        LOG_ERROR("bench-hash : {} hashes don't match AvaFormatLib.", num_mismatches);
+        return 1;
+    }
+
+    return 0;
+}
+
+static i32 bench_texture(App& app, i32 argc, const char** argv)
+{
+    argparse::ArgumentParser parser(argv[0], "Check and time the texture decoder against the scalar reference");
+    parser.add_argument("-s", "--size", "width and height of the test surfaces (default 2048)", false);
+    parser.add_argument("-n", "--iterations", "number of runs, the fastest is reported (default 10)", false);
+
+    i32 exit_code = 0;
+    if (!parse_arguments(parser, argc, argv, &exit_code)) return exit_code;
+
+    const u32 size       = (parser.exists("size") ? std::max(1u, parser.get<u32>("size")) : 2048);
+    const u32 iterations = (parser.exists("iterations") ? std::max(1u, parser.get<u32>("iterations")) : 10);
+
+    LOG_INFO("bench-texture : {}x{} surfaces, decoder uses {} with {} workers", size, size,
+             texture_decoder::get_implementation_name(), jobs::get_worker_count());
+
+    using namespace texture_decoder;
+    static constexpr EFormat formats[] = {FORMAT_BC1_UNORM, FORMAT_BC2_UNORM, FORMAT_BC3_UNORM,
+                                          FORMAT_BC4_UNORM, FORMAT_BC5_UNORM, FORMAT_BC7_UNORM,
+                                          FORMAT_B8G8R8A8_UNORM, FORMAT_R8_UNORM};
+
+    // random blocks cover every palette mode (and every bc7 mode and partition), which real textures may not
+    std::mt19937 rng(size);
+    const double megapixels = ((static_cast<double>(size) * size) / 1000000.0);
+
+    u32 num_mismatches = 0;
+    for (const auto format : formats) {
+        ByteArray data(get_surface_size(format, size, size));
+        std::generate(data.begin(), data.end(), [&] { return static_cast<u8>(rng()); });
+
+        ByteArray expected(static_cast<u64>(size) * size * 4);
+        ByteArray pixels(expected.size());
+
+        const auto reference = time_fastest(iterations, [&] {
+            decode_reference(format, data.data(), data.size(), size, size, expected.data());
+        });
+        const auto fast = time_fastest(iterations, [&] {
+            decode(format, data.data(), data.size(), size, size, pixels.data());
+        });
+
+        // decode() has to be bit exact
+        if (pixels != expected) {
+            LOG_ERROR("bench-texture : {} doesn't match the reference decoder", get_format_name(format));
+            ++num_mismatches;
+        }
+
+        fmt::print("{:<9} reference {:>8.1f} MP/s, decode {:>8.1f} MP/s ({:.2f}x)\n", get_format_name(format),
+                   (megapixels / (reference / 1000.0)), (megapixels / (fast / 1000.0)), (reference / fast));
+    }
+
+    return (num_mismatches > 0 ? 1 : 0);
+}
+
+static const Command s_commands[] = {
+    {"rtpc-index", "index every runtime container in the game archives", rtpc_index},
+    {"rtpc-query", "find runtime container variants by name and/or value", rtpc_query},
+    {"rtpc-diff", "create a patch with the differences between two runtime containers", rtpc_diff},
+    {"rtpc-patch", "apply a patch created by rtpc-diff to a runtime container", rtpc_patch},
+    {"deps-index", "build the graph of which files every file depends on", deps_index},
+    {"deps", "list the files a file depends on, or the files which depend on it", deps},
+    {"grep", "find files in the game archives which contain a string, hash or bytes", grep},
+    {"harvest-names", "find names for unknown namehashes in strings from the game archives", harvest_names},
+    {"crack", "find names for unknown namehashes and object ids from name templates", crack},
+    {"texture-export", "decode a texture and save it as a png or tga", export_texture},
+    {"model-export", "save a model and its textures, read and decoded in one batch", export_model},
+    {"texture-import", "build .ddsc and .hmddsc textures from png, tga or dds images", import_texture},
+    {"texture-stats", "estimate the texture memory a file needs against the texture budgets", texture_stats},
+    {"bench-hash", "check and time the batched string hashes against AvaFormatLib", bench_hash},
+    {"bench-texture", "check and time the texture decoder against the scalar reference", bench_texture},
+};
+
+static void print_usage()
+{
+    fmt::print("usage: jc-model-renderer <command> [options]\n\ncommands:\n");
+    for (const auto& command : s_commands) {
+        fmt::print("  {:<16} {}\n", command.name, command.description);
+    }
+
+    fmt::print("\nrun a command with --help for its options.\n");
+}
+
+i32 run(App& app, i32 argc, const char** argv)
+{
+    ASSERT(argc > 1);
+
+    const std::string_view name = argv[1];
+    auto iter = std::find_if(std::begin(s_commands), std::end(s_commands),
+                             [&](const Command& command) { return name == command.name; });
+
+    if (iter == std::end(s_commands)) {
+        if (name != "help" && name != "--help" && name != "-h") {
+            LOG_ERROR("unknown command \"{}\"", name);
+            print_usage();
+            return 1;
+        }
+
+        print_usage();
+        return 0;
+    }
+
+    load_namehash_lookup_table();
+
+    // the command sees its own name as argv[0]
+    return (*iter).callback(app, (argc - 1), (argv + 1));
+}
+} // namespace jcmr::cli
@@ -0,0 +1,17 @@
+#ifndef JCMR_APP_CLI_H_HEADER_GUARD
+#define JCMR_APP_CLI_H_HEADER_GUARD
+
+#include "platform.h"
+
+namespace jcmr
+{
+struct App;
+
+namespace cli
+{
+    // run a command line tool (argv[1] is the command name), returns the process exit code
+    i32 run(App& app, i32 argc, const char** argv);
+} // namespace cli
+} // namespace jcmr
+
+#endif // JCMR_APP_CLI_H_HEADER_GUARD
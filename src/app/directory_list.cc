@@ -4,13 +4,21 @@
 #include "platform.h"
 
 #include "app/app.h"
-#include "app/utils.h"
+#include "app/hashing.h"
 #include "game/format.h"
+#include "game/game.h"
+#include "game/thumbnail_cache.h"
+#include "render/texture.h"
 #include "render/ui.h"
 
 #include "render/fonts/icons.h"
 
+#include <condition_variable>
+#include <cstring>
 #include <imgui.h>
+#include <mutex>
+#include <numeric>
+#include <thread>
 
 namespace jcmr
 {
@@ -25,61 +33,557 @@ static bool has_search_terms()
     return s_search_terms[0] != '\0';
 }
 
-DirectoryList::DirectoryList(const std::string& folder_name, const std::string& remaining_parts,
-                             const std::string& current_path, const std::string& full_path)
-    : name(folder_name)
-    , path(current_path)
+static constexpr u32 TRIGRAM_BUCKET_BITS = 16;
+static constexpr u32 MAX_SEARCH_RESULTS  = 1000;
+static constexpr u32 SEARCH_CHUNK_SIZE   = 4096; // candidates checked between cancellation checks
+
+static u32 hash_name(std::string_view name)
 {
-    insert_part(remaining_parts, full_path);
+    // fnv-1a
+    u32 result = 0x811C9DC5;
+    for (auto ch : name) {
+        result = ((result ^ static_cast<u8>(ch)) * 0x01000193);
+    }
+
+    return result;
 }
 
-void DirectoryList::add(const std::string& filepath)
+static u64 folder_lookup_key(u32 parent, std::string_view name)
+{
+    return ((static_cast<u64>(parent) << 32) | hash_name(name));
+}
+
+static u32 get_trigram_bucket(const char* str)
 {
-    insert_part(filepath, filepath);
+    const u32 trigram = (static_cast<u8>(str[0]) | (static_cast<u8>(str[1]) << 8) | (static_cast<u8>(str[2]) << 16));
+    return ((trigram * 0x9E3779B1) >> (32 - TRIGRAM_BUCKET_BITS));
 }
 
-void DirectoryList::insert_part(const std::string& part, const std::string& full_path)
+// the posting list of the rarest trigram in the terms has every possible match, returns false if the terms are too
+// short to use the index.
+static bool find_rarest_trigram(const std::string& terms, const u32* offsets, const u32* postings,
+                                const u32** out_begin, const u32** out_end)
 {
-    auto slash_pos = part.find('/');
-    if (slash_pos != std::string::npos) {
-        auto directory = part.substr(0, slash_pos);
-        auto remaining = part.substr(slash_pos + 1, part.length());
+    if (terms.size() < 3 || !offsets) {
+        return false;
+    }
+
+    *out_begin = nullptr;
+    *out_end   = nullptr;
+
+    for (u64 k = 0; (k + 2) < terms.size(); ++k) {
+        const auto bucket = get_trigram_bucket(&terms[k]);
+        const auto first  = offsets[bucket];
+        const auto last   = offsets[bucket + 1];
+
+        if (!*out_begin || (last - first) < (*out_end - *out_begin)) {
+            *out_begin = (postings + first);
+            *out_end   = (postings + last);
+        }
+    }
+
+    return true;
+}
+
+// ranked search on a worker thread. a new query cancels the one in progress, the match count is published while
+// the search is running and the best results once it finishes.
+struct DirectoryList::SearchWorker {
+    // everything the search reads. these point into the vectors of the list, which keep their buffers when the list
+    // is moved. clear() and sort() stop the worker before changing them.
+    struct View {
+        const Node* m_Nodes;
+        const char* m_Strings;
+        const u32*  m_TrigramOffsets; // nullptr if the index wasn't built
+        const u32*  m_TrigramPostings;
+        u32         m_NumNodes;
+    };
+
+    // exact match, then prefix, then substring. shorter paths first, then tree order
+    struct Result {
+        u64 m_Key;
+        u32 m_Node;
+
+        bool operator<(const Result& other) const
+        {
+            return (m_Key != other.m_Key) ? (m_Key < other.m_Key) : (m_Node < other.m_Node);
+        }
+    };
 
-        auto iter = std::find_if(folders.begin(), folders.end(),
-                                 [&](const DirectoryList& folder) { return directory == folder.name; });
+    SearchWorker()
+        : m_thread(&SearchWorker::run, this)
+    {
+    }
+
+    ~SearchWorker()
+    {
+        {
+            std::lock_guard<std::mutex> _lock(m_mutex);
+            m_exit = true;
+            ++m_generation;
+        }
+
+        m_condition.notify_one();
+        m_thread.join();
+    }
+
+    void post(const std::string& terms, const View& view)
+    {
+        {
+            std::lock_guard<std::mutex> _lock(m_mutex);
+            m_terms         = terms;
+            m_view          = view;
+            m_has_query     = true;
+            m_num_matches   = 0;
+            m_finished      = false;
+            m_results_ready = false;
+            ++m_generation;
+        }
+
+        m_condition.notify_one();
+    }
+
+    // out_results is only replaced once the current query has finished
+    // returns true if out_results was replaced with new results
+    bool get_status(u32* out_num_matches, bool* out_finished, std::vector<u32>* out_results)
+    {
+        std::lock_guard<std::mutex> _lock(m_mutex);
+        *out_num_matches = m_num_matches;
+        *out_finished    = m_finished;
 
-        if (iter == folders.end()) {
-            // calculate the path to the current directory
-            auto current_path = full_path.substr(0, full_path.find(directory) + directory.length());
+        if (!m_results_ready) {
+            return false;
+        }
+
+        *out_results    = std::move(m_results);
+        m_results_ready = false;
+        return true;
+    }
+
+  private:
+    void run()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for (;;) {
+            m_condition.wait(lock, [&] { return (m_exit || m_has_query); });
+            if (m_exit) {
+                return;
+            }
+
+            m_has_query = false;
+
+            const auto terms      = m_terms;
+            const auto view       = m_view;
+            const auto generation = m_generation;
+
+            lock.unlock();
+            search(terms, view, generation);
+            lock.lock();
+        }
+    }
+
+    // returns false if the query was cancelled
+    bool publish(u32 generation, u32 num_matches, std::vector<u32>* results)
+    {
+        std::lock_guard<std::mutex> _lock(m_mutex);
+        if (m_generation != generation) {
+            return false;
+        }
+
+        m_num_matches = num_matches;
+        if (results) {
+            m_results       = std::move(*results);
+            m_results_ready = true;
+            m_finished      = true;
+        }
+
+        return true;
+    }
+
+    void search(const std::string& terms, const View& view, u32 generation)
+    {
+        // terms with a folder in them are matched against the whole path, which isn't indexed
+        const bool match_path = (terms.find('/') != std::string::npos);
+
+        const u32* begin = nullptr;
+        const u32* end   = nullptr;
+        if (!match_path) {
+            find_rarest_trigram(terms, view.m_TrigramOffsets, view.m_TrigramPostings, &begin, &end);
+        }
+
+        const u32 count = (begin ? static_cast<u32>(end - begin) : view.m_NumNodes);
+
+        std::vector<Result> heap; // worst result at the front
+        heap.reserve(MAX_SEARCH_RESULTS);
+        u32 num_matches = 0;
+
+        for (u32 i = 0; i < count; ++i) {
+            if ((i % SEARCH_CHUNK_SIZE) == (SEARCH_CHUNK_SIZE - 1) && !publish(generation, num_matches, nullptr)) {
+                return;
+            }
+
+            const auto  index = (begin ? begin[i] : i);
+            const auto& node  = view.m_Nodes[index];
+            if (node.m_IsFolder) continue;
+
+            const char* path = &view.m_Strings[node.m_Path];
+            const char* name = (match_path ? path : &view.m_Strings[node.m_Name]);
+            const char* pos  = strstr(name, terms.c_str());
+            if (!pos) continue;
+
+            ++num_matches;
+
+            u64 rank = 2;
+            if (pos == name) {
+                rank = (name[terms.size()] == '\0' ? 0 : 1);
+            }
+
+            const Result result{((rank << 32) | strlen(path)), index};
+            if (heap.size() < MAX_SEARCH_RESULTS) {
+                heap.push_back(result);
+                std::push_heap(heap.begin(), heap.end());
+            } else if (result < heap.front()) {
+                std::pop_heap(heap.begin(), heap.end());
+                heap.back() = result;
+                std::push_heap(heap.begin(), heap.end());
+            }
+        }
+
+        std::sort_heap(heap.begin(), heap.end());
+
+        std::vector<u32> results(heap.size());
+        std::transform(heap.begin(), heap.end(), results.begin(), [](const Result& result) { return result.m_Node; });
+        publish(generation, num_matches, &results);
+    }
+
+  private:
+    std::mutex              m_mutex;
+    std::condition_variable m_condition;
+    bool                    m_exit       = false;
+    bool                    m_has_query  = false;
+    u32                     m_generation = 0;
+    std::string             m_terms;
+    View                    m_view{};
+    u32                     m_num_matches   = 0;
+    bool                    m_finished      = false;
+    bool                    m_results_ready = false;
+    std::vector<u32>        m_results;
+    std::thread             m_thread; // last, so everything is constructed before the thread starts
+};
+
+DirectoryList::DirectoryList()
+{
+    clear();
+}
+
+DirectoryList::~DirectoryList() = default;
+
+DirectoryList::DirectoryList(DirectoryList&&) = default;
+
+DirectoryList& DirectoryList::operator=(DirectoryList&&) = default;
+
+void DirectoryList::clear()
+{
+    stop_search_worker();
+
+    m_nodes.clear();
+    m_strings.clear();
+    m_folder_lookup.clear();
+    m_num_folders = 0;
+    m_last_path.clear();
+    m_last_folders.clear();
+    m_trigram_offsets.clear();
+    m_trigram_postings.clear();
+    m_search_terms.clear();
+    m_search_matches.clear();
+    m_visible.clear();
+    m_rows.clear();
+    m_open_state.clear();
+    m_open_file_rows.clear();
+    m_rows_dirty = true;
+
+    // root node, the path and name is the empty string at the start of the pool
+    m_strings.push_back('\0');
+    m_nodes.push_back({INVALID_NODE, 0, 0, 0, 0, 0, 0, true});
+}
 
-            // add new directory
-            DirectoryList dl(directory, remaining, current_path, full_path);
-            folders.emplace_back(std::move(dl));
+u32 DirectoryList::add_node(u32 parent, std::string_view path, u32 name_start, bool is_folder)
+{
+    const auto offset = static_cast<u32>(m_strings.size());
+    m_strings.insert(m_strings.end(), path.begin(), path.end());
+    m_strings.push_back('\0');
+
+    Node node{};
+    node.m_Parent   = parent;
+    node.m_Path     = offset;
+    node.m_Name     = (offset + name_start);
+    node.m_IsFolder = is_folder;
+
+    m_nodes.push_back(node);
+    return static_cast<u32>(m_nodes.size() - 1);
+}
+
+// returns the slot for the folder, which is INVALID_NODE if it doesn't exist yet
+u32* DirectoryList::find_folder(u32 parent, std::string_view name)
+{
+    // keep the table at most half full
+    if ((m_num_folders * 2) >= m_folder_lookup.size()) {
+        const auto size = std::max<size_t>(1024, (m_folder_lookup.size() * 2));
+        const auto mask = (size - 1);
+
+        std::vector<FolderLookupEntry> entries(size, {0, INVALID_NODE});
+
+        for (const auto& entry : m_folder_lookup) {
+            if (entry.m_Node == INVALID_NODE) continue;
+
+            auto slot = (entry.m_Key * 0x9E3779B97F4A7C15) >> 32;
+            while (entries[slot & mask].m_Node != INVALID_NODE) ++slot;
+            entries[slot & mask] = entry;
+        }
+
+        m_folder_lookup = std::move(entries);
+    }
+
+    const auto key  = folder_lookup_key(parent, name);
+    const auto mask = (m_folder_lookup.size() - 1);
+
+    for (auto slot = (key * 0x9E3779B97F4A7C15) >> 32;; ++slot) {
+        auto& entry = m_folder_lookup[slot & mask];
+        if (entry.m_Node == INVALID_NODE) {
+            entry.m_Key = key;
+            return &entry.m_Node;
+        }
+
+        if (entry.m_Key == key && name == get_name(m_nodes[entry.m_Node])) {
+            return &entry.m_Node;
+        }
+    }
+}
+
+void DirectoryList::add(const std::string& filepath)
+{
+    const std::string_view path = filepath;
+
+    // paths are mostly added in order, so folders shared with the previous path don't need to be looked up again
+    const auto common = static_cast<size_t>(
+        std::mismatch(path.begin(), path.end(), m_last_path.begin(), m_last_path.end()).first - path.begin());
+
+    u32    parent = ROOT_NODE;
+    size_t start  = 0;
+    size_t slash  = 0;
+    size_t depth  = 0;
+
+    while ((slash = path.find('/', start)) != std::string_view::npos) {
+        if (slash < common && depth < m_last_folders.size()) {
+            parent = m_last_folders[depth];
         } else {
-            // folder already exists, insert the remaining bits into the current folder
-            (*iter).insert_part(remaining, full_path);
+            auto* folder = find_folder(parent, path.substr(start, (slash - start)));
+            if (*folder == INVALID_NODE) {
+                *folder = add_node(parent, path.substr(0, slash), static_cast<u32>(start), true);
+                ++m_num_folders;
+            }
+
+            parent = *folder;
+            m_last_folders.resize(depth);
+            m_last_folders.push_back(parent);
         }
-    } else {
-        // add the file to the current folder
-        auto extension_hash = ava::hashlittle(utils::get_extension(part).c_str());
-        files.push_back(std::make_tuple(part, full_path, extension_hash));
+
+        start = (slash + 1);
+        ++depth;
+    }
+
+    m_last_path.assign(path.begin(), path.end());
+    add_node(parent, path, static_cast<u32>(start), false);
+}
+
+// the extension is the end of the name, so it can be hashed in place. every file is hashed in one batch.
+void DirectoryList::hash_extensions()
+{
+    std::vector<u32>              files;
+    std::vector<std::string_view> extensions;
+    for (u32 i = 0; i < m_nodes.size(); ++i) {
+        if (m_nodes[i].m_IsFolder) continue;
+
+        const char* extension = strrchr(get_name(m_nodes[i]), '.');
+        files.push_back(i);
+        extensions.emplace_back(extension ? (extension + 1) : "");
+    }
+
+    std::vector<u32> hashes(files.size());
+    hashing::hashlittle_batch(extensions.data(), static_cast<u32>(extensions.size()), hashes.data());
+
+    for (u32 i = 0; i < files.size(); ++i) {
+        m_nodes[files[i]].m_ExtensionHash = hashes[i];
     }
 }
 
 void DirectoryList::sort()
 {
-    // sort folders
-    std::sort(folders.begin(), folders.end(),
-              [](const DirectoryList& lhs, const DirectoryList& rhs) -> bool { return lhs.name < rhs.name; });
+    stop_search_worker();
+    hash_extensions();
+
+    const auto num_nodes = static_cast<u32>(m_nodes.size());
+
+    // group every node by its parent
+    std::vector<u32> first_child(num_nodes + 1, 0);
+    for (u32 i = 1; i < num_nodes; ++i) {
+        ++first_child[m_nodes[i].m_Parent + 1];
+    }
+
+    std::partial_sum(first_child.begin(), first_child.end(), first_child.begin());
+
+    std::vector<u32> order(num_nodes - 1);
+    std::vector<u32> cursor(first_child.begin(), (first_child.end() - 1));
+    for (u32 i = 1; i < num_nodes; ++i) {
+        order[cursor[m_nodes[i].m_Parent]++] = i;
+    }
+
+    // folders first, then by name
+    for (u32 i = 0; i < num_nodes; ++i) {
+        std::sort((order.begin() + first_child[i]), (order.begin() + first_child[i + 1]), [&](u32 lhs, u32 rhs) {
+            const auto& a = m_nodes[lhs];
+            const auto& b = m_nodes[rhs];
+            if (a.m_IsFolder != b.m_IsFolder) return a.m_IsFolder;
+            return strcmp(get_name(a), get_name(b)) < 0;
+        });
+    }
+
+    // lay the nodes out breadth first so the children of every folder are contiguous
+    std::vector<Node> nodes;
+    std::vector<u32>  remap; // new index -> old index
+    nodes.reserve(num_nodes);
+    remap.reserve(num_nodes);
+
+    nodes.push_back(m_nodes[ROOT_NODE]);
+    remap.push_back(ROOT_NODE);
+
+    for (u32 index = 0; index < nodes.size(); ++index) {
+        const auto old_index = remap[index];
+
+        nodes[index].m_FirstChild = static_cast<u32>(nodes.size());
+        nodes[index].m_NumFolders = 0;
+        nodes[index].m_NumFiles   = 0;
+
+        for (u32 i = first_child[old_index]; i < first_child[old_index + 1]; ++i) {
+            const auto child = order[i];
+
+            auto node     = m_nodes[child];
+            node.m_Parent = index;
+            nodes.push_back(node);
+            remap.push_back(child);
+
+            if (node.m_IsFolder) {
+                ++nodes[index].m_NumFolders;
+            } else {
+                ++nodes[index].m_NumFiles;
+            }
+        }
+    }
+
+    m_nodes = std::move(nodes);
+    m_strings.shrink_to_fit();
+
+    // the lookup indices are stale now, and it's not needed after building
+    std::vector<FolderLookupEntry>().swap(m_folder_lookup);
+    m_num_folders = 0;
+    m_last_path.clear();
+    m_last_folders.clear();
+
+    // node indices have changed
+    m_rows.clear();
+    m_open_state.assign(m_nodes.size(), OPEN_STATE_DEFAULT);
+    m_open_file_rows.clear();
+    m_rows_dirty = true;
+
+    build_search_index();
+}
+
+void DirectoryList::build_search_index()
+{
+    const u32        num_buckets = (1 << TRIGRAM_BUCKET_BITS);
+    std::vector<u32> last_node(num_buckets, INVALID_NODE);
+
+    auto for_each_trigram = [&](auto&& callback) {
+        for (u32 i = 0; i < m_nodes.size(); ++i) {
+            if (m_nodes[i].m_IsFolder) continue;
+
+            const char* name = get_name(m_nodes[i]);
+            for (u32 k = 0; name[k] && name[k + 1] && name[k + 2]; ++k) {
+                const auto bucket = get_trigram_bucket(name + k);
+
+                // only add each file to a bucket once
+                if (last_node[bucket] == i) continue;
+                last_node[bucket] = i;
+
+                callback(bucket, i);
+            }
+        }
+    };
+
+    // count the postings for every bucket, then fill them in
+    m_trigram_offsets.assign((num_buckets + 1), 0);
+    for_each_trigram([&](u32 bucket, u32) { ++m_trigram_offsets[bucket + 1]; });
+    std::partial_sum(m_trigram_offsets.begin(), m_trigram_offsets.end(), m_trigram_offsets.begin());
+
+    std::vector<u32> cursor(m_trigram_offsets.begin(), (m_trigram_offsets.end() - 1));
+    std::fill(last_node.begin(), last_node.end(), INVALID_NODE);
+
+    m_trigram_postings.resize(m_trigram_offsets.back());
+    for_each_trigram([&](u32 bucket, u32 node) { m_trigram_postings[cursor[bucket]++] = node; });
+
+    m_search_terms.clear();
+    m_search_matches.clear();
+    m_visible.clear();
+}
+
+// returns true if the search terms changed
+bool DirectoryList::update_search()
+{
+    if (m_search_terms == s_search_terms) {
+        return false;
+    }
+
+    const std::string terms = s_search_terms;
+    if (terms.empty()) {
+        m_search_terms.clear();
+        m_search_matches.clear();
+        return true;
+    }
 
-    // sort files
-    std::sort(files.begin(), files.end(),
-              [](const File& lhs, const File& rhs) { return std::get<0>(lhs) < std::get<0>(rhs); });
+    const u32* begin = nullptr;
+    const u32* end   = nullptr;
+    find_rarest_trigram(terms, (m_trigram_offsets.empty() ? nullptr : m_trigram_offsets.data()),
+                        m_trigram_postings.data(), &begin, &end);
 
-    // sort child folders
-    for (auto& folder : folders) {
-        folder.sort();
+    // the terms were refined (more characters typed), only the previous matches can still match
+    std::vector<u32> candidates;
+    if (!m_search_terms.empty() && terms.find(m_search_terms) != std::string::npos
+        && (!begin || m_search_matches.size() < static_cast<u64>(end - begin))) {
+        candidates = std::move(m_search_matches);
+    } else if (begin) {
+        candidates.assign(begin, end);
+    } else {
+        for (u32 i = 0; i < m_nodes.size(); ++i) {
+            if (!m_nodes[i].m_IsFolder) candidates.push_back(i);
+        }
+    }
+
+    m_search_matches.clear();
+    for (auto node : candidates) {
+        if (strstr(get_name(m_nodes[node]), terms.c_str())) {
+            m_search_matches.push_back(node);
+        }
     }
+
+    // mark the matches and every folder above them visible
+    m_visible.assign(m_nodes.size(), 0);
+    for (auto match : m_search_matches) {
+        for (u32 node = match; node != INVALID_NODE && !m_visible[node]; node = m_nodes[node].m_Parent) {
+            m_visible[node] = 1;
+        }
+    }
+
+    m_search_terms = terms;
+    return true;
 }
 
 void DirectoryList::render_search_input()
@@ -88,14 +592,12 @@ void DirectoryList::render_search_input()
     const auto  avail_width = ImGui::GetContentRegionAvail().x;
     const auto  button_size = (ImGui::CalcTextSize(ICON_FA_TIMES).x + (style.FramePadding.x * 2));
 
-    // total_width - button_size - (item spacing (between button and input))
-    ImGui::PushItemWidth(avail_width - button_size - style.ItemSpacing.x);
+    const auto  list_size   = (ImGui::CalcTextSize(ICON_FA_LIST).x + (style.FramePadding.x * 2));
 
-    if (ImGui::InputTextWithHint("##search", ICON_FA_SEARCH " Search", s_search_terms, sizeof(s_search_terms))) {
-        // TODO : maybe just a function which handles the filtering.
-        //        we should maybe have a bool on each File in the tree for visibility so we don't have to test each time
-        //        in the render function.
+    // total_width - button_sizes - (item spacing (between buttons and input))
+    ImGui::PushItemWidth(avail_width - button_size - list_size - (style.ItemSpacing.x * 2));
 
+    if (ImGui::InputTextWithHint("##search", ICON_FA_SEARCH " Search", s_search_terms, sizeof(s_search_terms))) {
         // if (!has_search_terms() && !s_clicked_items_during_search.empty()) {
         //     for (auto& path : s_clicked_items_during_search) {
         //         LOG_INFO("{}", path);
@@ -105,168 +607,444 @@ void DirectoryList::render_search_input()
         // }
     }
 
+    ImGui::PopItemWidth();
+
+    // flat list of the best matches instead of the tree
+    ImGui::SameLine();
+    if (m_flat_search) ImGui::PushStyleColor(ImGuiCol_Text, loaded_colour);
+    if (ImGui::Button(ICON_FA_LIST "##flat_search")) {
+        m_flat_search = !m_flat_search;
+    }
+
+    if (m_flat_search) ImGui::PopStyleColor();
+    if (ImGui::IsItemHovered()) {
+        ImGui::SetTooltip(m_flat_search ? "Show search results in the tree" : "Show search results as a ranked list");
+    }
+
     ImGui::SameLine();
     if (ImGui::Button(ICON_FA_TIMES "##clear_search")) {
         s_search_terms[0] = '\0';
     }
 }
 
-static void set_tooltip(const std::string& value, const std::string& prefix)
+static void set_tooltip(const char* value, const std::string& prefix)
 {
     if (ImGui::IsItemHovered()) {
         // TODO : how do we get the base colour without any PushStyleColor() overriding?
         ImGui::PushStyleColor(ImGuiCol_Text, {1, 1, 1, 1});
 
         if (prefix.empty()) {
-            ImGui::SetTooltip("%s", value.c_str());
+            ImGui::SetTooltip("%s", value);
         } else {
-            ImGui::SetTooltip("%s://%s", prefix.c_str(), value.c_str());
+            ImGui::SetTooltip("%s://%s", prefix.c_str(), value);
         }
 
         ImGui::PopStyleColor();
     }
 }
 
-static bool matches_search_terms(DirectoryList& directory_list)
+// textures show their thumbnail under the path. the ones which are visible are made in the background before they're
+// hovered.
+static void set_file_tooltip(App& app, const char* path, const std::string& prefix)
 {
-    // look in sub-directories
-    for (auto& folder : directory_list.folders) {
-        // match folder name
-        // TODO : if we want to keep this, we'll need to return something which indicates if we matched on a folder or a
-        //        file, this is because, if we matched a folder we probably want to show all the contents of that
-        //        folder, not just files which also match the search terms.
-        // if (folder.name.find(s_search_terms) != std::string::npos) {
-        //     return true;
-        // }
+    auto* game       = app.get_game();
+    auto* thumbnails = (game ? game->get_thumbnail_cache() : nullptr);
+    if (!thumbnails || !ThumbnailCache::is_supported(path)) {
+        set_tooltip(path, prefix);
+        return;
+    }
 
-        // look recursively inside the folder
-        if (matches_search_terms(folder)) {
-            return true;
-        }
+    if (!ImGui::IsItemHovered()) {
+        thumbnails->prefetch(path);
+        return;
     }
 
-    // find the file
-    for (auto& [filename, path, extension_hash] : directory_list.files) {
-        if (filename.find(s_search_terms) != std::string::npos) {
-            return true;
-        }
+    ThumbnailCache::Thumbnail thumbnail;
+    const auto                state = thumbnails->get(path, &thumbnail);
+
+    ImGui::PushStyleColor(ImGuiCol_Text, {1, 1, 1, 1});
+    ImGui::BeginTooltip();
+
+    if (prefix.empty()) {
+        ImGui::TextUnformatted(path);
+    } else {
+        ImGui::Text("%s://%s", prefix.c_str(), path);
+    }
+
+    if (state == ThumbnailCache::E_STATE_READY) {
+        ImGui::Image(thumbnail.m_Texture->get_srv(), {(float)thumbnail.m_Width, (float)thumbnail.m_Height});
+    } else if (state == ThumbnailCache::E_STATE_PENDING) {
+        ImGui::TextDisabled(ICON_FA_SPINNER " loading thumbnail...");
     }
 
-    return false;
+    ImGui::EndTooltip();
+    ImGui::PopStyleColor();
 }
 
-void DirectoryList::render(App& app, const std::string& tooltip_prefix)
+bool DirectoryList::is_open_file(u32 node) const
 {
-    // folders
-    for (auto& folder : folders) {
-        bool should_open_tree_node = false;
+    return (!m_nodes[node].m_IsFolder && m_open_state[node] == OPEN_STATE_OPEN);
+}
+
+bool DirectoryList::is_open(u32 node) const
+{
+    // while searching, folders with matches are open unless they were closed by hand
+    if (m_nodes[node].m_IsFolder && strlen(s_search_terms) >= 4) {
+        return (m_open_state[node] != OPEN_STATE_CLOSED);
+    }
 
-        // ignore this folder if it doesn't contain anything which matches our search terms
-        if (has_search_terms() && !matches_search_terms(folder)) {
+    return (m_open_state[node] == OPEN_STATE_OPEN);
+}
+
+void DirectoryList::add_rows(u32 index, u16 depth, std::vector<Row>* out_rows) const
+{
+    const auto& node      = m_nodes[index];
+    const bool  searching = has_search_terms();
+
+    for (u32 child = node.m_FirstChild; child < (node.m_FirstChild + node.m_NumFolders + node.m_NumFiles); ++child) {
+        // skip anything which doesn't match our search terms
+        // TODO : don't filter the file if the handler wants to override the tree.
+        //        this will make it possible to open .ee archives while filtering and still see all the sub-files.
+        if (searching && !m_visible[child]) {
             continue;
         }
-        // we have search terms, AND something in this directory matches the terms
-        else if (has_search_terms() && strlen(s_search_terms) >= 4) {
-            should_open_tree_node = true;
-        }
 
-        auto& key = folder.name;
+        Row row{};
+        row.m_Node     = child;
+        row.m_Depth    = depth;
+        row.m_Revision = INVALID_REVISION;
+        out_rows->push_back(row);
 
-        u32 flags = ImGuiTreeNodeFlags_SpanAvailWidth;
-        if (should_open_tree_node) {
-            flags |= ImGuiTreeNodeFlags_DefaultOpen;
+        if (m_nodes[child].m_IsFolder && is_open(child)) {
+            add_rows(child, (depth + 1), out_rows);
         }
+    }
+}
 
-        const bool last_open_state = ImGui::GetStateStorage()->GetBool(ImGui::GetID(key.c_str()));
-        const bool tree_open       = ImGui::TreeNodeEx(key.c_str(), flags, "%s  %s",
-                                                       (last_open_state ? ICON_FA_FOLDER_OPEN : ICON_FA_FOLDER), key.c_str());
+void DirectoryList::rebuild_rows()
+{
+    m_rows.clear();
+    m_open_state.resize(m_nodes.size(), OPEN_STATE_DEFAULT);
 
-        set_tooltip(folder.path, tooltip_prefix);
-        app.get_ui().draw_context_menu(folder.path, nullptr, UI::E_CONTEXT_FOLDER);
+    add_rows(ROOT_NODE, 0, &m_rows);
+    m_rows_dirty = false;
 
-        if (tree_open) {
-            folder.render(app, tooltip_prefix);
-            ImGui::TreePop();
+    m_open_file_rows.clear();
+    for (u32 i = 0; i < m_rows.size(); ++i) {
+        if (is_open_file(m_rows[i].m_Node)) m_open_file_rows.push_back(i);
+    }
+}
+
+void DirectoryList::toggle_row(u32 index)
+{
+    const auto& row  = m_rows[index];
+    const bool  open = !is_open(row.m_Node);
+
+    m_open_state[row.m_Node] = (open ? OPEN_STATE_OPEN : OPEN_STATE_CLOSED);
+
+    // open archives render their own tree, they don't have any rows
+    auto open_files = std::upper_bound(m_open_file_rows.begin(), m_open_file_rows.end(), index);
+    if (!m_nodes[row.m_Node].m_IsFolder) {
+        if (open) {
+            m_open_file_rows.insert(open_files, index);
+        } else if (open_files != m_open_file_rows.begin() && *(open_files - 1) == index) {
+            m_open_file_rows.erase(open_files - 1);
         }
+
+        return;
     }
 
-    // files
-    for (auto& [filename, path, extension_hash] : files) {
-        // skip the current file if we're searching and the filename doesn't contain the search terms
-        // TODO : don't filter the file if the handler wants to override the tree.
-        //        this will make it possible to open .ee archives while filtering and still see all the sub-files.
-        if (has_search_terms() && filename.find(s_search_terms) == std::string::npos) {
-            continue;
+    // the rows after the folder move, the open files inside it come and go with it
+    if (open) {
+        std::vector<Row> rows;
+        add_rows(row.m_Node, (row.m_Depth + 1), &rows);
+        m_rows.insert((m_rows.begin() + index + 1), rows.begin(), rows.end());
+
+        for (auto iter = open_files; iter != m_open_file_rows.end(); ++iter) {
+            *iter += static_cast<u32>(rows.size());
         }
 
-        auto*       handler       = app.get_format_handler(extension_hash);
-        bool        highlight     = false;
-        bool        loaded        = false;
-        const char* filetype_icon = ICON_FA_FILE;
-        u32 flags = (ImGuiTreeNodeFlags_SpanAvailWidth | ImGuiTreeNodeFlags_Leaf | ImGuiTreeNodeFlags_NoTreePushOnOpen);
+        std::vector<u32> inserted;
+        for (u32 i = 0; i < rows.size(); ++i) {
+            if (is_open_file(rows[i].m_Node)) inserted.push_back(index + 1 + i);
+        }
 
-        // the current file type wants to override the tree, reset flags and highlight
-        if (handler) {
-            filetype_icon = handler->get_filetype_icon();
+        m_open_file_rows.insert(open_files, inserted.begin(), inserted.end());
+    } else {
+        // everything after the row which is deeper is inside the folder
+        auto       end   = std::find_if((m_rows.begin() + index + 1), m_rows.end(),
+                                        [&](const Row& other) { return other.m_Depth <= row.m_Depth; });
+        const auto count = static_cast<u32>(end - (m_rows.begin() + index + 1));
+        m_rows.erase((m_rows.begin() + index + 1), end);
 
-            if (handler->is_loaded(path)) {
-                loaded = true;
-            }
+        auto last = std::lower_bound(open_files, m_open_file_rows.end(), (index + 1 + count));
+        for (auto iter = last; iter != m_open_file_rows.end(); ++iter) {
+            *iter -= count;
+        }
 
-            // directory highlight
-            if (handler->wants_to_override_directory_tree() && loaded) {
-                highlight = true;
-                flags     = ImGuiTreeNodeFlags_SpanAvailWidth;
-            }
+        m_open_file_rows.erase(open_files, last);
+    }
+}
+
+void DirectoryList::update_row_state(App& app, Row& row)
+{
+    const auto revision = app.get_loaded_state_revision();
+    if (row.m_Revision == revision) {
+        return;
+    }
+
+    const auto& node = m_nodes[row.m_Node];
+
+    row.m_Revision = revision;
+    row.m_Handler  = app.get_format_handler(node.m_ExtensionHash);
+    row.m_Loaded   = (row.m_Handler && row.m_Handler->is_loaded(get_path(node)));
+
+    // loaded files which want to override the tree are highlighted and can be expanded
+    row.m_Highlight = (row.m_Loaded && row.m_Handler->wants_to_override_directory_tree());
+}
+
+void DirectoryList::render(App& app, const std::string& tooltip_prefix)
+{
+    if (m_flat_search && has_search_terms()) {
+        render_search_results(app, tooltip_prefix);
+        return;
+    }
+
+    if (update_search() || m_rows_dirty) {
+        rebuild_rows();
+    }
+
+    m_toggled_row = INVALID_NODE;
+
+    // rows are all a single line high, so only the visible rows are drawn. the exception is open archives (highlighted
+    // files) which draw their own tree underneath the row, the rows between them are clipped separately.
+    u32 start = 0;
+    for (const auto index : m_open_file_rows) {
+        auto& row = m_rows[index];
+        update_row_state(app, row);
+        if (!row.m_Highlight) continue;
+
+        render_rows(app, start, index, tooltip_prefix);
+        render_row(app, index, tooltip_prefix);
+        start = (index + 1);
+    }
+
+    render_rows(app, start, static_cast<u32>(m_rows.size()), tooltip_prefix);
+
+    // rows can't change while they are being drawn
+    if (m_toggled_row != INVALID_NODE) {
+        toggle_row(m_toggled_row);
+    }
+}
+
+void DirectoryList::render_rows(App& app, u32 begin, u32 end, const std::string& tooltip_prefix)
+{
+    if (begin >= end) {
+        return;
+    }
+
+    ImGuiListClipper clipper;
+    clipper.Begin(static_cast<i32>(end - begin));
+    while (clipper.Step()) {
+        for (i32 i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+            render_row(app, (begin + i), tooltip_prefix);
         }
+    }
 
-        // push highlight colour
-        if (highlight) ImGui::PushStyleColor(ImGuiCol_Text, highlight_colour);
-        if (loaded) ImGui::PushStyleColor(ImGuiCol_Text, loaded_colour);
+    clipper.End();
+}
 
-        const bool tree_open = ImGui::TreeNodeEx(filename.c_str(), flags, "%s  %s", filetype_icon, filename.c_str());
+void DirectoryList::render_row(App& app, u32 index, const std::string& tooltip_prefix)
+{
+    auto&       row  = m_rows[index];
+    const auto& node = m_nodes[row.m_Node];
+    const char* name = get_name(node);
+    const char* path = get_path(node);
+
+    const f32 indent = (row.m_Depth * ImGui::GetStyle().IndentSpacing);
+    if (indent > 0.0f) ImGui::Indent(indent);
 
-        if (loaded) ImGui::PopStyleColor();
+    ImGui::PushID(row.m_Node);
+
+    // folders
+    if (node.m_IsFolder) {
+        const bool is_folder_open = is_open(row.m_Node);
+
+        ImGui::SetNextItemOpen(is_folder_open, ImGuiCond_Always);
+        if (ImGui::TreeNodeEx("##folder", (ImGuiTreeNodeFlags_SpanAvailWidth | ImGuiTreeNodeFlags_NoTreePushOnOpen),
+                              "%s  %s", (is_folder_open ? ICON_FA_FOLDER_OPEN : ICON_FA_FOLDER), name)
+            != is_folder_open) {
+            m_toggled_row = index;
+        }
 
         set_tooltip(path, tooltip_prefix);
-        app.get_ui().draw_context_menu(path, handler, UI::E_CONTEXT_FILE);
-
-        // click handler
-        if ((flags & ImGuiTreeNodeFlags_Leaf) && ImGui::IsItemClicked()) {
-            // when and item is clicked while searching, open the directory tree up to the file
-            // if (has_search_terms()) {
-            //     open_folders_in_chain(this, this->path);
-            // }
-
-            // try get the handler from the file header magic, if we couldn't find one for the extension
-            if (!handler) {
-                handler = app.get_format_handler_for_file(path);
-            }
+        app.get_ui().draw_context_menu(path, nullptr, UI::E_CONTEXT_FOLDER);
 
-            // TODO : if item is already loaded, just bring whatever window is rendering it to the front!
+        ImGui::PopID();
+        if (indent > 0.0f) ImGui::Unindent(indent);
+        return;
+    }
 
-            if (handler && handler->load(path)) {
-                // if the handler is overriding the directory tree, reset the items default state
-                // NOTE : this is mainly to prevent a visual annoyance where if something gets unloaded after
-                //        expanding the node, next time you click the leaf it will auto-close instead of opening.
-                if (handler->wants_to_override_directory_tree()) {
-                    ImGui::GetStateStorage()->SetBool(ImGui::GetID(filename.c_str()), false);
-                }
+    // files
+    update_row_state(app, row);
+
+    auto*       handler       = row.m_Handler;
+    const bool  highlight     = row.m_Highlight;
+    const bool  loaded        = row.m_Loaded;
+    const char* filetype_icon = (handler ? handler->get_filetype_icon() : ICON_FA_FILE);
+    u32 flags = (ImGuiTreeNodeFlags_SpanAvailWidth | ImGuiTreeNodeFlags_Leaf | ImGuiTreeNodeFlags_NoTreePushOnOpen);
+
+    // the current file type wants to override the tree, reset flags
+    bool is_file_open = false;
+    if (highlight) {
+        flags        = ImGuiTreeNodeFlags_SpanAvailWidth;
+        is_file_open = (m_open_state[row.m_Node] == OPEN_STATE_OPEN);
+        ImGui::SetNextItemOpen(is_file_open, ImGuiCond_Always);
+    }
+
+    // push highlight colour
+    if (highlight) ImGui::PushStyleColor(ImGuiCol_Text, highlight_colour);
+    if (loaded) ImGui::PushStyleColor(ImGuiCol_Text, loaded_colour);
+
+    const bool tree_open = ImGui::TreeNodeEx("##file", flags, "%s  %s", filetype_icon, name);
+
+    if (loaded) ImGui::PopStyleColor();
+
+    set_file_tooltip(app, path, tooltip_prefix);
+    app.get_ui().draw_context_menu(path, handler, UI::E_CONTEXT_FILE);
+
+    if (highlight && tree_open != is_file_open) {
+        m_toggled_row = index;
+    }
+
+    // click handler
+    if ((flags & ImGuiTreeNodeFlags_Leaf) && ImGui::IsItemClicked()) {
+        // try get the handler from the file header magic, if we couldn't find one for the extension
+        if (!handler) {
+            handler = app.get_format_handler_for_file(path);
+        }
+
+        // TODO : if item is already loaded, just bring whatever window is rendering it to the front!
+
+        if (handler && handler->load(path)) {
+            // if the handler is overriding the directory tree, reset the items default state
+            // NOTE : this is mainly to prevent a visual annoyance where if something gets unloaded after
+            //        expanding the node, next time you click the leaf it will auto-close instead of opening.
+            // m_open_file_rows is being walked by render(), so it's closed like any other toggle
+            if (handler->wants_to_override_directory_tree() && m_open_state[row.m_Node] == OPEN_STATE_OPEN) {
+                m_toggled_row = index;
             }
         }
+    }
+
+    if (highlight) ImGui::Indent();
+
+    // render handler
+    if (tree_open && !(flags & ImGuiTreeNodeFlags_Leaf)) {
+        handler->directory_tree_handler(name, path);
+        ImGui::TreePop();
+    }
+
+    if (highlight) ImGui::Unindent();
+
+    // pop highlight colour
+    if (highlight) ImGui::PopStyleColor();
+
+    ImGui::PopID();
+    if (indent > 0.0f) ImGui::Unindent(indent);
+}
+
+void DirectoryList::stop_search_worker()
+{
+    m_search_worker.reset();
+    m_search_results_terms.clear();
+    m_search_results.clear();
+    m_search_result_rows.clear();
+}
+
+void DirectoryList::render_search_results(App& app, const std::string& tooltip_prefix)
+{
+    // the worker is started the first time it's needed
+    if (!m_search_worker) {
+        m_search_worker = std::make_unique<SearchWorker>();
+    }
 
-        if (highlight) ImGui::Indent();
+    // the previous results are kept until the new ones are ready
+    if (m_search_results_terms != s_search_terms) {
+        m_search_results_terms = s_search_terms;
 
-        // render handler
-        if (tree_open && !(flags & ImGuiTreeNodeFlags_Leaf)) {
-            if (handler) handler->directory_tree_handler(filename, path);
-            ImGui::TreePop();
+        SearchWorker::View view{};
+        view.m_Nodes           = m_nodes.data();
+        view.m_Strings         = m_strings.data();
+        view.m_TrigramOffsets  = (m_trigram_offsets.empty() ? nullptr : m_trigram_offsets.data());
+        view.m_TrigramPostings = m_trigram_postings.data();
+        view.m_NumNodes        = static_cast<u32>(m_nodes.size());
+        m_search_worker->post(m_search_results_terms, view);
+    }
+
+    u32  num_matches = 0;
+    bool finished    = false;
+    if (m_search_worker->get_status(&num_matches, &finished, &m_search_results)) {
+        m_search_result_rows.clear();
+        for (const auto node : m_search_results) {
+            Row row{};
+            row.m_Node     = node;
+            row.m_Revision = INVALID_REVISION;
+            m_search_result_rows.push_back(row);
         }
+    }
+
+    if (!finished) {
+        ImGui::TextDisabled(ICON_FA_SPINNER " %u matches...", num_matches);
+    } else if (num_matches > m_search_results.size()) {
+        ImGui::TextDisabled("%u matches (showing the best %u)", num_matches, static_cast<u32>(m_search_results.size()));
+    } else {
+        ImGui::TextDisabled("%u matches", num_matches);
+    }
+
+    ImGuiListClipper clipper;
+    clipper.Begin(static_cast<i32>(m_search_result_rows.size()));
+    while (clipper.Step()) {
+        for (i32 i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+            auto& row = m_search_result_rows[i];
+            update_row_state(app, row);
+
+            const auto& node    = m_nodes[row.m_Node];
+            const char* path    = get_path(node);
+            auto*       handler = row.m_Handler;
+            const bool  loaded  = row.m_Loaded;
+
+            ImGui::PushID(i);
 
-        if (highlight) ImGui::Unindent();
+            if (loaded) ImGui::PushStyleColor(ImGuiCol_Text, loaded_colour);
+            ImGui::TreeNodeEx("##result",
+                              (ImGuiTreeNodeFlags_Leaf | ImGuiTreeNodeFlags_NoTreePushOnOpen
+                               | ImGuiTreeNodeFlags_SpanAvailWidth),
+                              "%s  %s", (handler ? handler->get_filetype_icon() : ICON_FA_FILE), get_name(node));
+            if (loaded) ImGui::PopStyleColor();
 
-        // pop highlight colour
-        if (highlight) ImGui::PopStyleColor();
+            set_file_tooltip(app, path, tooltip_prefix);
+            app.get_ui().draw_context_menu(path, handler, UI::E_CONTEXT_FILE);
+
+            if (ImGui::IsItemClicked()) {
+                // try get the handler from the file header magic, if we couldn't find one for the extension
+                if (!handler) {
+                    handler = app.get_format_handler_for_file(path);
+                }
+
+                if (handler) {
+                    handler->load(path);
+                }
+            }
+
+            // the folder the file is in
+            ImGui::SameLine();
+            ImGui::TextDisabled("%s", get_path(m_nodes[node.m_Parent]));
+
+            ImGui::PopID();
+        }
     }
+
+    clipper.End();
 }
-} // namespace jcmr
\ No newline at end of file
+} // namespace jcmr
@@ -3,30 +3,129 @@
 
 #include "platform.h"
 
+#include <string_view>
+
 namespace jcmr
 {
 struct App;
 
+namespace game
+{
+    struct IFormat;
+}
+
+// flat directory tree. every folder and file is a node in a single array, names and paths live in a shared string
+// pool. after sort() the children of a folder are contiguous (folders first, then files, both sorted by name).
 struct DirectoryList {
-    using File = std::tuple<std::string, std::string, u32>;
+    static constexpr u32 ROOT_NODE    = 0;
+    static constexpr u32 INVALID_NODE = 0xFFFFFFFF;
 
-    std::string                name;
-    std::string                path;
-    std::vector<DirectoryList> folders;
-    std::vector<File>          files;
+    struct Node {
+        u32  m_Parent;
+        u32  m_Path;          // offset into the string pool, full path of the folder or file
+        u32  m_Name;          // offset into the string pool, the name is the last part of the path
+        u32  m_FirstChild;    // child folders, then child files (only valid after sort)
+        u32  m_NumFolders;
+        u32  m_NumFiles;
+        u32  m_ExtensionHash; // files only, set by sort()
+        bool m_IsFolder;
+    };
 
-    DirectoryList() = default;
-    explicit DirectoryList(const std::string& folder_name, const std::string& remaining_parts,
-                           const std::string& current_path, const std::string& full_path);
+    DirectoryList();
+    ~DirectoryList();
+    DirectoryList(DirectoryList&&);
+    DirectoryList& operator=(DirectoryList&&);
 
+    // the tree can't be added to after it's sorted, clear() it and add everything again
     void add(const std::string& filepath);
     void sort();
+    void clear();
+
+    const Node& get_node(u32 index) const { return m_nodes[index]; }
+    u32         get_num_nodes() const { return static_cast<u32>(m_nodes.size()); }
+    const char* get_name(const Node& node) const { return &m_strings[node.m_Name]; }
+    const char* get_path(const Node& node) const { return &m_strings[node.m_Path]; }
 
     void render_search_input();
     void render(App& app, const std::string& tooltip_prefix = "");
 
   private:
-    void insert_part(const std::string& part, const std::string& full_path);
+    // open addressing table of folders, keyed by (parent, name hash). only used while building.
+    struct FolderLookupEntry {
+        u64 m_Key;
+        u32 m_Node;
+    };
+
+    struct SearchWorker;
+
+    u32  add_node(u32 parent, std::string_view path, u32 name_start, bool is_folder);
+    u32* find_folder(u32 parent, std::string_view name);
+
+    // a visible line in the tree, rows are only built for open folders
+    struct Row {
+        u32            m_Node;
+        u16            m_Depth;
+        bool           m_Loaded;    // cached from the handler
+        bool           m_Highlight; // loaded and the handler overrides the tree
+        u32            m_Revision;  // loaded state revision m_Loaded and m_Highlight were cached for
+        game::IFormat* m_Handler;
+    };
+
+    enum OpenState : u8 {
+        OPEN_STATE_DEFAULT = 0,
+        OPEN_STATE_OPEN,
+        OPEN_STATE_CLOSED,
+    };
+
+    static constexpr u32 INVALID_REVISION = 0xFFFFFFFF;
+
+    void hash_extensions();
+    void build_search_index();
+    bool update_search();
+
+    bool is_open(u32 node) const;
+    bool is_open_file(u32 node) const;
+    void add_rows(u32 index, u16 depth, std::vector<Row>* out_rows) const;
+    void rebuild_rows();
+    void toggle_row(u32 index);
+    void update_row_state(App& app, Row& row);
+
+    void render_rows(App& app, u32 begin, u32 end, const std::string& tooltip_prefix);
+    void render_row(App& app, u32 index, const std::string& tooltip_prefix);
+
+    void stop_search_worker();
+    void update_search_results();
+    void render_search_results(App& app, const std::string& tooltip_prefix);
+
+  private:
+    std::vector<Node>              m_nodes;
+    std::vector<char>              m_strings;
+    std::vector<FolderLookupEntry> m_folder_lookup;
+    u32                            m_num_folders = 0;
+    std::string                    m_last_path;
+    std::vector<u32>               m_last_folders; // folder chain of m_last_path
+
+    // search. file names are indexed by trigram (hashed into buckets), the posting lists are sorted by node.
+    std::vector<u32> m_trigram_offsets;  // first posting for every bucket, with an extra entry for the end
+    std::vector<u32> m_trigram_postings; // file nodes
+    std::string      m_search_terms;     // terms m_search_matches and m_visible were built for
+    std::vector<u32> m_search_matches;   // file nodes which match m_search_terms
+    std::vector<u8>  m_visible;          // per node, set if the node (or anything inside the folder) matches
+
+    // rendering
+    std::vector<Row> m_rows;
+    std::vector<u8>  m_open_state;     // per node, see OpenState
+    std::vector<u32> m_open_file_rows; // sorted indices into m_rows of files with OPEN_STATE_OPEN
+    u32              m_toggled_row = INVALID_NODE;
+    bool             m_rows_dirty  = true;
+
+    // flat search. the worker ranks every match and keeps the best MAX_SEARCH_RESULTS, only the dictionary tree
+    // switches to it (render_search_input) so the archive trees never start a worker.
+    std::unique_ptr<SearchWorker> m_search_worker;
+    bool                          m_flat_search = false;
+    std::string                   m_search_results_terms; // terms the last query was posted for
+    std::vector<u32>              m_search_results;       // file nodes, best match first
+    std::vector<Row>              m_search_result_rows;   // m_search_results with the handler state cached
 };
 } // namespace jcmr
 
@@ -0,0 +1,404 @@
+#include "pch.h"
+
+#include "hashing.h"
+
+#include <cstring>
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// msvc allows avx2 intrinsics anywhere, gcc and clang need the functions which use them marked
+#if defined(__GNUC__) || defined(__clang__)
+#define JCMR_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define JCMR_TARGET_AVX2
+#endif
+
+namespace jcmr::hashing
+{
+static constexpr u32 LOOKUP3_LANES = 8;
+static constexpr u64 MURMUR3_C1    = 0x87C37B91114253D5;
+static constexpr u64 MURMUR3_C2    = 0x4CF5AD432745937F;
+
+// reading up to 16 bytes past the end of a string can't fault as long as it stays inside the same page. the extra
+// bytes are masked off.
+static bool can_over_read(const char* data)
+{
+#ifdef __SANITIZE_ADDRESS__
+    return false;
+#else
+    return ((reinterpret_cast<uintptr_t>(data) & 4095) <= (4096 - 16));
+#endif
+}
+
+// little endian load of up to 8 bytes, the rest is zero. the tail of both hashes is the same as hashing the remaining
+// bytes zero padded.
+static u64 load_partial(const char* data, u64 size)
+{
+    u64 value = 0;
+    if (size == 8 || (size > 0 && can_over_read(data))) {
+        std::memcpy(&value, data, sizeof(u64));
+        return (size == 8 ? value : (value & ((1ull << (size * 8)) - 1)));
+    }
+
+    std::memcpy(&value, data, size);
+    return value;
+}
+
+static u32 rot32(u32 x, u32 k)
+{
+    return ((x << k) | (x >> (32 - k)));
+}
+
+static u64 rot64(u64 x, u32 k)
+{
+    return ((x << k) | (x >> (64 - k)));
+}
+
+static void lookup3_mix(u32& a, u32& b, u32& c)
+{
+    a = ((a - c) ^ rot32(c, 4));
+    c += b;
+    b = ((b - a) ^ rot32(a, 6));
+    a += c;
+    c = ((c - b) ^ rot32(b, 8));
+    b += a;
+    a = ((a - c) ^ rot32(c, 16));
+    c += b;
+    b = ((b - a) ^ rot32(a, 19));
+    a += c;
+    c = ((c - b) ^ rot32(b, 4));
+    b += a;
+}
+
+static void lookup3_final(u32& a, u32& b, u32& c)
+{
+    c = ((c ^ b) - rot32(b, 14));
+    a = ((a ^ c) - rot32(c, 11));
+    b = ((b ^ a) - rot32(a, 25));
+    c = ((c ^ b) - rot32(b, 16));
+    a = ((a ^ c) - rot32(c, 4));
+    b = ((b ^ a) - rot32(a, 14));
+    c = ((c ^ b) - rot32(b, 24));
+}
+
+static u64 murmur3_mix_k1(u64 k1)
+{
+    return (rot64((k1 * MURMUR3_C1), 31) * MURMUR3_C2);
+}
+
+static u64 murmur3_mix_k2(u64 k2)
+{
+    return (rot64((k2 * MURMUR3_C2), 33) * MURMUR3_C1);
+}
+
+u32 hashlittle(std::string_view value)
+{
+    const char* data   = value.data();
+    u64         length = value.size();
+    u32         a, b, c;
+    a = b = c = (0xDEADBEEF + static_cast<u32>(length));
+
+    while (length > 12) {
+        a += static_cast<u32>(load_partial(data, 4));
+        b += static_cast<u32>(load_partial(data + 4, 4));
+        c += static_cast<u32>(load_partial(data + 8, 4));
+
+        lookup3_mix(a, b, c);
+
+        length -= 12;
+        data += 12;
+    }
+
+    if (length == 0) {
+        return c;
+    }
+
+    a += static_cast<u32>(load_partial(data, std::min<u64>(length, 4)));
+    if (length > 4) b += static_cast<u32>(load_partial(data + 4, std::min<u64>(length - 4, 4)));
+    if (length > 8) c += static_cast<u32>(load_partial(data + 8, length - 8));
+
+    lookup3_final(a, b, c);
+    return c;
+}
+
+static u64 fmix64(u64 k)
+{
+    k ^= (k >> 33);
+    k *= 0xFF51AFD7ED558CCD;
+    k ^= (k >> 33);
+    k *= 0xC4CEB9FE1A85EC53;
+    k ^= (k >> 33);
+    return k;
+}
+
+u64 hash_string_64(std::string_view value)
+{
+    const char* data       = value.data();
+    const u64   length     = value.size();
+    const u64   num_blocks = (length / 16);
+    u64         h1         = 0;
+    u64         h2         = 0;
+
+    for (u64 i = 0; i < num_blocks; ++i) {
+        h1 ^= murmur3_mix_k1(load_partial(data + (i * 16), 8));
+        h1 = ((rot64(h1, 27) + h2) * 5 + 0x52DCE729);
+        h2 ^= murmur3_mix_k2(load_partial(data + (i * 16) + 8, 8));
+        h2 = ((rot64(h2, 31) + h1) * 5 + 0x38495AB5);
+    }
+
+    const char* tail      = (data + (num_blocks * 16));
+    const u64   tail_size = (length & 15);
+    if (tail_size > 8) h2 ^= murmur3_mix_k2(load_partial(tail + 8, (tail_size - 8)));
+    if (tail_size > 0) h1 ^= murmur3_mix_k1(load_partial(tail, std::min<u64>(tail_size, 8)));
+
+    h1 ^= length;
+    h2 ^= length;
+    h1 += h2;
+    h2 += h1;
+    h1 = fmix64(h1);
+    h2 = fmix64(h2);
+    return (h1 + h2);
+}
+
+// strings are hashed in groups of similar length, so the lanes of a group finish at (nearly) the same time. the input
+// is processed in chunks, every chunk is counting sorted by block count on the stack. strings longer than the last
+// bucket would leave most lanes idle, they go to the scalar version instead.
+template <u32 NumLanes, u32 BlockSize, typename Kernel, typename Scalar>
+static void for_each_lane_group(const std::string_view* values, u32 count, Kernel&& kernel, Scalar&& scalar)
+{
+    static constexpr u32 CHUNK_SIZE  = 1024;
+    static constexpr u32 NUM_BUCKETS = 32;
+
+    auto get_bucket = [&](u32 index) { return std::min<u64>((values[index].size() / BlockSize), NUM_BUCKETS); };
+
+    u32 order[CHUNK_SIZE];
+    for (u32 start = 0; start < count; start += CHUNK_SIZE) {
+        const auto size                     = std::min(CHUNK_SIZE, (count - start));
+        u32        offsets[NUM_BUCKETS + 1] = {};
+        u32        num_grouped              = 0;
+
+        for (u32 i = 0; i < size; ++i) {
+            const auto bucket = get_bucket(start + i);
+            if (bucket < NUM_BUCKETS) {
+                ++offsets[bucket + 1];
+                ++num_grouped;
+            } else {
+                scalar(start + i);
+            }
+        }
+
+        for (u32 i = 0; i < (NUM_BUCKETS - 1); ++i) {
+            offsets[i + 1] += offsets[i];
+        }
+
+        for (u32 i = 0; i < size; ++i) {
+            const auto bucket = get_bucket(start + i);
+            if (bucket < NUM_BUCKETS) order[offsets[bucket]++] = (start + i);
+        }
+
+        for (u32 i = 0; i < num_grouped; i += NumLanes) {
+            kernel((order + i), std::min(NumLanes, (num_grouped - i)));
+        }
+    }
+}
+
+// up to 16 bytes of a string, the rest is zero
+JCMR_TARGET_AVX2 static __m128i load_16(const char* data, u64 size)
+{
+    if (size >= 16) {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+    }
+
+    if (can_over_read(data)) {
+        const auto mask = _mm_cmpgt_epi8(_mm_set1_epi8(static_cast<char>(size)),
+                                         _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+        return _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data)), mask);
+    }
+
+    alignas(16) char bytes[16] = {};
+    std::memcpy(bytes, data, size);
+    return _mm_load_si128(reinterpret_cast<const __m128i*>(bytes));
+}
+
+JCMR_TARGET_AVX2 static __m128i load_12(const char* data)
+{
+    u32 last;
+    std::memcpy(&last, (data + 8), sizeof(u32));
+    return _mm_insert_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(data)), static_cast<i32>(last), 2);
+}
+
+// avx2 lookup3, one string per 32 bit lane. every lane loads its next 12 bytes, the rows are transposed into a, b and c
+// words and mixed together. lanes which already ran out of blocks keep their state.
+JCMR_TARGET_AVX2 static __m256i rot32_x8(__m256i x, i32 k)
+{
+    return _mm256_or_si256(_mm256_slli_epi32(x, k), _mm256_srli_epi32(x, (32 - k)));
+}
+
+JCMR_TARGET_AVX2 static void lookup3_mix_x8(__m256i& a, __m256i& b, __m256i& c)
+{
+    a = _mm256_xor_si256(_mm256_sub_epi32(a, c), rot32_x8(c, 4));
+    c = _mm256_add_epi32(c, b);
+    b = _mm256_xor_si256(_mm256_sub_epi32(b, a), rot32_x8(a, 6));
+    a = _mm256_add_epi32(a, c);
+    c = _mm256_xor_si256(_mm256_sub_epi32(c, b), rot32_x8(b, 8));
+    b = _mm256_add_epi32(b, a);
+    a = _mm256_xor_si256(_mm256_sub_epi32(a, c), rot32_x8(c, 16));
+    c = _mm256_add_epi32(c, b);
+    b = _mm256_xor_si256(_mm256_sub_epi32(b, a), rot32_x8(a, 19));
+    a = _mm256_add_epi32(a, c);
+    c = _mm256_xor_si256(_mm256_sub_epi32(c, b), rot32_x8(b, 4));
+    b = _mm256_add_epi32(b, a);
+}
+
+JCMR_TARGET_AVX2 static void lookup3_final_x8(__m256i& a, __m256i& b, __m256i& c)
+{
+    c = _mm256_sub_epi32(_mm256_xor_si256(c, b), rot32_x8(b, 14));
+    a = _mm256_sub_epi32(_mm256_xor_si256(a, c), rot32_x8(c, 11));
+    b = _mm256_sub_epi32(_mm256_xor_si256(b, a), rot32_x8(a, 25));
+    c = _mm256_sub_epi32(_mm256_xor_si256(c, b), rot32_x8(b, 16));
+    a = _mm256_sub_epi32(_mm256_xor_si256(a, c), rot32_x8(c, 4));
+    b = _mm256_sub_epi32(_mm256_xor_si256(b, a), rot32_x8(a, 14));
+    c = _mm256_sub_epi32(_mm256_xor_si256(c, b), rot32_x8(b, 24));
+}
+
+// rows[lane] holds the words of one lane, out[word] gets that word from every lane
+JCMR_TARGET_AVX2 static void transpose_8x3(const __m128i* rows, __m256i* out)
+{
+    const auto r0 = _mm256_set_m128i(rows[4], rows[0]);
+    const auto r1 = _mm256_set_m128i(rows[5], rows[1]);
+    const auto r2 = _mm256_set_m128i(rows[6], rows[2]);
+    const auto r3 = _mm256_set_m128i(rows[7], rows[3]);
+    const auto t0 = _mm256_unpacklo_epi32(r0, r1);
+    const auto t1 = _mm256_unpacklo_epi32(r2, r3);
+    const auto t2 = _mm256_unpackhi_epi32(r0, r1);
+    const auto t3 = _mm256_unpackhi_epi32(r2, r3);
+
+    out[0] = _mm256_unpacklo_epi64(t0, t1);
+    out[1] = _mm256_unpackhi_epi64(t0, t1);
+    out[2] = _mm256_unpacklo_epi64(t2, t3);
+}
+
+JCMR_TARGET_AVX2 static void hashlittle_x8(const std::string_view* values, const u32* indices, u32 count,
+                                           u32* out_hashes)
+{
+    alignas(32) u32 lengths[LOOKUP3_LANES] = {};
+    alignas(32) u32 blocks[LOOKUP3_LANES]  = {};
+    const char*     data[LOOKUP3_LANES]    = {};
+    u32             max_blocks             = 0;
+
+    for (u32 lane = 0; lane < count; ++lane) {
+        const auto& value = values[indices[lane]];
+        lengths[lane]     = static_cast<u32>(value.size());
+        blocks[lane]      = (value.size() > 12 ? static_cast<u32>((value.size() - 1) / 12) : 0);
+        data[lane]        = value.data();
+        max_blocks        = std::max(max_blocks, blocks[lane]);
+    }
+
+    const auto lane_lengths = _mm256_load_si256(reinterpret_cast<const __m256i*>(lengths));
+    const auto lane_blocks  = _mm256_load_si256(reinterpret_cast<const __m256i*>(blocks));
+
+    auto    a = _mm256_add_epi32(_mm256_set1_epi32(static_cast<i32>(0xDEADBEEF)), lane_lengths);
+    auto    b = a;
+    auto    c = a;
+    __m128i rows[LOOKUP3_LANES];
+    __m256i words[3];
+
+    for (u32 block = 0; block < max_blocks; ++block) {
+        for (u32 lane = 0; lane < LOOKUP3_LANES; ++lane) {
+            rows[lane] = (block < blocks[lane] ? load_12(data[lane] + (block * 12)) : _mm_setzero_si128());
+        }
+
+        transpose_8x3(rows, words);
+
+        auto x = _mm256_add_epi32(a, words[0]);
+        auto y = _mm256_add_epi32(b, words[1]);
+        auto z = _mm256_add_epi32(c, words[2]);
+        lookup3_mix_x8(x, y, z);
+
+        const auto active = _mm256_cmpgt_epi32(lane_blocks, _mm256_set1_epi32(static_cast<i32>(block)));
+        a                 = _mm256_blendv_epi8(a, x, active);
+        b                 = _mm256_blendv_epi8(b, y, active);
+        c                 = _mm256_blendv_epi8(c, z, active);
+    }
+
+    // the final block is 1-12 bytes for every non-empty string, zero padded
+    for (u32 lane = 0; lane < LOOKUP3_LANES; ++lane) {
+        const auto offset = (blocks[lane] * 12);
+        const auto size   = (lengths[lane] - offset);
+        rows[lane]        = (size > 0 ? load_16((data[lane] + offset), size) : _mm_setzero_si128());
+    }
+
+    transpose_8x3(rows, words);
+
+    auto x = _mm256_add_epi32(a, words[0]);
+    auto y = _mm256_add_epi32(b, words[1]);
+    auto z = _mm256_add_epi32(c, words[2]);
+    lookup3_final_x8(x, y, z);
+
+    // empty strings skip the final mix
+    const auto empty = _mm256_cmpeq_epi32(lane_lengths, _mm256_setzero_si256());
+    c                = _mm256_blendv_epi8(z, c, empty);
+
+    alignas(32) u32 result[LOOKUP3_LANES];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(result), c);
+    for (u32 lane = 0; lane < count; ++lane) {
+        out_hashes[indices[lane]] = result[lane];
+    }
+}
+
+static bool detect_avx2()
+{
+#ifdef _MSC_VER
+    i32 info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7) return false;
+
+    // the os has to save the ymm registers too
+    __cpuid(info, 1);
+    const bool osxsave = (info[2] & (1 << 27));
+    const bool avx     = (info[2] & (1 << 28));
+    if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) return false;
+
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5));
+#else
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+
+bool has_avx2()
+{
+    static const bool supported = detect_avx2();
+    return supported;
+}
+
+const char* get_batch_implementation_name()
+{
+    return (has_avx2() ? "avx2" : "scalar");
+}
+
+void hashlittle_batch(const std::string_view* values, u32 count, u32* out_hashes)
+{
+    if (has_avx2()) {
+        for_each_lane_group<LOOKUP3_LANES, 12>(
+            values, count,
+            [&](const u32* indices, u32 num_lanes) { hashlittle_x8(values, indices, num_lanes, out_hashes); },
+            [&](u32 index) { out_hashes[index] = hashlittle(values[index]); });
+
+        return;
+    }
+
+    for (u32 i = 0; i < count; ++i) {
+        out_hashes[i] = hashlittle(values[i]);
+    }
+}
+
+void hash_string_64_batch(const std::string_view* values, u32 count, u64* out_hashes)
+{
+    for (u32 i = 0; i < count; ++i) {
+        out_hashes[i] = hash_string_64(values[i]);
+    }
+}
+} // namespace jcmr::hashing
@@ -0,0 +1,28 @@
+#ifndef JCMR_APP_HASHING_H_HEADER_GUARD
+#define JCMR_APP_HASHING_H_HEADER_GUARD
+
+#include "platform.h"
+
+#include <string_view>
+
+// the two string hashes the game uses, for hashing lots of strings at once. hashlittle_batch() hashes 8 strings at a
+// time in avx2 lanes when the cpu supports it (strings are grouped by length so the lanes finish together). murmur3 is
+// built on 64 bit multiplies which avx2 doesn't have, emulating them made the lanes slower than the scalar version so
+// hash_string_64_batch() stays scalar. every version returns exactly what ava::hashlittle and ava::HashString64 do.
+namespace jcmr::hashing
+{
+// jenkins lookup3 hashlittle, same as ava::hashlittle. strings don't need to be null terminated.
+u32 hashlittle(std::string_view value);
+
+// murmur3 x64_128 (first 64 bits), same as ava::HashString64. used for SObjectID.
+u64 hash_string_64(std::string_view value);
+
+// out_hashes must have room for count hashes
+void hashlittle_batch(const std::string_view* values, u32 count, u32* out_hashes);
+void hash_string_64_batch(const std::string_view* values, u32 count, u64* out_hashes);
+
+bool        has_avx2();
+const char* get_batch_implementation_name();
+} // namespace jcmr::hashing
+
+#endif // JCMR_APP_HASHING_H_HEADER_GUARD
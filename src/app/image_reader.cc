@@ -0,0 +1,423 @@
+#include "pch.h"
+
+#include "image_reader.h"
+
+#include "app/texture_decoder.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <zlib.h>
+
+namespace jcmr::image_reader
+{
+static constexpr u32 MAX_IMAGE_SIZE = 16384; // largest width or height, d3d11 can't create anything bigger
+
+static u32 read_u32_be(const u8* data)
+{
+    return ((static_cast<u32>(data[0]) << 24) | (data[1] << 16) | (data[2] << 8) | data[3]);
+}
+
+static u32 read_u32_le(const u8* data)
+{
+    u32 value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+static u16 read_u16_le(const u8* data)
+{
+    return static_cast<u16>(data[0] | (data[1] << 8));
+}
+
+static bool is_valid_size(u32 width, u32 height)
+{
+    return (width > 0 && height > 0 && width <= MAX_IMAGE_SIZE && height <= MAX_IMAGE_SIZE);
+}
+
+// png
+
+static u8 paeth(u8 a, u8 b, u8 c)
+{
+    const i32 p  = (a + b - c);
+    const i32 pa = std::abs(p - a);
+    const i32 pb = std::abs(p - b);
+    const i32 pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc) return a;
+    return (pb <= pc ? b : c);
+}
+
+// undoes the per-row filters in place, bpp is the filter distance in bytes (at least 1)
+static bool unfilter_png(u8* data, u32 height, u64 pitch, u32 bpp)
+{
+    const u8* previous = nullptr;
+    for (u32 y = 0; y < height; ++y) {
+        u8*      row    = (data + (y * (pitch + 1)));
+        const u8 filter = row[0];
+        u8*      pixels = (row + 1);
+
+        for (u64 i = 0; i < pitch; ++i) {
+            const u8 a = (i >= bpp ? pixels[i - bpp] : 0);
+            const u8 b = (previous ? previous[i] : 0);
+            const u8 c = ((previous && i >= bpp) ? previous[i - bpp] : 0);
+
+            switch (filter) {
+                case 0: break;
+                case 1: pixels[i] += a; break;
+                case 2: pixels[i] += b; break;
+                case 3: pixels[i] += static_cast<u8>((a + b) / 2); break;
+                case 4: pixels[i] += paeth(a, b, c); break;
+                default: return false;
+            }
+        }
+
+        previous = pixels;
+    }
+
+    return true;
+}
+
+bool decode_png(const ByteArray& buffer, Image* out_image)
+{
+    static constexpr u8 PNG_SIGNATURE[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    if (buffer.size() < 8 || std::memcmp(buffer.data(), PNG_SIGNATURE, sizeof(PNG_SIGNATURE)) != 0) {
+        LOG_ERROR("ImageReader : not a png");
+        return false;
+    }
+
+    u32       width = 0, height = 0;
+    u8        bit_depth = 0, color_type = 0, interlace = 0;
+    ByteArray compressed;
+    ByteArray palette; // rgba
+    ByteArray transparency;
+
+    u64 offset = 8;
+    while ((offset + 12) <= buffer.size()) {
+        const u32   size = read_u32_be(buffer.data() + offset);
+        const char* type = reinterpret_cast<const char*>(buffer.data() + offset + 4);
+        const u8*   data = (buffer.data() + offset + 8);
+        if ((offset + 12 + size) > buffer.size()) break;
+
+        if (std::memcmp(type, "IHDR", 4) == 0 && size >= 13) {
+            width      = read_u32_be(data);
+            height     = read_u32_be(data + 4);
+            bit_depth  = data[8];
+            color_type = data[9];
+            interlace  = data[12];
+        } else if (std::memcmp(type, "PLTE", 4) == 0) {
+            for (u32 i = 0; (i + 3) <= size; i += 3) {
+                palette.insert(palette.end(), {data[i], data[i + 1], data[i + 2], 255});
+            }
+        } else if (std::memcmp(type, "tRNS", 4) == 0) {
+            transparency.assign(data, (data + size));
+        } else if (std::memcmp(type, "IDAT", 4) == 0) {
+            compressed.insert(compressed.end(), data, (data + size));
+        } else if (std::memcmp(type, "IEND", 4) == 0) {
+            break;
+        }
+
+        offset += (12 + size);
+    }
+
+    if (!is_valid_size(width, height) || compressed.empty()) {
+        LOG_ERROR("ImageReader : png is missing its header or data");
+        return false;
+    }
+
+    if (interlace != 0 || (bit_depth != 8 && bit_depth != 16) || (color_type == 3 && bit_depth != 8)) {
+        LOG_ERROR("ImageReader : unsupported png (bit depth {}, color type {}, interlace {})", bit_depth, color_type,
+                  interlace);
+        return false;
+    }
+
+    u32 channels = 0;
+    switch (color_type) {
+        case 0: channels = 1; break;
+        case 2: channels = 3; break;
+        case 3: channels = 1; break;
+        case 4: channels = 2; break;
+        case 6: channels = 4; break;
+        default: LOG_ERROR("ImageReader : unknown png color type {}", color_type); return false;
+    }
+
+    const u32 bpp   = (channels * (bit_depth / 8));
+    const u64 pitch = (static_cast<u64>(width) * bpp);
+
+    ByteArray filtered((pitch + 1) * height);
+    uLongf    filtered_size = static_cast<uLongf>(filtered.size());
+    if (uncompress(filtered.data(), &filtered_size, compressed.data(), static_cast<uLong>(compressed.size())) != Z_OK
+        || filtered_size != filtered.size()) {
+        LOG_ERROR("ImageReader : failed to inflate png data");
+        return false;
+    }
+
+    if (!unfilter_png(filtered.data(), height, pitch, bpp)) {
+        LOG_ERROR("ImageReader : png has an unknown row filter");
+        return false;
+    }
+
+    // palette entries without a tRNS value are opaque
+    for (u64 i = 0; i < transparency.size() && ((i * 4) + 3) < palette.size(); ++i) {
+        palette[(i * 4) + 3] = transparency[i];
+    }
+
+    out_image->m_Width  = width;
+    out_image->m_Height = height;
+    out_image->m_Pixels.resize(static_cast<u64>(width) * height * 4);
+
+    // 16 bit samples are big endian, keeping the first byte rounds them down to 8 bits
+    const u32 step = (bit_depth / 8);
+    for (u32 y = 0; y < height; ++y) {
+        const u8* row = (filtered.data() + (y * (pitch + 1)) + 1);
+        u8*       out = (out_image->m_Pixels.data() + (static_cast<u64>(y) * width * 4));
+
+        for (u32 x = 0; x < width; ++x, out += 4) {
+            const u8* sample = (row + (x * bpp));
+            if (color_type == 3) {
+                if (((sample[0] * 4u) + 4) > palette.size()) {
+                    LOG_ERROR("ImageReader : png palette index {} is out of range", sample[0]);
+                    return false;
+                }
+
+                std::memcpy(out, &palette[sample[0] * 4], 4);
+                continue;
+            }
+
+            // gray and gray alpha repeat the first sample, alpha is always the last sample
+            const bool is_gray = (channels <= 2);
+            out[0]             = sample[0];
+            out[1]             = (is_gray ? sample[0] : sample[step]);
+            out[2]             = (is_gray ? sample[0] : sample[step * 2]);
+            out[3]             = ((channels == 2 || channels == 4) ? sample[step * (channels - 1)] : 255);
+        }
+    }
+
+    return true;
+}
+
+// tga
+
+bool decode_tga(const ByteArray& buffer, Image* out_image)
+{
+    if (buffer.size() < 18) {
+        LOG_ERROR("ImageReader : tga is too small");
+        return false;
+    }
+
+    const u8  id_length      = buffer[0];
+    const u8  colormap_type  = buffer[1];
+    const u8  image_type     = buffer[2];
+    const u32 width          = read_u16_le(&buffer[12]);
+    const u32 height         = read_u16_le(&buffer[14]);
+    const u8  bits_per_pixel = buffer[16];
+    const u8  descriptor     = buffer[17];
+
+    const bool is_rle  = (image_type == 10 || image_type == 11);
+    const bool is_gray = (image_type == 3 || image_type == 11);
+    if (colormap_type != 0 || (image_type != 2 && image_type != 3 && !is_rle) || !is_valid_size(width, height)
+        || (is_gray ? bits_per_pixel != 8 : (bits_per_pixel != 24 && bits_per_pixel != 32))) {
+        LOG_ERROR("ImageReader : unsupported tga (type {}, {} bits per pixel)", image_type, bits_per_pixel);
+        return false;
+    }
+
+    const u32 bpp        = (bits_per_pixel / 8);
+    const u64 num_pixels = (static_cast<u64>(width) * height);
+
+    // unpack into the file order first, rle packets can cross rows
+    ByteArray raw(num_pixels * bpp);
+    u64       offset = (18 + id_length);
+    if (!is_rle) {
+        if ((offset + raw.size()) > buffer.size()) {
+            LOG_ERROR("ImageReader : tga is truncated");
+            return false;
+        }
+
+        std::memcpy(raw.data(), &buffer[offset], raw.size());
+    } else {
+        u64 pixel = 0;
+        while (pixel < num_pixels) {
+            if (offset >= buffer.size()) {
+                LOG_ERROR("ImageReader : tga is truncated");
+                return false;
+            }
+
+            const u8  header = buffer[offset++];
+            const u64 count  = std::min<u64>(((header & 0x7F) + 1), (num_pixels - pixel));
+            const u64 size   = ((header & 0x80) ? bpp : (count * bpp));
+            if ((offset + size) > buffer.size()) {
+                LOG_ERROR("ImageReader : tga is truncated");
+                return false;
+            }
+
+            if (header & 0x80) {
+                for (u64 i = 0; i < count; ++i) std::memcpy(&raw[(pixel + i) * bpp], &buffer[offset], bpp);
+            } else {
+                std::memcpy(&raw[pixel * bpp], &buffer[offset], size);
+            }
+
+            offset += size;
+            pixel += count;
+        }
+    }
+
+    out_image->m_Width  = width;
+    out_image->m_Height = height;
+    out_image->m_Pixels.resize(num_pixels * 4);
+
+    // bottom row first unless bit 5 of the descriptor is set, pixels are bgr(a)
+    const bool top_to_bottom = (descriptor & 0x20);
+    for (u32 y = 0; y < height; ++y) {
+        const u8* row = &raw[static_cast<u64>(top_to_bottom ? y : (height - 1 - y)) * width * bpp];
+        u8*       out = &out_image->m_Pixels[static_cast<u64>(y) * width * 4];
+
+        for (u32 x = 0; x < width; ++x, row += bpp, out += 4) {
+            if (is_gray) {
+                out[0] = out[1] = out[2] = row[0];
+                out[3]                   = 255;
+            } else {
+                out[0] = row[2];
+                out[1] = row[1];
+                out[2] = row[0];
+                out[3] = (bpp == 4 ? row[3] : 255);
+            }
+        }
+    }
+
+    return true;
+}
+
+// dds
+
+static constexpr u32 make_fourcc(char a, char b, char c, char d)
+{
+    return (static_cast<u32>(static_cast<u8>(a)) | (static_cast<u32>(static_cast<u8>(b)) << 8)
+            | (static_cast<u32>(static_cast<u8>(c)) << 16) | (static_cast<u32>(static_cast<u8>(d)) << 24));
+}
+
+bool decode_dds(const ByteArray& buffer, Image* out_image)
+{
+    // magic, 124 byte header and the optional 20 byte dx10 header
+    static constexpr u32 DDS_HEADER_SIZE = 128;
+    static constexpr u32 DDPF_FOURCC     = 0x4;
+    static constexpr u32 DDPF_RGB        = 0x40;
+    static constexpr u32 DDPF_LUMINANCE  = 0x20000;
+
+    if (buffer.size() < DDS_HEADER_SIZE || read_u32_le(buffer.data()) != make_fourcc('D', 'D', 'S', ' ')) {
+        LOG_ERROR("ImageReader : not a dds");
+        return false;
+    }
+
+    const u32 height      = read_u32_le(&buffer[12]);
+    const u32 width       = read_u32_le(&buffer[16]);
+    const u32 pf_flags    = read_u32_le(&buffer[80]);
+    const u32 fourcc      = read_u32_le(&buffer[84]);
+    const u32 bit_count   = read_u32_le(&buffer[88]);
+    const u32 red_mask    = read_u32_le(&buffer[92]);
+    const u32 alpha_mask  = read_u32_le(&buffer[104]);
+    u64       data_offset = DDS_HEADER_SIZE;
+
+    if (!is_valid_size(width, height)) {
+        LOG_ERROR("ImageReader : dds has an invalid size ({}x{})", width, height);
+        return false;
+    }
+
+    u32  format  = 0;
+    bool is_rgba = false; // r8g8b8a8 isn't something the game uses, so texture_decoder doesn't handle it
+    if (pf_flags & DDPF_FOURCC) {
+        switch (fourcc) {
+            case make_fourcc('D', 'X', 'T', '1'): format = texture_decoder::FORMAT_BC1_UNORM; break;
+            case make_fourcc('D', 'X', 'T', '2'):
+            case make_fourcc('D', 'X', 'T', '3'): format = texture_decoder::FORMAT_BC2_UNORM; break;
+            case make_fourcc('D', 'X', 'T', '4'):
+            case make_fourcc('D', 'X', 'T', '5'): format = texture_decoder::FORMAT_BC3_UNORM; break;
+            case make_fourcc('A', 'T', 'I', '1'):
+            case make_fourcc('B', 'C', '4', 'U'): format = texture_decoder::FORMAT_BC4_UNORM; break;
+            case make_fourcc('A', 'T', 'I', '2'):
+            case make_fourcc('B', 'C', '5', 'U'): format = texture_decoder::FORMAT_BC5_UNORM; break;
+            case make_fourcc('D', 'X', '1', '0'): {
+                if (buffer.size() < (DDS_HEADER_SIZE + 20)) {
+                    LOG_ERROR("ImageReader : dds is missing its dx10 header");
+                    return false;
+                }
+
+                format = read_u32_le(&buffer[DDS_HEADER_SIZE]);
+                data_offset += 20;
+
+                // R8G8B8A8_UNORM and R8G8B8A8_UNORM_SRGB
+                if (format == 28 || format == 29) is_rgba = true;
+                break;
+            }
+        }
+    } else if ((pf_flags & DDPF_RGB) && bit_count == 32) {
+        is_rgba = (red_mask == 0x000000FF);
+        format  = (red_mask == 0x00FF0000 ? texture_decoder::FORMAT_B8G8R8A8_UNORM : 0);
+    } else if ((pf_flags & DDPF_LUMINANCE) && bit_count == 8 && alpha_mask == 0) {
+        format = texture_decoder::FORMAT_R8_UNORM;
+    }
+
+    out_image->m_Width  = width;
+    out_image->m_Height = height;
+    out_image->m_Pixels.resize(static_cast<u64>(width) * height * 4);
+
+    const u8* data = (buffer.data() + data_offset);
+    const u64 size = (buffer.size() - data_offset);
+    if (is_rgba) {
+        if (size < out_image->m_Pixels.size()) {
+            LOG_ERROR("ImageReader : dds is truncated");
+            return false;
+        }
+
+        std::memcpy(out_image->m_Pixels.data(), data, out_image->m_Pixels.size());
+        return true;
+    }
+
+    if (!texture_decoder::is_supported(format)) {
+        LOG_ERROR("ImageReader : unsupported dds pixel format (fourcc 0x{:08X}, dxgi {})", fourcc, format);
+        return false;
+    }
+
+    if (!texture_decoder::decode(format, data, size, width, height, out_image->m_Pixels.data())) {
+        LOG_ERROR("ImageReader : dds is truncated");
+        return false;
+    }
+
+    return true;
+}
+
+static std::string get_lowercase_extension(const std::filesystem::path& filename)
+{
+    auto extension = filename.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(), ::tolower);
+    return extension;
+}
+
+bool read(const std::filesystem::path& filename, Image* out_image)
+{
+    std::ifstream stream(filename, std::ios::binary);
+    if (stream.fail()) {
+        LOG_ERROR("ImageReader : failed to open \"{}\"", filename.generic_string());
+        return false;
+    }
+
+    ByteArray buffer(std::filesystem::file_size(filename));
+    stream.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
+    if (stream.fail()) {
+        LOG_ERROR("ImageReader : failed to read \"{}\"", filename.generic_string());
+        return false;
+    }
+
+    const auto extension = get_lowercase_extension(filename);
+    if (extension == ".png") return decode_png(buffer, out_image);
+    if (extension == ".tga") return decode_tga(buffer, out_image);
+    if (extension == ".dds") return decode_dds(buffer, out_image);
+
+    LOG_ERROR("ImageReader : unsupported image \"{}\"", filename.generic_string());
+    return false;
+}
+
+bool is_supported(const std::filesystem::path& filename)
+{
+    const auto extension = get_lowercase_extension(filename);
+    return (extension == ".png" || extension == ".tga" || extension == ".dds");
+}
+} // namespace jcmr::image_reader
@@ -0,0 +1,27 @@
+#ifndef JCMR_APP_IMAGE_READER_H_HEADER_GUARD
+#define JCMR_APP_IMAGE_READER_H_HEADER_GUARD
+
+#include "platform.h"
+
+// decodes images to rgba8 (4 bytes per pixel, top row first) for importing textures
+//  png - 8 and 16 bit gray, gray alpha, rgb, rgba and palette images, not interlaced
+//  tga - 8 bit gray, 24 and 32 bit true color, uncompressed or rle
+//  dds - the formats texture_decoder supports and 32 bit rgba, only the top mip of the first surface
+namespace jcmr::image_reader
+{
+struct Image {
+    u32       m_Width  = 0;
+    u32       m_Height = 0;
+    ByteArray m_Pixels;
+};
+
+bool decode_png(const ByteArray& buffer, Image* out_image);
+bool decode_tga(const ByteArray& buffer, Image* out_image);
+bool decode_dds(const ByteArray& buffer, Image* out_image);
+
+// picks the decoder from the file extension
+bool read(const std::filesystem::path& filename, Image* out_image);
+bool is_supported(const std::filesystem::path& filename);
+} // namespace jcmr::image_reader
+
+#endif // JCMR_APP_IMAGE_READER_H_HEADER_GUARD
@@ -0,0 +1,135 @@
+#include "pch.h"
+
+#include "image_writer.h"
+
+#include <cstring>
+#include <zlib.h>
+
+namespace jcmr::image_writer
+{
+static void write_u32_be(ByteArray* buffer, u32 value)
+{
+    buffer->push_back(static_cast<u8>(value >> 24));
+    buffer->push_back(static_cast<u8>(value >> 16));
+    buffer->push_back(static_cast<u8>(value >> 8));
+    buffer->push_back(static_cast<u8>(value));
+}
+
+static void write_png_chunk(ByteArray* buffer, const char* type, const u8* data, u32 size)
+{
+    write_u32_be(buffer, size);
+
+    const auto offset = buffer->size();
+    buffer->insert(buffer->end(), type, (type + 4));
+    if (size > 0) buffer->insert(buffer->end(), data, (data + size));
+
+    // crc covers the type and the data
+    const auto crc = crc32(0, (buffer->data() + offset), static_cast<uInt>(size + 4));
+    write_u32_be(buffer, static_cast<u32>(crc));
+}
+
+bool encode_png(const u8* pixels, u32 width, u32 height, ByteArray* out_buffer, i32 compression_level)
+{
+    if (!pixels || width == 0 || height == 0) return false;
+
+    // every row starts with its filter type. sub (1) stores the difference to the pixel on the left, which is cheap
+    // and compresses textures much better than no filter.
+    const u64 pitch = (width * 4ull);
+    ByteArray filtered((pitch + 1) * height);
+    for (u32 y = 0; y < height; ++y) {
+        const u8* row = (pixels + (y * pitch));
+        u8*       out = (filtered.data() + (y * (pitch + 1)));
+
+        out[0] = 1;
+        std::memcpy((out + 1), row, 4);
+        for (u64 i = 4; i < pitch; ++i) {
+            out[i + 1] = static_cast<u8>(row[i] - row[i - 4]);
+        }
+    }
+
+    uLongf    compressed_size = compressBound(static_cast<uLong>(filtered.size()));
+    ByteArray compressed(compressed_size);
+    if (compress2(compressed.data(), &compressed_size, filtered.data(), static_cast<uLong>(filtered.size()),
+                  compression_level)
+        != Z_OK) {
+        LOG_ERROR("ImageWriter : failed to compress {}x{} png", width, height);
+        return false;
+    }
+
+    static constexpr u8 PNG_SIGNATURE[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+
+    // 8 bit rgba, deflate, no interlacing
+    ByteArray header;
+    write_u32_be(&header, width);
+    write_u32_be(&header, height);
+    header.insert(header.end(), {8, 6, 0, 0, 0});
+
+    out_buffer->clear();
+    out_buffer->reserve(compressed_size + 64);
+    out_buffer->insert(out_buffer->end(), std::begin(PNG_SIGNATURE), std::end(PNG_SIGNATURE));
+    write_png_chunk(out_buffer, "IHDR", header.data(), static_cast<u32>(header.size()));
+    write_png_chunk(out_buffer, "IDAT", compressed.data(), static_cast<u32>(compressed_size));
+    write_png_chunk(out_buffer, "IEND", nullptr, 0);
+    return true;
+}
+
+bool encode_tga(const u8* pixels, u32 width, u32 height, ByteArray* out_buffer)
+{
+    if (!pixels || width == 0 || height == 0 || width > 0xFFFF || height > 0xFFFF) return false;
+
+    // uncompressed true color, 32 bits per pixel with 8 alpha bits and the top row first
+    u8 header[18] = {};
+    header[2]     = 2;
+    header[12]    = static_cast<u8>(width);
+    header[13]    = static_cast<u8>(width >> 8);
+    header[14]    = static_cast<u8>(height);
+    header[15]    = static_cast<u8>(height >> 8);
+    header[16]    = 32;
+    header[17]    = 0x28;
+
+    const u64 num_pixels = (static_cast<u64>(width) * height);
+    out_buffer->resize(sizeof(header) + (num_pixels * 4));
+    std::memcpy(out_buffer->data(), header, sizeof(header));
+
+    // tga pixels are bgra
+    u8* out = (out_buffer->data() + sizeof(header));
+    for (u64 i = 0; i < num_pixels; ++i) {
+        out[(i * 4) + 0] = pixels[(i * 4) + 2];
+        out[(i * 4) + 1] = pixels[(i * 4) + 1];
+        out[(i * 4) + 2] = pixels[(i * 4) + 0];
+        out[(i * 4) + 3] = pixels[(i * 4) + 3];
+    }
+
+    return true;
+}
+
+bool encode(EImageType type, const u8* pixels, u32 width, u32 height, ByteArray* out_buffer)
+{
+    switch (type) {
+        case E_IMAGE_TYPE_PNG: return encode_png(pixels, width, height, out_buffer);
+        case E_IMAGE_TYPE_TGA: return encode_tga(pixels, width, height, out_buffer);
+    }
+
+    return false;
+}
+
+const char* get_extension(EImageType type)
+{
+    return (type == E_IMAGE_TYPE_TGA ? ".tga" : ".png");
+}
+
+bool parse_type(const std::string& value, EImageType* out_type)
+{
+    if (value == "png") {
+        *out_type = E_IMAGE_TYPE_PNG;
+        return true;
+    }
+
+    if (value == "tga") {
+        *out_type = E_IMAGE_TYPE_TGA;
+        return true;
+    }
+
+    return false;
+}
+} // namespace jcmr::image_writer
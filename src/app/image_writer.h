@@ -0,0 +1,25 @@
+#ifndef JCMR_APP_IMAGE_WRITER_H_HEADER_GUARD
+#define JCMR_APP_IMAGE_WRITER_H_HEADER_GUARD
+
+#include "platform.h"
+
+// encodes rgba8 images (4 bytes per pixel, top row first) for exporting textures
+namespace jcmr::image_writer
+{
+enum EImageType : u8 {
+    E_IMAGE_TYPE_PNG = 0,
+    E_IMAGE_TYPE_TGA,
+};
+
+// compression_level is the zlib level, lower is faster and bigger
+bool encode_png(const u8* pixels, u32 width, u32 height, ByteArray* out_buffer, i32 compression_level = 6);
+bool encode_tga(const u8* pixels, u32 width, u32 height, ByteArray* out_buffer);
+
+bool        encode(EImageType type, const u8* pixels, u32 width, u32 height, ByteArray* out_buffer);
+const char* get_extension(EImageType type);
+
+// "png" or "tga", returns false for anything else
+bool parse_type(const std::string& value, EImageType* out_type);
+} // namespace jcmr::image_writer
+
+#endif // JCMR_APP_IMAGE_WRITER_H_HEADER_GUARD
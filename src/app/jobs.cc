@@ -0,0 +1,137 @@
+#include "pch.h"
+
+#include "jobs.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace jcmr::jobs
+{
+static constexpr u32 INVALID_WORKER = 0xFFFFFFFF;
+
+// the worker index of the thread while it's running items, nested calls run inline with it
+static thread_local u32 s_worker_index = INVALID_WORKER;
+
+struct Job {
+    const JobCallback_t* m_Callback;
+    u32                  m_Count;
+    std::atomic<u32>     m_NextIndex = 0;
+    u32                  m_NumActive = 0; // pool threads running items, guarded by the pool mutex
+};
+
+// get_worker_count() - 1 threads started on first use, the thread calling parallel_for is the last worker. more than
+// one thread can call parallel_for at a time, the jobs are queued and the pool threads help with the oldest one.
+struct Pool {
+    std::mutex               m_mutex;
+    std::condition_variable  m_work_condition;
+    std::condition_variable  m_done_condition;
+    std::deque<Job*>         m_jobs;
+    std::vector<std::thread> m_threads;
+    bool                     m_stopping = false;
+
+    Pool()
+    {
+        const u32 num_threads = (get_worker_count() - 1);
+        m_threads.reserve(num_threads);
+        for (u32 i = 0; i < num_threads; ++i) {
+            m_threads.emplace_back([this, i] { worker_thread(i); });
+        }
+    }
+
+    ~Pool()
+    {
+        {
+            std::lock_guard lock(m_mutex);
+            m_stopping = true;
+        }
+
+        m_work_condition.notify_all();
+        for (auto& thread : m_threads) {
+            thread.join();
+        }
+    }
+
+    static void run_items(Job& job, u32 worker_index)
+    {
+        s_worker_index = worker_index;
+        for (u32 index = job.m_NextIndex++; index < job.m_Count; index = job.m_NextIndex++) {
+            (*job.m_Callback)(index, worker_index);
+        }
+
+        s_worker_index = INVALID_WORKER;
+    }
+
+    // the items have all been handed out, nobody else needs to pick the job up
+    void remove_job(Job* job)
+    {
+        auto iter = std::find(m_jobs.begin(), m_jobs.end(), job);
+        if (iter != m_jobs.end()) m_jobs.erase(iter);
+    }
+
+    void worker_thread(u32 worker_index)
+    {
+        std::unique_lock lock(m_mutex);
+        while (true) {
+            m_work_condition.wait(lock, [this] { return (m_stopping || !m_jobs.empty()); });
+            if (m_stopping) return;
+
+            auto* job = m_jobs.front();
+            ++job->m_NumActive;
+
+            lock.unlock();
+            run_items(*job, worker_index);
+            lock.lock();
+
+            remove_job(job);
+            if (--job->m_NumActive == 0) {
+                m_done_condition.notify_all();
+            }
+        }
+    }
+
+    void run(Job& job)
+    {
+        {
+            std::lock_guard lock(m_mutex);
+            m_jobs.push_back(&job);
+        }
+
+        m_work_condition.notify_all();
+        run_items(job, (get_worker_count() - 1));
+
+        std::unique_lock lock(m_mutex);
+        remove_job(&job);
+        m_done_condition.wait(lock, [&job] { return (job.m_NumActive == 0); });
+    }
+};
+
+u32 get_worker_count()
+{
+    static const u32 s_worker_count = std::max(1u, std::thread::hardware_concurrency());
+    return s_worker_count;
+}
+
+void parallel_for(u32 count, JobCallback_t callback)
+{
+    if (count == 0) return;
+
+    // the workers are already busy with the outer items
+    if (s_worker_index != INVALID_WORKER) {
+        for (u32 index = 0; index < count; ++index) {
+            callback(index, s_worker_index);
+        }
+
+        return;
+    }
+
+    static Pool s_pool;
+
+    Job job;
+    job.m_Callback = &callback;
+    job.m_Count    = count;
+    s_pool.run(job);
+}
+} // namespace jcmr::jobs
@@ -0,0 +1,21 @@
+#ifndef JCMR_APP_JOBS_H_HEADER_GUARD
+#define JCMR_APP_JOBS_H_HEADER_GUARD
+
+#include "platform.h"
+
+namespace jcmr::jobs
+{
+// index is the item being processed, worker is in the range [0, get_worker_count()) and can be used to index
+// per-thread scratch data.
+using JobCallback_t = std::function<void(u32 index, u32 worker)>;
+
+u32 get_worker_count();
+
+// run callback for every index in [0, count) across the worker threads, blocks until all items are processed.
+// items are handed out one at a time so uneven workloads still balance. the worker threads are started on the first
+// call and kept. called from inside a callback, the items are processed on the calling thread with its own worker
+// index, so the nested callback mustn't touch the per-worker data the outer callback is using.
+void parallel_for(u32 count, JobCallback_t callback);
+} // namespace jcmr::jobs
+
+#endif // JCMR_APP_JOBS_H_HEADER_GUARD
@@ -299,6 +299,96 @@ ByteArray map_view_of_file(const char* filename, u64 offset, u64 size)
     return result;
 }
 
+void* get_library_function(const char* library_name, const char* function_name)
+{
+    auto module = GetModuleHandle(library_name);
+    if (!module) {
+        return nullptr;
+    }
+
+    return reinterpret_cast<void*>(GetProcAddress(module, function_name));
+}
+
+bool map_file(const char* filename, u64 size, MappedFile* out_file)
+{
+    *out_file = {};
+
+    auto file_handle = CreateFile(filename, (GENERIC_READ | GENERIC_WRITE), FILE_SHARE_READ, nullptr, OPEN_ALWAYS,
+                                  FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_handle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    // the mapping grows the file to size
+    auto mapping_handle = CreateFileMapping(file_handle, nullptr, PAGE_READWRITE, static_cast<DWORD>(size >> 32),
+                                            static_cast<DWORD>(size & 0xFFFFFFFF), nullptr);
+    if (!mapping_handle) {
+        CloseHandle(file_handle);
+        return false;
+    }
+
+    auto* ptr = static_cast<u8*>(MapViewOfFile(mapping_handle, FILE_MAP_ALL_ACCESS, 0, 0, size));
+    if (!ptr) {
+        CloseHandle(mapping_handle);
+        CloseHandle(file_handle);
+        return false;
+    }
+
+    out_file->file_handle    = file_handle;
+    out_file->mapping_handle = mapping_handle;
+    out_file->data           = ptr;
+    out_file->size           = size;
+    return true;
+}
+
+bool map_file_read_only(const char* filename, MappedFile* out_file)
+{
+    *out_file = {};
+
+    auto file_handle =
+        CreateFile(filename, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_handle == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file_handle, &size) || size.QuadPart == 0) {
+        CloseHandle(file_handle);
+        return false;
+    }
+
+    auto mapping_handle = CreateFileMapping(file_handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping_handle) {
+        CloseHandle(file_handle);
+        return false;
+    }
+
+    auto* ptr = static_cast<u8*>(MapViewOfFile(mapping_handle, FILE_MAP_READ, 0, 0, 0));
+    if (!ptr) {
+        CloseHandle(mapping_handle);
+        CloseHandle(file_handle);
+        return false;
+    }
+
+    out_file->file_handle    = file_handle;
+    out_file->mapping_handle = mapping_handle;
+    out_file->data           = ptr;
+    out_file->size           = static_cast<u64>(size.QuadPart);
+    return true;
+}
+
+void unmap_file(MappedFile* file)
+{
+    if (file->data) {
+        FlushViewOfFile(file->data, 0);
+        UnmapViewOfFile(file->data);
+    }
+
+    if (file->mapping_handle) CloseHandle(file->mapping_handle);
+    if (file->file_handle) CloseHandle(file->file_handle);
+    *file = {};
+}
+
 template <i32 N> static void toWChar(WCHAR (&out)[N], const char* in)
 {
     const char* c    = in;
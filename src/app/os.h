@@ -103,6 +103,24 @@ namespace os
 
     ByteArray map_view_of_file(const char* filename, u64 offset, u64 size);
 
+    // an exported function from a library the process has already loaded, nullptr if it isn't loaded
+    void* get_library_function(const char* library_name, const char* function_name);
+
+    struct MappedFile {
+        void* file_handle    = nullptr;
+        void* mapping_handle = nullptr;
+        u8*   data           = nullptr;
+        u64   size           = 0;
+    };
+
+    // read/write mapping of the first size bytes of the file, it's created or grown to size when it's smaller.
+    // changes are written back by the os, unmap_file() flushes them.
+    bool map_file(const char* filename, u64 size, MappedFile* out_file);
+
+    // the whole file, it has to exist
+    bool map_file_read_only(const char* filename, MappedFile* out_file);
+    void unmap_file(MappedFile* file);
+
     bool get_open_file(FileDialogParams& params, std::filesystem::path* out_path);
     bool get_open_file(const char* title, FileDialogParams& params, std::filesystem::path* out_path);
     bool get_open_folder(FileDialogParams& params, std::filesystem::path* out_path);
@@ -0,0 +1,810 @@
+#include "pch.h"
+
+#include "texture_decoder.h"
+
+#include "app/jobs.h"
+
+#include <cstring>
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// msvc allows ssse3 intrinsics anywhere, gcc and clang need the functions which use them marked
+#if defined(__GNUC__) || defined(__clang__)
+#define JCMR_TARGET_SSSE3 __attribute__((target("ssse3")))
+#else
+#define JCMR_TARGET_SSSE3
+#endif
+
+namespace jcmr::texture_decoder
+{
+static constexpr u32 TILE_BLOCK_ROWS   = 16;          // block rows per job
+static constexpr u64 MIN_THREADED_SIZE = (256 * 256); // smaller surfaces aren't worth splitting
+
+// writes a 4x4 block of rgba8 pixels, stride is the distance between rows in bytes
+using DecodeBlock_t = void (*)(const u8* block, u8* out, u64 stride);
+
+// converts count pixels of an uncompressed row to rgba8
+using ConvertRow_t = void (*)(const u8* row, u32 count, u8* out);
+
+struct FormatInfo {
+    const char*   m_Name;
+    u32           m_BlockSize; // bytes per 4x4 block, 0 for uncompressed formats
+    u32           m_PixelSize; // bytes per pixel for uncompressed formats
+    DecodeBlock_t m_DecodeBlock;
+    DecodeBlock_t m_DecodeBlockSimd;
+    ConvertRow_t  m_ConvertRow;
+    ConvertRow_t  m_ConvertRowSimd;
+};
+
+static u16 read_u16(const u8* data)
+{
+    return static_cast<u16>(data[0] | (data[1] << 8));
+}
+
+static u32 read_u32(const u8* data)
+{
+    u32 value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+static u64 read_u64(const u8* data)
+{
+    u64 value;
+    std::memcpy(&value, data, sizeof(value));
+    return value;
+}
+
+// 5:6:5 to rgba8 with the top bits repeated into the bottom bits
+static void expand_565(u16 color, u8* out)
+{
+    const u32 r = ((color >> 11) & 0x1F);
+    const u32 g = ((color >> 5) & 0x3F);
+    const u32 b = (color & 0x1F);
+
+    out[0] = static_cast<u8>((r << 3) | (r >> 2));
+    out[1] = static_cast<u8>((g << 2) | (g >> 4));
+    out[2] = static_cast<u8>((b << 3) | (b >> 2));
+    out[3] = 255;
+}
+
+// scalar decoders, used by decode_reference() and for the formats which don't have a simd version
+
+// bc2 and bc3 color blocks always use four colors, only bc1 has the three color and transparent black mode
+static void decode_color_block(const u8* block, u8* out, u64 stride, bool allow_transparent)
+{
+    const u16 c0 = read_u16(block);
+    const u16 c1 = read_u16(block + 2);
+
+    u8 palette[4][4];
+    expand_565(c0, palette[0]);
+    expand_565(c1, palette[1]);
+
+    for (u32 c = 0; c < 4; ++c) {
+        const u32 e0 = palette[0][c];
+        const u32 e1 = palette[1][c];
+        if (c0 > c1 || !allow_transparent) {
+            palette[2][c] = static_cast<u8>(((2 * e0) + e1) / 3);
+            palette[3][c] = static_cast<u8>((e0 + (2 * e1)) / 3);
+        } else {
+            palette[2][c] = static_cast<u8>((e0 + e1) / 2);
+            palette[3][c] = 0;
+        }
+    }
+
+    const u32 indices = read_u32(block + 4);
+    for (u32 i = 0; i < 16; ++i) {
+        std::memcpy((out + ((i / 4) * stride) + ((i % 4) * 4)), palette[(indices >> (i * 2)) & 3], 4);
+    }
+}
+
+// bc3 alpha, bc4 and bc5 channels
+static void decode_alpha_block(const u8* block, u8* out_values)
+{
+    const u32 a0 = block[0];
+    const u32 a1 = block[1];
+
+    u8 palette[8] = {static_cast<u8>(a0), static_cast<u8>(a1)};
+    if (a0 > a1) {
+        for (u32 i = 1; i < 7; ++i) {
+            palette[i + 1] = static_cast<u8>((((7 - i) * a0) + (i * a1)) / 7);
+        }
+    } else {
+        for (u32 i = 1; i < 5; ++i) {
+            palette[i + 1] = static_cast<u8>((((5 - i) * a0) + (i * a1)) / 5);
+        }
+
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+
+    const u64 indices = (read_u64(block) >> 16);
+    for (u32 i = 0; i < 16; ++i) {
+        out_values[i] = palette[(indices >> (i * 3)) & 7];
+    }
+}
+
+static void decode_bc1_block(const u8* block, u8* out, u64 stride)
+{
+    decode_color_block(block, out, stride, true);
+}
+
+static void decode_bc2_block(const u8* block, u8* out, u64 stride)
+{
+    decode_color_block((block + 8), out, stride, false);
+
+    const u64 alpha = read_u64(block);
+    for (u32 i = 0; i < 16; ++i) {
+        out[((i / 4) * stride) + ((i % 4) * 4) + 3] = static_cast<u8>(((alpha >> (i * 4)) & 0xF) * 17);
+    }
+}
+
+static void decode_bc3_block(const u8* block, u8* out, u64 stride)
+{
+    decode_color_block((block + 8), out, stride, false);
+
+    u8 alpha[16];
+    decode_alpha_block(block, alpha);
+    for (u32 i = 0; i < 16; ++i) {
+        out[((i / 4) * stride) + ((i % 4) * 4) + 3] = alpha[i];
+    }
+}
+
+static void decode_bc4_block(const u8* block, u8* out, u64 stride)
+{
+    u8 red[16];
+    decode_alpha_block(block, red);
+    for (u32 i = 0; i < 16; ++i) {
+        auto* pixel = (out + ((i / 4) * stride) + ((i % 4) * 4));
+        pixel[0]    = red[i];
+        pixel[1]    = 0;
+        pixel[2]    = 0;
+        pixel[3]    = 255;
+    }
+}
+
+static void decode_bc5_block(const u8* block, u8* out, u64 stride)
+{
+    u8 red[16];
+    u8 green[16];
+    decode_alpha_block(block, red);
+    decode_alpha_block((block + 8), green);
+    for (u32 i = 0; i < 16; ++i) {
+        auto* pixel = (out + ((i / 4) * stride) + ((i % 4) * 4));
+        pixel[0]    = red[i];
+        pixel[1]    = green[i];
+        pixel[2]    = 0;
+        pixel[3]    = 255;
+    }
+}
+
+// bc7
+struct Bc7Mode {
+    u8 m_NumSubsets;
+    u8 m_PartitionBits;
+    u8 m_RotationBits;
+    u8 m_IndexSelectionBits;
+    u8 m_ColorBits;
+    u8 m_AlphaBits;
+    u8 m_EndpointPBits; // one p-bit per endpoint
+    u8 m_SharedPBits;   // one p-bit per subset
+    u8 m_IndexBits;
+    u8 m_SecondaryIndexBits;
+};
+
+static constexpr Bc7Mode BC7_MODES[8] = {
+    {3, 4, 0, 0, 4, 0, 1, 0, 3, 0}, {2, 6, 0, 0, 6, 0, 0, 1, 3, 0}, {3, 6, 0, 0, 5, 0, 0, 0, 2, 0},
+    {2, 6, 0, 0, 7, 0, 1, 0, 2, 0}, {1, 0, 2, 1, 5, 6, 0, 0, 2, 3}, {1, 0, 2, 0, 7, 8, 0, 0, 2, 2},
+    {1, 0, 0, 0, 7, 7, 1, 0, 4, 0}, {2, 6, 0, 0, 5, 5, 1, 0, 2, 0},
+};
+
+// bit i is set when pixel i is in the second subset
+static constexpr u16 BC7_PARTITIONS_2[64] = {
+    0xCCCC, 0x8888, 0xEEEE, 0xECC8, 0xC880, 0xFEEC, 0xFEC8, 0xEC80, 0xC800, 0xFFEC, 0xFE80, 0xE800, 0xFFE8,
+    0xFF00, 0xFFF0, 0xF000, 0xF710, 0x008E, 0x7100, 0x08CE, 0x008C, 0x7310, 0x3100, 0x8CCE, 0x088C, 0x3110,
+    0x6666, 0x366C, 0x17E8, 0x0FF0, 0x718E, 0x399C, 0xAAAA, 0xF0F0, 0x5A5A, 0x33CC, 0x3C3C, 0x55AA, 0x9696,
+    0xA55A, 0x73CE, 0x13C8, 0x324C, 0x3BDC, 0x6996, 0xC33C, 0x9966, 0x0660, 0x0272, 0x04E4, 0x4E40, 0x2720,
+    0xC936, 0x936C, 0x39C6, 0x639C, 0x9336, 0x9CC6, 0x817E, 0xE718, 0xCCF0, 0x0FCC, 0x7744, 0xEE22,
+};
+
+static constexpr u8 BC7_PARTITIONS_3[64][16] = {
+    {0, 0, 1, 1, 0, 0, 1, 1, 0, 2, 2, 1, 2, 2, 2, 2}, {0, 0, 0, 1, 0, 0, 1, 1, 2, 2, 1, 1, 2, 2, 2, 1},
+    {0, 0, 0, 0, 2, 0, 0, 1, 2, 2, 1, 1, 2, 2, 1, 1}, {0, 2, 2, 2, 0, 0, 2, 2, 0, 0, 1, 1, 0, 1, 1, 1},
+    {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 2, 2, 1, 1, 2, 2}, {0, 0, 1, 1, 0, 0, 1, 1, 0, 0, 2, 2, 0, 0, 2, 2},
+    {0, 0, 2, 2, 0, 0, 2, 2, 1, 1, 1, 1, 1, 1, 1, 1}, {0, 0, 1, 1, 0, 0, 1, 1, 2, 2, 1, 1, 2, 2, 1, 1},
+    {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2}, {0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2},
+    {0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 2, 2, 2, 2}, {0, 0, 1, 2, 0, 0, 1, 2, 0, 0, 1, 2, 0, 0, 1, 2},
+    {0, 1, 1, 2, 0, 1, 1, 2, 0, 1, 1, 2, 0, 1, 1, 2}, {0, 1, 2, 2, 0, 1, 2, 2, 0, 1, 2, 2, 0, 1, 2, 2},
+    {0, 0, 1, 1, 0, 1, 1, 2, 1, 1, 2, 2, 1, 2, 2, 2}, {0, 0, 1, 1, 2, 0, 0, 1, 2, 2, 0, 0, 2, 2, 2, 0},
+    {0, 0, 0, 1, 0, 0, 1, 1, 0, 1, 1, 2, 1, 1, 2, 2}, {0, 1, 1, 1, 0, 0, 1, 1, 2, 0, 0, 1, 2, 2, 0, 0},
+    {0, 0, 0, 0, 1, 1, 2, 2, 1, 1, 2, 2, 1, 1, 2, 2}, {0, 0, 2, 2, 0, 0, 2, 2, 0, 0, 2, 2, 1, 1, 1, 1},
+    {0, 1, 1, 1, 0, 1, 1, 1, 0, 2, 2, 2, 0, 2, 2, 2}, {0, 0, 0, 1, 0, 0, 0, 1, 2, 2, 2, 1, 2, 2, 2, 1},
+    {0, 0, 0, 0, 0, 0, 1, 1, 0, 1, 2, 2, 0, 1, 2, 2}, {0, 0, 0, 0, 1, 1, 0, 0, 2, 2, 1, 0, 2, 2, 1, 0},
+    {0, 1, 2, 2, 0, 1, 2, 2, 0, 0, 1, 1, 0, 0, 0, 0}, {0, 0, 1, 2, 0, 0, 1, 2, 1, 1, 2, 2, 2, 2, 2, 2},
+    {0, 1, 1, 0, 1, 2, 2, 1, 1, 2, 2, 1, 0, 1, 1, 0}, {0, 0, 0, 0, 0, 1, 1, 0, 1, 2, 2, 1, 1, 2, 2, 1},
+    {0, 0, 2, 2, 1, 1, 0, 2, 1, 1, 0, 2, 0, 0, 2, 2}, {0, 1, 1, 0, 0, 1, 1, 0, 2, 0, 0, 2, 2, 2, 2, 2},
+    {0, 0, 1, 1, 0, 1, 2, 2, 0, 1, 2, 2, 0, 0, 1, 1}, {0, 0, 0, 0, 2, 0, 0, 0, 2, 2, 1, 1, 2, 2, 2, 1},
+    {0, 0, 0, 0, 0, 0, 0, 2, 1, 1, 2, 2, 1, 2, 2, 2}, {0, 2, 2, 2, 0, 0, 2, 2, 0, 0, 1, 2, 0, 0, 1, 1},
+    {0, 0, 1, 1, 0, 0, 1, 2, 0, 0, 2, 2, 0, 2, 2, 2}, {0, 1, 2, 0, 0, 1, 2, 0, 0, 1, 2, 0, 0, 1, 2, 0},
+    {0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 0, 0, 0, 0}, {0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0, 1, 2, 0},
+    {0, 1, 2, 0, 2, 0, 1, 2, 1, 2, 0, 1, 0, 1, 2, 0}, {0, 0, 1, 1, 2, 2, 0, 0, 1, 1, 2, 2, 0, 0, 1, 1},
+    {0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 0, 0, 0, 0, 1, 1}, {0, 1, 0, 1, 0, 1, 0, 1, 2, 2, 2, 2, 2, 2, 2, 2},
+    {0, 0, 0, 0, 0, 0, 0, 0, 2, 1, 2, 1, 2, 1, 2, 1}, {0, 0, 2, 2, 1, 1, 2, 2, 0, 0, 2, 2, 1, 1, 2, 2},
+    {0, 0, 2, 2, 0, 0, 1, 1, 0, 0, 2, 2, 0, 0, 1, 1}, {0, 2, 2, 0, 1, 2, 2, 1, 0, 2, 2, 0, 1, 2, 2, 1},
+    {0, 1, 0, 1, 2, 2, 2, 2, 2, 2, 2, 2, 0, 1, 0, 1}, {0, 0, 0, 0, 2, 1, 2, 1, 2, 1, 2, 1, 2, 1, 2, 1},
+    {0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 0, 1, 2, 2, 2, 2}, {0, 2, 2, 2, 0, 1, 1, 1, 0, 2, 2, 2, 0, 1, 1, 1},
+    {0, 0, 0, 2, 1, 1, 1, 2, 0, 0, 0, 2, 1, 1, 1, 2}, {0, 0, 0, 0, 2, 1, 1, 2, 2, 1, 1, 2, 2, 1, 1, 2},
+    {0, 2, 2, 2, 0, 1, 1, 1, 0, 1, 1, 1, 0, 2, 2, 2}, {0, 0, 0, 2, 1, 1, 1, 2, 1, 1, 1, 2, 0, 0, 0, 2},
+    {0, 1, 1, 0, 0, 1, 1, 0, 0, 1, 1, 0, 2, 2, 2, 2}, {0, 0, 0, 0, 0, 0, 0, 0, 2, 1, 1, 2, 2, 1, 1, 2},
+    {0, 1, 1, 0, 0, 1, 1, 0, 2, 2, 2, 2, 2, 2, 2, 2}, {0, 0, 2, 2, 0, 0, 1, 1, 0, 0, 1, 1, 0, 0, 2, 2},
+    {0, 0, 2, 2, 1, 1, 2, 2, 1, 1, 2, 2, 0, 0, 2, 2}, {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2, 1, 1, 2},
+    {0, 0, 0, 2, 0, 0, 0, 1, 0, 0, 0, 2, 0, 0, 0, 1}, {0, 2, 2, 2, 1, 2, 2, 2, 0, 2, 2, 2, 1, 2, 2, 2},
+    {0, 1, 0, 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2}, {0, 1, 1, 1, 2, 0, 1, 1, 2, 2, 0, 1, 2, 2, 2, 0},
+};
+
+// the index of the pixel in each subset which has its top index bit dropped (the first subset is always pixel 0)
+static constexpr u8 BC7_ANCHORS_2[64] = {
+    15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 2,  8, 2,  2, 8,  8,  15, 2,  8,  2,  2,
+    8,  8,  2,  2,  15, 15, 6,  8,  2,  8,  15, 15, 2,  8,  2,  2,  2,  15, 15, 6, 6, 2, 6,  8,  15, 15, 2,  2,
+    15, 15, 15, 15, 15, 2,  2,  15,
+};
+
+static constexpr u8 BC7_ANCHORS_3[2][64] = {
+    {3, 3,  15, 15, 8, 3,  15, 15, 8, 8,  6,  6,  6,  5, 3,  3,  3,  3,  8, 15, 3,  3,
+     6, 10, 5,  8,  8, 6,  8,  5,  15, 15, 8,  15, 3,  5, 6,  10, 8,  15, 15, 3, 15, 5,
+     15, 15, 15, 15, 3, 15, 5,  5,  5,  8,  5,  10, 5,  10, 8,  13, 15, 12, 3, 3},
+    {15, 8,  8,  3,  15, 15, 3,  8,  15, 15, 15, 15, 15, 15, 15, 8,  15, 8,  15, 3,  15, 8,
+     15, 8,  3,  15, 6,  10, 15, 15, 10, 8,  15, 3,  15, 10, 10, 8,  9,  10, 6,  15, 8,  15,
+     3,  6,  6,  8,  15, 3,  15, 15, 15, 15, 15, 15, 15, 15, 15, 15, 3,  15, 15, 8},
+};
+
+static constexpr u8 BC7_WEIGHTS_2[4]  = {0, 21, 43, 64};
+static constexpr u8 BC7_WEIGHTS_3[8]  = {0, 9, 18, 27, 37, 46, 55, 64};
+static constexpr u8 BC7_WEIGHTS_4[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+static const u8* get_bc7_weights(u32 index_bits)
+{
+    return (index_bits == 2 ? BC7_WEIGHTS_2 : (index_bits == 3 ? BC7_WEIGHTS_3 : BC7_WEIGHTS_4));
+}
+
+// reads bits lowest first across the 128 bit block
+struct BitReader {
+    u64 m_Low;
+    u64 m_High;
+    u32 m_Position = 0;
+
+    explicit BitReader(const u8* block)
+        : m_Low(read_u64(block))
+        , m_High(read_u64(block + 8))
+    {
+    }
+
+    u32 read(u32 count)
+    {
+        if (count == 0) return 0;
+
+        u64 value;
+        if (m_Position >= 64) {
+            value = (m_High >> (m_Position - 64));
+        } else if ((m_Position + count) <= 64) {
+            value = (m_Low >> m_Position);
+        } else {
+            value = ((m_Low >> m_Position) | (m_High << (64 - m_Position)));
+        }
+
+        m_Position += count;
+        return static_cast<u32>(value & ((1ull << count) - 1));
+    }
+};
+
+static u8 bc7_expand(u32 value, u32 bits)
+{
+    value <<= (8 - bits);
+    return static_cast<u8>(value | (value >> bits));
+}
+
+static u8 bc7_interpolate(u32 e0, u32 e1, u32 weight)
+{
+    return static_cast<u8>(((e0 * (64 - weight)) + (e1 * weight) + 32) >> 6);
+}
+
+static void decode_bc7_block(const u8* block, u8* out, u64 stride)
+{
+    BitReader bits(block);
+
+    u32 mode = 0;
+    while (mode < 8 && bits.read(1) == 0) ++mode;
+
+    // reserved mode, decodes to transparent black
+    if (mode == 8) {
+        for (u32 y = 0; y < 4; ++y) {
+            std::memset((out + (y * stride)), 0, 16);
+        }
+
+        return;
+    }
+
+    const auto& info            = BC7_MODES[mode];
+    const u32   partition       = bits.read(info.m_PartitionBits);
+    const u32   rotation        = bits.read(info.m_RotationBits);
+    const u32   index_selection = bits.read(info.m_IndexSelectionBits);
+
+    // [subset * 2 + endpoint][channel]
+    u32 endpoints[6][4] = {};
+    for (u32 c = 0; c < 3; ++c) {
+        for (u32 e = 0; e < (info.m_NumSubsets * 2u); ++e) {
+            endpoints[e][c] = bits.read(info.m_ColorBits);
+        }
+    }
+
+    if (info.m_AlphaBits > 0) {
+        for (u32 e = 0; e < (info.m_NumSubsets * 2u); ++e) {
+            endpoints[e][3] = bits.read(info.m_AlphaBits);
+        }
+    }
+
+    u32 color_bits = info.m_ColorBits;
+    u32 alpha_bits = info.m_AlphaBits;
+    if (info.m_EndpointPBits || info.m_SharedPBits) {
+        // shared p-bits are read once for both endpoints of a subset
+        u32 pbit = 0;
+        for (u32 e = 0; e < (info.m_NumSubsets * 2u); ++e) {
+            if (info.m_EndpointPBits || (e % 2) == 0) pbit = bits.read(1);
+            for (u32 c = 0; c < 4; ++c) {
+                endpoints[e][c] = ((endpoints[e][c] << 1) | pbit);
+            }
+        }
+
+        ++color_bits;
+        if (alpha_bits > 0) ++alpha_bits;
+    }
+
+    for (u32 e = 0; e < (info.m_NumSubsets * 2u); ++e) {
+        for (u32 c = 0; c < 3; ++c) {
+            endpoints[e][c] = bc7_expand(endpoints[e][c], color_bits);
+        }
+
+        endpoints[e][3] = (alpha_bits > 0 ? bc7_expand(endpoints[e][3], alpha_bits) : 255);
+    }
+
+    u8 subsets[16] = {};
+    u8 anchors[3]  = {0, 0, 0};
+    if (info.m_NumSubsets == 2) {
+        for (u32 i = 0; i < 16; ++i) subsets[i] = ((BC7_PARTITIONS_2[partition] >> i) & 1);
+        anchors[1] = BC7_ANCHORS_2[partition];
+    } else if (info.m_NumSubsets == 3) {
+        std::memcpy(subsets, BC7_PARTITIONS_3[partition], sizeof(subsets));
+        anchors[1] = BC7_ANCHORS_3[0][partition];
+        anchors[2] = BC7_ANCHORS_3[1][partition];
+    }
+
+    u8 indices[16];
+    u8 secondary_indices[16] = {};
+    for (u32 i = 0; i < 16; ++i) {
+        const bool is_anchor = (i == anchors[subsets[i]]);
+        indices[i]           = static_cast<u8>(bits.read(info.m_IndexBits - (is_anchor ? 1 : 0)));
+    }
+
+    if (info.m_SecondaryIndexBits > 0) {
+        for (u32 i = 0; i < 16; ++i) {
+            secondary_indices[i] = static_cast<u8>(bits.read(info.m_SecondaryIndexBits - (i == 0 ? 1 : 0)));
+        }
+    }
+
+    // modes 4 and 5 have separate color and alpha indices, index_selection swaps which set is used for color
+    const u8* color_indices = indices;
+    const u8* alpha_indices = indices;
+    u32       color_index_bits = info.m_IndexBits;
+    u32       alpha_index_bits = info.m_IndexBits;
+    if (info.m_SecondaryIndexBits > 0) {
+        alpha_indices    = secondary_indices;
+        alpha_index_bits = info.m_SecondaryIndexBits;
+        if (index_selection) {
+            std::swap(color_indices, alpha_indices);
+            std::swap(color_index_bits, alpha_index_bits);
+        }
+    }
+
+    const u8* color_weights = get_bc7_weights(color_index_bits);
+    const u8* alpha_weights = get_bc7_weights(alpha_index_bits);
+
+    for (u32 i = 0; i < 16; ++i) {
+        const auto* e0 = endpoints[subsets[i] * 2];
+        const auto* e1 = endpoints[(subsets[i] * 2) + 1];
+
+        u8 pixel[4];
+        for (u32 c = 0; c < 3; ++c) {
+            pixel[c] = bc7_interpolate(e0[c], e1[c], color_weights[color_indices[i]]);
+        }
+
+        pixel[3] = bc7_interpolate(e0[3], e1[3], alpha_weights[alpha_indices[i]]);
+
+        if (rotation != 0) std::swap(pixel[3], pixel[rotation - 1]);
+        std::memcpy((out + ((i / 4) * stride) + ((i % 4) * 4)), pixel, 4);
+    }
+}
+
+static void convert_b8g8r8a8_row(const u8* row, u32 count, u8* out)
+{
+    for (u32 i = 0; i < count; ++i) {
+        out[(i * 4) + 0] = row[(i * 4) + 2];
+        out[(i * 4) + 1] = row[(i * 4) + 1];
+        out[(i * 4) + 2] = row[(i * 4) + 0];
+        out[(i * 4) + 3] = row[(i * 4) + 3];
+    }
+}
+
+static void convert_r8_row(const u8* row, u32 count, u8* out)
+{
+    for (u32 i = 0; i < count; ++i) {
+        out[(i * 4) + 0] = row[i];
+        out[(i * 4) + 1] = 0;
+        out[(i * 4) + 2] = 0;
+        out[(i * 4) + 3] = 255;
+    }
+}
+
+// ssse3 decoders. palettes are built in 16 bit lanes and every pixel is a pshufb lookup into the palette.
+
+// expands the 16 2-bit indices of a color block to one byte per pixel
+JCMR_TARGET_SSSE3 static __m128i spread_color_indices(u32 indices)
+{
+    const __m128i mask = _mm_set1_epi8(3);
+    const __m128i v    = _mm_cvtsi32_si128(static_cast<i32>(indices));
+
+    // byte n of t0 is pixel 4n, t1 is 4n+1 and so on
+    const __m128i t0 = _mm_and_si128(v, mask);
+    const __m128i t1 = _mm_and_si128(_mm_srli_epi32(v, 2), mask);
+    const __m128i t2 = _mm_and_si128(_mm_srli_epi32(v, 4), mask);
+    const __m128i t3 = _mm_and_si128(_mm_srli_epi32(v, 6), mask);
+    return _mm_unpacklo_epi16(_mm_unpacklo_epi8(t0, t1), _mm_unpacklo_epi8(t2, t3));
+}
+
+// expands the 16 3-bit indices of an alpha block to one byte per pixel. each 16 bit lane picks up the two bytes its
+// index is in, then the multiply moves the index to the top 3 bits (a per-lane shift, which sse doesn't have).
+JCMR_TARGET_SSSE3 static __m128i spread_alpha_indices(const u8* block)
+{
+    const __m128i v    = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(block));
+    const __m128i lo   = _mm_shuffle_epi8(v, _mm_setr_epi8(2, 3, 2, 3, 2, 3, 3, 4, 3, 4, 3, 4, 4, 5, 4, 5));
+    const __m128i hi   = _mm_shuffle_epi8(v, _mm_setr_epi8(5, 6, 5, 6, 5, 6, 6, 7, 6, 7, 6, 7, 7, -128, 7, -128));
+    const __m128i mult = _mm_setr_epi16(8192, 1024, 128, 4096, 512, 64, 2048, 256);
+    return _mm_packus_epi16(_mm_srli_epi16(_mm_mullo_epi16(lo, mult), 13),
+                            _mm_srli_epi16(_mm_mullo_epi16(hi, mult), 13));
+}
+
+// the 8 palette entries of an alpha block in the low 8 bytes. the divides are multiplies by the rounded up
+// reciprocal, which is exact for every value an 8 bit endpoint pair can make.
+JCMR_TARGET_SSSE3 static __m128i alpha_palette(const u8* block)
+{
+    const u32     a0 = block[0];
+    const u32     a1 = block[1];
+    const __m128i e0 = _mm_set1_epi16(static_cast<i16>(a0));
+    const __m128i e1 = _mm_set1_epi16(static_cast<i16>(a1));
+
+    __m128i palette;
+    if (a0 > a1) {
+        const __m128i sum = _mm_add_epi16(_mm_mullo_epi16(e0, _mm_setr_epi16(7, 0, 6, 5, 4, 3, 2, 1)),
+                                          _mm_mullo_epi16(e1, _mm_setr_epi16(0, 7, 1, 2, 3, 4, 5, 6)));
+        palette             = _mm_mulhi_epu16(sum, _mm_set1_epi16(9363));
+    } else {
+        const __m128i sum = _mm_add_epi16(_mm_mullo_epi16(e0, _mm_setr_epi16(5, 0, 4, 3, 2, 1, 0, 0)),
+                                          _mm_mullo_epi16(e1, _mm_setr_epi16(0, 5, 1, 2, 3, 4, 0, 0)));
+        palette             = _mm_or_si128(_mm_mulhi_epu16(sum, _mm_set1_epi16(13108)),
+                                           _mm_setr_epi16(0, 0, 0, 0, 0, 0, 0, 255));
+    }
+
+    return _mm_packus_epi16(palette, _mm_setzero_si128());
+}
+
+JCMR_TARGET_SSSE3 static __m128i decode_alpha_block_ssse3(const u8* block)
+{
+    return _mm_shuffle_epi8(alpha_palette(block), spread_alpha_indices(block));
+}
+
+// the 4 palette colors of a color block, as rgba8 in each 32 bit lane
+JCMR_TARGET_SSSE3 static __m128i color_palette(const u8* block, bool allow_transparent)
+{
+    const u16 c0 = read_u16(block);
+    const u16 c1 = read_u16(block + 2);
+
+    // e is c0 then c1 in 16 bit lanes. every channel is moved to the top of its lane and the multiply high does the
+    // shift down and the bit replication of expand_565() in one go.
+    const __m128i v        = _mm_setr_epi16(c0, c0, c0, 0, c1, c1, c1, 0);
+    const __m128i mask     = _mm_setr_epi16(-2048, 0x07E0, 0x001F, 0, -2048, 0x07E0, 0x001F, 0);
+    const __m128i to_top   = _mm_setr_epi16(1, 32, 2048, 0, 1, 32, 2048, 0);
+    const __m128i expand   = _mm_setr_epi16(264, 260, 264, 0, 264, 260, 264, 0);
+    const __m128i channels = _mm_mulhi_epu16(_mm_mullo_epi16(_mm_and_si128(v, mask), to_top), expand);
+    const __m128i e        = _mm_or_si128(channels, _mm_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255));
+    const __m128i sum = _mm_add_epi16(e, _mm_shuffle_epi32(e, _MM_SHUFFLE(1, 0, 3, 2)));
+
+    __m128i interpolated;
+    if (c0 > c1 || !allow_transparent) {
+        // (2 * c0 + c1) / 3 and (c0 + 2 * c1) / 3
+        interpolated = _mm_mulhi_epu16(_mm_add_epi16(sum, e), _mm_set1_epi16(21846));
+    } else {
+        // (c0 + c1) / 2 and transparent black
+        interpolated = _mm_move_epi64(_mm_srli_epi16(sum, 1));
+    }
+
+    return _mm_packus_epi16(e, interpolated);
+}
+
+// writes the 4 rows of a color block, alpha (one byte per pixel) replaces the palette alpha when it's given
+JCMR_TARGET_SSSE3 static void write_color_block(__m128i palette, u32 indices, const __m128i* alpha, u8* out,
+                                                u64 stride)
+{
+    // palette byte for every channel of every pixel, index * 4 + channel. the shuffle controls are for the first row,
+    // adding 4 moves them to the next row (the zeroing -128 entries stay negative).
+    const __m128i offsets  = _mm_slli_epi16(spread_color_indices(indices), 2);
+    const __m128i channel  = _mm_setr_epi8(0, 1, 2, 3, 0, 1, 2, 3, 0, 1, 2, 3, 0, 1, 2, 3);
+    const __m128i rgb      = _mm_set1_epi32(0x00FFFFFF);
+    const __m128i next_row = _mm_set1_epi8(4);
+
+    __m128i repeat   = _mm_setr_epi8(0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3);
+    __m128i to_alpha =
+        _mm_setr_epi8(-128, -128, -128, 0, -128, -128, -128, 1, -128, -128, -128, 2, -128, -128, -128, 3);
+
+    for (u32 y = 0; y < 4; ++y) {
+        __m128i row = _mm_shuffle_epi8(palette, _mm_add_epi8(_mm_shuffle_epi8(offsets, repeat), channel));
+        if (alpha) {
+            row = _mm_or_si128(_mm_and_si128(row, rgb), _mm_shuffle_epi8(*alpha, to_alpha));
+        }
+
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + (y * stride)), row);
+
+        repeat   = _mm_add_epi8(repeat, next_row);
+        to_alpha = _mm_add_epi8(to_alpha, next_row);
+    }
+}
+
+JCMR_TARGET_SSSE3 static void decode_bc1_block_ssse3(const u8* block, u8* out, u64 stride)
+{
+    write_color_block(color_palette(block, true), read_u32(block + 4), nullptr, out, stride);
+}
+
+JCMR_TARGET_SSSE3 static void decode_bc2_block_ssse3(const u8* block, u8* out, u64 stride)
+{
+    // 4 bit alpha, n * 17 repeats the nibble into both halves of the byte
+    const __m128i v      = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(block));
+    const __m128i mask   = _mm_set1_epi8(0x0F);
+    const __m128i values = _mm_unpacklo_epi8(_mm_and_si128(v, mask), _mm_and_si128(_mm_srli_epi16(v, 4), mask));
+    const __m128i alpha  = _mm_or_si128(values, _mm_slli_epi16(values, 4));
+
+    write_color_block(color_palette((block + 8), false), read_u32(block + 12), &alpha, out, stride);
+}
+
+JCMR_TARGET_SSSE3 static void decode_bc3_block_ssse3(const u8* block, u8* out, u64 stride)
+{
+    const __m128i alpha = decode_alpha_block_ssse3(block);
+    write_color_block(color_palette((block + 8), false), read_u32(block + 12), &alpha, out, stride);
+}
+
+JCMR_TARGET_SSSE3 static void decode_bc4_block_ssse3(const u8* block, u8* out, u64 stride)
+{
+    const __m128i red      = decode_alpha_block_ssse3(block);
+    const __m128i opaque   = _mm_set1_epi32(static_cast<i32>(0xFF000000));
+    const __m128i next_row = _mm_set1_epi8(4);
+
+    __m128i to_red = _mm_setr_epi8(0, -128, -128, -128, 1, -128, -128, -128, 2, -128, -128, -128, 3, -128, -128, -128);
+    for (u32 y = 0; y < 4; ++y) {
+        const __m128i row = _mm_or_si128(_mm_shuffle_epi8(red, to_red), opaque);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + (y * stride)), row);
+
+        to_red = _mm_add_epi8(to_red, next_row);
+    }
+}
+
+JCMR_TARGET_SSSE3 static void decode_bc5_block_ssse3(const u8* block, u8* out, u64 stride)
+{
+    const __m128i red      = decode_alpha_block_ssse3(block);
+    const __m128i green    = decode_alpha_block_ssse3(block + 8);
+    const __m128i opaque   = _mm_set1_epi32(static_cast<i32>(0xFF000000));
+    const __m128i next_row = _mm_set1_epi8(4);
+
+    __m128i to_red = _mm_setr_epi8(0, -128, -128, -128, 1, -128, -128, -128, 2, -128, -128, -128, 3, -128, -128, -128);
+    __m128i to_green =
+        _mm_setr_epi8(-128, 0, -128, -128, -128, 1, -128, -128, -128, 2, -128, -128, -128, 3, -128, -128);
+    for (u32 y = 0; y < 4; ++y) {
+        const __m128i rg = _mm_or_si128(_mm_shuffle_epi8(red, to_red), _mm_shuffle_epi8(green, to_green));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + (y * stride)), _mm_or_si128(rg, opaque));
+
+        to_red   = _mm_add_epi8(to_red, next_row);
+        to_green = _mm_add_epi8(to_green, next_row);
+    }
+}
+
+JCMR_TARGET_SSSE3 static void convert_b8g8r8a8_row_ssse3(const u8* row, u32 count, u8* out)
+{
+    const __m128i swap = _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15);
+
+    u32 i = 0;
+    for (; (i + 4) <= count; i += 4) {
+        const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row + (i * 4)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + (i * 4)), _mm_shuffle_epi8(pixels, swap));
+    }
+
+    convert_b8g8r8a8_row((row + (i * 4)), (count - i), (out + (i * 4)));
+}
+
+JCMR_TARGET_SSSE3 static void convert_r8_row_ssse3(const u8* row, u32 count, u8* out)
+{
+    const __m128i to_red = _mm_setr_epi8(0, -128, -128, -128, 1, -128, -128, -128, 2, -128, -128, -128, 3, -128, -128,
+                                         -128);
+    const __m128i opaque = _mm_set1_epi32(static_cast<i32>(0xFF000000));
+
+    u32 i = 0;
+    for (; (i + 4) <= count; i += 4) {
+        const __m128i pixels = _mm_cvtsi32_si128(static_cast<i32>(read_u32(row + i)));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + (i * 4)),
+                         _mm_or_si128(_mm_shuffle_epi8(pixels, to_red), opaque));
+    }
+
+    convert_r8_row((row + i), (count - i), (out + (i * 4)));
+}
+
+static const FormatInfo* get_format_info(u32 format)
+{
+    // clang-format off
+    static const FormatInfo s_bc1  = {"BC1",  8,  0, decode_bc1_block, decode_bc1_block_ssse3, nullptr, nullptr};
+    static const FormatInfo s_bc2  = {"BC2",  16, 0, decode_bc2_block, decode_bc2_block_ssse3, nullptr, nullptr};
+    static const FormatInfo s_bc3  = {"BC3",  16, 0, decode_bc3_block, decode_bc3_block_ssse3, nullptr, nullptr};
+    static const FormatInfo s_bc4  = {"BC4",  8,  0, decode_bc4_block, decode_bc4_block_ssse3, nullptr, nullptr};
+    static const FormatInfo s_bc5  = {"BC5",  16, 0, decode_bc5_block, decode_bc5_block_ssse3, nullptr, nullptr};
+    static const FormatInfo s_bc7  = {"BC7",  16, 0, decode_bc7_block, decode_bc7_block,       nullptr, nullptr};
+    static const FormatInfo s_r8   = {"R8",   0,  1, nullptr, nullptr, convert_r8_row, convert_r8_row_ssse3};
+    static const FormatInfo s_bgra = {"B8G8R8A8", 0, 4, nullptr, nullptr, convert_b8g8r8a8_row,
+                                      convert_b8g8r8a8_row_ssse3};
+    // clang-format on
+
+    switch (format) {
+        case FORMAT_BC1_UNORM:
+        case FORMAT_BC1_UNORM_SRGB: return &s_bc1;
+        case FORMAT_BC2_UNORM:
+        case FORMAT_BC2_UNORM_SRGB: return &s_bc2;
+        case FORMAT_BC3_UNORM:
+        case FORMAT_BC3_UNORM_SRGB: return &s_bc3;
+        case FORMAT_BC4_UNORM: return &s_bc4;
+        case FORMAT_BC5_UNORM: return &s_bc5;
+        case FORMAT_BC7_UNORM:
+        case FORMAT_BC7_UNORM_SRGB: return &s_bc7;
+        case FORMAT_B8G8R8A8_UNORM:
+        case FORMAT_B8G8R8A8_UNORM_SRGB: return &s_bgra;
+        case FORMAT_R8_UNORM: return &s_r8;
+    }
+
+    return nullptr;
+}
+
+// decodes block rows [first, last), blocks which hang over the edge of the surface go through a scratch block
+static void decode_block_rows(const FormatInfo& info, DecodeBlock_t decode_block, const u8* data, u32 width, u32 height,
+                              u32 first, u32 last, u8* out_pixels)
+{
+    const u32 blocks_wide = ((width + 3) / 4);
+    const u64 stride      = (width * 4ull);
+
+    for (u32 by = first; by < last; ++by) {
+        const u8* blocks = (data + (static_cast<u64>(by) * blocks_wide * info.m_BlockSize));
+        const u32 y      = (by * 4);
+        const u32 rows   = std::min(4u, (height - y));
+
+        for (u32 bx = 0; bx < blocks_wide; ++bx) {
+            const u32 x    = (bx * 4);
+            u8*       out  = (out_pixels + (y * stride) + (x * 4ull));
+            const u32 cols = std::min(4u, (width - x));
+
+            if (rows == 4 && cols == 4) {
+                decode_block((blocks + (bx * info.m_BlockSize)), out, stride);
+                continue;
+            }
+
+            u8 scratch[64];
+            decode_block((blocks + (bx * info.m_BlockSize)), scratch, 16);
+            for (u32 row = 0; row < rows; ++row) {
+                std::memcpy((out + (row * stride)), (scratch + (row * 16)), (cols * 4));
+            }
+        }
+    }
+}
+
+// the same bands as compressed formats so both are split across the workers the same way
+static void convert_block_rows(const FormatInfo& info, ConvertRow_t convert_row, const u8* data, u32 width,
+                               u32 height, u32 first, u32 last, u8* out_pixels)
+{
+    const u64 pitch = (static_cast<u64>(width) * info.m_PixelSize);
+    const u32 end   = std::min(height, (last * 4));
+
+    for (u32 y = (first * 4); y < end; ++y) {
+        convert_row((data + (y * pitch)), width, (out_pixels + (y * width * 4ull)));
+    }
+}
+
+static bool decode_surface(u32 format, const u8* data, u64 size, u32 width, u32 height, u8* out_pixels, bool simd,
+                           bool threaded)
+{
+    const auto* info = get_format_info(format);
+    if (!info || size < get_surface_size(format, width, height)) {
+        return false;
+    }
+
+    auto decode_rows = [&](u32 first, u32 last) {
+        if (info->m_BlockSize > 0) {
+            decode_block_rows(*info, (simd ? info->m_DecodeBlockSimd : info->m_DecodeBlock), data, width, height, first,
+                              last, out_pixels);
+        } else {
+            convert_block_rows(*info, (simd ? info->m_ConvertRowSimd : info->m_ConvertRow), data, width, height, first,
+                               last, out_pixels);
+        }
+    };
+
+    const u32 block_rows = ((height + 3) / 4);
+    if (!threaded || (static_cast<u64>(width) * height) < MIN_THREADED_SIZE) {
+        decode_rows(0, block_rows);
+        return true;
+    }
+
+    const u32 num_tiles = ((block_rows + TILE_BLOCK_ROWS - 1) / TILE_BLOCK_ROWS);
+    jobs::parallel_for(num_tiles, [&](u32 index, u32) {
+        const u32 first = (index * TILE_BLOCK_ROWS);
+        decode_rows(first, std::min(block_rows, (first + TILE_BLOCK_ROWS)));
+    });
+
+    return true;
+}
+
+bool is_supported(u32 format)
+{
+    return (get_format_info(format) != nullptr);
+}
+
+const char* get_format_name(u32 format)
+{
+    const auto* info = get_format_info(format);
+    return (info ? info->m_Name : "unknown");
+}
+
+u64 get_surface_size(u32 format, u32 width, u32 height)
+{
+    const auto* info = get_format_info(format);
+    if (!info) return 0;
+
+    if (info->m_BlockSize > 0) {
+        return (static_cast<u64>((width + 3) / 4) * ((height + 3) / 4) * info->m_BlockSize);
+    }
+
+    return (static_cast<u64>(width) * height * info->m_PixelSize);
+}
+
+bool decode(u32 format, const u8* data, u64 size, u32 width, u32 height, u8* out_pixels)
+{
+    return decode_surface(format, data, size, width, height, out_pixels, has_ssse3(), true);
+}
+
+bool decode_reference(u32 format, const u8* data, u64 size, u32 width, u32 height, u8* out_pixels)
+{
+    return decode_surface(format, data, size, width, height, out_pixels, false, false);
+}
+
+static bool detect_ssse3()
+{
+#ifdef _MSC_VER
+    i32 info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 9));
+#else
+    return __builtin_cpu_supports("ssse3");
+#endif
+}
+
+bool has_ssse3()
+{
+    static const bool supported = detect_ssse3();
+    return supported;
+}
+
+const char* get_implementation_name()
+{
+    return (has_ssse3() ? "ssse3" : "scalar");
+}
+} // namespace jcmr::texture_decoder
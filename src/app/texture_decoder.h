@@ -0,0 +1,46 @@
+#ifndef JCMR_APP_TEXTURE_DECODER_H_HEADER_GUARD
+#define JCMR_APP_TEXTURE_DECODER_H_HEADER_GUARD
+
+#include "platform.h"
+
+// decodes texture surfaces to rgba8 on the cpu, for exporting and previewing textures without a d3d device. 4x4
+// blocks are decoded with ssse3 when the cpu supports it (bc7 blocks are always scalar, every block can pick a
+// different mode and partition) and large surfaces are split into bands of block rows across the job workers.
+// missing channels follow d3d, r8 and bc4 decode to (r, 0, 0, 255) and bc5 to (r, g, 0, 255).
+namespace jcmr::texture_decoder
+{
+// dxgi format values, this doesn't include the d3d headers so the command line tools can use it
+enum EFormat : u32 {
+    FORMAT_R8_UNORM            = 61,
+    FORMAT_BC1_UNORM           = 71,
+    FORMAT_BC1_UNORM_SRGB      = 72,
+    FORMAT_BC2_UNORM           = 74,
+    FORMAT_BC2_UNORM_SRGB      = 75,
+    FORMAT_BC3_UNORM           = 77,
+    FORMAT_BC3_UNORM_SRGB      = 78,
+    FORMAT_BC4_UNORM           = 80,
+    FORMAT_BC5_UNORM           = 83,
+    FORMAT_B8G8R8A8_UNORM      = 87,
+    FORMAT_B8G8R8A8_UNORM_SRGB = 91,
+    FORMAT_BC7_UNORM           = 98,
+    FORMAT_BC7_UNORM_SRGB      = 99,
+};
+
+bool        is_supported(u32 format);
+const char* get_format_name(u32 format);
+
+// size of a single width x height surface, 0 if the format isn't supported
+u64 get_surface_size(u32 format, u32 width, u32 height);
+
+// out_pixels must have room for width * height * 4 bytes. returns false if the format isn't supported or size is
+// smaller than get_surface_size().
+bool decode(u32 format, const u8* data, u64 size, u32 width, u32 height, u8* out_pixels);
+
+// single threaded and scalar, decode() must match it exactly
+bool decode_reference(u32 format, const u8* data, u64 size, u32 width, u32 height, u8* out_pixels);
+
+bool        has_ssse3();
+const char* get_implementation_name();
+} // namespace jcmr::texture_decoder
+
+#endif // JCMR_APP_TEXTURE_DECODER_H_HEADER_GUARD
@@ -0,0 +1,949 @@
+#include "pch.h"
+
+#include "texture_encoder.h"
+
+#include "app/jobs.h"
+#include "app/texture_decoder.h"
+
+#include <cmath>
+#include <cstring>
+#include <emmintrin.h>
+#include <limits>
+
+namespace jcmr::texture_encoder
+{
+static constexpr u32 TILE_ROWS         = 16;          // mip rows or block rows per job
+static constexpr u64 MIN_THREADED_SIZE = (256 * 256); // smaller surfaces aren't worth splitting
+
+// pixels is a 4x4 block of rgba8, out is the compressed block
+using EncodeBlock_t = void (*)(const u8* pixels, EQuality quality, u8* out);
+
+template <typename T> static T clamp(T value, T min, T max)
+{
+    return std::min(std::max(value, min), max);
+}
+
+// runs callback(first, last) over bands of TILE_ROWS rows, across the job workers when the surface is big enough
+template <typename Callback> static void for_each_band(u32 rows, u64 num_pixels, Callback&& callback)
+{
+    if (num_pixels < MIN_THREADED_SIZE) {
+        callback(0u, rows);
+        return;
+    }
+
+    const u32 num_bands = ((rows + TILE_ROWS - 1) / TILE_ROWS);
+    jobs::parallel_for(num_bands, [&](u32 index, u32) {
+        const u32 first = (index * TILE_ROWS);
+        callback(first, std::min(rows, (first + TILE_ROWS)));
+    });
+}
+
+// mips
+
+static __m128 load_pixel(const u8* pixel)
+{
+    u32 value;
+    std::memcpy(&value, pixel, sizeof(value));
+
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i v    = _mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<i32>(value)), zero);
+    return _mm_cvtepi32_ps(_mm_unpacklo_epi16(v, zero));
+}
+
+static void store_pixel(__m128 value, u8* pixel)
+{
+    // packs and packus clamp to [0, 255]
+    const __m128i v     = _mm_cvtps_epi32(value);
+    const __m128i bytes = _mm_packus_epi16(_mm_packs_epi32(v, v), _mm_setzero_si128());
+    const u32     rgba  = static_cast<u32>(_mm_cvtsi128_si32(bytes));
+    std::memcpy(pixel, &rgba, sizeof(rgba));
+}
+
+static void box_filter_rows(const Surface& source, Surface* dest, u32 first, u32 last)
+{
+    const u32     width = source.m_Width;
+    const __m128i zero  = _mm_setzero_si128();
+    const __m128i round = _mm_set1_epi16(2);
+
+    for (u32 y = first; y < last; ++y) {
+        const u8* row0 = &source.m_Pixels[static_cast<u64>(std::min((y * 2), (source.m_Height - 1))) * width * 4];
+        const u8* row1 = &source.m_Pixels[static_cast<u64>(std::min((y * 2) + 1, (source.m_Height - 1))) * width * 4];
+        u8*       out  = &dest->m_Pixels[static_cast<u64>(y) * dest->m_Width * 4];
+
+        // 4 pixels from 8 pixels of both rows, sums of 4 bytes fit in 16 bit lanes
+        u32 x = 0;
+        for (; ((x + 4) * 2) <= width; x += 4) {
+            __m128i sums[2];
+            for (u32 i = 0; i < 2; ++i) {
+                const __m128i a  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + ((x * 2) + (i * 4)) * 4));
+                const __m128i b  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + ((x * 2) + (i * 4)) * 4));
+                const __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+                const __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+
+                // (pixel 0 + pixel 1), (pixel 2 + pixel 3)
+                sums[i] = _mm_add_epi16(_mm_unpacklo_epi64(lo, hi), _mm_unpackhi_epi64(lo, hi));
+            }
+
+            const __m128i result = _mm_packus_epi16(_mm_srli_epi16(_mm_add_epi16(sums[0], round), 2),
+                                                    _mm_srli_epi16(_mm_add_epi16(sums[1], round), 2));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + (x * 4)), result);
+        }
+
+        // the last pixels, and odd widths where the last column is repeated
+        for (; x < dest->m_Width; ++x) {
+            const u32 x0 = std::min((x * 2), (width - 1)) * 4;
+            const u32 x1 = std::min((x * 2) + 1, (width - 1)) * 4;
+            for (u32 c = 0; c < 4; ++c) {
+                out[(x * 4) + c] = static_cast<u8>((row0[x0 + c] + row0[x1 + c] + row1[x0 + c] + row1[x1 + c] + 2) / 4);
+            }
+        }
+    }
+}
+
+static constexpr u32 KAISER_TAPS = 8;
+
+static f64 bessel_i0(f64 x)
+{
+    f64 sum  = 1.0;
+    f64 term = 1.0;
+    for (u32 k = 1; k < 32; ++k) {
+        term *= ((x / (2.0 * k)) * (x / (2.0 * k)));
+        sum += term;
+    }
+
+    return sum;
+}
+
+// sinc windowed by a kaiser window (alpha 4) 2 destination pixels wide on each side. tap t reads source pixel
+// (2x + t - 3), which is (|t - 3.5| / 2) destination pixels away from the center of pixel x.
+static const std::array<f32, KAISER_TAPS>& get_kaiser_weights()
+{
+    static const auto weights = [] {
+        static constexpr f64 PI     = 3.14159265358979323846;
+        static constexpr f64 ALPHA  = 4.0;
+        static constexpr f64 RADIUS = 2.0;
+
+        std::array<f64, KAISER_TAPS> values{};
+        f64                          total = 0.0;
+        for (u32 t = 0; t < KAISER_TAPS; ++t) {
+            const f64 distance = (std::abs(t - 3.5) / 2.0);
+            const f64 sinc     = (std::sin(PI * distance) / (PI * distance));
+            const f64 ratio    = (distance / RADIUS);
+            values[t]          = (sinc * bessel_i0(ALPHA * std::sqrt(1.0 - (ratio * ratio))) / bessel_i0(ALPHA));
+            total += values[t];
+        }
+
+        std::array<f32, KAISER_TAPS> result{};
+        for (u32 t = 0; t < KAISER_TAPS; ++t) result[t] = static_cast<f32>(values[t] / total);
+        return result;
+    }();
+
+    return weights;
+}
+
+// separable, the horizontal pass is kept for the source rows the band needs and the vertical pass reads it
+static void kaiser_filter_rows(const Surface& source, Surface* dest, u32 first, u32 last)
+{
+    const auto& weights    = get_kaiser_weights();
+    const i32   src_width  = static_cast<i32>(source.m_Width);
+    const i32   src_height = static_cast<i32>(source.m_Height);
+    const u32   dst_width  = dest->m_Width;
+
+    const i32 row_begin = std::max(0, (static_cast<i32>(first) * 2) - 3);
+    const i32 row_end   = std::min((src_height - 1), (static_cast<i32>(last - 1) * 2) + 4);
+
+    std::vector<f32> horizontal(static_cast<u64>(row_end - row_begin + 1) * dst_width * 4);
+    for (i32 row = row_begin; row <= row_end; ++row) {
+        const u8* src = &source.m_Pixels[static_cast<u64>(row) * src_width * 4];
+        f32*      out = &horizontal[static_cast<u64>(row - row_begin) * dst_width * 4];
+
+        for (u32 x = 0; x < dst_width; ++x) {
+            __m128 sum = _mm_setzero_ps();
+            for (u32 t = 0; t < KAISER_TAPS; ++t) {
+                const i32 sx = clamp((static_cast<i32>(x * 2) + static_cast<i32>(t) - 3), 0, (src_width - 1));
+                sum          = _mm_add_ps(sum, _mm_mul_ps(load_pixel(src + (sx * 4)), _mm_set1_ps(weights[t])));
+            }
+
+            _mm_storeu_ps((out + (x * 4)), sum);
+        }
+    }
+
+    for (u32 y = first; y < last; ++y) {
+        u8* out = &dest->m_Pixels[static_cast<u64>(y) * dst_width * 4];
+
+        const f32* rows[KAISER_TAPS];
+        for (u32 t = 0; t < KAISER_TAPS; ++t) {
+            const i32 sy = clamp((static_cast<i32>(y * 2) + static_cast<i32>(t) - 3), 0, (src_height - 1));
+            rows[t]      = &horizontal[static_cast<u64>(sy - row_begin) * dst_width * 4];
+        }
+
+        for (u32 x = 0; x < dst_width; ++x) {
+            __m128 sum = _mm_setzero_ps();
+            for (u32 t = 0; t < KAISER_TAPS; ++t) {
+                sum = _mm_add_ps(sum, _mm_mul_ps(_mm_loadu_ps(rows[t] + (x * 4)), _mm_set1_ps(weights[t])));
+            }
+
+            store_pixel(sum, (out + (x * 4)));
+        }
+    }
+}
+
+u32 get_num_mips(u32 width, u32 height)
+{
+    u32 count = 1;
+    while (width > 1 || height > 1) {
+        width  = std::max(1u, (width / 2));
+        height = std::max(1u, (height / 2));
+        ++count;
+    }
+
+    return count;
+}
+
+void generate_mips(const u8* pixels, u32 width, u32 height, EMipFilter filter, u32 num_mips,
+                   std::vector<Surface>* out_mips)
+{
+    const u32 max_mips = get_num_mips(width, height);
+    const u32 count    = (num_mips == 0 ? max_mips : std::min(num_mips, max_mips));
+
+    out_mips->clear();
+    out_mips->resize(count);
+
+    auto& top    = (*out_mips)[0];
+    top.m_Width  = width;
+    top.m_Height = height;
+    top.m_Pixels.assign(pixels, (pixels + (static_cast<u64>(width) * height * 4)));
+
+    for (u32 level = 1; level < count; ++level) {
+        const auto& source = (*out_mips)[level - 1];
+        auto&       dest   = (*out_mips)[level];
+
+        dest.m_Width  = std::max(1u, (source.m_Width / 2));
+        dest.m_Height = std::max(1u, (source.m_Height / 2));
+        dest.m_Pixels.resize(static_cast<u64>(dest.m_Width) * dest.m_Height * 4);
+
+        for_each_band(dest.m_Height, (static_cast<u64>(source.m_Width) * source.m_Height), [&](u32 first, u32 last) {
+            if (filter == E_MIP_FILTER_KAISER) {
+                kaiser_filter_rows(source, &dest, first, last);
+            } else {
+                box_filter_rows(source, &dest, first, last);
+            }
+        });
+    }
+}
+
+// endpoint search, shared by the color and bc7 encoders. points are 0-255 floats.
+
+// two endpoints which span the points, out_e0 is the "high" end
+static void find_endpoints(const f32 (*points)[4], u32 count, u32 channels, EQuality quality, f32* out_e0, f32* out_e1)
+{
+    f32 min[4] = {255, 255, 255, 255};
+    f32 max[4] = {0, 0, 0, 0};
+    f32 mean[4] = {};
+    for (u32 i = 0; i < count; ++i) {
+        for (u32 c = 0; c < channels; ++c) {
+            min[c] = std::min(min[c], points[i][c]);
+            max[c] = std::max(max[c], points[i][c]);
+            mean[c] += points[i][c];
+        }
+    }
+
+    for (u32 c = 0; c < channels; ++c) mean[c] /= count;
+
+    f32 covariance[4][4] = {};
+    for (u32 i = 0; i < count; ++i) {
+        for (u32 a = 0; a < channels; ++a) {
+            for (u32 b = a; b < channels; ++b) {
+                covariance[a][b] += ((points[i][a] - mean[a]) * (points[i][b] - mean[b]));
+            }
+        }
+    }
+
+    for (u32 a = 0; a < channels; ++a) {
+        for (u32 b = 0; b < a; ++b) covariance[a][b] = covariance[b][a];
+    }
+
+    // the bounding box diagonal, flipped on the channels which go down as the widest channel goes up
+    u32 major = 0;
+    for (u32 c = 1; c < channels; ++c) {
+        if ((max[c] - min[c]) > (max[major] - min[major])) major = c;
+    }
+
+    f32 axis[4] = {};
+    for (u32 c = 0; c < channels; ++c) {
+        const bool flip = (covariance[major][c] < 0.0f);
+        out_e0[c]       = (flip ? min[c] : max[c]);
+        out_e1[c]       = (flip ? max[c] : min[c]);
+        axis[c]         = (out_e0[c] - out_e1[c]);
+    }
+
+    if (quality == E_QUALITY_FAST) {
+        return;
+    }
+
+    // power iteration for the principal axis, starting from the diagonal
+    const u32 iterations = (quality == E_QUALITY_HIGH ? 8 : 4);
+    for (u32 i = 0; i < iterations; ++i) {
+        f32 next[4] = {};
+        for (u32 a = 0; a < channels; ++a) {
+            for (u32 b = 0; b < channels; ++b) next[a] += (covariance[a][b] * axis[b]);
+        }
+
+        f32 length = 0.0f;
+        for (u32 c = 0; c < channels; ++c) length += (next[c] * next[c]);
+        if (length < 1e-6f) return; // flat block, the diagonal is as good as anything
+
+        length = (1.0f / std::sqrt(length));
+        for (u32 c = 0; c < channels; ++c) axis[c] = (next[c] * length);
+    }
+
+    f32 t_min = std::numeric_limits<f32>::max();
+    f32 t_max = std::numeric_limits<f32>::lowest();
+    for (u32 i = 0; i < count; ++i) {
+        f32 t = 0.0f;
+        for (u32 c = 0; c < channels; ++c) t += ((points[i][c] - mean[c]) * axis[c]);
+        t_min = std::min(t_min, t);
+        t_max = std::max(t_max, t);
+    }
+
+    for (u32 c = 0; c < channels; ++c) {
+        out_e0[c] = clamp((mean[c] + (axis[c] * t_max)), 0.0f, 255.0f);
+        out_e1[c] = clamp((mean[c] + (axis[c] * t_min)), 0.0f, 255.0f);
+    }
+}
+
+// least squares fit of the endpoints to the points, weights are how far each point is towards e1 (0 to 1)
+static bool refine_endpoints(const f32 (*points)[4], const f32* weights, u32 count, u32 channels, f32* out_e0,
+                             f32* out_e1)
+{
+    f32 aa = 0.0f, ab = 0.0f, bb = 0.0f;
+    f32 ax[4] = {}, bx[4] = {};
+    for (u32 i = 0; i < count; ++i) {
+        const f32 b = weights[i];
+        const f32 a = (1.0f - b);
+        aa += (a * a);
+        ab += (a * b);
+        bb += (b * b);
+        for (u32 c = 0; c < channels; ++c) {
+            ax[c] += (a * points[i][c]);
+            bx[c] += (b * points[i][c]);
+        }
+    }
+
+    const f32 determinant = ((aa * bb) - (ab * ab));
+    if (std::abs(determinant) < 1e-6f) return false;
+
+    for (u32 c = 0; c < channels; ++c) {
+        out_e0[c] = clamp((((ax[c] * bb) - (bx[c] * ab)) / determinant), 0.0f, 255.0f);
+        out_e1[c] = clamp((((bx[c] * aa) - (ax[c] * ab)) / determinant), 0.0f, 255.0f);
+    }
+
+    return true;
+}
+
+// bc1 color
+
+static void expand_565(u16 color, i32* out)
+{
+    const i32 r = ((color >> 11) & 0x1F);
+    const i32 g = ((color >> 5) & 0x3F);
+    const i32 b = (color & 0x1F);
+    out[0]      = ((r << 3) | (r >> 2));
+    out[1]      = ((g << 2) | (g >> 4));
+    out[2]      = ((b << 3) | (b >> 2));
+}
+
+static u16 quantize_565(const f32* color)
+{
+    const i32 r = clamp(static_cast<i32>((color[0] * (31.0f / 255.0f)) + 0.5f), 0, 31);
+    const i32 g = clamp(static_cast<i32>((color[1] * (63.0f / 255.0f)) + 0.5f), 0, 63);
+    const i32 b = clamp(static_cast<i32>((color[2] * (31.0f / 255.0f)) + 0.5f), 0, 31);
+    return static_cast<u16>((r << 11) | (g << 5) | b);
+}
+
+struct ColorBlock {
+    u16 m_Color0  = 0;
+    u16 m_Color1  = 0;
+    u32 m_Indices = 0;
+    u32 m_Error   = std::numeric_limits<u32>::max();
+};
+
+// the palette the decoder builds, so the error is exactly what will be seen
+static ColorBlock evaluate_color_block(const u8* pixels, const bool* transparent, u16 c0, u16 c1, bool three_color,
+                                       bool allow_transparent, u8* out_indices)
+{
+    // four colors need c0 > c1, three colors and transparent black need c0 <= c1
+    if (three_color ? (c0 > c1) : (c0 < c1)) std::swap(c0, c1);
+
+    const bool four_color = (c0 > c1 || !allow_transparent);
+
+    i32 palette[4][3];
+    expand_565(c0, palette[0]);
+    expand_565(c1, palette[1]);
+    for (u32 c = 0; c < 3; ++c) {
+        const i32 e0 = palette[0][c];
+        const i32 e1 = palette[1][c];
+        palette[2][c] = (four_color ? (((2 * e0) + e1) / 3) : ((e0 + e1) / 2));
+        palette[3][c] = (four_color ? ((e0 + (2 * e1)) / 3) : 0);
+    }
+
+    ColorBlock block;
+    block.m_Color0 = c0;
+    block.m_Color1 = c1;
+    block.m_Error  = 0;
+
+    const u32 num_colors = (four_color ? 4 : 3);
+    for (u32 i = 0; i < 16; ++i) {
+        u32 best_index = 3;
+        u32 best_error = 0;
+        if (!transparent[i]) {
+            best_error = std::numeric_limits<u32>::max();
+            for (u32 p = 0; p < num_colors; ++p) {
+                const i32 dr    = (pixels[(i * 4) + 0] - palette[p][0]);
+                const i32 dg    = (pixels[(i * 4) + 1] - palette[p][1]);
+                const i32 db    = (pixels[(i * 4) + 2] - palette[p][2]);
+                const u32 error = static_cast<u32>((dr * dr) + (dg * dg) + (db * db));
+                if (error < best_error) {
+                    best_error = error;
+                    best_index = p;
+                }
+            }
+        }
+
+        out_indices[i] = static_cast<u8>(best_index);
+        block.m_Error += best_error;
+        block.m_Indices |= (best_index << (i * 2));
+    }
+
+    return block;
+}
+
+// bc2 and bc3 color blocks are always decoded with four colors, only bc1 has transparent pixels
+static void encode_color_block(const u8* pixels, EQuality quality, bool allow_transparent, u8* out)
+{
+    bool transparent[16];
+    f32  points[16][4];
+    u32  count = 0;
+    for (u32 i = 0; i < 16; ++i) {
+        transparent[i] = (allow_transparent && pixels[(i * 4) + 3] < 128);
+        if (transparent[i]) continue;
+
+        for (u32 c = 0; c < 3; ++c) points[count][c] = pixels[(i * 4) + c];
+        ++count;
+    }
+
+    const auto write = [out](const ColorBlock& block) {
+        std::memcpy(out, &block.m_Color0, 2);
+        std::memcpy((out + 2), &block.m_Color1, 2);
+        std::memcpy((out + 4), &block.m_Indices, 4);
+    };
+
+    if (count == 0) {
+        ColorBlock block;
+        block.m_Indices = 0xFFFFFFFF;
+        write(block);
+        return;
+    }
+
+    const bool three_color = (count < 16);
+
+    f32 e0[4], e1[4];
+    find_endpoints(points, count, 3, quality, e0, e1);
+
+    // inset the endpoints a little, the extremes are usually outliers
+    for (u32 c = 0; c < 3; ++c) {
+        const f32 inset = ((e0[c] - e1[c]) / 16.0f);
+        e0[c] -= inset;
+        e1[c] += inset;
+    }
+
+    ColorBlock best;
+    const u32  passes = (quality == E_QUALITY_HIGH ? 3 : 1);
+    for (u32 pass = 0; pass < passes; ++pass) {
+        u8   indices[16];
+        auto block = evaluate_color_block(pixels, transparent, quantize_565(e0), quantize_565(e1), three_color,
+                                          allow_transparent, indices);
+        if (block.m_Error < best.m_Error) best = block;
+        if (best.m_Error == 0 || (pass + 1) == passes) break;
+
+        // how far each opaque pixel is towards color 1
+        const bool four_color  = (block.m_Color0 > block.m_Color1 || !allow_transparent);
+        const f32  weights4[4] = {0.0f, 1.0f, (1.0f / 3.0f), (2.0f / 3.0f)};
+        const f32  weights3[4] = {0.0f, 1.0f, 0.5f, 0.0f};
+
+        f32 weights[16];
+        u32 n = 0;
+        for (u32 i = 0; i < 16; ++i) {
+            if (!transparent[i]) weights[n++] = (four_color ? weights4 : weights3)[indices[i]];
+        }
+
+        // the refined endpoints follow the order of the block, which may have been swapped
+        if (!refine_endpoints(points, weights, count, 3, e0, e1)) break;
+    }
+
+    write(best);
+}
+
+// bc3 alpha, bc4 and bc5 channels
+
+static void alpha_palette(u32 a0, u32 a1, u8* palette)
+{
+    palette[0] = static_cast<u8>(a0);
+    palette[1] = static_cast<u8>(a1);
+    if (a0 > a1) {
+        for (u32 i = 1; i < 7; ++i) palette[i + 1] = static_cast<u8>((((7 - i) * a0) + (i * a1)) / 7);
+    } else {
+        for (u32 i = 1; i < 5; ++i) palette[i + 1] = static_cast<u8>((((5 - i) * a0) + (i * a1)) / 5);
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+}
+
+static u32 evaluate_alpha_block(const u8* values, u32 a0, u32 a1, u64* out_indices)
+{
+    u8 palette[8];
+    alpha_palette(a0, a1, palette);
+
+    u32 total = 0;
+    u64 bits  = 0;
+    for (u32 i = 0; i < 16; ++i) {
+        u32 best_index = 0;
+        u32 best_error = std::numeric_limits<u32>::max();
+        for (u32 p = 0; p < 8; ++p) {
+            const i32 difference = (values[i] - palette[p]);
+            const u32 error      = static_cast<u32>(difference * difference);
+            if (error < best_error) {
+                best_error = error;
+                best_index = p;
+            }
+        }
+
+        total += best_error;
+        bits |= (static_cast<u64>(best_index) << (i * 3));
+    }
+
+    *out_indices = bits;
+    return total;
+}
+
+static void encode_alpha_block(const u8* values, EQuality quality, u8* out)
+{
+    u32 min = 255, max = 0;
+    u32 inner_min = 255, inner_max = 0; // ignoring 0 and 255, which the six value palette has for free
+    for (u32 i = 0; i < 16; ++i) {
+        min = std::min<u32>(min, values[i]);
+        max = std::max<u32>(max, values[i]);
+        if (values[i] != 0 && values[i] != 255) {
+            inner_min = std::min<u32>(inner_min, values[i]);
+            inner_max = std::max<u32>(inner_max, values[i]);
+        }
+    }
+
+    u32 best_a0 = max, best_a1 = min;
+    u64 best_indices = 0;
+    u32 best_error   = evaluate_alpha_block(values, max, min, &best_indices);
+
+    const auto attempt = [&](u32 a0, u32 a1) {
+        u64       indices;
+        const u32 error = evaluate_alpha_block(values, a0, a1, &indices);
+        if (error < best_error) {
+            best_a0      = a0;
+            best_a1      = a1;
+            best_indices = indices;
+            best_error   = error;
+        }
+    };
+
+    if (best_error > 0 && quality != E_QUALITY_FAST) {
+        // six values (a0 <= a1) with 0 and 255
+        if (inner_min <= inner_max) attempt(inner_min, inner_max);
+
+        // pull the eight value endpoints in a little
+        if (quality == E_QUALITY_HIGH) {
+            for (u32 d0 = 0; d0 <= 2; ++d0) {
+                for (u32 d1 = 0; d1 <= 2; ++d1) {
+                    if ((d0 || d1) && (max - d0) > (min + d1)) attempt((max - d0), (min + d1));
+                }
+            }
+        }
+    }
+
+    out[0] = static_cast<u8>(best_a0);
+    out[1] = static_cast<u8>(best_a1);
+    for (u32 i = 0; i < 6; ++i) out[i + 2] = static_cast<u8>(best_indices >> (i * 8));
+}
+
+// bc7 (mode 6)
+
+static constexpr u8 BC7_WEIGHTS_4[16] = {0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64};
+
+// writes bits lowest first across the 128 bit block
+struct BitWriter {
+    u64 m_Low      = 0;
+    u64 m_High     = 0;
+    u32 m_Position = 0;
+
+    void write(u32 value, u32 count)
+    {
+        for (u32 i = 0; i < count; ++i, ++m_Position) {
+            const u64 bit = ((value >> i) & 1);
+            if (m_Position < 64) {
+                m_Low |= (bit << m_Position);
+            } else {
+                m_High |= (bit << (m_Position - 64));
+            }
+        }
+    }
+};
+
+struct Bc7Block {
+    u8  m_Endpoints[2][4]; // 7 bit
+    u8  m_PBits[2];
+    u8  m_Indices[16];
+    u32 m_Error = std::numeric_limits<u32>::max();
+};
+
+static void bc7_quantize(const f32* endpoint, u32 pbit, u8* out)
+{
+    for (u32 c = 0; c < 4; ++c) {
+        out[c] = static_cast<u8>(clamp(static_cast<i32>(std::lround((endpoint[c] - pbit) / 2.0f)), 0, 127));
+    }
+}
+
+static u32 bc7_quantize_error(const f32* endpoint, u32 pbit)
+{
+    u8 quantized[4];
+    bc7_quantize(endpoint, pbit, quantized);
+
+    f32 error = 0.0f;
+    for (u32 c = 0; c < 4; ++c) error += std::abs(endpoint[c] - ((quantized[c] << 1) | pbit));
+    return static_cast<u32>(error * 256.0f);
+}
+
+static Bc7Block evaluate_bc7_block(const u8* pixels, const f32* e0, const f32* e1, u32 p0, u32 p1, EQuality quality)
+{
+    Bc7Block block;
+    block.m_PBits[0] = static_cast<u8>(p0);
+    block.m_PBits[1] = static_cast<u8>(p1);
+    bc7_quantize(e0, p0, block.m_Endpoints[0]);
+    bc7_quantize(e1, p1, block.m_Endpoints[1]);
+
+    // 8 bit endpoints with the p-bit as the lowest bit, which the decoder doesn't expand any further
+    i32 v0[4], v1[4];
+    for (u32 c = 0; c < 4; ++c) {
+        v0[c] = ((block.m_Endpoints[0][c] << 1) | p0);
+        v1[c] = ((block.m_Endpoints[1][c] << 1) | p1);
+    }
+
+    i32 palette[16][4];
+    for (u32 i = 0; i < 16; ++i) {
+        for (u32 c = 0; c < 4; ++c) {
+            palette[i][c] = (((v0[c] * (64 - BC7_WEIGHTS_4[i])) + (v1[c] * BC7_WEIGHTS_4[i]) + 32) >> 6);
+        }
+    }
+
+    i32 axis[4];
+    i32 length = 0;
+    for (u32 c = 0; c < 4; ++c) {
+        axis[c] = (v1[c] - v0[c]);
+        length += (axis[c] * axis[c]);
+    }
+
+    block.m_Error = 0;
+    for (u32 i = 0; i < 16; ++i) {
+        const u8* pixel = (pixels + (i * 4));
+
+        u32 best_index = 0;
+        u32 best_error = std::numeric_limits<u32>::max();
+        if (quality == E_QUALITY_FAST && length > 0) {
+            // nearest step along the line between the endpoints
+            i32 dot = 0;
+            for (u32 c = 0; c < 4; ++c) dot += ((pixel[c] - v0[c]) * axis[c]);
+            best_index = static_cast<u32>(clamp(((dot * 15) + (length / 2)) / length, 0, 15));
+            best_error = 0;
+            for (u32 c = 0; c < 4; ++c) {
+                const i32 d = (pixel[c] - palette[best_index][c]);
+                best_error += static_cast<u32>(d * d);
+            }
+        } else {
+            for (u32 p = 0; p < 16; ++p) {
+                u32 error = 0;
+                for (u32 c = 0; c < 4; ++c) {
+                    const i32 d = (pixel[c] - palette[p][c]);
+                    error += static_cast<u32>(d * d);
+                }
+
+                if (error < best_error) {
+                    best_error = error;
+                    best_index = p;
+                }
+            }
+        }
+
+        block.m_Indices[i] = static_cast<u8>(best_index);
+        block.m_Error += best_error;
+    }
+
+    return block;
+}
+
+static void encode_bc7_block(const u8* pixels, EQuality quality, u8* out)
+{
+    f32 points[16][4];
+    for (u32 i = 0; i < 16; ++i) {
+        for (u32 c = 0; c < 4; ++c) points[i][c] = pixels[(i * 4) + c];
+    }
+
+    f32 e0[4], e1[4];
+    find_endpoints(points, 16, 4, quality, e0, e1);
+
+    const auto pick_pbit = [](const f32* endpoint) {
+        return (bc7_quantize_error(endpoint, 1) < bc7_quantize_error(endpoint, 0) ? 1u : 0u);
+    };
+
+    Bc7Block  best;
+    const u32 passes = (quality == E_QUALITY_HIGH ? 3 : 1);
+    for (u32 pass = 0; pass < passes; ++pass) {
+        if (quality == E_QUALITY_HIGH) {
+            for (u32 p = 0; p < 4; ++p) {
+                auto block = evaluate_bc7_block(pixels, e0, e1, (p & 1), (p >> 1), quality);
+                if (block.m_Error < best.m_Error) best = block;
+            }
+        } else {
+            auto block = evaluate_bc7_block(pixels, e0, e1, pick_pbit(e0), pick_pbit(e1), quality);
+            if (block.m_Error < best.m_Error) best = block;
+        }
+
+        if (best.m_Error == 0 || (pass + 1) == passes) break;
+
+        f32 weights[16];
+        for (u32 i = 0; i < 16; ++i) weights[i] = (BC7_WEIGHTS_4[best.m_Indices[i]] / 64.0f);
+        if (!refine_endpoints(points, weights, 16, 4, e0, e1)) break;
+    }
+
+    // the top index bit of pixel 0 isn't stored, so it has to be in the first half. flipping the endpoints and the
+    // indices gives the same colors as the weights are symmetric.
+    if (best.m_Indices[0] & 8) {
+        std::swap(best.m_Endpoints[0], best.m_Endpoints[1]);
+        std::swap(best.m_PBits[0], best.m_PBits[1]);
+        for (auto& index : best.m_Indices) index = static_cast<u8>(15 - index);
+    }
+
+    BitWriter bits;
+    bits.write((1 << 6), 7);
+    for (u32 c = 0; c < 4; ++c) {
+        bits.write(best.m_Endpoints[0][c], 7);
+        bits.write(best.m_Endpoints[1][c], 7);
+    }
+
+    bits.write(best.m_PBits[0], 1);
+    bits.write(best.m_PBits[1], 1);
+    for (u32 i = 0; i < 16; ++i) bits.write(best.m_Indices[i], (i == 0 ? 3 : 4));
+
+    std::memcpy(out, &bits.m_Low, 8);
+    std::memcpy((out + 8), &bits.m_High, 8);
+}
+
+// formats
+
+static void get_channel(const u8* pixels, u32 channel, u8* out_values)
+{
+    for (u32 i = 0; i < 16; ++i) out_values[i] = pixels[(i * 4) + channel];
+}
+
+static void encode_bc1_block(const u8* pixels, EQuality quality, u8* out)
+{
+    encode_color_block(pixels, quality, true, out);
+}
+
+static void encode_bc3_block(const u8* pixels, EQuality quality, u8* out)
+{
+    u8 alpha[16];
+    get_channel(pixels, 3, alpha);
+    encode_alpha_block(alpha, quality, out);
+    encode_color_block(pixels, quality, false, (out + 8));
+}
+
+static void encode_bc4_block(const u8* pixels, EQuality quality, u8* out)
+{
+    u8 red[16];
+    get_channel(pixels, 0, red);
+    encode_alpha_block(red, quality, out);
+}
+
+static void encode_bc5_block(const u8* pixels, EQuality quality, u8* out)
+{
+    u8 red[16], green[16];
+    get_channel(pixels, 0, red);
+    get_channel(pixels, 1, green);
+    encode_alpha_block(red, quality, out);
+    encode_alpha_block(green, quality, (out + 8));
+}
+
+struct FormatInfo {
+    u32           m_BlockSize;
+    EncodeBlock_t m_EncodeBlock;
+};
+
+static const FormatInfo* get_format_info(u32 format)
+{
+    static const FormatInfo s_bc1 = {8, encode_bc1_block};
+    static const FormatInfo s_bc3 = {16, encode_bc3_block};
+    static const FormatInfo s_bc4 = {8, encode_bc4_block};
+    static const FormatInfo s_bc5 = {16, encode_bc5_block};
+    static const FormatInfo s_bc7 = {16, encode_bc7_block};
+
+    switch (format) {
+        case texture_decoder::FORMAT_BC1_UNORM:
+        case texture_decoder::FORMAT_BC1_UNORM_SRGB: return &s_bc1;
+        case texture_decoder::FORMAT_BC3_UNORM:
+        case texture_decoder::FORMAT_BC3_UNORM_SRGB: return &s_bc3;
+        case texture_decoder::FORMAT_BC4_UNORM: return &s_bc4;
+        case texture_decoder::FORMAT_BC5_UNORM: return &s_bc5;
+        case texture_decoder::FORMAT_BC7_UNORM:
+        case texture_decoder::FORMAT_BC7_UNORM_SRGB: return &s_bc7;
+    }
+
+    return nullptr;
+}
+
+// encodes block rows [first, last), blocks which hang over the edge repeat the last row and column
+static void encode_block_rows(const FormatInfo& info, EQuality quality, const Surface& surface, u32 first, u32 last,
+                              u8* out)
+{
+    const u32 blocks_wide = ((surface.m_Width + 3) / 4);
+
+    for (u32 by = first; by < last; ++by) {
+        u8* blocks = (out + (static_cast<u64>(by) * blocks_wide * info.m_BlockSize));
+
+        for (u32 bx = 0; bx < blocks_wide; ++bx) {
+            u8 pixels[64];
+            for (u32 y = 0; y < 4; ++y) {
+                const u32 sy  = std::min(((by * 4) + y), (surface.m_Height - 1));
+                const u8* row = &surface.m_Pixels[static_cast<u64>(sy) * surface.m_Width * 4];
+
+                for (u32 x = 0; x < 4; ++x) {
+                    const u32 sx = std::min(((bx * 4) + x), (surface.m_Width - 1));
+                    std::memcpy(&pixels[((y * 4) + x) * 4], (row + (sx * 4)), 4);
+                }
+            }
+
+            info.m_EncodeBlock(pixels, quality, (blocks + (bx * info.m_BlockSize)));
+        }
+    }
+}
+
+bool is_supported(u32 format)
+{
+    return (get_format_info(format) != nullptr);
+}
+
+bool encode(u32 format, const u8* pixels, u32 width, u32 height, EQuality quality, ByteArray* out_buffer)
+{
+    Surface surface;
+    surface.m_Width  = width;
+    surface.m_Height = height;
+    surface.m_Pixels.assign(pixels, (pixels + (static_cast<u64>(width) * height * 4)));
+
+    std::vector<ByteArray> buffers;
+    if (!encode_mips(format, {surface}, quality, &buffers)) return false;
+
+    *out_buffer = std::move(buffers[0]);
+    return true;
+}
+
+bool encode_mips(u32 format, const std::vector<Surface>& mips, EQuality quality, std::vector<ByteArray>* out_mips)
+{
+    const auto* info = get_format_info(format);
+    if (!info) return false;
+
+    // one list of bands across every mip, so the small mips don't leave workers idle at the end of each level
+    struct Band {
+        u32 m_Mip;
+        u32 m_FirstRow;
+    };
+
+    std::vector<Band> bands;
+    u64               num_pixels = 0;
+
+    out_mips->resize(mips.size());
+    for (u32 i = 0; i < mips.size(); ++i) {
+        const auto& mip = mips[i];
+        const u64   size = (static_cast<u64>(mip.m_Width) * mip.m_Height);
+        if (size == 0 || mip.m_Pixels.size() < (size * 4)) return false;
+
+        (*out_mips)[i].resize(texture_decoder::get_surface_size(format, mip.m_Width, mip.m_Height));
+        num_pixels += size;
+
+        const u32 block_rows = ((mip.m_Height + 3) / 4);
+        for (u32 row = 0; row < block_rows; row += TILE_ROWS) bands.push_back({i, row});
+    }
+
+    const auto encode_band = [&](u32 index, u32) {
+        const auto& band       = bands[index];
+        const auto& mip        = mips[band.m_Mip];
+        const u32   block_rows = ((mip.m_Height + 3) / 4);
+        encode_block_rows(*info, quality, mip, band.m_FirstRow, std::min(block_rows, (band.m_FirstRow + TILE_ROWS)),
+                          (*out_mips)[band.m_Mip].data());
+    };
+
+    if (num_pixels < MIN_THREADED_SIZE) {
+        for (u32 i = 0; i < bands.size(); ++i) encode_band(i, 0);
+    } else {
+        jobs::parallel_for(static_cast<u32>(bands.size()), encode_band);
+    }
+
+    return true;
+}
+
+bool parse_format(const std::string& value, u32* out_format)
+{
+    static const std::pair<const char*, u32> formats[] = {
+        {"bc1", texture_decoder::FORMAT_BC1_UNORM}, {"bc3", texture_decoder::FORMAT_BC3_UNORM},
+        {"bc4", texture_decoder::FORMAT_BC4_UNORM}, {"bc5", texture_decoder::FORMAT_BC5_UNORM},
+        {"bc7", texture_decoder::FORMAT_BC7_UNORM},
+    };
+
+    for (const auto& format : formats) {
+        if (value == format.first) {
+            *out_format = format.second;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool parse_quality(const std::string& value, EQuality* out_quality)
+{
+    static const std::pair<const char*, EQuality> qualities[] = {
+        {"fast", E_QUALITY_FAST},
+        {"normal", E_QUALITY_NORMAL},
+        {"high", E_QUALITY_HIGH},
+    };
+
+    for (const auto& quality : qualities) {
+        if (value == quality.first) {
+            *out_quality = quality.second;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool parse_mip_filter(const std::string& value, EMipFilter* out_filter)
+{
+    if (value == "box") {
+        *out_filter = E_MIP_FILTER_BOX;
+        return true;
+    }
+
+    if (value == "kaiser") {
+        *out_filter = E_MIP_FILTER_KAISER;
+        return true;
+    }
+
+    return false;
+}
+} // namespace jcmr::texture_encoder
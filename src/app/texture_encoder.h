@@ -0,0 +1,47 @@
+#ifndef JCMR_APP_TEXTURE_ENCODER_H_HEADER_GUARD
+#define JCMR_APP_TEXTURE_ENCODER_H_HEADER_GUARD
+
+#include "platform.h"
+
+// encodes rgba8 surfaces to block compressed formats for importing textures. formats are the texture_decoder dxgi
+// values, BC1, BC3, BC4, BC5 and BC7 (mode 6 only, one subset with rgba endpoints) are supported.
+// blocks of every mip level are encoded as one pool of work across the job workers.
+namespace jcmr::texture_encoder
+{
+enum EQuality : u8 {
+    E_QUALITY_FAST = 0, // bounding box endpoints, indices by projection
+    E_QUALITY_NORMAL,   // principal axis endpoints, best index per pixel
+    E_QUALITY_HIGH,     // normal plus least squares endpoint refinement and a wider endpoint search
+};
+
+enum EMipFilter : u8 {
+    E_MIP_FILTER_BOX = 0, // 2x2 average
+    E_MIP_FILTER_KAISER,  // 8 tap windowed sinc, sharper but slower
+};
+
+struct Surface {
+    u32       m_Width  = 0;
+    u32       m_Height = 0;
+    ByteArray m_Pixels; // rgba8, top row first
+};
+
+bool is_supported(u32 format);
+
+// number of levels in a full chain down to 1x1
+u32 get_num_mips(u32 width, u32 height);
+
+// out_mips[0] is a copy of pixels. num_mips of 0 generates the full chain.
+void generate_mips(const u8* pixels, u32 width, u32 height, EMipFilter filter, u32 num_mips,
+                   std::vector<Surface>* out_mips);
+
+// out_buffer is resized to texture_decoder::get_surface_size()
+bool encode(u32 format, const u8* pixels, u32 width, u32 height, EQuality quality, ByteArray* out_buffer);
+bool encode_mips(u32 format, const std::vector<Surface>& mips, EQuality quality, std::vector<ByteArray>* out_mips);
+
+// command line names, "bc1", "fast", "box", ...
+bool parse_format(const std::string& value, u32* out_format);
+bool parse_quality(const std::string& value, EQuality* out_quality);
+bool parse_mip_filter(const std::string& value, EMipFilter* out_filter);
+} // namespace jcmr::texture_encoder
+
+#endif // JCMR_APP_TEXTURE_ENCODER_H_HEADER_GUARD
@@ -0,0 +1,198 @@
+#include "pch.h"
+
+#include "avtx.h"
+
+#include "app/texture_decoder.h"
+
+#include "render/dds_texture_loader.h"
+#include "render/renderer.h"
+
+#include <cstdlib>
+
+namespace jcmr::avtx
+{
+static u32 get_stream_rank(const AvtxHeader& header, u32 stream_index)
+{
+    u32 rank = 0;
+    for (u32 i = 0; i < AVTX_MAX_STREAMS; ++i) {
+        if (i != stream_index && header.m_Streams[i].m_Size > header.m_Streams[stream_index].m_Size) {
+            ++rank;
+        }
+    }
+
+    return rank;
+}
+
+const AvtxHeader* get_header(const ByteArray& buffer)
+{
+    if (buffer.size() < sizeof(AvtxHeader)) {
+        return nullptr;
+    }
+
+    auto header = reinterpret_cast<const AvtxHeader*>(buffer.data());
+    if (header->m_Magic != ava::AvalancheTexture::AVTX_MAGIC) {
+        return nullptr;
+    }
+
+    return header;
+}
+
+// the mip level the quality wants, counted down from the full size
+static u32 get_target_level(const AvtxHeader& header, const Quality& quality)
+{
+    const u32 max_level = std::max<u32>(header.m_Mips, 1) - 1;
+
+    u32 level = std::min(quality.m_MipBias, max_level);
+    if (quality.m_MaxDimension != 0) {
+        while (level < max_level
+               && std::max((header.m_Width >> level), (header.m_Height >> level)) > quality.m_MaxDimension) {
+            ++level;
+        }
+    }
+
+    return level;
+}
+
+// the smallest stream whose first mip is still at least the size the quality wants, the rest are skipped inside it.
+// if every stream is smaller than that (the source streams weren't read), the biggest one there is.
+static u32 select_stream(const AvtxHeader& header, bool has_source, const Quality& quality, u32* out_skip_mips)
+{
+    const u32 level = get_target_level(header, quality);
+
+    u32 best_index    = AVTX_MAX_STREAMS;
+    u32 best_rank     = 0;
+    u32 biggest_index = AVTX_MAX_STREAMS;
+    u32 biggest_rank  = 0;
+    for (u32 i = 0; i < AVTX_MAX_STREAMS; ++i) {
+        const auto& stream = header.m_Streams[i];
+        if (stream.m_Size == 0 || (stream.m_Source && !has_source)) {
+            continue;
+        }
+
+        const u32 rank = get_stream_rank(header, i);
+        if (rank <= level && (best_index == AVTX_MAX_STREAMS || rank > best_rank)) {
+            best_index = i;
+            best_rank  = rank;
+        }
+
+        if (biggest_index == AVTX_MAX_STREAMS || rank < biggest_rank) {
+            biggest_index = i;
+            biggest_rank  = rank;
+        }
+    }
+
+    if (best_index == AVTX_MAX_STREAMS) {
+        *out_skip_mips = 0;
+        return biggest_index;
+    }
+
+    *out_skip_mips = (level - best_rank);
+    return best_index;
+}
+
+bool parse_quality(const std::string& value, Quality* out_quality)
+{
+    *out_quality = {};
+    if (value == "full") return true;
+
+    if (value == "half") {
+        out_quality->m_MipBias = 1;
+        return true;
+    }
+
+    if (value == "quarter") {
+        out_quality->m_MipBias = 2;
+        return true;
+    }
+
+    char* end       = nullptr;
+    auto  dimension = std::strtoul(value.c_str(), &end, 10);
+    if (value.empty() || *end != '\0' || dimension == 0) {
+        return false;
+    }
+
+    out_quality->m_MaxDimension = static_cast<u32>(dimension);
+    return true;
+}
+
+u32 get_source_stream_size(const ByteArray& buffer, const Quality& quality)
+{
+    auto header = get_header(buffer);
+    if (!header) {
+        return 0;
+    }
+
+    u32        skip_mips;
+    const auto index = select_stream(*header, true, quality, &skip_mips);
+    if (index == AVTX_MAX_STREAMS || !header->m_Streams[index].m_Source) {
+        return 0;
+    }
+
+    return header->m_Streams[index].m_Size;
+}
+
+bool get_best_stream(const ByteArray& buffer, const ByteArray& source_buffer, StreamView* out_view,
+                     const Quality& quality)
+{
+    auto header = get_header(buffer);
+    if (!header) {
+        return false;
+    }
+
+    u32        skip_mips;
+    const auto index = select_stream(*header, !source_buffer.empty(), quality, &skip_mips);
+    if (index == AVTX_MAX_STREAMS) {
+        return false;
+    }
+
+    const auto& stream = header->m_Streams[index];
+    const auto& data   = (stream.m_Source ? source_buffer : buffer);
+    if ((static_cast<u64>(stream.m_Offset) + stream.m_Size) > data.size()) {
+        return false;
+    }
+
+    const u32 rank = get_stream_rank(*header, index);
+
+    out_view->m_Data   = (data.data() + stream.m_Offset);
+    out_view->m_Size   = stream.m_Size;
+    out_view->m_Width  = std::max<u32>((header->m_Width >> rank), 1);
+    out_view->m_Height = std::max<u32>((header->m_Height >> rank), 1);
+    out_view->m_Depth  = std::max<u32>(header->m_Depth, 1);
+    out_view->m_Format = header->m_Format;
+
+    // the smaller mips follow the first one in the stream, step over the ones which are bigger than the quality wants.
+    // formats the decoder doesn't know the size of are left at the top of the stream.
+    for (; skip_mips > 0; --skip_mips) {
+        const u64 mip_size =
+            texture_decoder::get_surface_size(out_view->m_Format, out_view->m_Width, out_view->m_Height);
+        if (mip_size == 0 || mip_size >= out_view->m_Size) {
+            break;
+        }
+
+        out_view->m_Data += mip_size;
+        out_view->m_Size -= static_cast<u32>(mip_size);
+        out_view->m_Width  = std::max<u32>((out_view->m_Width >> 1), 1);
+        out_view->m_Height = std::max<u32>((out_view->m_Height >> 1), 1);
+    }
+
+    return true;
+}
+
+void get_dds_header(const StreamView& view, DDS_HEADER* out_header, DDS_HEADER_DXT10* out_dxt10_header)
+{
+    *out_header             = {};
+    out_header->size        = sizeof(DDS_HEADER);
+    out_header->flags       = (DDS_TEXTURE | DDSD_MIPMAPCOUNT);
+    out_header->width       = view.m_Width;
+    out_header->height      = view.m_Height;
+    out_header->depth       = view.m_Depth;
+    out_header->mipMapCount = 1;
+    out_header->ddspf       = Renderer::get_pixel_format((DXGI_FORMAT)view.m_Format);
+    out_header->caps        = (DDSCAPS_COMPLEX | DDSCAPS_TEXTURE);
+
+    *out_dxt10_header                   = {};
+    out_dxt10_header->dxgiFormat        = (DXGI_FORMAT)view.m_Format;
+    out_dxt10_header->resourceDimension = D3D11_RESOURCE_DIMENSION_TEXTURE2D;
+    out_dxt10_header->arraySize         = 1;
+}
+} // namespace jcmr::avtx
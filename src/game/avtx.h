@@ -0,0 +1,86 @@
+#ifndef JCMR_GAME_AVTX_H_HEADER_GUARD
+#define JCMR_GAME_AVTX_H_HEADER_GUARD
+
+#include "platform.h"
+
+struct DDS_HEADER;
+struct DDS_HEADER_DXT10;
+
+// the avtx (.ddsc) header layout. AvaFormatLib only has a reader which copies the stream it picks, this lets the
+// texture paths find the same stream in place and the importer write new ones.
+namespace jcmr::avtx
+{
+static constexpr u32 AVTX_MAX_STREAMS      = 8;
+static constexpr u32 AVTX_STREAM_ALIGNMENT = 16;
+
+// every stream is a run of mips (largest first), and the size of a stream's first mip is the full size shifted by
+// the number of streams which are bigger than it.
+#pragma pack(push, 1)
+struct AvtxStream {
+    u32 m_Offset;
+    u32 m_Size;
+    u16 m_Alignment;
+    u8  m_TileMode;
+    u8  m_Source; // 1 if the stream is in the .hmddsc
+};
+
+struct AvtxHeader {
+    u32        m_Magic;
+    u16        m_Version;
+    u8         m_Unknown;
+    u8         m_Dimension;
+    u32        m_Format;
+    u16        m_Width;
+    u16        m_Height;
+    u16        m_Depth;
+    u16        m_Flags;
+    u8         m_Mips;
+    u8         m_MipsRedisent; // mips in the .ddsc
+    u8         m_MipsCinematic;
+    u8         m_MipsBias;
+    u8         m_LodGroup;
+    u8         m_Padding[3];
+    u32        m_Unknown2;
+    AvtxStream m_Streams[AVTX_MAX_STREAMS];
+};
+#pragma pack(pop)
+
+static_assert(sizeof(AvtxStream) == 0xC, "AvtxStream alignment is wrong!");
+static_assert(sizeof(AvtxHeader) == 0x80, "AvtxHeader alignment is wrong!");
+
+// the first mip of a stream, m_Data points into the buffer it was found in and is only valid as long as that is
+struct StreamView {
+    const u8* m_Data   = nullptr;
+    u32       m_Size   = 0; // the whole stream, the first mip and any smaller ones after it
+    u32       m_Width  = 0;
+    u32       m_Height = 0;
+    u32       m_Depth  = 0;
+    u32       m_Format = 0;
+};
+
+// the "texture_quality" setting, how far below their full size textures are loaded. applied when picking the stream
+// so the .hmddsc isn't read at all when the .ddsc mips are big enough, then by skipping the top mips of the stream.
+struct Quality {
+    u32 m_MipBias      = 0; // mips dropped from every texture, "half" is 1 and "quarter" 2
+    u32 m_MaxDimension = 0; // more mips are dropped until the width and height fit, 0 for no limit
+};
+
+// "full", "half", "quarter" or a maximum dimension ("1024")
+bool parse_quality(const std::string& value, Quality* out_quality);
+
+// nullptr if the buffer is too small or the magic is wrong
+const AvtxHeader* get_header(const ByteArray& buffer);
+
+// size of the .hmddsc stream the quality wants, 0 if the .ddsc has everything it needs
+u32 get_source_stream_size(const ByteArray& buffer, const Quality& quality = {});
+
+// at full quality this is the biggest stream, the same one ReadBestEntry picks. source streams are skipped when
+// source_buffer is empty.
+bool get_best_stream(const ByteArray& buffer, const ByteArray& source_buffer, StreamView* out_view,
+                     const Quality& quality = {});
+
+// headers for uploading the first mip of a stream with Renderer::create_texture or Texture::load
+void get_dds_header(const StreamView& view, DDS_HEADER* out_header, DDS_HEADER_DXT10* out_dxt10_header);
+} // namespace jcmr::avtx
+
+#endif // JCMR_GAME_AVTX_H_HEADER_GUARD
@@ -0,0 +1,287 @@
+#include "pch.h"
+
+#include "content_search.h"
+
+#include "app/jobs.h"
+#include "app/profile.h"
+#include "app/utils.h"
+
+#include "game/resource_manager.h"
+
+#include <emmintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+namespace jcmr::content_search
+{
+static u8 to_lower(u8 ch)
+{
+    return ((ch >= 'A' && ch <= 'Z') ? (ch | 0x20) : ch);
+}
+
+static bool is_alpha(u8 ch)
+{
+    return (to_lower(ch) >= 'a' && to_lower(ch) <= 'z');
+}
+
+static u32 count_trailing_zeros(u32 value)
+{
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, value);
+    return index;
+#else
+    return __builtin_ctz(value);
+#endif
+}
+
+Pattern make_string_pattern(const std::string& value, bool ignore_case)
+{
+    Pattern pattern;
+    pattern.m_Bytes.assign(value.begin(), value.end());
+    pattern.m_Flags = (ignore_case ? E_PATTERN_FLAG_IGNORE_CASE : E_PATTERN_FLAG_NONE);
+    return pattern;
+}
+
+Pattern make_u32_pattern(u32 value)
+{
+    Pattern pattern;
+    pattern.m_Bytes.resize(sizeof(u32));
+    std::memcpy(pattern.m_Bytes.data(), &value, sizeof(u32));
+    return pattern;
+}
+
+bool parse_hex_pattern(const std::string& value, Pattern* out_pattern)
+{
+    auto get_nibble = [](char ch) -> i32 {
+        if (ch >= '0' && ch <= '9') return (ch - '0');
+        if (ch >= 'a' && ch <= 'f') return (ch - 'a' + 10);
+        if (ch >= 'A' && ch <= 'F') return (ch - 'A' + 10);
+        return -1;
+    };
+
+    std::string digits;
+    for (auto ch : value) {
+        if (ch == ' ') continue;
+        if (get_nibble(ch) < 0) return false;
+        digits.push_back(ch);
+    }
+
+    if (digits.empty() || (digits.size() % 2) != 0) {
+        return false;
+    }
+
+    out_pattern->m_Bytes.clear();
+    out_pattern->m_Flags = E_PATTERN_FLAG_NONE;
+    for (u64 i = 0; i < digits.size(); i += 2) {
+        out_pattern->m_Bytes.push_back(static_cast<u8>((get_nibble(digits[i]) << 4) | get_nibble(digits[i + 1])));
+    }
+
+    return true;
+}
+
+Matcher::Matcher(const std::vector<Pattern>& patterns)
+{
+    for (u32 i = 0; i < patterns.size(); ++i) {
+        const auto& pattern = patterns[i];
+        if (pattern.m_Bytes.empty()) continue;
+
+        Entry entry{};
+        entry.m_Bytes      = pattern.m_Bytes;
+        entry.m_Pattern    = i;
+        entry.m_IgnoreCase = (pattern.m_Flags & E_PATTERN_FLAG_IGNORE_CASE);
+
+        if (entry.m_IgnoreCase) {
+            std::transform(entry.m_Bytes.begin(), entry.m_Bytes.end(), entry.m_Bytes.begin(), to_lower);
+        }
+
+        entry.m_First     = entry.m_Bytes.front();
+        entry.m_Last      = entry.m_Bytes.back();
+        entry.m_FirstMask = ((entry.m_IgnoreCase && is_alpha(entry.m_First)) ? 0x20 : 0);
+        entry.m_LastMask  = ((entry.m_IgnoreCase && is_alpha(entry.m_Last)) ? 0x20 : 0);
+        m_entries.emplace_back(std::move(entry));
+    }
+}
+
+void Matcher::find(const u8* data, u64 size, const MatchCallback_t& callback) const
+{
+    struct Filter {
+        __m128i first;
+        __m128i last;
+        __m128i first_mask;
+        __m128i last_mask;
+    };
+
+    auto verify = [&](const Entry& entry, u64 offset) {
+        const auto* bytes = (data + offset);
+        if (!entry.m_IgnoreCase) {
+            return (std::memcmp(bytes, entry.m_Bytes.data(), entry.m_Bytes.size()) == 0);
+        }
+
+        for (u64 i = 0; i < entry.m_Bytes.size(); ++i) {
+            if (to_lower(bytes[i]) != entry.m_Bytes[i]) return false;
+        }
+
+        return true;
+    };
+
+    std::vector<Filter> filters(m_entries.size());
+    u64                 max_length = 0;
+    for (u32 i = 0; i < m_entries.size(); ++i) {
+        const auto& entry  = m_entries[i];
+        auto&       filter = filters[i];
+
+        filter.first      = _mm_set1_epi8(static_cast<char>(entry.m_First));
+        filter.last       = _mm_set1_epi8(static_cast<char>(entry.m_Last));
+        filter.first_mask = _mm_set1_epi8(static_cast<char>(entry.m_FirstMask));
+        filter.last_mask  = _mm_set1_epi8(static_cast<char>(entry.m_LastMask));
+        max_length        = std::max<u64>(max_length, entry.m_Bytes.size());
+    }
+
+    // 16 offsets at a time. the first and last byte of every pattern are compared against the block, only the
+    // offsets where both match are verified. every pattern is checked against a block before moving on so the
+    // buffer is only streamed through the cache once.
+    u64 offset = 0;
+    if (size >= (max_length + 15)) {
+        for (; (offset + max_length + 15) <= size; offset += 16) {
+            const auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + offset));
+
+            for (u32 i = 0; i < m_entries.size(); ++i) {
+                const auto& entry  = m_entries[i];
+                const auto& filter = filters[i];
+
+                const auto* tail  = (data + offset + entry.m_Bytes.size() - 1);
+                const auto  last  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(tail));
+                const auto  equal = _mm_and_si128(_mm_cmpeq_epi8(_mm_or_si128(block, filter.first_mask), filter.first),
+                                                  _mm_cmpeq_epi8(_mm_or_si128(last, filter.last_mask), filter.last));
+
+                for (u32 mask = static_cast<u32>(_mm_movemask_epi8(equal)); mask != 0; mask &= (mask - 1)) {
+                    const auto match = (offset + count_trailing_zeros(mask));
+                    if (verify(entry, match) && !callback(entry.m_Pattern, match)) return;
+                }
+            }
+        }
+    }
+
+    // the tail which is too short for a full block
+    for (; offset < size; ++offset) {
+        for (const auto& entry : m_entries) {
+            if ((offset + entry.m_Bytes.size()) > size) continue;
+            if (verify(entry, offset) && !callback(entry.m_Pattern, offset)) return;
+        }
+    }
+}
+
+bool search(ResourceManager& resource_manager, const Options& options, Progress* progress, MatchCallback_t callback)
+{
+    ProfileBlock _("ContentSearch search");
+
+    std::vector<std::pair<u32, std::string>> files;
+    resource_manager.enumerate_dictionary([&](u32 namehash, const std::string& filename) {
+        if (options.m_Extension.empty() || utils::get_extension(filename) == options.m_Extension) {
+            files.emplace_back(namehash, filename);
+        }
+    });
+
+    // results come back in roughly the same order between runs
+    std::sort(files.begin(), files.end(), [](const auto& lhs, const auto& rhs) { return lhs.second < rhs.second; });
+
+    progress->m_NumFiles = static_cast<u32>(files.size());
+    LOG_INFO("ContentSearch : searching {} files for {} patterns...", files.size(), options.m_Patterns.size());
+
+    const Matcher          matcher(options.m_Patterns);
+    std::vector<ByteArray> buffers(jobs::get_worker_count()); // compressed files, reused between files, one per worker
+    std::atomic<bool>      limit_reached = false;
+
+    jobs::parallel_for(static_cast<u32>(files.size()), [&](u32 index, u32 worker) {
+        if (progress->m_Cancel || limit_reached) return;
+
+        // stored files are searched in place in the mapped archive
+        ResourceManager::FileView file;
+        if (!resource_manager.read_view(files[index].first, &buffers[worker], &file,
+                                        ResourceManager::E_READ_FLAG_QUIET)) {
+            ++progress->m_NumFilesFailed;
+            ++progress->m_NumFilesSearched;
+            return;
+        }
+
+        u32 num_file_matches = 0;
+        matcher.find(file.m_Data, file.m_Size, [&](u32 pattern, u64 offset) {
+            if (progress->m_Cancel || limit_reached) return false;
+
+            // only count the match if it's still under the limit
+            u32 num_matches = progress->m_NumMatches;
+            do {
+                if (options.m_MaxMatches != 0 && num_matches >= options.m_MaxMatches) {
+                    limit_reached = true;
+                    return false;
+                }
+            } while (!progress->m_NumMatches.compare_exchange_weak(num_matches, (num_matches + 1)));
+
+            callback(files[index].second, pattern, offset);
+            ++num_file_matches;
+            return (options.m_MaxMatchesPerFile == 0 || num_file_matches < options.m_MaxMatchesPerFile);
+        });
+
+        progress->m_NumBytesSearched += file.m_Size;
+        ++progress->m_NumFilesSearched;
+    });
+
+    if (progress->m_NumFilesFailed > 0) {
+        LOG_WARNING("ContentSearch : {} files failed to read.", progress->m_NumFilesFailed.load());
+    }
+
+    LOG_INFO("ContentSearch : searched {} files ({} MB), {} matches.", progress->m_NumFilesSearched.load(),
+             (progress->m_NumBytesSearched.load() / (1024 * 1024)), progress->m_NumMatches.load());
+    return !progress->m_Cancel;
+}
+
+AsyncSearch::~AsyncSearch()
+{
+    cancel();
+}
+
+void AsyncSearch::start(ResourceManager& resource_manager, Options options)
+{
+    cancel();
+
+    m_progress.m_NumFiles         = 0;
+    m_progress.m_NumFilesSearched = 0;
+    m_progress.m_NumFilesFailed   = 0;
+    m_progress.m_NumMatches       = 0;
+    m_progress.m_NumBytesSearched = 0;
+    m_progress.m_Cancel           = false;
+
+    {
+        std::lock_guard<decltype(m_mutex)> _lock(m_mutex);
+        m_matches.clear();
+    }
+
+    m_running = true;
+    m_thread  = std::thread([this, &resource_manager, options = std::move(options)] {
+        search(resource_manager, options, &m_progress, [this](const std::string& filename, u32 pattern, u64 offset) {
+            std::lock_guard<decltype(m_mutex)> _lock(m_mutex);
+            m_matches.push_back({filename, pattern, offset});
+        });
+
+        m_running = false;
+    });
+}
+
+void AsyncSearch::cancel()
+{
+    if (m_thread.joinable()) {
+        m_progress.m_Cancel = true;
+        m_thread.join();
+    }
+}
+
+void AsyncSearch::take_matches(std::vector<Match>* out_matches)
+{
+    std::lock_guard<decltype(m_mutex)> _lock(m_mutex);
+    out_matches->insert(out_matches->end(), std::make_move_iterator(m_matches.begin()),
+                        std::make_move_iterator(m_matches.end()));
+    m_matches.clear();
+}
+} // namespace jcmr::content_search
@@ -0,0 +1,111 @@
+#ifndef JCMR_GAME_CONTENT_SEARCH_H_HEADER_GUARD
+#define JCMR_GAME_CONTENT_SEARCH_H_HEADER_GUARD
+
+#include "platform.h"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+namespace jcmr
+{
+struct ResourceManager;
+}
+
+// search the contents of every file in the game archives for one or more byte patterns. files are viewed in place in
+// the mapped archives on the job workers (compressed ones are decompressed into a scratch buffer per worker), and
+// scanned with an sse2 first/last byte filter for all patterns at once.
+namespace jcmr::content_search
+{
+enum PatternFlags : u32 {
+    E_PATTERN_FLAG_NONE        = 0,
+    E_PATTERN_FLAG_IGNORE_CASE = (1 << 0), // ascii only
+};
+
+struct Pattern {
+    ByteArray m_Bytes;
+    u32       m_Flags = E_PATTERN_FLAG_NONE;
+};
+
+Pattern make_string_pattern(const std::string& value, bool ignore_case = false);
+Pattern make_u32_pattern(u32 value); // little endian, for namehashes
+bool    parse_hex_pattern(const std::string& value, Pattern* out_pattern); // "DEADBEEF" or "DE AD BE EF"
+
+// matches any number of patterns in a buffer
+struct Matcher {
+    // return false to stop matching the buffer
+    using MatchCallback_t = std::function<bool(u32 pattern, u64 offset)>;
+
+    explicit Matcher(const std::vector<Pattern>& patterns);
+
+    void find(const u8* data, u64 size, const MatchCallback_t& callback) const;
+
+  private:
+    struct Entry {
+        ByteArray m_Bytes; // lower case if the pattern ignores case
+        u32       m_Pattern;
+        u8        m_First;
+        u8        m_Last;
+        u8        m_FirstMask; // or'd into the buffer before comparing, folds ascii letters to lower case
+        u8        m_LastMask;
+        bool      m_IgnoreCase;
+    };
+
+    std::vector<Entry> m_entries;
+};
+
+struct Options {
+    std::vector<Pattern> m_Patterns;
+    std::string          m_Extension;              // only search files with this extension, empty for all files
+    u32                  m_MaxMatchesPerFile = 16; // 0 for no limit
+    u32                  m_MaxMatches        = 0;  // stop searching after this many matches, 0 for no limit
+};
+
+struct Progress {
+    std::atomic<u32>  m_NumFiles         = 0;
+    std::atomic<u32>  m_NumFilesSearched = 0;
+    std::atomic<u32>  m_NumFilesFailed   = 0;
+    std::atomic<u32>  m_NumMatches       = 0;
+    std::atomic<u64>  m_NumBytesSearched = 0;
+    std::atomic<bool> m_Cancel           = false;
+};
+
+// called from the job workers as matches are found
+using MatchCallback_t = std::function<void(const std::string& filename, u32 pattern, u64 offset)>;
+
+// blocks until every file is searched, progress->m_Cancel is set or m_MaxMatches is reached. returns false if the
+// search was cancelled.
+bool search(ResourceManager& resource_manager, const Options& options, Progress* progress, MatchCallback_t callback);
+
+// runs search() on a background thread and collects the matches, used by the ui
+struct AsyncSearch {
+    struct Match {
+        std::string m_Filename;
+        u32         m_Pattern;
+        u64         m_Offset;
+    };
+
+    ~AsyncSearch();
+
+    // cancels any search which is already running. the resource manager must outlive the search (or cancel() it)
+    void start(ResourceManager& resource_manager, Options options);
+
+    // blocks until the worker thread exits
+    void cancel();
+
+    bool            is_running() const { return m_running; }
+    const Progress& get_progress() const { return m_progress; }
+
+    // moves the matches found since the last call to the end of out_matches
+    void take_matches(std::vector<Match>* out_matches);
+
+  private:
+    Progress           m_progress;
+    std::thread        m_thread;
+    std::atomic<bool>  m_running = false;
+    std::mutex         m_mutex;
+    std::vector<Match> m_matches;
+};
+} // namespace jcmr::content_search
+
+#endif // JCMR_GAME_CONTENT_SEARCH_H_HEADER_GUARD
@@ -0,0 +1,454 @@
+#include "pch.h"
+
+#include "dependency_graph.h"
+
+#include "app/hashing.h"
+#include "app/jobs.h"
+#include "app/profile.h"
+#include "app/utils.h"
+
+#include "game/formats/runtime_container_variant_types.h"
+#include "game/resource_manager.h"
+
+#include <atomic>
+#include <fstream>
+#include <unordered_set>
+
+namespace jcmr
+{
+static constexpr std::array TEXTURE_EXTENSIONS{".dds", ".ddsc", ".hmddsc"};
+static constexpr u32        MAX_TEXTURE_PATH_LENGTH = 255;
+
+enum class EFileType {
+    RENDER_BLOCK_MODEL,
+    AMF_MODEL,
+    AMF_MESH,
+    RUNTIME_CONTAINER,
+};
+
+struct GraphHeader {
+    u32 m_Magic;
+    u32 m_Version;
+    u32 m_NumNodes;
+    u32 m_NumEdges;
+    u32 m_NumReverseNodes;
+};
+
+static std::optional<EFileType> get_file_type(const std::string& filename)
+{
+    const auto extension = utils::get_extension(filename);
+    if (extension == "rbm") return EFileType::RENDER_BLOCK_MODEL;
+    if (extension == "modelc") return EFileType::AMF_MODEL;
+    if (extension == "meshc") return EFileType::AMF_MESH;
+    if (extension == "blo" || extension == "epe") return EFileType::RUNTIME_CONTAINER;
+    return std::nullopt;
+}
+
+static bool ends_with(std::string_view value, std::string_view suffix)
+{
+    return (value.size() > suffix.size() && value.compare((value.size() - suffix.size()), suffix.size(), suffix) == 0);
+}
+
+static bool is_texture_path(std::string_view value)
+{
+    return std::any_of(TEXTURE_EXTENSIONS.begin(), TEXTURE_EXTENSIONS.end(),
+                       [&](const char* extension) { return ends_with(value, extension); });
+}
+
+// every render block type stores its textures as length prefixed paths after the vertex data, scanning for them
+// avoids parsing the layout of every render block type.
+template <typename Callback> static void for_each_render_block_texture(const ByteArray& buffer, Callback&& callback)
+{
+    const auto size = buffer.size();
+    for (u64 offset = 0; (offset + 4) < size; ++offset) {
+        // lengths are u32 but never more than a byte
+        if (buffer[offset + 3] != 0 || buffer[offset + 2] != 0 || buffer[offset + 1] != 0) continue;
+
+        const u32 length = buffer[offset];
+        if (length < 5 || length > MAX_TEXTURE_PATH_LENGTH || (offset + 4 + length) > size) continue;
+
+        std::string_view value(reinterpret_cast<const char*>(buffer.data() + offset + 4), length);
+        if (!std::all_of(value.begin(), value.end(), [](char ch) { return (ch >= 0x20 && ch < 0x7F); })) continue;
+        if (!is_texture_path(value)) continue;
+
+        callback(value);
+        offset += (3 + length);
+    }
+}
+
+static void collect_render_block_model(const ByteArray& buffer, const std::unordered_set<u32>& dictionary,
+                                       std::vector<u32>* out_dependencies)
+{
+    for_each_render_block_texture(buffer, [&](std::string_view value) {
+        out_dependencies->push_back(hashing::hashlittle(value));
+
+        // the game prefers the high resolution source texture when it exists
+        if (ends_with(value, ".ddsc")) {
+            std::string source(value.substr(0, (value.size() - 5)));
+            source += ".hmddsc";
+
+            const auto hash = hashing::hashlittle(source);
+            if (dictionary.count(hash) != 0) out_dependencies->push_back(hash);
+        }
+    });
+}
+
+static void add_adf_string(ava::AvalancheDataFormat::ADF* adf, u64 hash, std::vector<u32>* out_dependencies)
+{
+    const char* name = adf->HashLookup(hash);
+    if (name && name[0] != '\0') out_dependencies->push_back(hashing::hashlittle(name));
+}
+
+static bool collect_amf_model(const ByteArray& buffer, std::vector<u32>* out_dependencies)
+{
+    ava::AvalancheDataFormat::ADF*        adf   = nullptr;
+    ava::AvalancheModelFormat::SAmfModel* model = nullptr;
+    if (!AVA_FL_SUCCEEDED(ava::AvalancheModelFormat::ParseModelc(buffer, &adf, &model))) return false;
+
+    add_adf_string(adf, model->m_Mesh, out_dependencies);
+    for (const auto& material : model->m_Materials) {
+        for (const auto texture : material.m_Textures) {
+            add_adf_string(adf, texture, out_dependencies);
+        }
+    }
+
+    delete adf;
+    std::free(model);
+    return true;
+}
+
+static bool collect_amf_mesh(const ByteArray& buffer, std::vector<u32>* out_dependencies)
+{
+    ava::AvalancheDataFormat::ADF*              adf     = nullptr;
+    ava::AvalancheModelFormat::SAmfMeshHeader*  header  = nullptr;
+    ava::AvalancheModelFormat::SAmfMeshBuffers* buffers = nullptr;
+    if (!AVA_FL_SUCCEEDED(ava::AvalancheModelFormat::ParseMeshc(buffer, &adf, &header, &buffers))) return false;
+
+    add_adf_string(adf, header->m_HighLodPath, out_dependencies);
+
+    delete adf;
+    std::free(header);
+    std::free(buffers);
+    return true;
+}
+
+// hash variants and strings are only kept when they name a file, most of them are names of other things
+static void collect_runtime_container(const ava::RuntimePropertyContainer::Container& container,
+                                      const std::unordered_set<u32>& dictionary, std::vector<u32>* out_dependencies)
+{
+    using namespace ava::RuntimePropertyContainer;
+    using game::format::get_variant_datatype;
+    using game::format::RuntimeContainer;
+
+    for (const auto& variant : container.m_Variants) {
+        u32 namehash = 0;
+        if (variant.m_Type == T_VARIANT_STRING) {
+            namehash = hashing::hashlittle(variant.as<std::string>());
+        } else if (variant.m_Type == T_VARIANT_INTEGER
+                   && get_variant_datatype(variant.m_NameHash) == RuntimeContainer::VARIANT_DATATYPE_HASH) {
+            namehash = static_cast<u32>(variant.as<i32>());
+        } else {
+            continue;
+        }
+
+        if (dictionary.count(namehash) != 0) out_dependencies->push_back(namehash);
+    }
+
+    for (const auto& child : container.m_Containers) {
+        collect_runtime_container(child, dictionary, out_dependencies);
+    }
+}
+
+// edges are (from, to) pairs, sorted and deduplicated here
+static void build_adjacency(std::vector<std::pair<u32, u32>>* edges, std::vector<DependencyGraph::Node>* out_nodes,
+                            std::vector<u32>* out_edges)
+{
+    std::sort(edges->begin(), edges->end());
+    edges->erase(std::unique(edges->begin(), edges->end()), edges->end());
+
+    out_nodes->clear();
+    out_edges->clear();
+    out_edges->reserve(edges->size());
+
+    for (const auto& [from, to] : *edges) {
+        if (out_nodes->empty() || out_nodes->back().m_NameHash != from) {
+            out_nodes->push_back({from, static_cast<u32>(out_edges->size())});
+        }
+
+        out_edges->push_back(to);
+    }
+
+    out_nodes->push_back({0, static_cast<u32>(out_edges->size())});
+}
+
+static std::pair<const u32*, const u32*> find_edges(const std::vector<DependencyGraph::Node>& nodes,
+                                                    const std::vector<u32>& edges, u32 namehash)
+{
+    if (nodes.empty()) return {nullptr, nullptr};
+
+    const auto end  = (nodes.end() - 1);
+    auto       iter = std::lower_bound(nodes.begin(), end, namehash, [](const DependencyGraph::Node& node, u32 value) {
+        return node.m_NameHash < value;
+    });
+
+    if (iter == end || (*iter).m_NameHash != namehash) return {nullptr, nullptr};
+    return {(edges.data() + (*iter).m_FirstEdge), (edges.data() + (*(iter + 1)).m_FirstEdge)};
+}
+
+static std::vector<u32> walk(const std::vector<DependencyGraph::Node>& nodes, const std::vector<u32>& edges,
+                             u32 namehash, u32 limit)
+{
+    std::vector<u32>        result;
+    std::unordered_set<u32> visited{namehash};
+
+    // result doubles as the queue
+    auto visit = [&](u32 node) {
+        const auto [begin, end] = find_edges(nodes, edges, node);
+        for (auto it = begin; it != end; ++it) {
+            if (limit != 0 && result.size() >= limit) return false;
+            if (visited.insert(*it).second) result.push_back(*it);
+        }
+
+        return true;
+    };
+
+    if (!visit(namehash)) return result;
+    for (u64 i = 0; i < result.size(); ++i) {
+        if (!visit(result[i])) break;
+    }
+
+    return result;
+}
+
+bool DependencyGraph::get_texture_paths(const std::string& filename, const ByteArray& buffer,
+                                        std::vector<std::string>* out_paths)
+{
+    const auto type = get_file_type(filename);
+    if (type == EFileType::RENDER_BLOCK_MODEL) {
+        for_each_render_block_texture(buffer, [&](std::string_view value) { out_paths->emplace_back(value); });
+        return true;
+    }
+
+    if (type != EFileType::AMF_MODEL) {
+        return false;
+    }
+
+    ava::AvalancheDataFormat::ADF*        adf   = nullptr;
+    ava::AvalancheModelFormat::SAmfModel* model = nullptr;
+    if (!AVA_FL_SUCCEEDED(ava::AvalancheModelFormat::ParseModelc(buffer, &adf, &model))) return false;
+
+    for (const auto& material : model->m_Materials) {
+        for (const auto texture : material.m_Textures) {
+            const char* name = adf->HashLookup(texture);
+            if (name && is_texture_path(name)) out_paths->emplace_back(name);
+        }
+    }
+
+    delete adf;
+    std::free(model);
+    return true;
+}
+
+bool DependencyGraph::build(ResourceManager& resource_manager)
+{
+    ProfileBlock _("DependencyGraph build");
+
+    std::unordered_set<u32>                 dictionary;
+    std::vector<std::pair<u32, EFileType>> files;
+    resource_manager.enumerate_dictionary([&](u32 namehash, const std::string& filename) {
+        dictionary.insert(namehash);
+        if (auto type = get_file_type(filename)) {
+            files.emplace_back(namehash, type.value());
+        }
+    });
+
+    LOG_INFO("DependencyGraph : indexing {} files...", files.size());
+
+    std::vector<std::vector<u32>> dependencies(files.size());
+    std::atomic<u32>              num_failed = 0;
+
+    jobs::parallel_for(static_cast<u32>(files.size()), [&](u32 index, u32) {
+        const auto [namehash, type] = files[index];
+
+        ByteArray buffer;
+        if (!resource_manager.read(namehash, &buffer, ResourceManager::E_READ_FLAG_QUIET)) {
+            ++num_failed;
+            return;
+        }
+
+        auto* out_dependencies = &dependencies[index];
+        switch (type) {
+            case EFileType::RENDER_BLOCK_MODEL: collect_render_block_model(buffer, dictionary, out_dependencies); break;
+            case EFileType::AMF_MODEL: {
+                if (!collect_amf_model(buffer, out_dependencies)) ++num_failed;
+                break;
+            }
+            case EFileType::AMF_MESH: {
+                if (!collect_amf_mesh(buffer, out_dependencies)) ++num_failed;
+                break;
+            }
+            case EFileType::RUNTIME_CONTAINER: {
+                ava::RuntimePropertyContainer::Container container{};
+                if (!AVA_FL_SUCCEEDED(ava::RuntimePropertyContainer::Parse(buffer, &container))) {
+                    ++num_failed;
+                    break;
+                }
+
+                collect_runtime_container(container, dictionary, out_dependencies);
+                break;
+            }
+        }
+    });
+
+    if (num_failed > 0) {
+        LOG_WARNING("DependencyGraph : {} files failed to read or parse.", num_failed.load());
+    }
+
+    std::vector<std::pair<u32, u32>> edges;
+    for (u32 i = 0; i < files.size(); ++i) {
+        for (const auto dependency : dependencies[i]) {
+            if (dependency != files[i].first) edges.emplace_back(files[i].first, dependency);
+        }
+
+        dependencies[i] = {};
+    }
+
+    build_adjacency(&edges, &m_nodes, &m_edges);
+
+    for (auto& [from, to] : edges) {
+        std::swap(from, to);
+    }
+
+    build_adjacency(&edges, &m_reverse_nodes, &m_reverse_edges);
+
+    LOG_INFO("DependencyGraph : indexed {} files, {} edges.", get_num_nodes(), get_num_edges());
+    return true;
+}
+
+template <typename T> static void write_vector(std::ofstream& stream, const std::vector<T>& values)
+{
+    stream.write(reinterpret_cast<const char*>(values.data()), (values.size() * sizeof(T)));
+}
+
+template <typename T> static bool read_vector(std::ifstream& stream, u32 count, std::vector<T>* out_values)
+{
+    out_values->resize(count);
+    stream.read(reinterpret_cast<char*>(out_values->data()), (count * sizeof(T)));
+    return !stream.fail();
+}
+
+bool DependencyGraph::load(const std::filesystem::path& filename)
+{
+    std::ifstream stream(filename, std::ios::binary);
+    if (stream.fail()) {
+        return false;
+    }
+
+    GraphHeader header{};
+    stream.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (stream.fail() || header.m_Magic != GRAPH_MAGIC) {
+        LOG_ERROR("DependencyGraph : \"{}\" is not a dependency graph.", filename.generic_string());
+        return false;
+    }
+
+    if (header.m_Version != GRAPH_VERSION) {
+        LOG_ERROR("DependencyGraph : \"{}\" is out of date (version {}), it needs to be rebuilt.",
+                  filename.generic_string(), header.m_Version);
+        return false;
+    }
+
+    // the counts are checked before anything is allocated for them
+    std::error_code error;
+    const u64       file_size     = std::filesystem::file_size(filename, error);
+    const u64       expected_size = (sizeof(GraphHeader)
+                               + ((static_cast<u64>(header.m_NumNodes) + header.m_NumReverseNodes) * sizeof(Node))
+                               + (static_cast<u64>(header.m_NumEdges) * sizeof(u32) * 2));
+    if (error || file_size != expected_size) {
+        LOG_ERROR("DependencyGraph : \"{}\" is truncated.", filename.generic_string());
+        return false;
+    }
+
+    if (!read_vector(stream, header.m_NumNodes, &m_nodes) || !read_vector(stream, header.m_NumEdges, &m_edges)
+        || !read_vector(stream, header.m_NumReverseNodes, &m_reverse_nodes)
+        || !read_vector(stream, header.m_NumEdges, &m_reverse_edges)) {
+        LOG_ERROR("DependencyGraph : \"{}\" is truncated.", filename.generic_string());
+        return false;
+    }
+
+    if (!validate()) {
+        LOG_ERROR("DependencyGraph : \"{}\" is corrupt, it needs to be rebuilt.", filename.generic_string());
+        return false;
+    }
+
+    return true;
+}
+
+// find_edges() binary searches the nodes and uses the edge ranges without a bounds check. nodes are sorted by
+// namehash, the ranges don't go backwards and the sentinel closes the last range at the end of the edges.
+static bool validate_adjacency(const std::vector<DependencyGraph::Node>& nodes, const std::vector<u32>& edges)
+{
+    if (nodes.empty() || nodes.front().m_FirstEdge != 0 || nodes.back().m_FirstEdge != edges.size()) {
+        return false;
+    }
+
+    for (u32 i = 1; i < nodes.size(); ++i) {
+        if (nodes[i].m_FirstEdge < nodes[i - 1].m_FirstEdge) return false;
+        if ((i + 1) < nodes.size() && nodes[i].m_NameHash <= nodes[i - 1].m_NameHash) return false;
+    }
+
+    return true;
+}
+
+bool DependencyGraph::validate() const
+{
+    return (validate_adjacency(m_nodes, m_edges) && validate_adjacency(m_reverse_nodes, m_reverse_edges));
+}
+
+bool DependencyGraph::save(const std::filesystem::path& filename) const
+{
+    if (filename.has_parent_path()) {
+        std::filesystem::create_directories(filename.parent_path());
+    }
+
+    std::ofstream stream(filename, std::ios::binary);
+    if (stream.fail()) {
+        return false;
+    }
+
+    GraphHeader header{};
+    header.m_Magic           = GRAPH_MAGIC;
+    header.m_Version         = GRAPH_VERSION;
+    header.m_NumNodes        = static_cast<u32>(m_nodes.size());
+    header.m_NumEdges        = static_cast<u32>(m_edges.size());
+    header.m_NumReverseNodes = static_cast<u32>(m_reverse_nodes.size());
+
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    write_vector(stream, m_nodes);
+    write_vector(stream, m_edges);
+    write_vector(stream, m_reverse_nodes);
+    write_vector(stream, m_reverse_edges);
+    return !stream.fail();
+}
+
+std::vector<u32> DependencyGraph::get_dependencies(u32 namehash) const
+{
+    const auto [begin, end] = find_edges(m_nodes, m_edges, namehash);
+    return std::vector<u32>(begin, end);
+}
+
+std::vector<u32> DependencyGraph::get_referrers(u32 namehash) const
+{
+    const auto [begin, end] = find_edges(m_reverse_nodes, m_reverse_edges, namehash);
+    return std::vector<u32>(begin, end);
+}
+
+std::vector<u32> DependencyGraph::get_all_dependencies(u32 namehash, u32 limit) const
+{
+    return walk(m_nodes, m_edges, namehash, limit);
+}
+
+std::vector<u32> DependencyGraph::get_all_referrers(u32 namehash, u32 limit) const
+{
+    return walk(m_reverse_nodes, m_reverse_edges, namehash, limit);
+}
+} // namespace jcmr
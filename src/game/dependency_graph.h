@@ -0,0 +1,56 @@
+#ifndef JCMR_GAME_DEPENDENCY_GRAPH_H_HEADER_GUARD
+#define JCMR_GAME_DEPENDENCY_GRAPH_H_HEADER_GUARD
+
+#include "platform.h"
+
+namespace jcmr
+{
+struct ResourceManager;
+
+// which files every file pulls in, across the game archives. edges go from the referrer to the referenced namehash:
+//  rbm           - texture paths in the render blocks
+//  modelc        - the meshc and the material textures
+//  meshc         - the hrmeshc
+//  blo, epe      - hash and string variants which name a file in the dictionary (model, skeleton, filepath, ...)
+// stored as two adjacency lists (forward and reverse) so both directions are a binary search and a range.
+struct DependencyGraph {
+    static constexpr u32 GRAPH_MAGIC   = 0x47504544; // DEPG
+    static constexpr u32 GRAPH_VERSION = 1;
+
+    struct Node {
+        u32 m_NameHash;
+        u32 m_FirstEdge; // edges are [m_FirstEdge, next node m_FirstEdge)
+    };
+
+    // the texture paths in a .rbm or .modelc, read from the file itself so the graph isn't needed. .hmddsc sources
+    // aren't included and paths can repeat. false for other file types.
+    static bool get_texture_paths(const std::string& filename, const ByteArray& buffer,
+                                  std::vector<std::string>* out_paths);
+
+    bool build(ResourceManager& resource_manager);
+    bool load(const std::filesystem::path& filename);
+    bool save(const std::filesystem::path& filename) const;
+
+    // direct edges only
+    std::vector<u32> get_dependencies(u32 namehash) const;
+    std::vector<u32> get_referrers(u32 namehash) const;
+
+    // breadth first, so the closest files come first. namehash itself isn't included. limit of 0 for no limit.
+    std::vector<u32> get_all_dependencies(u32 namehash, u32 limit = 0) const;
+    std::vector<u32> get_all_referrers(u32 namehash, u32 limit = 0) const;
+
+    u32 get_num_nodes() const { return static_cast<u32>(m_nodes.empty() ? 0 : (m_nodes.size() - 1)); }
+    u32 get_num_edges() const { return static_cast<u32>(m_edges.size()); }
+
+  private:
+    bool validate() const;
+
+  private:
+    std::vector<Node> m_nodes; // sorted by namehash, the last node is a sentinel
+    std::vector<u32>  m_edges;
+    std::vector<Node> m_reverse_nodes;
+    std::vector<u32>  m_reverse_edges;
+};
+} // namespace jcmr
+
+#endif // JCMR_GAME_DEPENDENCY_GRAPH_H_HEADER_GUARD
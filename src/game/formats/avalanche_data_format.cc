@@ -77,6 +77,7 @@ struct AvalancheDataFormatImpl final : AvalancheDataFormat {
         auto adf = std::make_unique<ava::AvalancheDataFormat::ADF>(buffer);
         generate_adf_source_code(filename, adf.get());
         m_adfs.insert({filename, std::move(adf)});
+        m_app.notify_loaded_state_changed();
         return true;
     }
 
@@ -85,6 +86,7 @@ struct AvalancheDataFormatImpl final : AvalancheDataFormat {
         auto iter = m_adfs.find(filename);
         if (iter == m_adfs.end()) return;
         m_adfs.erase(iter);
+        m_app.notify_loaded_state_changed();
     }
 
     bool save(const std::string& filename, ByteArray* out_buffer) override { return false; }
@@ -216,6 +218,7 @@ struct AvalancheDataFormatImpl final : AvalancheDataFormat {
         out_stream.close();
 
         m_adfs.erase(iter);
+        m_app.notify_loaded_state_changed();
         return true;
     }
 
@@ -454,6 +454,7 @@ struct AvalancheModelFormatImpl final : AvalancheModelFormat {
         AVA_FL_ENSURE(ava::AvalancheModelFormat::ParseModelc(buffer, &adf, &model), false);
 
         m_models.insert({filename, std::make_unique<AmfModelInstance>(m_app, adf, model)});
+        m_app.notify_loaded_state_changed();
         return true;
     }
 
@@ -472,6 +473,7 @@ struct AvalancheModelFormatImpl final : AvalancheModelFormat {
 #endif
 
         m_models.erase(iter);
+        m_app.notify_loaded_state_changed();
     }
 
     bool save(const std::string& filename, ByteArray* out_buffer) override
@@ -482,6 +484,13 @@ struct AvalancheModelFormatImpl final : AvalancheModelFormat {
 
     bool is_loaded(const std::string& filename) const override { return m_models.find(filename) != m_models.end(); }
 
+    // the export runs in the background, it's only false if another export is still running
+    bool export_to(const std::string& filename, const std::filesystem::path& path) override
+    {
+        LOG_INFO("AvalancheModelFormat -> export_to({}, {})", filename, path.generic_string());
+        return m_app.get_ui().export_model(filename, path);
+    }
+
   private:
     App& m_app;
 
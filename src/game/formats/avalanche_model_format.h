@@ -13,6 +13,9 @@ namespace game::format
         static AvalancheModelFormat* create(App& app);
         static void                  destroy(AvalancheModelFormat* instance);
 
+        // the model and every texture it uses
+        bool can_be_exported() const override { return true; }
+
         std::vector<const char*> get_extensions() override { return {"modelc"}; }
     };
 
@@ -8,6 +8,7 @@
 #include "game/game.h"
 #include "game/render_block.h"
 #include "game/resource_manager.h"
+#include "game/texture_export.h"
 
 #include "render/renderer.h"
 #include "render/texture.h"
@@ -77,6 +78,7 @@ struct AvalancheTextureImpl final : AvalancheTexture {
 
         auto texture = m_app.get_game()->create_texture(filename);
         m_textures.insert({filename, std::move(texture)});
+        m_app.notify_loaded_state_changed();
         return true;
     }
 
@@ -85,6 +87,7 @@ struct AvalancheTextureImpl final : AvalancheTexture {
         auto iter = m_textures.find(filename);
         if (iter == m_textures.end()) return;
         m_textures.erase(iter);
+        m_app.notify_loaded_state_changed();
     }
 
     bool save(const std::string& filename, ByteArray* out_buffer) override
@@ -95,6 +98,17 @@ struct AvalancheTextureImpl final : AvalancheTexture {
 
     bool is_loaded(const std::string& filename) const override { return m_textures.find(filename) != m_textures.end(); }
 
+    bool export_to(const std::string& filename, const std::filesystem::path& path) override
+    {
+        LOG_INFO("AvalancheTexture -> export_to({}, {})", filename, path.generic_string());
+
+        // decoded on the cpu, the texture doesn't need to be open in a viewer
+        auto export_filename = path / std::filesystem::path(filename).filename();
+        export_filename.replace_extension(image_writer::get_extension(image_writer::E_IMAGE_TYPE_PNG));
+        return texture_export::export_to(*m_app.get_game()->get_resource_manager(), filename, export_filename,
+                                         image_writer::E_IMAGE_TYPE_PNG);
+    }
+
   private:
     App& m_app;
 
@@ -16,6 +16,8 @@ namespace game::format
 
         const char* get_filetype_icon() const override { return ICON_FA_FILE_IMAGE; }
 
+        bool can_be_exported() const override { return true; }
+
         std::vector<const char*> get_extensions() override { return {"ddsc"}; }
         u32                      get_header_magic() const override { return ava::AvalancheTexture::AVTX_MAGIC; }
     };
@@ -36,6 +36,8 @@ struct ExportedEntityArchive {
 
     void build_tree()
     {
+        tree.clear();
+
         for (auto& entry : entries) {
             tree.add(entry.m_Filename);
         }
@@ -118,6 +120,7 @@ struct ExportedEntityImpl final : ExportedEntity {
             std::lock_guard<decltype(m_decompression_mutex)> _lock(m_decompression_mutex);
             m_decompression_queue.push(std::make_pair(filename, std::move(buffer)));
             m_archives.insert({filename, ExportedEntityArchive()});
+            m_app.notify_loaded_state_changed();
             return true;
         }
 
@@ -129,6 +132,7 @@ struct ExportedEntityImpl final : ExportedEntity {
         auto iter = m_archives.find(filename);
         if (iter == m_archives.end()) return;
         m_archives.erase(iter);
+        m_app.notify_loaded_state_changed();
     }
 
     bool save(const std::string& filename, ByteArray* out_buffer) override
@@ -199,6 +203,7 @@ struct ExportedEntityImpl final : ExportedEntity {
         }
 
         m_archives.erase(iter);
+        m_app.notify_loaded_state_changed();
         return true;
     }
 
@@ -261,6 +266,7 @@ struct ExportedEntityImpl final : ExportedEntity {
         }
 
         m_archives.insert({filename, ExportedEntityArchive(std::move(buffer), std::move(entries))});
+        m_app.notify_loaded_state_changed();
         return true;
     }
 
@@ -47,6 +47,14 @@ struct RenderBlockModelImpl final : RenderBlockModel {
                                 m_app.save_file(this, render_block.first, "dropzone");
                             }
 
+                            // export the model with its textures
+                            if (ImGui::Selectable(ICON_FA_FILE_EXPORT " Export with textures...")) {
+                                std::filesystem::path path;
+                                if (os::get_open_folder(os::FileDialogParams{}, &path)) {
+                                    export_to(render_block.first, path);
+                                }
+                            }
+
                             // close
                             ImGui::Separator();
                             if (ImGui::Selectable(ICON_FA_WINDOW_CLOSE " Close")) {
@@ -136,6 +144,7 @@ struct RenderBlockModelImpl final : RenderBlockModel {
 
             render_blocks.shrink_to_fit(); // because we might have failed to create some blocks.
             m_render_blocks.insert({filename, std::move(render_blocks)});
+            m_app.notify_loaded_state_changed();
         }
 
         m_app.get_renderer().add_to_renderlist(m_render_blocks[filename]);
@@ -155,6 +164,7 @@ struct RenderBlockModelImpl final : RenderBlockModel {
         }
 
         m_render_blocks.erase(iter);
+        m_app.notify_loaded_state_changed();
     }
 
     bool save(const std::string& filename, ByteArray* out_buffer) override
@@ -194,6 +204,13 @@ struct RenderBlockModelImpl final : RenderBlockModel {
         return m_render_blocks.find(filename) != m_render_blocks.end();
     }
 
+    // the export runs in the background, it's only false if another export is still running
+    bool export_to(const std::string& filename, const std::filesystem::path& path) override
+    {
+        LOG_INFO("RenderBlockModel -> export_to({}, {})", filename, path.generic_string());
+        return m_app.get_ui().export_model(filename, path);
+    }
+
   private:
     App& m_app;
 
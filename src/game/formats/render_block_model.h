@@ -13,6 +13,9 @@ namespace game::format
         static RenderBlockModel* create(App& app);
         static void              destroy(RenderBlockModel* instance);
 
+        // the model and every texture it uses
+        bool can_be_exported() const override { return true; }
+
         std::vector<const char*> get_extensions() override { return {"rbm", "lod"}; }
         // u32 get_header_magic() const override { ava::RenderBlockModel::MAGIC }
     };
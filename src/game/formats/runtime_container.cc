@@ -1,6 +1,8 @@
 #include "pch.h"
 
 #include "runtime_container.h"
+#include "runtime_container_variant_types.h"
+#include "runtime_container_view.h"
 
 #include "app/app.h"
 
@@ -14,6 +16,7 @@
 
 #include <imgui.h>
 #include <sstream>
+#include <unordered_set>
 
 namespace jcmr::game::format
 {
@@ -55,345 +58,474 @@ static const char* variant_data_type_to_string(u32 datatype)
 }
 
 struct RuntimeContainerWrapper {
-    RuntimeContainerWrapper() = delete;
-    explicit RuntimeContainerWrapper(const ava::RuntimePropertyContainer::Container& container)
-        : m_container(std::move(container))
-    {
-        update_container_display_names(m_container);
-    }
+    using Node    = RuntimeContainerView::Node;
+    using Variant = RuntimeContainerView::Variant;
 
-    void render() { render(m_container); }
+    enum Mat4x4Part : u8 {
+        MAT4x4_PART_TRANSLATION = 0,
+        MAT4x4_PART_ROTATION,
+        MAT4x4_PART_SCALE,
 
-    void render(ava::RuntimePropertyContainer::Container& container)
-    {
-        using namespace ava::RuntimePropertyContainer;
+        MAT4x4_PART_COUNT,
+    };
 
-        ImGui::PushID((void*)&container);
+    // a single line in the flattened tree of open containers
+    struct Row {
+        enum Type : u8 {
+            ROW_CONTAINER = 0,
+            ROW_VARIANT,
+        };
 
-        u32 flags = ImGuiTreeNodeFlags_SpanAvailWidth;
+        u8                                   m_Type       = ROW_CONTAINER;
+        u8                                   m_Part       = 0; // Mat4x4Part for mat4x4 variants
+        u16                                  m_Depth      = 0;
+        u16                                  m_Index      = 0;  // index in the parent container
+        u16                                  m_Occurrence = 0;  // earlier variants in the parent with the same name
+        i32                                  m_Parent     = -1; // row index of the parent container
+        const std::string*                   m_Label      = nullptr;
+        const RuntimeContainer::VariantData* m_Data       = nullptr;
+        const char*                          m_TypeName   = "";
+        Node                                 m_Node;
+        Variant                              m_Variant;
+    };
 
-        // open the root tree by default
-        static auto s_root_container_hash = "root"_hash_little;
-        if (container.m_NameHash == s_root_container_hash) {
-            flags |= ImGuiTreeNodeFlags_DefaultOpen;
+    RuntimeContainerWrapper() = delete;
+    explicit RuntimeContainerWrapper(ByteArray&& buffer)
+        : m_buffer(std::move(buffer))
+        , m_view(m_buffer)
+    {
+        // open the root container by default
+        auto root = m_view.root();
+        if (root.m_NameHash == "root"_hash_little) {
+            m_open_containers.insert(root.m_Offset);
         }
+    }
 
-        auto title = get_container_display_name(&container);
-        if (ImGui::TreeNodeEx(title.c_str(), flags)) {
-            // draw variants
-            if (ImGuiEx::BeginWidgetTableLayout()) {
-                for (auto& variant : container.m_Variants) {
-                    // skip unassigned variants
-                    if (variant.m_Type == T_VARIANT_UNASSIGNED) continue;
+    RuntimeContainerWrapper(const RuntimeContainerWrapper&) = delete;
+    RuntimeContainerWrapper& operator=(const RuntimeContainerWrapper&) = delete;
 
-                    ImGui::TableNextRow();
-                    ImGui::TableNextColumn();
+    bool is_valid() const { return m_view.is_valid(); }
 
-                    auto& [label, is_unknown, datatype] = get_variant_data(variant.m_NameHash);
+    void render()
+    {
+        if (m_rows_dirty) {
+            rebuild_rows();
+        }
 
-                    if (is_unknown) ImGui::PushStyleColor(ImGuiCol_Text, {0.53f, 0.53f, 0.53f, 1.0f});
-                    ImGuiEx::Label("%s", label.c_str());
-                    if (is_unknown) ImGui::PopStyleColor();
+        if (ImGuiEx::BeginWidgetTableLayout()) {
+            // every row is a single frame high (mat4x4 variants are split over several rows) so the clipper only
+            // has to draw what is actually on screen
+            ImGuiListClipper clipper;
+            clipper.Begin(static_cast<i32>(m_rows.size()));
+            while (clipper.Step()) {
+                for (i32 i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+                    ImGui::TableNextRow();
+                    ImGui::PushID(i);
+                    render_row(m_rows[i]);
+                    ImGui::PopID();
+                }
+            }
 
-                    // if the current variant is unknown, left mouse click will copy the namehash to the clipboard
-                    // if (is_unknown && ImGui::IsMouseClicked(ImGuiMouseButton_Left)) {
-                    // }
+            clipper.End();
+        }
 
-                    // tooltip
-                    if (ImGui::IsItemHovered()) {
-                        ImGui::SetTooltip("%s%s - %s", label.c_str(), variant_data_type_to_string(datatype),
-                                          VariantTypeToString(variant.m_Type));
-                    }
+        ImGuiEx::EndWidgetTableLayout();
+    }
 
-                    ImGui::TableNextColumn();
+    void render_row(const Row& row)
+    {
+        using namespace ava::RuntimePropertyContainer;
 
-                    ImGui::PushID((void*)&variant);
-                    ImGui::SetNextItemWidth(-1);
+        ImGui::TableNextColumn();
 
-                    switch (variant.m_Type) {
-                        case T_VARIANT_INTEGER: {
-                            auto value = variant.as<i32>();
-                            if (ImGui::InputInt("", &value, 0, 0,
-                                                (datatype == RuntimeContainer::VARIANT_DATATYPE_HASH)
-                                                    ? ImGuiInputTextFlags_CharsHexadecimal
-                                                    : ImGuiInputTextFlags_CharsDecimal)) {
-                                variant.m_Value = value;
-                            }
+        const f32 indent = (row.m_Depth * ImGui::GetStyle().IndentSpacing);
+        if (indent > 0.0f) ImGui::Indent(indent);
 
-                            break;
-                        }
+        if (row.m_Type == Row::ROW_CONTAINER) {
+            const bool is_open = (m_open_containers.find(row.m_Node.m_Offset) != m_open_containers.end());
 
-                        case T_VARIANT_FLOAT: {
-                            auto value = variant.as<float>();
-                            if (ImGui::InputFloat("", &value)) {
-                                variant.m_Value = value;
-                            }
+            ImGui::AlignTextToFramePadding();
+            ImGui::SetNextItemOpen(is_open, ImGuiCond_Always);
+            if (ImGui::TreeNodeEx(row.m_Label->c_str(), ImGuiTreeNodeFlags_NoTreePushOnOpen) != is_open) {
+                toggle_container(row.m_Node);
+            }
 
-                            break;
-                        }
+            if (indent > 0.0f) ImGui::Unindent(indent);
+            return;
+        }
 
-                        case T_VARIANT_STRING: {
-                            auto value = variant.as<std::string>();
+        auto& [label, is_unknown, datatype] = *row.m_Data;
 
-                            char buf[1024] = {0};
-                            strcpy_s(buf, value.c_str());
-                            if (ImGui::InputText("", buf, lengthOf(buf))) {
-                                variant.m_Value = std::string(buf);
-                            }
+        // only the first row of a split variant gets a label
+        if (row.m_Part == 0) {
+            if (is_unknown) ImGui::PushStyleColor(ImGuiCol_Text, {0.53f, 0.53f, 0.53f, 1.0f});
+            ImGuiEx::Label("%s", label.c_str());
+            if (is_unknown) ImGui::PopStyleColor();
 
-                            break;
-                        }
+            // tooltip
+            if (ImGui::IsItemHovered()) {
+                ImGui::SetTooltip("%s%s - %s", label.c_str(), variant_data_type_to_string(datatype), row.m_TypeName);
+            }
+        }
 
-                        case T_VARIANT_VEC2: {
-                            auto value = variant.as<std::array<float, 2>>();
-                            if (ImGui::InputFloat2("", value.data())) {
-                                variant.m_Value = value;
-                            }
+        if (indent > 0.0f) ImGui::Unindent(indent);
 
-                            break;
-                        }
+        ImGui::TableNextColumn();
+        ImGui::SetNextItemWidth(-1);
 
-                        case T_VARIANT_VEC3: {
-                            // TODO : colours seem to be acting weird? might be something todo with how imgui is
-                            // treating
-                            //        them as we're getting float values 0-255, imgui is expecting 0-1?
-                            auto value = variant.as<std::array<float, 3>>();
-                            if ((datatype == RuntimeContainer::VARIANT_DATATYPE_COLOUR)
-                                    ? ImGuiEx::ColorButtonPicker3("", value.data())
-                                    : ImGui::InputFloat3("", value.data())) {
-                                variant.m_Value = value;
-                            }
+        update_path(row.m_Parent);
+        render_variant_value(row.m_Variant, row.m_Occurrence, datatype, row.m_Part);
+    }
 
-                            break;
-                        }
+    void render_variant_value(const Variant& variant, u16 occurrence, u32 datatype, u8 part)
+    {
+        using namespace ava::RuntimePropertyContainer;
 
-                        case T_VARIANT_VEC4: {
-                            // TODO : colours seem to be acting weird? might be something todo with how imgui is
-                            // treating
-                            //        them as we're getting float values 0-255, imgui is expecting 0-1?
-                            auto value = variant.as<std::array<float, 4>>();
-                            if ((datatype == RuntimeContainer::VARIANT_DATATYPE_COLOUR)
-                                    ? ImGuiEx::ColorButtonPicker4("", value.data())
-                                    : ImGui::InputFloat4("", value.data())) {
-                                variant.m_Value = value;
-                            }
+        // once the container has been edited, values come from the materialized tree instead of the raw buffer
+        auto* edited = find_materialized_variant(variant, occurrence);
+
+        switch (variant.m_Type) {
+            case T_VARIANT_INTEGER: {
+                auto value = (edited ? edited->as<i32>() : m_view.as_int(variant));
+                if (ImGui::InputInt("", &value, 0, 0,
+                                    (datatype == RuntimeContainer::VARIANT_DATATYPE_HASH)
+                                        ? ImGuiInputTextFlags_CharsHexadecimal
+                                        : ImGuiInputTextFlags_CharsDecimal)) {
+                    set_variant_value(variant, occurrence, value);
+                }
 
-                            break;
-                        }
+                break;
+            }
 
-                        case T_VARIANT_MAT4x4: {
-                            auto value = variant.as<std::array<float, 16>>();
+            case T_VARIANT_FLOAT: {
+                auto value = (edited ? edited->as<float>() : m_view.as_float(variant));
+                if (ImGui::InputFloat("", &value)) {
+                    set_variant_value(variant, occurrence, value);
+                }
 
-                            vec3 scale, translation, skew;
-                            vec4 perspective;
-                            quat orientation;
+                break;
+            }
 
-                            glm::decompose(glm::make_mat4(value.data()), scale, orientation, translation, skew,
-                                           perspective);
+            case T_VARIANT_STRING: {
+                auto value = (edited ? std::string_view(edited->as<std::string>()) : m_view.as_string(variant));
 
-                            ImGui::InputFloat3("Translation##translation", glm::value_ptr(translation));
+                char buf[1024] = {0};
+                value.copy(buf, (lengthOf(buf) - 1));
+                if (ImGui::InputText("", buf, lengthOf(buf))) {
+                    set_variant_value(variant, occurrence, std::string(buf));
+                }
 
-                            ImGui::SetNextItemWidth(-1);
-                            glm::vec3 euler = glm::eulerAngles(orientation) * glm::pi<float>() / 180.f;
-                            ImGui::InputFloat3("Rotation##rotation", glm::value_ptr(euler));
+                break;
+            }
 
-                            ImGui::SetNextItemWidth(-1);
-                            ImGui::InputFloat3("Scale##scale", glm::value_ptr(scale));
+            case T_VARIANT_VEC2: {
+                auto value = (edited ? edited->as<std::array<float, 2>>() : m_view.as_floats<2>(variant));
+                if (ImGui::InputFloat2("", value.data())) {
+                    set_variant_value(variant, occurrence, value);
+                }
 
-                            // ImGui::PushItemWidth(-1);
-                            // ImGui::InputFloat4("##m1", value.data());
-                            // ImGui::InputFloat4("##m2", &value.data()[4]);
-                            // ImGui::InputFloat4("##m3", &value.data()[8]);
-                            // ImGui::InputFloat4("##m4", &value.data()[12]);
-                            break;
-                        }
+                break;
+            }
 
-                        case T_VARIANT_VEC_INTS: {
-                            auto& value = variant.as<std::vector<i32>>();
-                            ImGui::Text("vec_ints (%d)", value.size());
-                            break;
-                        }
+            case T_VARIANT_VEC3: {
+                // TODO : colours seem to be acting weird? might be something todo with how imgui is treating
+                //        them as we're getting float values 0-255, imgui is expecting 0-1?
+                auto value = (edited ? edited->as<std::array<float, 3>>() : m_view.as_floats<3>(variant));
+                if ((datatype == RuntimeContainer::VARIANT_DATATYPE_COLOUR)
+                        ? ImGuiEx::ColorButtonPicker3("", value.data())
+                        : ImGui::InputFloat3("", value.data())) {
+                    set_variant_value(variant, occurrence, value);
+                }
 
-                        case T_VARIANT_VEC_FLOATS: {
-                            auto& value = variant.as<std::vector<float>>();
-                            ImGui::Text("vec_floats (%d)", value.size());
-                            break;
-                        }
+                break;
+            }
 
-                        case T_VARIANT_VEC_BYTES: {
-                            auto& value = variant.as<std::vector<u8>>();
-                            ImGui::Text("vec_bytes (%d)", value.size());
-                            break;
-                        }
+            case T_VARIANT_VEC4: {
+                // TODO : colours seem to be acting weird? might be something todo with how imgui is treating
+                //        them as we're getting float values 0-255, imgui is expecting 0-1?
+                auto value = (edited ? edited->as<std::array<float, 4>>() : m_view.as_floats<4>(variant));
+                if ((datatype == RuntimeContainer::VARIANT_DATATYPE_COLOUR)
+                        ? ImGuiEx::ColorButtonPicker4("", value.data())
+                        : ImGui::InputFloat4("", value.data())) {
+                    set_variant_value(variant, occurrence, value);
+                }
 
-                        case T_VARIANT_OBJECTID: {
-                            auto value = variant.as<ava::SObjectID>().to_uint64();
-                            if (ImGui::InputScalar("", ImGuiDataType_U64, (void*)&value, nullptr, nullptr, "%016llX",
-                                                   ImGuiInputTextFlags_CharsHexadecimal)) {
-                                variant.m_Value = ava::SObjectID(value);
-                            }
+                break;
+            }
 
-                            break;
-                        }
+            case T_VARIANT_MAT4x4: {
+                auto value = (edited ? edited->as<std::array<float, 16>>() : m_view.as_floats<16>(variant));
 
-                        case T_VARIANT_VEC_EVENTS: {
-                            auto& value = variant.as<std::vector<ava::SObjectID>>();
-                            ImGui::Text("vec_events (%d)", value.size());
-                            for (auto i = 0; i < value.size(); ++i) {
-
-                                // auto val = value[i].to_uint64();
-                                // if (ImGui::InputScalar("", ImGuiDataType_U64, (void*)&val, nullptr, nullptr,
-                                // "%016llX",
-                                //                        ImGuiInputTextFlags_CharsHexadecimal)) {
-                                //     value[i]        = ava::SObjectID(val);
-                                //     variant.m_Value = value;
-                                // }
-
-                                // ImGui::TableNextRow();
-                                // ImGui::TableNextColumn();
-                                // ImGui::TableNextColumn();
-                                // ImGui::SetNextItemWidth(-1);
-                            }
+                vec3 scale, translation, skew;
+                vec4 perspective;
+                quat orientation;
 
-                            break;
-                        }
-                    }
+                glm::decompose(glm::make_mat4(value.data()), scale, orientation, translation, skew, perspective);
 
-                    ImGui::PopID();
+                if (part == MAT4x4_PART_TRANSLATION) {
+                    ImGui::InputFloat3("Translation##translation", glm::value_ptr(translation));
+                } else if (part == MAT4x4_PART_ROTATION) {
+                    glm::vec3 euler = glm::eulerAngles(orientation) * glm::pi<float>() / 180.f;
+                    ImGui::InputFloat3("Rotation##rotation", glm::value_ptr(euler));
+                } else {
+                    ImGui::InputFloat3("Scale##scale", glm::value_ptr(scale));
                 }
+                break;
             }
 
-            ImGuiEx::EndWidgetTableLayout();
+            case T_VARIANT_VEC_INTS: {
+                auto count = (edited ? edited->as<std::vector<i32>>().size() : m_view.as_array_count(variant));
+                ImGui::Text("vec_ints (%d)", count);
+                break;
+            }
 
-            // draw child containers
-            for (auto& child : container.m_Containers) {
-                render(child);
+            case T_VARIANT_VEC_FLOATS: {
+                auto count = (edited ? edited->as<std::vector<float>>().size() : m_view.as_array_count(variant));
+                ImGui::Text("vec_floats (%d)", count);
+                break;
             }
 
-            ImGui::TreePop();
-        }
+            case T_VARIANT_VEC_BYTES: {
+                auto count = (edited ? edited->as<std::vector<u8>>().size() : m_view.as_array_count(variant));
+                ImGui::Text("vec_bytes (%d)", count);
+                break;
+            }
+
+            case T_VARIANT_OBJECTID: {
+                auto value = (edited ? edited->as<ava::SObjectID>().to_uint64() : m_view.as_object_id(variant));
+                if (ImGui::InputScalar("", ImGuiDataType_U64, (void*)&value, nullptr, nullptr, "%016llX",
+                                       ImGuiInputTextFlags_CharsHexadecimal)) {
+                    set_variant_value(variant, occurrence, ava::SObjectID(value));
+                }
 
-        ImGui::PopID();
+                break;
+            }
+
+            case T_VARIANT_VEC_EVENTS: {
+                auto count =
+                    (edited ? edited->as<std::vector<ava::SObjectID>>().size() : m_view.as_array_count(variant));
+                ImGui::Text("vec_events (%d)", count);
+                break;
+            }
+        }
     }
 
-    const std::string& get_container_display_name(ava::RuntimePropertyContainer::Container* container)
+    const std::string& get_container_display_name(const Node& node)
     {
-        auto iter = m_container_names.find(container);
+        auto iter = m_container_names.find(node.m_Offset);
         if (iter != m_container_names.end()) {
             return (*iter).second;
         }
 
-        // cache the name from the lookup table
-        m_container_names.insert({container, find_in_namehash_lookup_table(container->m_NameHash)});
-        return m_container_names[container];
-    }
-
-    const RuntimeContainer::VariantData& get_variant_data(u32 namehash)
-    {
-        auto iter = m_variant_names.find(namehash);
-        return (*iter).second;
-    }
+        using namespace ava::RuntimePropertyContainer;
 
-    const ava::RuntimePropertyContainer::Container& get_container() const { return m_container; }
+        auto name       = m_view.find_variant(node, "name"_hash_little);
+        auto class_name = m_view.find_variant(node, "_class"_hash_little);
+        auto class_hash = m_view.find_variant(node, "_class_hash"_hash_little);
 
-  private:
-    void update_container_display_names(ava::RuntimePropertyContainer::Container& container)
-    {
-        auto& name       = container.GetVariant("name"_hash_little, false);
-        auto& class_name = container.GetVariant("_class"_hash_little, false);
-        auto& class_hash = container.GetVariant("_class_hash"_hash_little, false);
+        const bool has_name       = (name.valid() && name.m_Type == T_VARIANT_STRING);
+        const bool has_class_name = (class_name.valid() && class_name.m_Type == T_VARIANT_STRING);
+        const bool has_class_hash = (class_hash.valid() && class_hash.m_Type == T_VARIANT_INTEGER);
 
         std::stringstream display_name;
 
         // append class_name or class_hash
-        if (class_name.valid()) {
-            display_name << class_name.as<std::string>() << " - ";
-        } else if (class_hash.valid()) {
-            display_name << find_in_namehash_lookup_table(class_hash.as<i32>()) << " - ";
+        if (has_class_name) {
+            display_name << m_view.as_string(class_name) << " - ";
+        } else if (has_class_hash) {
+            display_name << find_in_namehash_lookup_table(m_view.as_int(class_hash)) << " - ";
         }
 
         // add real name
-        if (name.valid()) {
-            display_name << name.as<std::string>();
+        if (has_name) {
+            display_name << m_view.as_string(name);
         } else {
-            display_name << find_in_namehash_lookup_table(container.m_NameHash);
+            display_name << find_in_namehash_lookup_table(node.m_NameHash);
         }
 
         // fallback to the class_hash or container namehash if the final string is still empty
         if (display_name.str().empty()) {
-            if (class_hash.valid()) {
-                display_name << fmt::format("Class 0x{:X}", class_hash.as<i32>());
+            if (has_class_hash) {
+                display_name << fmt::format("Class 0x{:X}", m_view.as_int(class_hash));
             } else {
-                display_name << fmt::format("0x{:X}", container.m_NameHash);
+                display_name << fmt::format("0x{:X}", node.m_NameHash);
             }
         }
 
-        m_container_names.insert({&container, display_name.str()});
+        return (*m_container_names.insert({node.m_Offset, display_name.str()}).first).second;
+    }
 
-        for (auto& variant : container.m_Variants) {
-            update_variant_display_names(variant);
+    const RuntimeContainer::VariantData& get_variant_data(u32 namehash)
+    {
+        auto iter = m_variant_names.find(namehash);
+        if (iter != m_variant_names.end()) {
+            return (*iter).second;
         }
 
-        for (auto& child_container : container.m_Containers) {
-            update_container_display_names(child_container);
+        std::string name(find_in_namehash_lookup_table(namehash));
+        bool        is_unknown = false;
+
+        if (name.empty()) {
+            name       = fmt::format("0x{:X}", namehash);
+            is_unknown = true;
         }
+
+        const u32 datatype = get_variant_datatype(namehash);
+        return (*m_variant_names.insert({namehash, std::make_tuple(name, is_unknown, datatype)}).first).second;
     }
 
-    // known variants that contain hashes
-    static inline std::array s_hash_keys{
-        "ragdoll"_hash_little,  "skeleton"_hash_little,   "model"_hash_little,
-        "filepath"_hash_little, "layer_name"_hash_little, "EffectUsage"_hash_little,
-    };
+    bool write(ByteArray* out_buffer) const
+    {
+        // nothing was edited, the original buffer is still valid
+        if (!m_materialized) {
+            *out_buffer = m_buffer;
+            return true;
+        }
 
-    // known variants that contain guids
-    static inline std::array s_guid_keys{
-        "Sound"_hash_little,
-        "FMODEvent"_hash_little,
-    };
+        AVA_FL_ENSURE(ava::RuntimePropertyContainer::Write(*m_materialized, 1, out_buffer), false);
+        return true;
+    }
 
-    // known variants that contain colours
-    static inline std::array s_colour_keys{
-        "diffuse"_hash_little,
-    };
+  private:
+    void rebuild_rows()
+    {
+        m_rows.clear();
+        m_rows_dirty = false;
 
-#define IS_KNOWN_KEY(array) std::find(array.begin(), array.end(), variant.m_NameHash) != array.end()
+        auto root = m_view.root();
+        if (root.valid()) {
+            add_container_rows(root, 0, 0, -1);
+        }
+    }
 
-    void update_variant_display_names(ava::RuntimePropertyContainer::Variant& variant)
+    void add_container_rows(const Node& node, u16 index, u16 depth, i32 parent)
     {
-        if (m_variant_names.find(variant.m_NameHash) != m_variant_names.end()) {
+        using namespace ava::RuntimePropertyContainer;
+
+        const auto row_index = static_cast<i32>(m_rows.size());
+
+        Row row;
+        row.m_Type   = Row::ROW_CONTAINER;
+        row.m_Depth  = depth;
+        row.m_Index  = index;
+        row.m_Parent = parent;
+        row.m_Label  = &get_container_display_name(node);
+        row.m_Node   = node;
+        m_rows.push_back(row);
+
+        // collapsed containers only need their own row
+        if (m_open_containers.find(node.m_Offset) == m_open_containers.end()) {
             return;
         }
 
-        std::string name       = find_in_namehash_lookup_table(variant.m_NameHash);
-        bool        is_unknown = false;
-        u32         datatype   = RuntimeContainer::VARIANT_DATATYPE_COUNT;
+        std::unordered_map<u32, u16> occurrences;
+        for (u16 i = 0; i < node.m_NumVariants; ++i) {
+            auto variant = m_view.variant(node, i);
+            if (!variant.valid()) continue;
+
+            // unassigned variants still count, the materialized container keeps them
+            const u16 occurrence = occurrences[variant.m_NameHash]++;
+
+            // skip unassigned variants
+            if (variant.m_Type == T_VARIANT_UNASSIGNED) continue;
+
+            Row variant_row;
+            variant_row.m_Type       = Row::ROW_VARIANT;
+            variant_row.m_Depth      = (depth + 1);
+            variant_row.m_Index      = i;
+            variant_row.m_Occurrence = occurrence;
+            variant_row.m_Parent     = row_index;
+            variant_row.m_Data       = &get_variant_data(variant.m_NameHash);
+            variant_row.m_TypeName   = VariantTypeToString(static_cast<EVariantType>(variant.m_Type));
+            variant_row.m_Variant    = variant;
+
+            const u8 num_parts = (variant.m_Type == T_VARIANT_MAT4x4 ? MAT4x4_PART_COUNT : 1);
+            for (u8 part = 0; part < num_parts; ++part) {
+                variant_row.m_Part = part;
+                m_rows.push_back(variant_row);
+            }
+        }
 
-        if (name.empty()) {
-            name       = fmt::format("0x{:X}", variant.m_NameHash);
-            is_unknown = true;
+        for (u16 i = 0; i < node.m_NumContainers; ++i) {
+            auto child = m_view.child(node, i);
+            if (child.valid()) {
+                add_container_rows(child, i, (depth + 1), row_index);
+            }
+        }
+    }
+
+    void toggle_container(const Node& node)
+    {
+        auto iter = m_open_containers.find(node.m_Offset);
+        if (iter != m_open_containers.end()) {
+            m_open_containers.erase(iter);
+        } else {
+            m_open_containers.insert(node.m_Offset);
         }
 
-        static auto string_contains = [](const std::string_view& haystack, const std::string_view& needle) -> bool {
-            auto it = std::search(haystack.begin(), haystack.end(), needle.begin(), needle.end(),
-                                  [](char ch1, char ch2) { return toupper(ch1) == toupper(ch2); });
-            return (it != haystack.end());
-        };
+        // rows are rebuilt next frame, the current row list is still being drawn
+        m_rows_dirty = true;
+    }
 
-        if (IS_KNOWN_KEY(s_hash_keys) || string_contains(name, "hash")) {
-            datatype = RuntimeContainer::VARIANT_DATATYPE_HASH;
-        } else if (IS_KNOWN_KEY(s_guid_keys)) {
-            datatype = RuntimeContainer::VARIANT_DATATYPE_GUID;
-        } else if (IS_KNOWN_KEY(s_colour_keys) || string_contains(name, "color")) {
-            datatype = RuntimeContainer::VARIANT_DATATYPE_COLOUR;
+    // walk up the parent rows to get the child indices of a container, used to find materialized variants
+    void update_path(i32 row_index)
+    {
+        m_path.clear();
+        for (i32 i = row_index; (i >= 0 && m_rows[i].m_Parent >= 0); i = m_rows[i].m_Parent) {
+            m_path.push_back(m_rows[i].m_Index);
         }
 
-        m_variant_names.insert({variant.m_NameHash, std::make_tuple(name, is_unknown, datatype)});
+        std::reverse(m_path.begin(), m_path.end());
+    }
+
+    // find the variant in the materialized tree using the child indices of the container currently being rendered.
+    // variants can share a name, so it's the nth one with the name (and it has to be the same type)
+    ava::RuntimePropertyContainer::Variant* find_materialized_variant(const Variant& variant, u16 occurrence)
+    {
+        if (!m_materialized) return nullptr;
+
+        auto* container = m_materialized.get();
+        for (auto index : m_path) {
+            if (index >= container->m_Containers.size()) return nullptr;
+            container = &container->m_Containers[index];
+        }
+
+        for (auto& item : container->m_Variants) {
+            if (item.m_NameHash != variant.m_NameHash || occurrence-- != 0) continue;
+            return (static_cast<u8>(item.m_Type) == variant.m_Type ? &item : nullptr);
+        }
+
+        return nullptr;
+    }
+
+    // the first edit parses the full container, everything before that is read straight from the buffer
+    template <typename T> void set_variant_value(const Variant& variant, u16 occurrence, T&& value)
+    {
+        if (!m_materialized) {
+            auto container = std::make_unique<ava::RuntimePropertyContainer::Container>();
+            if (!AVA_FL_SUCCEEDED(ava::RuntimePropertyContainer::Parse(m_buffer, container.get()))) {
+                LOG_ERROR("RuntimeContainer : failed to parse container for editing.");
+                return;
+            }
+
+            m_materialized = std::move(container);
+        }
+
+        if (auto* target = find_materialized_variant(variant, occurrence)) {
+            target->m_Value = std::forward<T>(value);
+        }
     }
 
   private:
-    ava::RuntimePropertyContainer::Container                                   m_container;
-    std::unordered_map<ava::RuntimePropertyContainer::Container*, std::string> m_container_names;
-    std::unordered_map<u32, RuntimeContainer::VariantData>                     m_variant_names;
+    ByteArray                                                 m_buffer;
+    RuntimeContainerView                                      m_view;
+    std::unique_ptr<ava::RuntimePropertyContainer::Container> m_materialized = nullptr;
+    std::vector<u16>                                          m_path;
+    std::vector<Row>                                          m_rows;
+    std::unordered_set<u32>                                   m_open_containers;
+    bool                                                      m_rows_dirty = true;
+    std::unordered_map<u32, std::string>                      m_container_names;
+    std::unordered_map<u32, RuntimeContainer::VariantData>    m_variant_names;
 };
 
 struct RuntimeContainerImpl final : RuntimeContainer {
@@ -455,10 +587,15 @@ struct RuntimeContainerImpl final : RuntimeContainer {
             return false;
         }
 
-        ava::RuntimePropertyContainer::Container container{};
-        AVA_FL_ENSURE(ava::RuntimePropertyContainer::Parse(buffer, &container), false);
+        // the buffer is kept as-is, containers are only decoded when the editor needs them
+        auto iter = m_containers.try_emplace(filename, std::move(buffer)).first;
+        if (!(*iter).second.is_valid()) {
+            LOG_ERROR("RuntimeContainer : \"{}\" is not a valid runtime container.", filename);
+            m_containers.erase(iter);
+            return false;
+        }
 
-        m_containers.insert({filename, RuntimeContainerWrapper(std::move(container))});
+        m_app.notify_loaded_state_changed();
         return true;
     }
 
@@ -467,6 +604,7 @@ struct RuntimeContainerImpl final : RuntimeContainer {
         auto iter = m_containers.find(filename);
         if (iter == m_containers.end()) return;
         m_containers.erase(iter);
+        m_app.notify_loaded_state_changed();
     }
 
     bool save(const std::string& filename, ByteArray* out_buffer) override
@@ -474,9 +612,7 @@ struct RuntimeContainerImpl final : RuntimeContainer {
         auto iter = m_containers.find(filename);
         if (iter == m_containers.end()) return false;
 
-        auto& runtime_container = (*iter).second.get_container();
-        AVA_FL_ENSURE(ava::RuntimePropertyContainer::Write(runtime_container, 1, out_buffer), false);
-        return true;
+        return (*iter).second.write(out_buffer);
     }
 
     bool is_loaded(const std::string& filename) const override
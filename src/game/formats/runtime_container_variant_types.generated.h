@@ -0,0 +1,82 @@
+// generated by build_rtpc_variant_types.py from assets/rtpc_variant_types.txt - do not edit!
+#ifndef JCMR_FORMATS_RUNTIME_CONTAINER_VARIANT_TYPES_GENERATED_H_HEADER_GUARD
+#define JCMR_FORMATS_RUNTIME_CONTAINER_VARIANT_TYPES_GENERATED_H_HEADER_GUARD
+
+namespace jcmr::game::format::variant_types
+{
+// 23 known variants
+// 0x1C89E5C6 guid FMODEvent
+// 0xED8714AF colour skidmark_color
+// 0x7D3A868C hash name_hash
+// 0x4EDEA68B colour TintColor2
+// 0xB9581621 hash EffectUsage
+// 0xF460ED4F colour diffuse
+// 0x90A5F97F hash layer_name
+// 0x92890535 colour fade_color
+// 0xC85A50E7 colour DebugColor
+// 0x00DDDF9D colour CColorMatrixFilter
+// 0xB498C27D hash filepath
+// 0x49F3CA26 colour Color
+// 0x0F94740B hash model
+// 0x26FA86FE hash skeleton
+// 0x66AE584D colour color_curves
+// 0xE276D842 colour CColorXForm
+// 0x1262BA81 colour TintColor3
+// 0xD04059E6 hash _class_hash
+// 0x932E9257 hash ragdoll
+// 0xCB0107EF colour dirt_color_factor
+// 0x897BD0FB colour color
+// 0x46A4CAC7 colour TintColor1
+// 0xCA6EC803 guid Sound
+
+static constexpr u32 TABLE_BITS  = 5;
+static constexpr u32 NUM_BUCKETS = 5;
+
+static constexpr u32 s_seeds[NUM_BUCKETS] = {
+    2, 48, 4, 2, 4,
+};
+
+static constexpr u32 s_keys[1 << TABLE_BITS] = {
+    0x1C89E5C6, 0xED8714AF, 0x7D3A868C, 0x4EDEA68B, 0xB9581621, 0xF460ED4F, 0x90A5F97F, 0x92890535,
+    0xC85A50E7, 0x00DDDF9D, 0xB498C27D, 0x49F3CA26, 0x00000000, 0x0F94740B, 0x26FA86FE, 0x00000000,
+    0x00000000, 0x66AE584D, 0x00000000, 0xE276D842, 0x00000000, 0x00000000, 0x00000000, 0x1262BA81,
+    0xD04059E6, 0x932E9257, 0xCB0107EF, 0x897BD0FB, 0x46A4CAC7, 0xCA6EC803, 0x00000000, 0x00000000,
+};
+
+static constexpr u8 s_datatypes[1 << TABLE_BITS] = {
+    RuntimeContainer::VARIANT_DATATYPE_GUID,
+    RuntimeContainer::VARIANT_DATATYPE_COLOUR,
+    RuntimeContainer::VARIANT_DATATYPE_HASH,
+    RuntimeContainer::VARIANT_DATATYPE_COLOUR,
+    RuntimeContainer::VARIANT_DATATYPE_HASH,
+    RuntimeContainer::VARIANT_DATATYPE_COLOUR,
+    RuntimeContainer::VARIANT_DATATYPE_HASH,
+    RuntimeContainer::VARIANT_DATATYPE_COLOUR,
+    RuntimeContainer::VARIANT_DATATYPE_COLOUR,
+    RuntimeContainer::VARIANT_DATATYPE_COLOUR,
+    RuntimeContainer::VARIANT_DATATYPE_HASH,
+    RuntimeContainer::VARIANT_DATATYPE_COLOUR,
+    RuntimeContainer::VARIANT_DATATYPE_COUNT,
+    RuntimeContainer::VARIANT_DATATYPE_HASH,
+    RuntimeContainer::VARIANT_DATATYPE_HASH,
+    RuntimeContainer::VARIANT_DATATYPE_COUNT,
+    RuntimeContainer::VARIANT_DATATYPE_COUNT,
+    RuntimeContainer::VARIANT_DATATYPE_COLOUR,
+    RuntimeContainer::VARIANT_DATATYPE_COUNT,
+    RuntimeContainer::VARIANT_DATATYPE_COLOUR,
+    RuntimeContainer::VARIANT_DATATYPE_COUNT,
+    RuntimeContainer::VARIANT_DATATYPE_COUNT,
+    RuntimeContainer::VARIANT_DATATYPE_COUNT,
+    RuntimeContainer::VARIANT_DATATYPE_COLOUR,
+    RuntimeContainer::VARIANT_DATATYPE_HASH,
+    RuntimeContainer::VARIANT_DATATYPE_HASH,
+    RuntimeContainer::VARIANT_DATATYPE_COLOUR,
+    RuntimeContainer::VARIANT_DATATYPE_COLOUR,
+    RuntimeContainer::VARIANT_DATATYPE_COLOUR,
+    RuntimeContainer::VARIANT_DATATYPE_GUID,
+    RuntimeContainer::VARIANT_DATATYPE_COUNT,
+    RuntimeContainer::VARIANT_DATATYPE_COUNT,
+};
+} // namespace jcmr::game::format::variant_types
+
+#endif // JCMR_FORMATS_RUNTIME_CONTAINER_VARIANT_TYPES_GENERATED_H_HEADER_GUARD
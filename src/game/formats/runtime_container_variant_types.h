@@ -0,0 +1,35 @@
+#ifndef JCMR_FORMATS_RUNTIME_CONTAINER_VARIANT_TYPES_H_HEADER_GUARD
+#define JCMR_FORMATS_RUNTIME_CONTAINER_VARIANT_TYPES_H_HEADER_GUARD
+
+#include "runtime_container.h"
+
+// known variant namehash -> datatype table. edit assets/rtpc_variant_types.txt and run build_rtpc_variant_types.py to
+// regenerate it.
+#include "runtime_container_variant_types.generated.h"
+
+namespace jcmr::game::format
+{
+namespace variant_types
+{
+    // must match slot_for in build_rtpc_variant_types.py
+    constexpr u32 get_slot(u32 namehash)
+    {
+        const u32 seed = s_seeds[namehash % NUM_BUCKETS];
+        return (static_cast<u32>((namehash ^ seed) * 0x9E3779B1u) >> (32 - TABLE_BITS));
+    }
+} // namespace variant_types
+
+// returns the datatype of a known variant, or RuntimeContainer::VARIANT_DATATYPE_COUNT
+constexpr u32 get_variant_datatype(u32 namehash)
+{
+    const u32 slot = variant_types::get_slot(namehash);
+    if (variant_types::s_keys[slot] != namehash) return RuntimeContainer::VARIANT_DATATYPE_COUNT;
+    return variant_types::s_datatypes[slot];
+}
+
+static_assert(get_variant_datatype(0x932E9257) /* ragdoll */ == RuntimeContainer::VARIANT_DATATYPE_HASH);
+static_assert(get_variant_datatype(0xCA6EC803) /* Sound */ == RuntimeContainer::VARIANT_DATATYPE_GUID);
+static_assert(get_variant_datatype(0xF460ED4F) /* diffuse */ == RuntimeContainer::VARIANT_DATATYPE_COLOUR);
+} // namespace jcmr::game::format
+
+#endif // JCMR_FORMATS_RUNTIME_CONTAINER_VARIANT_TYPES_H_HEADER_GUARD
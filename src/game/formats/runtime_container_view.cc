@@ -0,0 +1,137 @@
+#include "pch.h"
+
+#include "runtime_container_view.h"
+
+#include <limits>
+
+namespace jcmr::game::format
+{
+RuntimeContainerView::RuntimeContainerView(const u8* data, u64 size)
+    : m_data(data)
+    , m_size(size)
+{
+}
+
+bool RuntimeContainerView::is_valid() const
+{
+    Header header;
+    if (!read(0, &header)) return false;
+    if (header.m_Magic != ava::RuntimePropertyContainer::RTPC_MAGIC) return false;
+    if (header.m_Version != RTPC_VERSION) return false;
+    return root().valid();
+}
+
+RuntimeContainerView::Node RuntimeContainerView::root() const
+{
+    return read_node(sizeof(Header));
+}
+
+RuntimeContainerView::Node RuntimeContainerView::child(const Node& node, u16 index) const
+{
+    if (index >= node.m_NumContainers) return {};
+
+    // child container headers come after the variant headers, aligned to 4 bytes
+    u64 offset = (node.m_DataOffset + (node.m_NumVariants * sizeof(VariantHeader)));
+    offset     = ((offset + 3) & ~3ull);
+    offset += (index * sizeof(ContainerHeader));
+
+    if (offset > std::numeric_limits<u32>::max()) return {};
+    return read_node(static_cast<u32>(offset));
+}
+
+RuntimeContainerView::Variant RuntimeContainerView::variant(const Node& node, u16 index) const
+{
+    if (index >= node.m_NumVariants) return {};
+
+    u64           offset = (node.m_DataOffset + (index * sizeof(VariantHeader)));
+    VariantHeader header;
+    if (offset > std::numeric_limits<u32>::max() || !read(offset, &header)) return {};
+
+    Variant result;
+    result.m_Offset   = static_cast<u32>(offset);
+    result.m_NameHash = header.m_NameHash;
+    result.m_Data     = header.m_Data;
+    result.m_Type     = header.m_Type;
+    return result;
+}
+
+RuntimeContainerView::Variant RuntimeContainerView::find_variant(const Node& node, u32 namehash) const
+{
+    for (u16 i = 0; i < node.m_NumVariants; ++i) {
+        auto result = variant(node, i);
+        if (result.valid() && result.m_NameHash == namehash) {
+            return result;
+        }
+    }
+
+    return {};
+}
+
+i32 RuntimeContainerView::as_int(const Variant& variant) const
+{
+    ASSERT(variant.m_Type == ava::RuntimePropertyContainer::T_VARIANT_INTEGER);
+    return static_cast<i32>(variant.m_Data);
+}
+
+f32 RuntimeContainerView::as_float(const Variant& variant) const
+{
+    ASSERT(variant.m_Type == ava::RuntimePropertyContainer::T_VARIANT_FLOAT);
+
+    f32 result;
+    std::memcpy(&result, &variant.m_Data, sizeof(f32));
+    return result;
+}
+
+std::string_view RuntimeContainerView::as_string(const Variant& variant) const
+{
+    ASSERT(variant.m_Type == ava::RuntimePropertyContainer::T_VARIANT_STRING);
+
+    if (variant.m_Data >= m_size) return {};
+
+    auto* begin = reinterpret_cast<const char*>(m_data + variant.m_Data);
+    auto* end   = static_cast<const char*>(std::memchr(begin, 0, (m_size - variant.m_Data)));
+    if (!end) return {};
+
+    return std::string_view(begin, (end - begin));
+}
+
+u64 RuntimeContainerView::as_object_id(const Variant& variant) const
+{
+    ASSERT(variant.m_Type == ava::RuntimePropertyContainer::T_VARIANT_OBJECTID);
+
+    u64 result = 0;
+    read(variant.m_Data, &result);
+    return result;
+}
+
+u32 RuntimeContainerView::as_array_count(const Variant& variant) const
+{
+    using namespace ava::RuntimePropertyContainer;
+    ASSERT(variant.m_Type == T_VARIANT_VEC_INTS || variant.m_Type == T_VARIANT_VEC_FLOATS
+           || variant.m_Type == T_VARIANT_VEC_BYTES || variant.m_Type == T_VARIANT_VEC_EVENTS);
+
+    u32 result = 0;
+    read(variant.m_Data, &result);
+    return result;
+}
+
+const u8* RuntimeContainerView::at(u64 offset, u64 size) const
+{
+    if (!m_data || offset > m_size || size > (m_size - offset)) return nullptr;
+    return (m_data + offset);
+}
+
+RuntimeContainerView::Node RuntimeContainerView::read_node(u32 offset) const
+{
+    ContainerHeader header;
+    if (!read(offset, &header)) return {};
+
+    Node result;
+    result.m_Offset        = offset;
+    result.m_NameHash      = header.m_NameHash;
+    result.m_DataOffset    = header.m_DataOffset;
+    result.m_NumVariants   = header.m_NumVariants;
+    result.m_NumContainers = header.m_NumContainers;
+    return result;
+}
+} // namespace jcmr::game::format
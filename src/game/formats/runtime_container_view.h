@@ -0,0 +1,109 @@
+#ifndef JCMR_FORMATS_RUNTIME_CONTAINER_VIEW_H_HEADER_GUARD
+#define JCMR_FORMATS_RUNTIME_CONTAINER_VIEW_H_HEADER_GUARD
+
+#include "platform.h"
+
+#include <cstring>
+#include <string_view>
+
+namespace jcmr::game::format
+{
+// read-only view over a raw RTPC buffer. container headers and variant values are decoded straight from the buffer
+// when they are asked for, nothing is parsed or copied up front.
+// NOTE : the view does not own the buffer, the caller must keep it alive (and unmodified) for the views lifetime.
+struct RuntimeContainerView {
+    static constexpr u32 RTPC_VERSION = 1;
+
+#pragma pack(push, 1)
+    struct Header {
+        u32 m_Magic;
+        u32 m_Version;
+    };
+
+    struct ContainerHeader {
+        u32 m_NameHash;
+        u32 m_DataOffset;
+        u16 m_NumVariants;
+        u16 m_NumContainers;
+    };
+
+    struct VariantHeader {
+        u32 m_NameHash;
+        u32 m_Data; // value for int/float types, offset into the buffer for everything else
+        u8  m_Type;
+    };
+#pragma pack(pop)
+
+    static_assert(sizeof(ContainerHeader) == 12, "ContainerHeader alignment is wrong!");
+    static_assert(sizeof(VariantHeader) == 9, "VariantHeader alignment is wrong!");
+
+    struct Node {
+        u32 m_Offset        = 0; // offset of the ContainerHeader
+        u32 m_NameHash      = 0;
+        u32 m_DataOffset    = 0;
+        u16 m_NumVariants   = 0;
+        u16 m_NumContainers = 0;
+
+        bool valid() const { return m_Offset != 0; }
+    };
+
+    struct Variant {
+        u32 m_Offset   = 0; // offset of the VariantHeader
+        u32 m_NameHash = 0;
+        u32 m_Data     = 0;
+        u8  m_Type     = 0;
+
+        bool valid() const { return m_Offset != 0; }
+    };
+
+    RuntimeContainerView() = default;
+    RuntimeContainerView(const u8* data, u64 size);
+    explicit RuntimeContainerView(const ByteArray& buffer)
+        : RuntimeContainerView(buffer.data(), buffer.size())
+    {
+    }
+
+    bool is_valid() const;
+
+    Node    root() const;
+    Node    child(const Node& node, u16 index) const;
+    Variant variant(const Node& node, u16 index) const;
+    Variant find_variant(const Node& node, u32 namehash) const;
+
+    i32              as_int(const Variant& variant) const;
+    f32              as_float(const Variant& variant) const;
+    std::string_view as_string(const Variant& variant) const;
+    u64              as_object_id(const Variant& variant) const;
+    u32              as_array_count(const Variant& variant) const;
+
+    // vec2/vec3/vec4/mat4x4
+    template <u32 Count> std::array<f32, Count> as_floats(const Variant& variant) const
+    {
+        std::array<f32, Count> result{};
+        if (auto* ptr = at(variant.m_Data, sizeof(f32) * Count)) {
+            std::memcpy(result.data(), ptr, sizeof(f32) * Count);
+        }
+
+        return result;
+    }
+
+  private:
+    const u8* at(u64 offset, u64 size) const;
+
+    template <typename T> bool read(u64 offset, T* out) const
+    {
+        auto* ptr = at(offset, sizeof(T));
+        if (!ptr) return false;
+        std::memcpy(out, ptr, sizeof(T));
+        return true;
+    }
+
+    Node read_node(u32 offset) const;
+
+  private:
+    const u8* m_data = nullptr;
+    u64       m_size = 0;
+};
+} // namespace jcmr::game::format
+
+#endif // JCMR_FORMATS_RUNTIME_CONTAINER_VIEW_H_HEADER_GUARD
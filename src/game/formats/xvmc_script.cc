@@ -146,6 +146,7 @@ struct XVMCScriptImpl final : XVMCScript {
 
         auto* adf = new ava::AvalancheDataFormat::ADF(buffer);
         m_scripts.insert({filename, std::make_unique<XVMCScriptInstance>(m_app, adf)});
+        m_app.notify_loaded_state_changed();
         return true;
     }
 
@@ -154,6 +155,7 @@ struct XVMCScriptImpl final : XVMCScript {
         auto iter = m_scripts.find(filename);
         if (iter == m_scripts.end()) return;
         m_scripts.erase(iter);
+        m_app.notify_loaded_state_changed();
     }
 
     bool save(const std::string& filename, ByteArray* out_buffer) override
@@ -18,6 +18,17 @@ IGame* IGame::create(EGame game_type, App& app)
     return nullptr;
 }
 
+ResourceManager* IGame::create_resource_manager(EGame game_type, App& app)
+{
+    switch (game_type) {
+        case EGame::EGAME_JUSTCAUSE3: return game::JustCause3::create_resource_manager(app);
+        case EGame::EGAME_JUSTCAUSE4: return game::JustCause4::create_resource_manager(app);
+    }
+
+    ASSERT(false);
+    return nullptr;
+}
+
 void IGame::destroy(IGame* game)
 {
     ASSERT(game != nullptr);
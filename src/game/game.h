@@ -13,6 +13,8 @@ namespace jcmr
 struct App;
 struct ResourceManager;
 struct Texture;
+struct TextureStreamer;
+struct ThumbnailCache;
 struct Shader;
 struct RenderContext;
 
@@ -31,6 +33,8 @@ struct IGame {
     static IGame* create(EGame game_type, App& app);
     static void   destroy(IGame* game);
 
+    static ResourceManager* create_resource_manager(EGame game_type, App& app);
+
     virtual ~IGame() = default;
 
     virtual game::IRenderBlock*      create_render_block(u32 typehash)                          = 0;
@@ -39,10 +43,15 @@ struct IGame {
 
     virtual void setup_render_constants(RenderContext& context) {}
 
+    // called once per frame after the renderer
+    virtual void update() {}
+
     virtual const char*                  get_title() const     = 0;
     virtual const std::filesystem::path& get_directory() const = 0;
 
     virtual ResourceManager* get_resource_manager() = 0;
+    virtual TextureStreamer* get_texture_streamer() { return nullptr; }
+    virtual ThumbnailCache*  get_thumbnail_cache() { return nullptr; }
 };
 } // namespace jcmr
 
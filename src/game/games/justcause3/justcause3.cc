@@ -8,11 +8,14 @@
 #include "app/settings.h"
 #include "app/utils.h"
 
+#include "game/avtx.h"
 #include "game/games/justcause3/renderblocks/renderblockcharacter.h"
 #include "game/games/justcause3/renderblocks/renderblockcharacterskin.h"
 #include "game/games/justcause3/renderblocks/renderblockgeneralmkiii.h"
 #include "game/render_block.h"
 #include "game/resource_manager.h"
+#include "game/texture_streamer.h"
+#include "game/thumbnail_cache.h"
 
 #include "render/dds_texture_loader.h"
 #include "render/renderer.h"
@@ -20,24 +23,52 @@
 #include "render/texture.h"
 
 #include <AvaFormatLib/legacy/string_lookup.h>
-#include <AvaFormatLib/util/byte_vector_stream.h>
+#include <thread>
 
 namespace jcmr::game
 {
 static constexpr i32 INTERNAL_RESOURCE_JUSTCAUSE3_DICTIONARY = 128;
 
 struct JustCause3Impl final : JustCause3 {
+    // the parsed Shaders_F.shader_bundle, the shaders' bytecode points into it
+    struct LoadedShaderBundle {
+        static constexpr u32 NUM_SHADER_TYPES = 2;
+
+        ~LoadedShaderBundle()
+        {
+            if (m_Library) std::free(m_Library);
+            delete m_Adf;
+        }
+
+        ava::AvalancheDataFormat::ADF*     m_Adf     = nullptr;
+        ava::ShaderBundle::SShaderLibrary* m_Library = nullptr;
+
+        // entries by namehash for each Shader::ShaderType
+        std::unordered_map<u32, ava::ShaderBundle::SShader*> m_Index[NUM_SHADER_TYPES];
+    };
+
     JustCause3Impl(App& app)
         : m_app(app)
     {
         m_directory = m_app.get_settings().get<const char*>("jc3_path");
 
-        m_resource_manager = ResourceManager::create(m_app);
-        m_resource_manager->set_base_path(m_directory);
-        m_resource_manager->set_flags(ResourceManager::E_FLAG_LEGACY_ARCHIVE_TABLE);
-        m_resource_manager->load_dictionary(INTERNAL_RESOURCE_JUSTCAUSE3_DICTIONARY);
+        m_resource_manager = create_resource_manager(m_app);
+        ASSERT(m_resource_manager);
+
+        // optional, built by the deps-index command. opened files prefetch their dependencies when it's loaded.
+        m_resource_manager->load_dependency_graph("cache/jc3.depgraph");
 
-        load_shader_bundle();
+        m_texture_streamer = TextureStreamer::create(m_app, *m_resource_manager);
+        m_thumbnail_cache  = ThumbnailCache::create(m_app, *m_resource_manager, "cache/jc3.thumbnails");
+
+        const auto texture_quality = m_app.get_settings().get<const char*>("texture_quality", "full");
+        if (!avtx::parse_quality(texture_quality, &m_texture_quality)) {
+            LOG_ERROR("JustCause3 : unknown texture_quality \"{}\" (expected full, half, quarter or a maximum size)",
+                      texture_quality);
+        }
+
+        // the bundle is only needed once the first model is loaded
+        m_shader_bundle_thread = std::thread([this] { m_shader_bundle = load_shader_bundle(); });
         init_shader_constants();
     }
 
@@ -47,26 +78,50 @@ struct JustCause3Impl final : JustCause3 {
         m_app.get_renderer().destroy_buffer(m_vertex_global_constants);
         m_app.get_renderer().destroy_buffer(m_pixel_global_constants);
 
-        // free shader bundle
-        if (m_shader_library) {
-            std::free(m_shader_library);
-            delete m_shader_adf;
-        }
+        // free shader bundle, shaders still held by render blocks keep it alive
+        if (m_shader_bundle_thread.joinable()) m_shader_bundle_thread.join();
+        m_shaders.clear();
+        m_shader_bundle = nullptr;
 
+        ThumbnailCache::destroy(m_thumbnail_cache);
+        TextureStreamer::destroy(m_texture_streamer);
         ResourceManager::destroy(m_resource_manager);
     }
 
-    void load_shader_bundle()
+    // runs on m_shader_bundle_thread
+    std::shared_ptr<LoadedShaderBundle> load_shader_bundle()
     {
+        // the file buffer is only needed while it's parsed, the bytecode lives in the library
         ByteArray buffer;
         if (!m_resource_manager->read_from_disk("Shaders_F.shader_bundle", &buffer)) {
-            DEBUG_BREAK();
-            return;
+            LOG_ERROR("JustCause3 : failed to read the shader bundle");
+            return nullptr;
+        }
+
+        auto bundle = std::make_shared<LoadedShaderBundle>();
+        if (!AVA_FL_SUCCEEDED(ava::ShaderBundle::Parse(buffer, &bundle->m_Adf, &bundle->m_Library))) {
+            LOG_ERROR("JustCause3 : failed to parse the shader bundle");
+            return nullptr;
         }
 
-        AVA_FL_ENSURE(ava::ShaderBundle::Parse(buffer, &m_shader_adf, &m_shader_library));
-        LOG_INFO("JustCause3 : shader bundle \"{}\" ({}) loaded!", m_shader_library->m_Name,
-                 m_shader_library->m_BuildTime);
+        LOG_INFO("JustCause3 : shader bundle \"{}\" ({}) loaded!", bundle->m_Library->m_Name,
+                 bundle->m_Library->m_BuildTime);
+
+        build_shader_index(bundle->m_Library->m_VertexShaders, &bundle->m_Index[Shader::E_SHADER_TYPE_VERTEX]);
+        build_shader_index(bundle->m_Library->m_FragmentShaders, &bundle->m_Index[Shader::E_SHADER_TYPE_PIXEL]);
+        return bundle;
+    }
+
+    static void build_shader_index(ava::SAdfArray<ava::ShaderBundle::SShader>&           shaders,
+                                   std::unordered_map<u32, ava::ShaderBundle::SShader*>* out_index)
+    {
+        for (auto& shader : shaders) {
+            const auto [iter, inserted] = out_index->emplace(ava::hashlittle(shader.m_Name), &shader);
+            if (!inserted) {
+                LOG_WARNING("JustCause3 : shader \"{}\" has the same namehash as \"{}\"", shader.m_Name,
+                            iter->second->m_Name);
+            }
+        }
     }
 
     void init_shader_constants()
@@ -108,49 +163,24 @@ struct JustCause3Impl final : JustCause3 {
             return nullptr;
         }
 
-        // attempt to read source file
-        auto      source_filename = utils::replace(filename, ".ddsc", ".hmddsc");
-        ByteArray source_buffer;
-        if (m_resource_manager->read(source_filename, &source_buffer)) {
-            LOG_INFO("JustCause3 : create_texture - loaded source texture \"{}\"", source_filename);
+        // create from the mips in the .ddsc, the streamer swaps in the .hmddsc mip once it's been read (if the quality
+        // setting wants it). the pixels are uploaded straight out of the read buffer, only the headers are built here.
+        avtx::StreamView stream;
+        if (!avtx::get_best_stream(buffer, {}, &stream, m_texture_quality)) {
+            LOG_ERROR("JustCause3 : create_texture - failed to read texture entry from \"{}\"", filename);
+            return nullptr;
         }
 
-        ava::AvalancheTexture::TextureEntry entry{};
-        ByteArray                           texture_buffer;
-        AVA_FL_ENSURE(ava::AvalancheTexture::ReadBestEntry(buffer, &entry, &texture_buffer, source_buffer), nullptr);
-
-        LOG_INFO("JustCause3 : create_texture - using best texture {}x{}", entry.m_Width, entry.m_Height);
-
-        DDS_HEADER header{};
-        header.size        = sizeof(DDS_HEADER);
-        header.flags       = (DDS_TEXTURE | DDSD_MIPMAPCOUNT);
-        header.width       = entry.m_Width;
-        header.height      = entry.m_Height;
-        header.depth       = entry.m_Depth;
-        header.mipMapCount = 1;
-        header.ddspf       = Renderer::get_pixel_format((DXGI_FORMAT)entry.m_Format);
-        header.caps        = (DDSCAPS_COMPLEX | DDSCAPS_TEXTURE);
-
-        const bool is_dxt10 = (header.ddspf.fourCC == MAKEFOURCC('D', 'X', '1', '0'));
-
-        ByteArray dds_buffer(sizeof(DDS_MAGIC) + sizeof(DDS_HEADER) + (is_dxt10 ? sizeof(DDS_HEADER_DXT10) : 0)
-                             + texture_buffer.size());
-        ava::utils::ByteVectorStream stream(&dds_buffer);
-        stream.setp(0);
-
-        stream.write(DDS_MAGIC);
-        stream.write(header);
-
-        if (is_dxt10) {
-            DDS_HEADER_DXT10 dxt10_header{};
-            dxt10_header.dxgiFormat        = (DXGI_FORMAT)entry.m_Format;
-            dxt10_header.resourceDimension = D3D11_RESOURCE_DIMENSION_TEXTURE2D;
-            dxt10_header.arraySize         = 1;
-            stream.write(dxt10_header);
+        DDS_HEADER       header;
+        DDS_HEADER_DXT10 dxt10_header;
+        avtx::get_dds_header(stream, &header, &dxt10_header);
+
+        auto texture = renderer.create_texture(filename, header, &dxt10_header, stream.m_Data, stream.m_Size);
+        if (texture && avtx::get_source_stream_size(buffer, m_texture_quality) != 0) {
+            m_texture_streamer->add(texture, utils::replace(filename, ".ddsc", ".hmddsc"), buffer, m_texture_quality);
         }
 
-        stream.write(texture_buffer);
-        return renderer.create_texture(filename, std::move(dds_buffer));
+        return texture;
     }
 
     // TODO : this should be moved into IGame probably. There're no differences between JC3/JC4.
@@ -158,34 +188,39 @@ struct JustCause3Impl final : JustCause3 {
     //        we can just override on a game-specific level?
     std::shared_ptr<Shader> create_shader(const std::string& filename, u8 shader_type) override
     {
-        // use cached shader if it's available
-        auto& renderer = m_app.get_renderer();
-        // FIXME : this won't work because we append the extension to the filename.
-        if (auto shader = renderer.get_shader(filename); shader) {
-            return shader;
-        }
+        ASSERT(shader_type < LoadedShaderBundle::NUM_SHADER_TYPES);
 
-        ASSERT(m_shader_adf != nullptr);
-        ASSERT(m_shader_library != nullptr);
+        // every render block using the same shader shares it
+        const u32 namehash = ava::hashlittle(filename.c_str());
+        const u64 key      = Shader::get_key(namehash, shader_type);
+        if (auto iter = m_shaders.find(key); iter != m_shaders.end()) {
+            return iter->second;
+        }
 
-        // use the correct shader bundle for the shader type
-        ava::SAdfArray<ava::ShaderBundle::SShader>* shaders = nullptr;
-        if (shader_type == Shader::E_SHADER_TYPE_VERTEX) {
-            shaders = &m_shader_library->m_VertexShaders;
-        } else if (shader_type == Shader::E_SHADER_TYPE_PIXEL) {
-            shaders = &m_shader_library->m_FragmentShaders;
+        // the first shader waits for the bundle to finish loading
+        if (m_shader_bundle_thread.joinable()) m_shader_bundle_thread.join();
+        if (!m_shader_bundle) {
+            return nullptr;
         }
 
-        auto iter =
-            std::find_if(shaders->begin(), shaders->end(),
-                         [filename](const ava::ShaderBundle::SShader& shader) { return shader.m_Name == filename; });
-        if (iter == shaders->end()) {
+        const auto& index = m_shader_bundle->m_Index[shader_type];
+        const auto  iter  = index.find(namehash);
+        if (iter == index.end()) {
             LOG_ERROR("JustCause3 : can't find shader \"{}\"", filename);
             return nullptr;
         }
 
-        ByteArray buffer((*iter).m_BinaryData.begin(), (*iter).m_BinaryData.end());
-        return renderer.create_shader(filename, shader_type, std::move(buffer));
+        // the shader points into the bundle instead of copying the bytecode
+        auto& binary_data = iter->second->m_BinaryData;
+
+        ShaderBytecode bytecode;
+        bytecode.m_Owner = m_shader_bundle;
+        bytecode.m_Data  = binary_data.begin();
+        bytecode.m_Size  = static_cast<u64>(binary_data.end() - binary_data.begin());
+
+        auto shader = m_app.get_renderer().create_shader(filename, shader_type, bytecode);
+        m_shaders.emplace(key, shader);
+        return shader;
     }
 
     void setup_render_constants(RenderContext& context) override
@@ -207,8 +242,12 @@ struct JustCause3Impl final : JustCause3 {
         renderer.set_pixel_shader_constants(m_pixel_global_constants, 0, FragmentGlobalConstants);
     }
 
+    void update() override { m_texture_streamer->update(); }
+
     const std::filesystem::path& get_directory() const override { return m_directory; }
     ResourceManager*             get_resource_manager() override { return m_resource_manager; }
+    TextureStreamer*             get_texture_streamer() override { return m_texture_streamer; }
+    ThumbnailCache*              get_thumbnail_cache() override { return m_thumbnail_cache; }
 
   private:
     struct {
@@ -258,15 +297,37 @@ struct JustCause3Impl final : JustCause3 {
     // static_assert(sizeof(LightingFrameConsts) == 37328);
 
   private:
-    App&                               m_app;
-    std::filesystem::path              m_directory;
-    ResourceManager*                   m_resource_manager        = nullptr;
-    ava::AvalancheDataFormat::ADF*     m_shader_adf              = nullptr;
-    ava::ShaderBundle::SShaderLibrary* m_shader_library          = nullptr;
-    Buffer*                            m_vertex_global_constants = nullptr;
-    Buffer*                            m_pixel_global_constants  = nullptr;
+    App&                  m_app;
+    std::filesystem::path m_directory;
+    ResourceManager*      m_resource_manager        = nullptr;
+    TextureStreamer*      m_texture_streamer        = nullptr;
+    ThumbnailCache*       m_thumbnail_cache         = nullptr;
+    avtx::Quality         m_texture_quality;
+    Buffer*               m_vertex_global_constants = nullptr;
+    Buffer*               m_pixel_global_constants  = nullptr;
+
+    // set by m_shader_bundle_thread, only read once it's joined
+    std::shared_ptr<LoadedShaderBundle> m_shader_bundle;
+    std::thread                         m_shader_bundle_thread;
+    // held for the session so a shader is only created once, even when no render block is using it
+    std::unordered_map<u64, std::shared_ptr<Shader>> m_shaders; // Shader::get_key
 };
 
+ResourceManager* JustCause3::create_resource_manager(App& app)
+{
+    const char* directory = app.get_settings().get<const char*>("jc3_path", nullptr);
+    if (!directory) {
+        LOG_ERROR("JustCause3 : game directory has not been set.");
+        return nullptr;
+    }
+
+    auto* resource_manager = ResourceManager::create(app);
+    resource_manager->set_base_path(directory);
+    resource_manager->set_flags(ResourceManager::E_FLAG_LEGACY_ARCHIVE_TABLE);
+    resource_manager->load_dictionary(INTERNAL_RESOURCE_JUSTCAUSE3_DICTIONARY);
+    return resource_manager;
+}
+
 JustCause3* JustCause3::create(App& app)
 {
     return new JustCause3Impl(app);
@@ -7,6 +7,7 @@
 
 #include "game/games/justcause4/renderblocks/renderblockcharacter.h"
 #include "game/name_hash_lookup.h"
+#include "game/oodle.h"
 #include "game/render_block.h"
 #include "game/resource_manager.h"
 
@@ -24,12 +25,11 @@ struct JustCause4Impl final : JustCause4 {
     {
         m_directory = m_app.get_settings().get<const char*>("jc4_path");
 
-        m_resource_manager = ResourceManager::create(app);
-        m_resource_manager->set_base_path(m_directory);
-        m_resource_manager->load_dictionary(INTERNAL_RESOURCE_JUSTCAUSE4_DICTIONARY);
+        m_resource_manager = create_resource_manager(m_app);
+        ASSERT(m_resource_manager);
 
-        auto oodle_lib_path = fmt::format("{}\\oo2core_7_win64.dll", m_directory.string());
-        AVA_FL_ENSURE(ava::Oodle::LoadLib(oodle_lib_path.c_str()));
+        // optional, built by the deps-index command. opened files prefetch their dependencies when it's loaded.
+        m_resource_manager->load_dependency_graph("cache/jc4.depgraph");
 
         // load shader bundle : ShadersDX11_F.shader_bundle
 
@@ -39,8 +39,9 @@ struct JustCause4Impl final : JustCause4 {
 
     ~JustCause4Impl()
     {
-        ava::Oodle::UnloadLib();
+        // the resource manager joins its prefetch thread, which could be decompressing with oodle
         ResourceManager::destroy(m_resource_manager);
+        ava::Oodle::UnloadLib();
     }
 
     IRenderBlock* create_render_block(u32 typehash) override
@@ -76,6 +77,27 @@ struct JustCause4Impl final : JustCause4 {
     ResourceManager*      m_resource_manager = nullptr;
 };
 
+ResourceManager* JustCause4::create_resource_manager(App& app)
+{
+    const char* directory = app.get_settings().get<const char*>("jc4_path", nullptr);
+    if (!directory) {
+        LOG_ERROR("JustCause4 : game directory has not been set.");
+        return nullptr;
+    }
+
+    auto* resource_manager = ResourceManager::create(app);
+    resource_manager->set_base_path(directory);
+    resource_manager->load_dictionary(INTERNAL_RESOURCE_JUSTCAUSE4_DICTIONARY);
+
+    // archives are compressed with oodle, it's unloaded when the game is destroyed
+    auto oodle_lib_path = fmt::format("{}\\{}", directory, oodle::LIBRARY_NAME);
+    if (!AVA_FL_SUCCEEDED(ava::Oodle::LoadLib(oodle_lib_path.c_str()))) {
+        LOG_ERROR("JustCause4 : failed to load oodle library \"{}\"", oodle_lib_path);
+    }
+
+    return resource_manager;
+}
+
 JustCause4* JustCause4::create(App& app)
 {
     return new JustCause4Impl(app);
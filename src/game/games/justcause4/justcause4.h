@@ -9,6 +9,9 @@ struct JustCause4 : IGame {
     static JustCause4* create(App& app);
     static void        destroy(JustCause4* inst);
 
+    // setup a resource manager for the game directory without creating the game (or needing a renderer)
+    static ResourceManager* create_resource_manager(App& app);
+
     const char* get_title() const override { return "Just Cause 4"; }
 };
 } // namespace jcmr::game
@@ -0,0 +1,384 @@
+#include "pch.h"
+
+#include "hash_cracker.h"
+
+#include "app/hashing.h"
+#include "app/jobs.h"
+#include "app/profile.h"
+
+#include <fstream>
+#include <mutex>
+#include <unordered_set>
+
+namespace jcmr::hash_cracker
+{
+static constexpr u32 CHUNK_SIZE       = 65536; // candidates per job
+static constexpr u32 BATCH_SIZE       = 1024;  // candidates hashed at once
+static constexpr u32 CHUNKS_PER_ROUND = 64;    // per worker, progress is saved between rounds
+static constexpr u32 PROGRESS_VERSION = 1;
+
+// every placeholder with the same name is one dimension, the candidates are every combination of the dimensions
+struct Template {
+    struct Segment {
+        std::string m_Literal;
+        i32         m_Dimension = -1; // -1 for literals
+    };
+
+    std::vector<Segment>                  m_Segments;
+    std::vector<std::vector<std::string>> m_Dimensions;
+    u64                                   m_NumCandidates = 0;
+};
+
+// a bitset in front of the sorted hashes, almost every candidate misses so it's usually the only check
+struct HashFilter {
+    std::vector<u64> m_Bits;
+    std::vector<u64> m_Sorted;
+    u64              m_Mask = 0;
+
+    explicit HashFilter(std::vector<u64> values)
+        : m_Sorted(std::move(values))
+    {
+        std::sort(m_Sorted.begin(), m_Sorted.end());
+        m_Sorted.erase(std::unique(m_Sorted.begin(), m_Sorted.end()), m_Sorted.end());
+
+        // at least 64 bits per hash keeps false positives under 2%
+        u64 num_bits = 65536;
+        while (num_bits < (m_Sorted.size() * 64) && num_bits < (1ull << 30)) num_bits *= 2;
+
+        m_Bits.resize(num_bits / 64);
+        m_Mask = (num_bits - 1);
+        for (auto value : m_Sorted) {
+            const auto bit = get_bit(value);
+            m_Bits[bit / 64] |= (1ull << (bit % 64));
+        }
+    }
+
+    u64 get_bit(u64 value) const { return ((value ^ (value >> 32)) & m_Mask); }
+
+    bool contains(u64 value) const
+    {
+        const auto bit = get_bit(value);
+        if ((m_Bits[bit / 64] & (1ull << (bit % 64))) == 0) return false;
+        return std::binary_search(m_Sorted.begin(), m_Sorted.end(), value);
+    }
+
+    bool empty() const { return m_Sorted.empty(); }
+};
+
+static bool parse_template(const std::string& text, const Options& options, Template* out_template)
+{
+    std::unordered_map<std::string, i32> dimensions;
+
+    auto add_dimension = [&](const std::string& name, u32 width) -> i32 {
+        const auto key  = fmt::format("{}:{}", name, width);
+        auto       iter = dimensions.find(key);
+        if (iter != dimensions.end()) return (*iter).second;
+
+        std::vector<std::string> values;
+        if (name.compare(0, 4, "word") == 0) {
+            values = options.m_Words;
+        } else {
+            values.reserve(options.m_MaxNumber);
+            for (u32 i = 0; i < options.m_MaxNumber; ++i) {
+                values.push_back(fmt::format("{:0{}}", i, width));
+            }
+        }
+
+        out_template->m_Dimensions.push_back(std::move(values));
+        return dimensions[key] = static_cast<i32>(out_template->m_Dimensions.size() - 1);
+    };
+
+    out_template->m_Segments.clear();
+    out_template->m_Dimensions.clear();
+
+    for (u64 i = 0; i < text.size();) {
+        const auto open = text.find('{', i);
+        if (open != i) {
+            const auto end = std::min(open, text.size());
+            out_template->m_Segments.push_back({text.substr(i, (end - i))});
+            i = end;
+            continue;
+        }
+
+        const auto close = text.find('}', open);
+        if (close == std::string::npos) {
+            LOG_ERROR("HashCracker : unterminated placeholder in \"{}\"", text);
+            return false;
+        }
+
+        // "name" or "name:width"
+        auto       name  = text.substr((open + 1), (close - open - 1));
+        u32        width = 0;
+        const auto colon = name.find(':');
+        if (colon != std::string::npos) {
+            width = static_cast<u32>(std::strtoul(name.c_str() + colon + 1, nullptr, 10));
+            name.resize(colon);
+        }
+
+        const bool is_word   = (name.compare(0, 4, "word") == 0);
+        const bool is_number = (!name.empty() && name[0] == 'n'
+                                && name.find_first_not_of("0123456789", 1) == std::string::npos);
+        if (!is_word && !is_number) {
+            LOG_ERROR("HashCracker : unknown placeholder \"{{{}}}\" in \"{}\"", name, text);
+            return false;
+        }
+
+        Template::Segment segment;
+        segment.m_Dimension = add_dimension(name, (is_word ? 0 : width));
+        out_template->m_Segments.push_back(std::move(segment));
+        i = (close + 1);
+    }
+
+    out_template->m_NumCandidates = 1;
+    for (const auto& dimension : out_template->m_Dimensions) {
+        out_template->m_NumCandidates *= dimension.size();
+    }
+
+    return true;
+}
+
+bool load_targets(const std::filesystem::path& filename, Targets* out_targets)
+{
+    std::ifstream stream(filename);
+    if (stream.fail()) {
+        LOG_ERROR("HashCracker : failed to open \"{}\"", filename.generic_string());
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(stream, line)) {
+        if (line.empty() || line[0] == '#') continue;
+
+        const bool is_hex = (line.size() > 2 && line[0] == '0' && (line[1] == 'x' || line[1] == 'X'));
+        const auto value  = std::strtoull((line.c_str() + (is_hex ? 2 : 0)), nullptr, (is_hex ? 16 : 10));
+        if (value > 0xFFFFFFFF) {
+            out_targets->m_ObjectIds.push_back(value);
+        } else {
+            out_targets->m_NameHashes.push_back(static_cast<u32>(value));
+        }
+    }
+
+    return true;
+}
+
+u64 count_candidates(const std::string& name_template, const Options& options)
+{
+    Template parsed;
+    return (parse_template(name_template, options, &parsed) ? parsed.m_NumCandidates : 0);
+}
+
+// identifies the run in the progress file, so a changed run starts again from the beginning. the words are part of
+// it, a chunk index means something else once the word list is edited even if it has the same length.
+static u32 get_run_signature(const Targets& targets, const Options& options)
+{
+    auto signature = fmt::format("{}:{}:{}:{}", options.m_MaxNumber, options.m_Words.size(),
+                                 targets.m_NameHashes.size(), targets.m_ObjectIds.size());
+    for (const auto& name_template : options.m_Templates) {
+        signature += ('\n' + name_template);
+    }
+
+    for (const auto& word : options.m_Words) {
+        signature += '\n';
+        signature += word;
+    }
+
+    // a different target list with the same counts must not resume from the old progress
+    auto name_hashes = targets.m_NameHashes;
+    auto object_ids  = targets.m_ObjectIds;
+    std::sort(name_hashes.begin(), name_hashes.end());
+    std::sort(object_ids.begin(), object_ids.end());
+
+    for (const auto name_hash : name_hashes) {
+        signature += fmt::format("\n{:08x}", name_hash);
+    }
+
+    for (const auto object_id : object_ids) {
+        signature += fmt::format("\n{:016x}", object_id);
+    }
+
+    return hashing::hashlittle(signature);
+}
+
+// "version signature template chunk", the first chunk which hasn't been checked
+static void read_progress(const std::filesystem::path& filename, u32 signature, u32* out_template, u64* out_chunk)
+{
+    *out_template = 0;
+    *out_chunk    = 0;
+
+    std::ifstream stream(filename);
+    u32           version = 0, saved_signature = 0, name_template = 0;
+    u64           chunk = 0;
+    if (!(stream >> version >> saved_signature >> name_template >> chunk)) return;
+
+    if (version == PROGRESS_VERSION && saved_signature == signature) {
+        *out_template = name_template;
+        *out_chunk    = chunk;
+        LOG_INFO("HashCracker : resuming from template {}, chunk {}", name_template, chunk);
+    }
+}
+
+static bool write_progress(const std::filesystem::path& filename, u32 signature, u32 name_template, u64 chunk)
+{
+    std::ofstream stream(filename, std::ios::trunc);
+    stream << PROGRESS_VERSION << ' ' << signature << ' ' << name_template << ' ' << chunk << '\n';
+    return !stream.fail();
+}
+
+// per worker, reused between chunks
+struct WorkerState {
+    std::string                   m_Names; // every candidate in the batch, back to back
+    std::vector<u32>              m_Offsets;
+    std::vector<std::string_view> m_Views;
+    std::vector<u32>              m_NameHashes;
+    std::vector<u64>              m_ObjectIds;
+    std::vector<u32>              m_Digits;
+};
+
+static void check_batch(WorkerState& state, const HashFilter& name_hashes, const HashFilter& object_ids,
+                        std::mutex& mutex, std::vector<Match>* out_matches)
+{
+    const auto count = static_cast<u32>(state.m_Offsets.size() - 1);
+
+    state.m_Views.clear();
+    for (u32 i = 0; i < count; ++i) {
+        const auto offset = state.m_Offsets[i];
+        state.m_Views.emplace_back((state.m_Names.data() + offset), (state.m_Offsets[i + 1] - offset));
+    }
+
+    auto add_match = [&](u32 index, u64 hash, bool is_object_id) {
+        std::lock_guard<decltype(mutex)> _lock(mutex);
+        out_matches->push_back({std::string(state.m_Views[index]), hash, is_object_id});
+    };
+
+    if (!name_hashes.empty()) {
+        state.m_NameHashes.resize(count);
+        hashing::hashlittle_batch(state.m_Views.data(), count, state.m_NameHashes.data());
+        for (u32 i = 0; i < count; ++i) {
+            if (name_hashes.contains(state.m_NameHashes[i])) add_match(i, state.m_NameHashes[i], false);
+        }
+    }
+
+    if (!object_ids.empty()) {
+        state.m_ObjectIds.resize(count);
+        hashing::hash_string_64_batch(state.m_Views.data(), count, state.m_ObjectIds.data());
+        for (u32 i = 0; i < count; ++i) {
+            // the same name can be used for a global or a local object id
+            for (u16 user_data : {(u16)0x0000, (u16)0xFFFF}) {
+                const auto object_id = ava::SObjectID{state.m_ObjectIds[i], user_data}.to_uint64();
+                if (object_ids.contains(object_id)) add_match(i, object_id, true);
+            }
+        }
+    }
+
+    state.m_Names.clear();
+    state.m_Offsets.assign(1, 0);
+}
+
+// expands candidates [first, first + count) of the template
+static void check_chunk(const Template& name_template, u64 first, u64 count, WorkerState& state,
+                        const HashFilter& name_hashes, const HashFilter& object_ids, std::mutex& mutex,
+                        std::vector<Match>* out_matches)
+{
+    const auto& dimensions = name_template.m_Dimensions;
+
+    // the first dimension changes fastest
+    auto& digits = state.m_Digits;
+    digits.resize(dimensions.size());
+    for (u32 i = 0; i < dimensions.size(); ++i) {
+        digits[i] = static_cast<u32>(first % dimensions[i].size());
+        first /= dimensions[i].size();
+    }
+
+    state.m_Names.clear();
+    state.m_Offsets.assign(1, 0);
+
+    for (u64 candidate = 0; candidate < count; ++candidate) {
+        for (const auto& segment : name_template.m_Segments) {
+            state.m_Names += (segment.m_Dimension < 0 ? segment.m_Literal
+                                                       : dimensions[segment.m_Dimension][digits[segment.m_Dimension]]);
+        }
+
+        state.m_Offsets.push_back(static_cast<u32>(state.m_Names.size()));
+        if ((state.m_Offsets.size() - 1) == BATCH_SIZE) {
+            check_batch(state, name_hashes, object_ids, mutex, out_matches);
+        }
+
+        for (u32 i = 0; i < digits.size() && ++digits[i] == dimensions[i].size(); ++i) {
+            digits[i] = 0;
+        }
+    }
+
+    if (state.m_Offsets.size() > 1) {
+        check_batch(state, name_hashes, object_ids, mutex, out_matches);
+    }
+}
+
+bool crack(const Targets& targets, const Options& options, MatchCallback_t callback)
+{
+    ProfileBlock _("HashCracker crack");
+
+    std::vector<Template> templates(options.m_Templates.size());
+    for (u32 i = 0; i < templates.size(); ++i) {
+        if (!parse_template(options.m_Templates[i], options, &templates[i])) return false;
+    }
+
+    const HashFilter name_hashes(std::vector<u64>(targets.m_NameHashes.begin(), targets.m_NameHashes.end()));
+    const HashFilter object_ids(targets.m_ObjectIds);
+
+    const auto signature = get_run_signature(targets, options);
+    u32        first_template;
+    u64        first_chunk;
+    read_progress(options.m_ProgressFile, signature, &first_template, &first_chunk);
+
+    const auto               num_workers = jobs::get_worker_count();
+    std::vector<WorkerState> states(num_workers);
+    std::unordered_set<u64>  reported; // a name can match a target in more than one template
+    std::mutex               mutex;
+
+    for (u32 t = first_template; t < templates.size(); ++t) {
+        const auto& name_template = templates[t];
+        const auto  num_chunks    = ((name_template.m_NumCandidates + CHUNK_SIZE - 1) / CHUNK_SIZE);
+
+        LOG_INFO("HashCracker : \"{}\" expands to {} candidates", options.m_Templates[t],
+                 name_template.m_NumCandidates);
+
+        for (u64 round = (t == first_template ? first_chunk : 0); round < num_chunks;) {
+            const auto         round_chunks = std::min<u64>((num_workers * CHUNKS_PER_ROUND), (num_chunks - round));
+            std::vector<Match> matches;
+
+            jobs::parallel_for(static_cast<u32>(round_chunks), [&](u32 index, u32 worker) {
+                const auto first = ((round + index) * CHUNK_SIZE);
+                const auto count = std::min<u64>(CHUNK_SIZE, (name_template.m_NumCandidates - first));
+                check_chunk(name_template, first, count, states[worker], name_hashes, object_ids, mutex, &matches);
+            });
+
+            // the matches are handed over before the progress moves past them, so a run which is stopped doesn't
+            // lose them
+            matches.erase(std::remove_if(matches.begin(), matches.end(),
+                                         [&](const Match& match) { return !reported.insert(match.m_Hash).second; }),
+                          matches.end());
+            if (!matches.empty() && !callback(matches)) {
+                return false;
+            }
+
+            round += round_chunks;
+            if (!options.m_ProgressFile.empty()) {
+                const bool finished   = (round == num_chunks);
+                const u32  next_index = (finished ? (t + 1) : t);
+                if (!write_progress(options.m_ProgressFile, signature, next_index, (finished ? 0 : round))) {
+                    LOG_ERROR("HashCracker : failed to write \"{}\"", options.m_ProgressFile.generic_string());
+                    return false;
+                }
+            }
+        }
+    }
+
+    // finished, the next run starts from the beginning
+    if (!options.m_ProgressFile.empty()) {
+        std::error_code error;
+        std::filesystem::remove(options.m_ProgressFile, error);
+    }
+
+    return true;
+}
+} // namespace jcmr::hash_cracker
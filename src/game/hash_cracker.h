@@ -0,0 +1,50 @@
+#ifndef JCMR_GAME_HASH_CRACKER_H_HEADER_GUARD
+#define JCMR_GAME_HASH_CRACKER_H_HEADER_GUARD
+
+#include "platform.h"
+
+// brute forces names for unknown namehashes (lookup3) and object ids (murmur3) from name templates. a template is a
+// string with placeholders, "models/characters/{word}/{word}_{n}.rbm" tries every word in the word list with every
+// number. placeholders with the same name take the same value, so the template above tries "rico/rico_0.rbm" but
+// never "rico/mira_0.rbm".
+//  {word}, {word2}, ... - every word in the word list
+//  {n}, {n2}, ...       - every number in [0, m_MaxNumber), "{n:3}" pads the number with zeros to 3 digits
+//
+// candidates are expanded, hashed in batches and checked against a bitset of the target hashes on the job workers.
+// progress is saved after every round so a long run can be stopped and picked up again.
+namespace jcmr::hash_cracker
+{
+struct Targets {
+    std::vector<u32> m_NameHashes;
+    std::vector<u64> m_ObjectIds; // SObjectID::to_uint64(), global (0x0000) or local (0xFFFF) user data
+};
+
+// one hash per line, "0x" prefixed hex or decimal. values which don't fit in 32 bits are object ids.
+bool load_targets(const std::filesystem::path& filename, Targets* out_targets);
+
+struct Options {
+    std::vector<std::string> m_Templates;
+    std::vector<std::string> m_Words;
+    u32                      m_MaxNumber = 100;
+    std::filesystem::path    m_ProgressFile; // empty to always start from the beginning
+};
+
+struct Match {
+    std::string m_Name;
+    u64         m_Hash;
+    bool        m_IsObjectId;
+};
+
+// called on the calling thread at the end of every round which found new names, before the progress is saved.
+// returning false stops the run, the round is checked again next time.
+using MatchCallback_t = std::function<bool(const std::vector<Match>& matches)>;
+
+// returns the number of candidates a template expands to, or 0 if the template isn't valid
+u64 count_candidates(const std::string& name_template, const Options& options);
+
+// blocks until every template is expanded. returns false if a template isn't valid, the progress file can't be
+// written or the callback stopped the run.
+bool crack(const Targets& targets, const Options& options, MatchCallback_t callback);
+} // namespace jcmr::hash_cracker
+
+#endif // JCMR_GAME_HASH_CRACKER_H_HEADER_GUARD
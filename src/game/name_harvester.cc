@@ -0,0 +1,234 @@
+#include "pch.h"
+
+#include "name_harvester.h"
+
+#include "app/hashing.h"
+#include "app/jobs.h"
+#include "app/profile.h"
+#include "app/utils.h"
+
+#include "game/formats/runtime_container_variant_types.h"
+#include "game/name_hash_lookup.h"
+#include "game/resource_manager.h"
+
+#include <atomic>
+#include <unordered_set>
+
+namespace jcmr::name_harvester
+{
+static constexpr std::array RUNTIME_CONTAINER_EXTENSIONS{"blo", "epe"};
+static constexpr u32        CANDIDATE_BATCH_SIZE = 1024;
+
+// per worker, merged once all the files are processed
+struct WorkerState {
+    std::unordered_set<u32>              m_Hashes;
+    std::vector<std::string>             m_Strings;
+    std::unordered_map<u32, std::string> m_Names;
+    u64                                  m_NumCandidates = 0;
+    std::vector<std::string_view>        m_Candidates; // waiting to be hashed, point into the file being scanned
+    std::vector<u32>                     m_CandidateHashes;
+};
+
+static bool is_runtime_container(const std::string& filename)
+{
+    const auto extension = utils::get_extension(filename);
+    return std::find_if(RUNTIME_CONTAINER_EXTENSIONS.begin(), RUNTIME_CONTAINER_EXTENSIONS.end(),
+                        [&](const char* ext) { return extension == ext; })
+           != RUNTIME_CONTAINER_EXTENSIONS.end();
+}
+
+static bool is_printable(u8 ch)
+{
+    return (ch >= 0x20 && ch < 0x7F);
+}
+
+static bool is_identifier(u8 ch)
+{
+    return ((ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || (ch >= '0' && ch <= '9') || ch == '_');
+}
+
+// every namehash a runtime container references, and its string variants as candidates
+static void collect_container(const ava::RuntimePropertyContainer::Container& container, WorkerState* state)
+{
+    using namespace ava::RuntimePropertyContainer;
+    using game::format::get_variant_datatype;
+    using game::format::RuntimeContainer;
+
+    state->m_Hashes.insert(container.m_NameHash);
+
+    for (const auto& variant : container.m_Variants) {
+        state->m_Hashes.insert(variant.m_NameHash);
+
+        if (variant.m_Type == T_VARIANT_STRING) {
+            state->m_Strings.push_back(variant.as<std::string>());
+        } else if (variant.m_Type == T_VARIANT_INTEGER
+                   && get_variant_datatype(variant.m_NameHash) == RuntimeContainer::VARIANT_DATATYPE_HASH) {
+            state->m_Hashes.insert(static_cast<u32>(variant.as<i32>()));
+        }
+    }
+
+    for (const auto& child : container.m_Containers) {
+        collect_container(child, state);
+    }
+}
+
+// candidates are hashed in batches, flush() must be called before the strings they point to go away
+struct CandidateTester {
+    const std::unordered_set<u32>& m_Unknown;
+    WorkerState*                   m_State;
+
+    void test(const char* str, u64 length)
+    {
+        if (length == 0) return;
+
+        m_State->m_Candidates.emplace_back(str, length);
+        if (m_State->m_Candidates.size() == CANDIDATE_BATCH_SIZE) {
+            flush();
+        }
+    }
+
+    void flush()
+    {
+        auto& candidates = m_State->m_Candidates;
+        auto& hashes     = m_State->m_CandidateHashes;
+
+        hashes.resize(candidates.size());
+        hashing::hashlittle_batch(candidates.data(), static_cast<u32>(candidates.size()), hashes.data());
+
+        for (u32 i = 0; i < candidates.size(); ++i) {
+            if (m_Unknown.count(hashes[i]) != 0) {
+                m_State->m_Names.try_emplace(hashes[i], candidates[i]);
+            }
+        }
+
+        m_State->m_NumCandidates += candidates.size();
+        candidates.clear();
+    }
+
+    // the run itself, and the identifier-like parts of it ("models/jc_characters/rico.rbm" -> "models",
+    // "jc_characters", "rico", "rbm")
+    void test_run(const char* str, u64 length)
+    {
+        test(str, length);
+
+        u64 start = 0;
+        for (u64 i = 0; i <= length; ++i) {
+            if (i < length && is_identifier(str[i])) continue;
+            if (start > 0 || i < length) test((str + start), (i - start));
+            start = (i + 1);
+        }
+    }
+};
+
+bool harvest(ResourceManager& resource_manager, const Options& options, Result* out_result)
+{
+    ProfileBlock _("NameHarvester harvest");
+
+    std::vector<std::pair<u32, std::string>> containers;
+    std::vector<std::pair<u32, std::string>> files;
+    resource_manager.enumerate_dictionary([&](u32 namehash, const std::string& filename) {
+        if (is_runtime_container(filename)) {
+            containers.emplace_back(namehash, filename);
+        }
+
+        if (options.m_Extension.empty() || utils::get_extension(filename) == options.m_Extension) {
+            files.emplace_back(namehash, filename);
+        }
+    });
+
+    const auto             num_workers = jobs::get_worker_count();
+    std::vector<ByteArray> buffers(num_workers); // reused between files, one per worker
+    std::atomic<u32>       num_failed = 0;
+
+    // gather every namehash the runtime containers reference
+    LOG_INFO("NameHarvester : reading {} runtime containers...", containers.size());
+
+    std::vector<WorkerState> states(num_workers);
+    jobs::parallel_for(static_cast<u32>(containers.size()), [&](u32 index, u32 worker) {
+        auto& buffer = buffers[worker];
+        if (!resource_manager.read(containers[index].first, &buffer, ResourceManager::E_READ_FLAG_QUIET)) {
+            ++num_failed;
+            return;
+        }
+
+        ava::RuntimePropertyContainer::Container container{};
+        if (!AVA_FL_SUCCEEDED(ava::RuntimePropertyContainer::Parse(buffer, &container))) {
+            ++num_failed;
+            return;
+        }
+
+        collect_container(container, &states[worker]);
+    });
+
+    std::unordered_set<u32> unknown;
+    for (auto& state : states) {
+        for (auto namehash : state.m_Hashes) {
+            if (namehash != 0 && !is_in_namehash_lookup_table(namehash)) {
+                unknown.insert(namehash);
+            }
+        }
+
+        state.m_Hashes = {};
+    }
+
+    out_result->m_NumUnknownHashes = static_cast<u32>(unknown.size());
+    LOG_INFO("NameHarvester : {} unknown namehashes, scanning {} files for strings...", unknown.size(), files.size());
+
+    if (unknown.empty()) {
+        return true;
+    }
+
+    // string variants are tested as they are
+    for (auto& state : states) {
+        CandidateTester tester{unknown, &state};
+        for (const auto& string : state.m_Strings) {
+            tester.test(string.c_str(), string.size());
+        }
+
+        tester.flush();
+        state.m_Strings = {};
+    }
+
+    // printable runs in the raw data of every file
+    jobs::parallel_for(static_cast<u32>(files.size()), [&](u32 index, u32 worker) {
+        auto& buffer = buffers[worker];
+        if (!resource_manager.read(files[index].first, &buffer, ResourceManager::E_READ_FLAG_QUIET)) {
+            ++num_failed;
+            return;
+        }
+
+        CandidateTester tester{unknown, &states[worker]};
+
+        const auto* data  = reinterpret_cast<const char*>(buffer.data());
+        u64         start = 0;
+        for (u64 i = 0; i <= buffer.size(); ++i) {
+            if (i < buffer.size() && is_printable(buffer[i])) continue;
+
+            const auto length = (i - start);
+            if (length >= options.m_MinLength && length <= options.m_MaxLength) {
+                tester.test_run((data + start), length);
+            }
+
+            start = (i + 1);
+        }
+
+        tester.flush();
+    });
+
+    if (num_failed > 0) {
+        LOG_WARNING("NameHarvester : {} files failed to read or parse.", num_failed.load());
+    }
+
+    for (auto& state : states) {
+        out_result->m_NumCandidates += state.m_NumCandidates;
+        for (auto& [namehash, name] : state.m_Names) {
+            out_result->m_Names.try_emplace(namehash, std::move(name));
+        }
+    }
+
+    out_result->m_NumFiles = static_cast<u32>(files.size());
+    LOG_INFO("NameHarvester : {} names found for {} unknown namehashes ({} candidates tested).",
+             out_result->m_Names.size(), unknown.size(), out_result->m_NumCandidates);
+    return true;
+}
+} // namespace jcmr::name_harvester
@@ -0,0 +1,33 @@
+#ifndef JCMR_GAME_NAME_HARVESTER_H_HEADER_GUARD
+#define JCMR_GAME_NAME_HARVESTER_H_HEADER_GUARD
+
+#include "platform.h"
+
+namespace jcmr
+{
+struct ResourceManager;
+}
+
+// finds names for namehashes which aren't in the lookup table. unknown hashes are gathered from the runtime
+// containers, then every file is scanned for strings (runtime container string variants, and printable runs in the
+// raw data which covers adf string tables and xvmc string buffers) which are hashed and kept if they match.
+namespace jcmr::name_harvester
+{
+struct Options {
+    std::string m_Extension;       // only scan files with this extension for strings, empty for all files
+    u32         m_MinLength = 3;   // shortest printable run which is considered
+    u32         m_MaxLength = 256; // longer runs are skipped, they are almost never names
+};
+
+struct Result {
+    std::map<u32, std::string> m_Names; // namehash -> harvested name
+    u32                        m_NumUnknownHashes = 0;
+    u32                        m_NumFiles         = 0;
+    u64                        m_NumCandidates    = 0;
+};
+
+// the namehash lookup table must be loaded
+bool harvest(ResourceManager& resource_manager, const Options& options, Result* out_result);
+} // namespace jcmr::name_harvester
+
+#endif // JCMR_GAME_NAME_HARVESTER_H_HEADER_GUARD
@@ -4,54 +4,229 @@
 
 #include "app/app.h"
 
-#include <AvaFormatLib/util/byte_array_buffer.h>
-#include <rapidjson/document.h>
-#include <rapidjson/istreamwrapper.h>
+#include <atomic>
+#include <fstream>
+#include <unordered_set>
 
 namespace jcmr
 {
-static constexpr i32 INTERNAL_RESOURCE_FILELIST = 512;
-
-using LookupTable = std::unordered_map<u32, std::string>;
+static constexpr i32 INTERNAL_RESOURCE_NAMEHASH_LOOKUP = 512;
+
+// built by build_namehashlookup.py
+static constexpr u32 LOOKUP_TABLE_MAGIC   = 0x544C484E; // NHLT
+static constexpr u32 LOOKUP_TABLE_VERSION = 1;
+
+// the resource is laid out as the header, sorted namehashes, the name index for every namehash, the offset of every
+// block of names and then the front-coded names. it's used in place, straight from the executable image.
+struct LookupTableHeader {
+    u32 m_Magic;
+    u32 m_Version;
+    u32 m_NumEntries;
+    u32 m_BlockSize; // names per block
+    u32 m_NumBlocks;
+    u32 m_StringDataSize;
+};
+
+struct LookupTable {
+    const LookupTableHeader* m_Header       = nullptr;
+    const u32*               m_Hashes       = nullptr;
+    const u32*               m_NameIndices  = nullptr;
+    const u32*               m_BlockOffsets = nullptr;
+    const u8*                m_Strings      = nullptr;
+};
 
 static bool        s_namehash_lookup_table_is_loaded = false;
 static LookupTable s_namehash_lookup_table;
 
+// every name in a block, decoded together the first time one of them is looked up. blocks are published with a
+// compare exchange and never changed or freed after that, so lookups don't lock and the views stay valid.
+struct DecodedBlock {
+    std::string      m_Names;   // back to back
+    std::vector<u32> m_Offsets; // start of every name, with an extra entry for the end
+};
+
+static std::unique_ptr<std::atomic<const DecodedBlock*>[]> s_decoded_blocks;
+
 void load_namehash_lookup_table()
 {
     ASSERT(!s_namehash_lookup_table_is_loaded);
 
-    auto buffer = App::load_internal_resource(INTERNAL_RESOURCE_FILELIST);
+    u64       size = 0;
+    const u8* data = App::map_internal_resource(INTERNAL_RESOURCE_NAMEHASH_LOOKUP, &size);
+    if (!data || size < sizeof(LookupTableHeader)) {
+        LOG_ERROR("namehash lookup table is missing.");
+        return;
+    }
 
-    byte_array_buffer buf(buffer);
-    std::istream      buf_stream(&buf);
+    const auto* header = reinterpret_cast<const LookupTableHeader*>(data);
+    if (header->m_Magic != LOOKUP_TABLE_MAGIC || header->m_Version != LOOKUP_TABLE_VERSION
+        || header->m_BlockSize == 0) {
+        LOG_ERROR("namehash lookup table is invalid or out of date (run build_namehashlookup.py).");
+        return;
+    }
 
-    rapidjson::IStreamWrapper stream(buf_stream);
-    rapidjson::Document       document;
-    document.ParseStream(stream);
+    const u64 expected_size = (sizeof(LookupTableHeader) + (header->m_NumEntries * sizeof(u32) * 2)
+                               + (header->m_NumBlocks * sizeof(u32)) + header->m_StringDataSize);
+    if (size < expected_size) {
+        LOG_ERROR("namehash lookup table is truncated.");
+        return;
+    }
 
-    ASSERT(document.IsArray());
-    s_namehash_lookup_table.reserve(document.Size());
+    auto& table          = s_namehash_lookup_table;
+    table.m_Header       = header;
+    table.m_Hashes       = reinterpret_cast<const u32*>(header + 1);
+    table.m_NameIndices  = (table.m_Hashes + header->m_NumEntries);
+    table.m_BlockOffsets = (table.m_NameIndices + header->m_NumEntries);
+    table.m_Strings      = reinterpret_cast<const u8*>(table.m_BlockOffsets + header->m_NumBlocks);
 
-    for (auto iter = document.Begin(); iter != document.End(); ++iter) {
-        ASSERT(iter->IsString());
-        auto namehash                     = ava::hashlittle(iter->GetString());
-        s_namehash_lookup_table[namehash] = iter->GetString();
+    s_decoded_blocks = std::make_unique<std::atomic<const DecodedBlock*>[]>(header->m_NumBlocks);
+    for (u32 i = 0; i < header->m_NumBlocks; ++i) {
+        s_decoded_blocks[i] = nullptr;
     }
 
     s_namehash_lookup_table_is_loaded = true;
-    LOG_INFO("namehash lookup table is loaded. {} entries.", s_namehash_lookup_table.size());
+    LOG_INFO("namehash lookup table is loaded. {} entries.", header->m_NumEntries);
+}
+
+static u32 read_varint(const u8** ptr)
+{
+    u32 result = 0;
+    for (u32 shift = 0;; shift += 7) {
+        const u8 byte = *(*ptr)++;
+        result |= (static_cast<u32>(byte & 0x7F) << shift);
+        if (!(byte & 0x80)) return result;
+    }
+}
+
+// every block starts with a full name, the rest store the length of the prefix shared with the previous name and
+// the remaining suffix. the last block runs to the end of the string data.
+static const DecodedBlock* decode_block(u32 block)
+{
+    const auto& table      = s_namehash_lookup_table;
+    const bool  is_last    = ((block + 1) == table.m_Header->m_NumBlocks);
+    const u32   end_offset = (is_last ? table.m_Header->m_StringDataSize : table.m_BlockOffsets[block + 1]);
+    const u8*   ptr        = (table.m_Strings + table.m_BlockOffsets[block]);
+    const u8*   end        = (table.m_Strings + end_offset);
+
+    auto        decoded = std::make_unique<DecodedBlock>();
+    std::string name;
+    for (u32 i = 0; i < table.m_Header->m_BlockSize && ptr < end; ++i) {
+        const u32 prefix = (i == 0 ? 0 : read_varint(&ptr));
+        const u32 suffix = read_varint(&ptr);
+
+        name.resize(prefix);
+        name.append(reinterpret_cast<const char*>(ptr), suffix);
+        ptr += suffix;
+
+        decoded->m_Offsets.push_back(static_cast<u32>(decoded->m_Names.size()));
+        decoded->m_Names += name;
+    }
+
+    decoded->m_Offsets.push_back(static_cast<u32>(decoded->m_Names.size()));
+
+    // another thread could have decoded it at the same time, the first one wins
+    const DecodedBlock* expected = nullptr;
+    if (s_decoded_blocks[block].compare_exchange_strong(expected, decoded.get())) {
+        return decoded.release();
+    }
+
+    return expected;
+}
+
+// returns the index of the namehash in the sorted hash array, or the number of entries if it isn't known
+static u32 find_entry(u32 namehash)
+{
+    const auto& table = s_namehash_lookup_table;
+    const auto* begin = table.m_Hashes;
+    const auto* end   = (table.m_Hashes + table.m_Header->m_NumEntries);
+    const auto* it    = std::lower_bound(begin, end, namehash);
+    if (it == end || *it != namehash) {
+        return table.m_Header->m_NumEntries;
+    }
+
+    return static_cast<u32>(it - begin);
 }
 
-const char* find_in_namehash_lookup_table(u32 namehash)
+bool is_in_namehash_lookup_table(u32 namehash)
 {
     ASSERT(s_namehash_lookup_table_is_loaded);
+    if (!s_namehash_lookup_table_is_loaded) {
+        return false;
+    }
+
+    return (find_entry(namehash) != s_namehash_lookup_table.m_Header->m_NumEntries);
+}
+
+std::string_view find_in_namehash_lookup_table(u32 namehash)
+{
+    ASSERT(s_namehash_lookup_table_is_loaded);
+    if (!s_namehash_lookup_table_is_loaded) {
+        return {};
+    }
+
+    const auto entry = find_entry(namehash);
+    if (entry == s_namehash_lookup_table.m_Header->m_NumEntries) {
+        return {};
+    }
+
+    const auto  index      = s_namehash_lookup_table.m_NameIndices[entry];
+    const auto  block_size = s_namehash_lookup_table.m_Header->m_BlockSize;
+    const auto* block      = s_decoded_blocks[index / block_size].load();
+    if (!block) {
+        block = decode_block(index / block_size);
+    }
 
-    auto iter = s_namehash_lookup_table.find(namehash);
-    if (iter == s_namehash_lookup_table.end()) {
-        return "";
+    const auto i = (index % block_size);
+    if ((i + 1) >= block->m_Offsets.size()) {
+        return {};
     }
 
-    return (*iter).second.c_str();
+    const auto offset = block->m_Offsets[i];
+    return std::string_view((block->m_Names.data() + offset), (block->m_Offsets[i + 1] - offset));
+}
+
+bool append_to_namehash_lookup_source(const std::filesystem::path& filename, std::vector<std::string> names,
+                                      u32* out_num_added)
+{
+    std::unordered_set<std::string> existing;
+    bool                            ends_with_newline = true;
+
+    {
+        std::ifstream stream(filename, std::ios::binary);
+        std::string   line;
+        while (std::getline(stream, line)) {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            existing.insert(line);
+        }
+
+        // getline() doesn't say if the last line had a newline
+        stream.clear();
+        if (stream.seekg(-1, std::ios::end)) {
+            ends_with_newline = (stream.get() == '\n');
+        }
+    }
+
+    std::sort(names.begin(), names.end());
+    names.erase(std::unique(names.begin(), names.end()), names.end());
+    names.erase(std::remove_if(names.begin(), names.end(),
+                               [&](const std::string& name) { return existing.count(name) != 0; }),
+                names.end());
+
+    std::ofstream stream(filename, std::ios::app);
+    if (stream.fail()) {
+        LOG_ERROR("failed to open namehash lookup source \"{}\"", filename.generic_string());
+        return false;
+    }
+
+    for (const auto& name : names) {
+        if (!ends_with_newline) stream << '\n';
+        stream << name;
+        ends_with_newline = false;
+    }
+
+    stream << (ends_with_newline ? "" : "\n");
+
+    *out_num_added = static_cast<u32>(names.size());
+    return !stream.fail();
 }
-} // namespace jcmr
\ No newline at end of file
+} // namespace jcmr
@@ -3,10 +3,23 @@
 
 #include "platform.h"
 
+#include <string_view>
+
 namespace jcmr
 {
-void        load_namehash_lookup_table();
-const char* find_in_namehash_lookup_table(u32 namehash);
+void load_namehash_lookup_table();
+
+// returns an empty string if the namehash isn't known. the returned view stays valid for the lifetime of the process.
+// names are decoded a block at a time and kept, it doesn't lock so it's safe to call from worker threads.
+std::string_view find_in_namehash_lookup_table(u32 namehash);
+
+// doesn't decode the name, safe to call from worker threads
+bool is_in_namehash_lookup_table(u32 namehash);
+
+// appends the names which aren't already in filename (one name per line). only the assets/namehashlookup_*.txt sources
+// are read by build_namehashlookup.py, it has to be run again to add them to the lookup table.
+bool append_to_namehash_lookup_source(const std::filesystem::path& filename, std::vector<std::string> names,
+                                      u32* out_num_added);
 } // namespace jcmr
 
 #endif // JCMR_GAME_NAME_HASH_LOOKUP_H_HEADER_GUARD
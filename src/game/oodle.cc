@@ -0,0 +1,34 @@
+#include "pch.h"
+
+#include "oodle.h"
+
+#include "app/os.h"
+
+namespace jcmr::oodle
+{
+using OodleLZ_Decompress_t = intptr_t (*)(const void* compressed, intptr_t compressed_size, void* raw,
+                                          intptr_t raw_size, i32 fuzz_safe, i32 check_crc, i32 verbosity,
+                                          void* decode_buffer, intptr_t decode_buffer_size, void* callback,
+                                          void* callback_user_data, void* decoder_memory, intptr_t decoder_memory_size,
+                                          i32 thread_phase);
+
+static constexpr i32 OODLELZ_FUZZ_SAFE_YES     = 1;
+static constexpr i32 OODLELZ_CHECK_CRC_NO      = 0;
+static constexpr i32 OODLELZ_VERBOSITY_NONE    = 0;
+static constexpr i32 OODLELZ_DECODE_UNTHREADED = 3;
+
+bool decompress(const u8* data, u64 size, u8* out, u64 out_size)
+{
+    // looked up every time, the library is unloaded with the game
+    const auto oodle_decompress =
+        reinterpret_cast<OodleLZ_Decompress_t>(os::get_library_function(LIBRARY_NAME, "OodleLZ_Decompress"));
+    if (!oodle_decompress) {
+        return false;
+    }
+
+    const auto result = oodle_decompress(data, static_cast<intptr_t>(size), out, static_cast<intptr_t>(out_size),
+                                         OODLELZ_FUZZ_SAFE_YES, OODLELZ_CHECK_CRC_NO, OODLELZ_VERBOSITY_NONE, nullptr,
+                                         0, nullptr, nullptr, nullptr, 0, OODLELZ_DECODE_UNTHREADED);
+    return (result == static_cast<intptr_t>(out_size));
+}
+} // namespace jcmr::oodle
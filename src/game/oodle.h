@@ -0,0 +1,16 @@
+#ifndef JCMR_GAME_OODLE_H_HEADER_GUARD
+#define JCMR_GAME_OODLE_H_HEADER_GUARD
+
+#include "platform.h"
+
+namespace jcmr::oodle
+{
+// shipped with the game, ava::Oodle::LoadLib loads it from the game directory and it's unloaded with the game
+static constexpr const char* LIBRARY_NAME = "oo2core_7_win64.dll";
+
+// decompresses a single oodle stream straight into out, returns false if the library isn't loaded or the stream didn't
+// produce exactly out_size bytes.
+bool decompress(const u8* data, u64 size, u8* out, u64 out_size);
+} // namespace jcmr::oodle
+
+#endif // JCMR_GAME_OODLE_H_HEADER_GUARD
@@ -4,18 +4,33 @@
 
 #include "app/app.h"
 #include "app/directory_list.h"
+#include "app/hashing.h"
+#include "app/jobs.h"
 #include "app/os.h"
 #include "app/profile.h"
 
+#include "game/dependency_graph.h"
+#include "game/oodle.h"
+
 #include <AvaFormatLib/legacy/archive_table.h>
 #include <AvaFormatLib/util/byte_array_buffer.h>
 #include <rapidjson/document.h>
 #include <rapidjson/istreamwrapper.h>
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <fstream>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
 
 namespace jcmr
 {
+static constexpr u64 READ_CACHE_SIZE    = (256 * 1024 * 1024);
+static constexpr u32 MAX_PREFETCH_FILES = 256; // per opened file, closest dependencies first
+
 struct ResourceManagerImpl final : ResourceManager {
   public:
     ResourceManagerImpl(App& app)
@@ -23,8 +38,34 @@ struct ResourceManagerImpl final : ResourceManager {
     {
     }
 
-    void set_base_path(const std::filesystem::path& base_path) override { m_base_path = base_path; }
-    void set_flags(u32 flags) override { m_flags = flags; }
+    ~ResourceManagerImpl()
+    {
+        {
+            std::lock_guard<decltype(m_read_cache_mutex)> _lock(m_read_cache_mutex);
+            m_prefetch_shutdown = true;
+        }
+
+        m_prefetch_condition.notify_one();
+        if (m_prefetch_thread.joinable()) m_prefetch_thread.join();
+
+        clear_archive_tables();
+    }
+
+    void set_base_path(const std::filesystem::path& base_path) override
+    {
+        stop_prefetch();
+        m_base_path = base_path;
+        clear_archive_tables();
+        clear_read_cache();
+    }
+
+    void set_flags(u32 flags) override
+    {
+        stop_prefetch();
+        m_flags = flags;
+        clear_archive_tables();
+        clear_read_cache();
+    }
 
     void load_dictionary(i32 resource_id) override
     {
@@ -44,10 +85,22 @@ struct ResourceManagerImpl final : ResourceManager {
 
         m_dictionary.clear();
         m_dictionary.reserve(document.GetObjectA().MemberCount());
+        m_dictionary_tree.clear();
 
+        // every name is hashed up front in one batch
+        std::vector<std::string_view> names;
+        std::vector<u32>              namehashes(document.GetObjectA().MemberCount());
+        names.reserve(namehashes.size());
+        for (auto iter = document.MemberBegin(); iter != document.MemberEnd(); ++iter) {
+            names.emplace_back(iter->name.GetString(), iter->name.GetStringLength());
+        }
+
+        hashing::hashlittle_batch(names.data(), static_cast<u32>(names.size()), namehashes.data());
+
+        u32 index = 0;
         for (auto iter = document.MemberBegin(); iter != document.MemberEnd(); ++iter) {
             std::string name     = iter->name.GetString();
-            const u32   namehash = ava::hashlittle(name.c_str());
+            const u32   namehash = namehashes[index++];
 
             m_dictionary_tree.add(name);
 
@@ -59,24 +112,38 @@ struct ResourceManagerImpl final : ResourceManager {
             m_dictionary.insert({namehash, std::make_pair(std::move(name), std::move(paths))});
         }
 
+        m_dictionary_tree.sort();
+
         LOG_INFO("ResourceManager : dictionary loaded. ({} entries)", m_dictionary.size());
     }
 
     DirectoryList& get_dictionary_tree() override { return m_dictionary_tree; }
 
-    bool read(u32 namehash, ByteArray* out_buffer) override
+    void enumerate_dictionary(EnumerateCallback_t callback) const override
     {
-        ProfileBlock _("ResourceManager read");
+        for (const auto& [namehash, entry] : m_dictionary) {
+            callback(namehash, entry.first);
+        }
+    }
 
-        const auto& [archives, _namehash] = locate_in_dictionary(namehash);
-        for (const auto& archive : archives) {
-            LOG_INFO("ResourceManager : reading {:x} from archive \"{}\"...", namehash, archive);
-            if (read_from_archive(archive.c_str(), namehash, out_buffer)) {
-                return true;
-            }
+    bool read(u32 namehash, ByteArray* out_buffer, u32 read_flags = E_READ_FLAG_NONE) override
+    {
+        if (read_from_cache(namehash, out_buffer)) {
+            return true;
         }
 
-        return false;
+        return read_uncached(namehash, out_buffer, read_flags);
+    }
+
+    bool read_view(u32 namehash, ByteArray* scratch_buffer, FileView* out_view,
+                   u32 read_flags = E_READ_FLAG_NONE) override
+    {
+        if (read_from_cache(namehash, scratch_buffer)) {
+            *out_view = {scratch_buffer->data(), scratch_buffer->size()};
+            return true;
+        }
+
+        return read_from_archives(namehash, scratch_buffer, out_view, read_flags);
     }
 
     bool read(const std::string& filename, ByteArray* out_buffer) override
@@ -89,7 +156,14 @@ struct ResourceManagerImpl final : ResourceManager {
             }
         }
 
-        return read(ava::hashlittle(filename.c_str()), out_buffer);
+        // a file which was prefetched is a dependency of one which was opened, and its own dependencies were part of
+        // that prefetch. only the file which was opened queues anything, not every dependency it reads after it.
+        const auto namehash = ava::hashlittle(filename.c_str());
+        if (m_dependency_graph && !is_prefetched(namehash)) {
+            prefetch(m_dependency_graph->get_all_dependencies(namehash, MAX_PREFETCH_FILES));
+        }
+
+        return read(namehash, out_buffer);
     }
 
     bool read_from_disk(const std::string& filename, ByteArray* out_buffer) override
@@ -101,75 +175,422 @@ struct ResourceManagerImpl final : ResourceManager {
         return !out_buffer->empty();
     }
 
-  private:
-    using DictionaryLookupResult = std::tuple<std::vector<std::string>, u32>;
-    using TabEntries             = std::vector<ava::ArchiveTable::TabEntry>;
-    using LegacyTabEntries       = std::vector<ava::legacy::ArchiveTable::TabEntry>;
-    using CompressionBlocks      = std::vector<ava::ArchiveTable::TabCompressedBlock>;
+    u32 read_batch(const std::vector<u32>& namehashes, std::vector<ByteArray>* out_buffers) override
+    {
+        struct BatchEntry {
+            const ava::ArchiveTable::TabEntry* m_Entry;
+            const ArchiveTableCache*           m_Table;
+            u32                                m_Index; // into namehashes
+        };
+
+        out_buffers->clear();
+        out_buffers->resize(namehashes.size());
+
+        // the same archive read() would use
+        std::atomic<u32>                                         num_read = 0;
+        std::unordered_map<std::string, std::vector<BatchEntry>> archives;
+        for (u32 i = 0; i < namehashes.size(); ++i) {
+            if (read_from_cache(namehashes[i], &(*out_buffers)[i])) {
+                ++num_read;
+                continue;
+            }
+
+            auto iter = m_dictionary.find(namehashes[i]);
+            if (iter == m_dictionary.end()) continue;
+
+            for (const auto& archive : (*iter).second.second) {
+                const auto* table = get_archive_table(archive);
+                if (!table->m_valid) continue;
 
-    DictionaryLookupResult locate_in_dictionary(u32 namehash)
+                const auto* entry = find_entry(*table, namehashes[i]);
+                if (!entry || entry->m_Size == 0) continue;
+
+                archives[archive].push_back({entry, table, i});
+                break;
+            }
+        }
+
+        for (auto& [archive, entries] : archives) {
+            // front to back through the archive
+            std::sort(entries.begin(), entries.end(), [](const BatchEntry& lhs, const BatchEntry& rhs) {
+                return lhs.m_Entry->m_Offset < rhs.m_Entry->m_Offset;
+            });
+
+            jobs::parallel_for(static_cast<u32>(entries.size()), [&](u32 index, u32) {
+                const auto& [entry, table, buffer_index] = entries[index];
+                if ((static_cast<u64>(entry->m_Offset) + entry->m_Size) > table->m_arc.size) return;
+
+                const u8* data       = (table->m_arc.data + entry->m_Offset);
+                auto*     out_buffer = &(*out_buffers)[buffer_index];
+                if (entry->m_Library == ava::ArchiveTable::E_COMPRESS_LIBRARY_NONE) {
+                    out_buffer->assign(data, (data + entry->m_Size));
+                } else if (!decompress_entry(data, *entry, table->m_compression_blocks, out_buffer)) {
+                    out_buffer->clear();
+                }
+
+                if (!out_buffer->empty()) ++num_read;
+            });
+        }
+
+        return num_read;
+    }
+
+    bool get_entry_info(u32 namehash, EntryInfo* out_info) override
     {
         auto iter = m_dictionary.find(namehash);
         if (iter == m_dictionary.end()) {
-            return {};
+            return false;
+        }
+
+        // the same archive read() would use
+        for (const auto& archive : (*iter).second.second) {
+            const auto* table = get_archive_table(archive);
+            if (!table->m_valid) continue;
+
+            const auto* entry = find_entry(*table, namehash);
+            if (!entry || entry->m_Size == 0) continue;
+
+            out_info->m_ArchiveHash = ava::hashlittle(archive.c_str());
+            out_info->m_Offset      = entry->m_Offset;
+            out_info->m_Size        = entry->m_Size;
+            return true;
         }
 
-        const auto& entry = (*iter);
-        return {entry.second.second, entry.first};
+        return false;
     }
 
-    bool read_from_archive(const char* archive, u32 namehash, ByteArray* out_buffer)
+    void prefetch(const std::vector<u32>& namehashes) override
     {
-        auto tab_file = m_base_path / archive;
-        tab_file += ".tab";
+        if (namehashes.empty()) return;
 
-        auto arc_file = m_base_path / archive;
-        arc_file += ".arc";
+        {
+            std::lock_guard<decltype(m_read_cache_mutex)> _lock(m_read_cache_mutex);
+            for (const auto namehash : namehashes) {
+                if (m_read_cache_lookup.count(namehash) != 0 || !m_prefetch_pending.insert(namehash).second) continue;
+                m_prefetch_queue.push_back(namehash);
+            }
 
-        if (!std::filesystem::exists(tab_file) || !std::filesystem::exists(arc_file)) {
-            LOG_ERROR("ResourceManager : can't find arc/tab file. \"{}\" \"{}\"", tab_file.generic_string(),
-                      arc_file.generic_string());
+            if (!m_prefetch_thread.joinable()) {
+                m_prefetch_thread = std::thread([this] { prefetch_thread(); });
+            }
+        }
+
+        m_prefetch_condition.notify_one();
+    }
+
+    bool load_dependency_graph(const std::filesystem::path& filename) override
+    {
+        auto graph = std::make_unique<DependencyGraph>();
+        if (!graph->load(filename)) {
+            return false;
+        }
+
+        LOG_INFO("ResourceManager : loaded dependency graph \"{}\" ({} files, {} edges)", filename.generic_string(),
+                 graph->get_num_nodes(), graph->get_num_edges());
+        m_dependency_graph = std::move(graph);
+        return true;
+    }
+
+    const DependencyGraph* get_dependency_graph() const override { return m_dependency_graph.get(); }
+
+  private:
+    using TabEntries        = std::vector<ava::ArchiveTable::TabEntry>;
+    using LegacyTabEntries  = std::vector<ava::legacy::ArchiveTable::TabEntry>;
+    using CompressionBlocks = std::vector<ava::ArchiveTable::TabCompressedBlock>;
+
+    struct ArchiveTableCache {
+        bool              m_valid = false;
+        TabEntries        m_entries; // sorted by namehash
+        CompressionBlocks m_compression_blocks;
+        os::MappedFile    m_arc; // the whole .arc, mapped for as long as the table is cached
+    };
+
+    // stored files are copied out of the mapped archive into out_buffer, which keeps its capacity
+    bool read_uncached(u32 namehash, ByteArray* out_buffer, u32 read_flags)
+    {
+        FileView view;
+        if (!read_from_archives(namehash, out_buffer, &view, read_flags)) {
             return false;
         }
 
-        ava::ArchiveTable::TabEntry entry{};
-        CompressionBlocks           compression_blocks;
+        if (view.m_Data != out_buffer->data()) {
+            out_buffer->assign(view.m_Data, (view.m_Data + view.m_Size));
+        }
+
+        return true;
+    }
+
+    bool read_from_archives(u32 namehash, ByteArray* scratch_buffer, FileView* out_view, u32 read_flags)
+    {
+        const bool quiet = (read_flags & E_READ_FLAG_QUIET);
+
+        std::optional<ProfileBlock> profile;
+        if (!quiet) profile.emplace("ResourceManager read");
+
+        auto iter = m_dictionary.find(namehash);
+        if (iter == m_dictionary.end()) {
+            return false;
+        }
+
+        for (const auto& archive : (*iter).second.second) {
+            if (!quiet) LOG_INFO("ResourceManager : reading {:x} from archive \"{}\"...", namehash, archive);
+            if (read_from_archive(archive, namehash, scratch_buffer, out_view, read_flags)) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    // stored files are viewed in place in the mapped archive, compressed files are decompressed into scratch_buffer
+    bool read_from_archive(const std::string& archive, u32 namehash, ByteArray* scratch_buffer, FileView* out_view,
+                           u32 read_flags)
+    {
+        const bool quiet = (read_flags & E_READ_FLAG_QUIET);
+
+        const auto* table = get_archive_table(archive);
+        if (!table->m_valid) {
+            return false;
+        }
 
-        // read entry from archive table
-        if (!read_archive_table_entry(tab_file, namehash, &entry, &compression_blocks)) {
+        const auto* found_entry = find_entry(*table, namehash);
+        if (!found_entry) {
             LOG_ERROR("ResourceManager : failed to read archive table entry.");
             return false;
         }
 
+        const auto& entry = (*found_entry);
         if (entry.m_Size == 0) {
             LOG_WARNING("ResourceManager : entry {:x} is empty (zero size)", entry.m_NameHash);
             return false;
         }
 
-        // TODO : just use ReadEntryBuffer for all of this???
-        // ArchiveTable::ReadEntryBuffer();
+        if ((static_cast<u64>(entry.m_Offset) + entry.m_Size) > table->m_arc.size) {
+            LOG_ERROR("ResourceManager : entry {:x} is outside of archive \"{}\"", entry.m_NameHash, archive);
+            return false;
+        }
 
-        auto buffer = os::map_view_of_file(arc_file.string().c_str(), entry.m_Offset, entry.m_Size);
+        const u8* data = (table->m_arc.data + entry.m_Offset);
 
         // file is not compressed
         if (entry.m_Library == ava::ArchiveTable::E_COMPRESS_LIBRARY_NONE) {
-            *out_buffer = std::move(buffer);
-            return !out_buffer->empty();
+            *out_view = {data, entry.m_Size};
+            return true;
         }
 
         ASSERT(entry.m_Size != entry.m_UncompressedSize);
 
-        // TODO : this might be wrong? should we map_view_of_file with the required_size instead?
+        // TODO : this might be wrong? should we read the required_size instead?
         // NOTE : looks like on everything I've tested, the required buffer size is stored in m_Size when compression is
         //        used so we should be fine. to be safe, let's keep the ASSERT here.
-        auto required_size = ava::ArchiveTable::GetEntryRequiredBufferSize(entry, compression_blocks);
+        auto required_size = ava::ArchiveTable::GetEntryRequiredBufferSize(entry, table->m_compression_blocks);
         ASSERT(entry.m_Size == required_size);
 
-        LOG_INFO("ResourceManager : archive is compressed! (size={}, uncompressed_size={}, required_size={})",
-                 entry.m_Size, entry.m_UncompressedSize, required_size);
+        if (!quiet) {
+            LOG_INFO("ResourceManager : archive is compressed! (size={}, uncompressed_size={}, required_size={})",
+                     entry.m_Size, entry.m_UncompressedSize, required_size);
+        }
+
+        if (!decompress_entry(data, entry, table->m_compression_blocks, scratch_buffer)) {
+            return false;
+        }
+
+        *out_view = {scratch_buffer->data(), scratch_buffer->size()};
+        return !scratch_buffer->empty();
+    }
+
+    // single block oodle entries are decompressed straight from the mapped archive. DecompressEntryBuffer only takes a
+    // ByteArray, so for anything else (multi-block entries, or if oodle isn't loaded) the compressed bytes are copied
+    // into a buffer each thread keeps.
+    static bool decompress_entry(const u8* data, const ava::ArchiveTable::TabEntry& entry,
+                                 const CompressionBlocks& compression_blocks, ByteArray* out_buffer)
+    {
+        if (entry.m_Library == ava::ArchiveTable::E_COMPRESS_LIBRARY_OODLE && entry.m_CompressedBlockIndex == 0) {
+            out_buffer->resize(entry.m_UncompressedSize);
+            if (oodle::decompress(data, entry.m_Size, out_buffer->data(), entry.m_UncompressedSize)) {
+                return true;
+            }
+        }
+
+        thread_local ByteArray buffer;
+        buffer.assign(data, (data + entry.m_Size));
 
         AVA_FL_ENSURE(ava::ArchiveTable::DecompressEntryBuffer(buffer, entry, out_buffer, compression_blocks), false);
-        return !out_buffer->empty();
+        return true;
+    }
+
+    static const ava::ArchiveTable::TabEntry* find_entry(const ArchiveTableCache& table, u32 namehash)
+    {
+        auto iter = std::lower_bound(table.m_entries.begin(), table.m_entries.end(), namehash,
+                                     [](const ava::ArchiveTable::TabEntry& entry, u32 namehash) {
+                                         return entry.m_NameHash < namehash;
+                                     });
+
+        if (iter == table.m_entries.end() || (*iter).m_NameHash != namehash) {
+            return nullptr;
+        }
+
+        return &(*iter);
+    }
+
+    // archive tables are parsed (and the archive is mapped) the first time they are used and kept around, entries are
+    // never removed so the returned pointer stays valid until the base path or flags change.
+    const ArchiveTableCache* get_archive_table(const std::string& archive)
+    {
+        std::lock_guard<decltype(m_archive_tables_mutex)> _lock(m_archive_tables_mutex);
+
+        auto iter = m_archive_tables.find(archive);
+        if (iter != m_archive_tables.end()) {
+            return &(*iter).second;
+        }
+
+        auto& table = m_archive_tables[archive];
+
+        auto tab_file = m_base_path / archive;
+        tab_file += ".tab";
+
+        auto arc_file = m_base_path / archive;
+        arc_file += ".arc";
+
+        if (!std::filesystem::exists(tab_file) || !std::filesystem::exists(arc_file)) {
+            LOG_ERROR("ResourceManager : can't find arc/tab file. \"{}\" \"{}\"", tab_file.generic_string(),
+                      arc_file.generic_string());
+            return &table;
+        }
+
+        if (!read_archive_table(tab_file, &table.m_entries, &table.m_compression_blocks)) {
+            LOG_ERROR("ResourceManager : failed to read archive table. \"{}\"", tab_file.generic_string());
+            return &table;
+        }
+
+        std::sort(table.m_entries.begin(), table.m_entries.end(),
+                  [](const ava::ArchiveTable::TabEntry& lhs, const ava::ArchiveTable::TabEntry& rhs) {
+                      return lhs.m_NameHash < rhs.m_NameHash;
+                  });
+
+        // reads copy or decompress straight out of the mapping
+        if (!os::map_file_read_only(arc_file.string().c_str(), &table.m_arc)) {
+            LOG_ERROR("ResourceManager : failed to map archive \"{}\"", arc_file.generic_string());
+            return &table;
+        }
+
+        table.m_valid = true;
+        return &table;
+    }
+
+    void clear_archive_tables()
+    {
+        std::lock_guard<decltype(m_archive_tables_mutex)> _lock(m_archive_tables_mutex);
+        for (auto& [archive, table] : m_archive_tables) {
+            os::unmap_file(&table.m_arc);
+        }
+
+        m_archive_tables.clear();
+    }
+
+    // cached files are copied out rather than moved, a file is often read more than once when it's opened. the copy is
+    // made after unlocking, the cache only hands out a reference to the buffer so eviction can't free it underneath. a
+    // file the prefetcher is reading is waited for, one which is only queued is taken off the queue and read by the
+    // caller.
+    bool read_from_cache(u32 namehash, ByteArray* out_buffer)
+    {
+        std::unique_lock<decltype(m_read_cache_mutex)> lock(m_read_cache_mutex);
+
+        if (m_prefetch_pending.count(namehash) != 0) {
+            auto queued = std::find(m_prefetch_queue.begin(), m_prefetch_queue.end(), namehash);
+            if (queued != m_prefetch_queue.end()) {
+                m_prefetch_queue.erase(queued);
+                m_prefetch_pending.erase(namehash);
+            } else {
+                m_prefetch_done_condition.wait(lock, [&] { return (m_prefetch_pending.count(namehash) == 0); });
+            }
+        }
+
+        auto iter = m_read_cache_lookup.find(namehash);
+        if (iter == m_read_cache_lookup.end()) {
+            return false;
+        }
+
+        m_read_cache.splice(m_read_cache.begin(), m_read_cache, (*iter).second);
+        const auto cached = (*iter).second->second;
+        lock.unlock();
+
+        *out_buffer = *cached;
+        return true;
+    }
+
+    // NOTE : m_read_cache_mutex must be held
+    void add_to_cache(u32 namehash, ByteArray buffer)
+    {
+        if (buffer.size() > (READ_CACHE_SIZE / 4) || m_read_cache_lookup.count(namehash) != 0) return;
+
+        // least recently used files are evicted first
+        while (!m_read_cache.empty() && (m_read_cache_size + buffer.size()) > READ_CACHE_SIZE) {
+            m_read_cache_size -= m_read_cache.back().second->size();
+            m_read_cache_lookup.erase(m_read_cache.back().first);
+            m_read_cache.pop_back();
+        }
+
+        m_read_cache_size += buffer.size();
+        m_read_cache.emplace_front(namehash, std::make_shared<const ByteArray>(std::move(buffer)));
+        m_read_cache_lookup[namehash] = m_read_cache.begin();
+    }
+
+    bool is_prefetched(u32 namehash)
+    {
+        std::lock_guard<decltype(m_read_cache_mutex)> _lock(m_read_cache_mutex);
+        return (m_prefetch_pending.count(namehash) != 0 || m_read_cache_lookup.count(namehash) != 0);
+    }
+
+    // drops the queued prefetches and waits for the one being read, which reads through the base path and the archive
+    // tables. the thread is left running for the next prefetch.
+    void stop_prefetch()
+    {
+        std::unique_lock<decltype(m_read_cache_mutex)> lock(m_read_cache_mutex);
+        for (const auto namehash : m_prefetch_queue) {
+            m_prefetch_pending.erase(namehash);
+        }
+
+        m_prefetch_queue.clear();
+        m_prefetch_done_condition.wait(lock, [this] { return m_prefetch_pending.empty(); });
+    }
+
+    void clear_read_cache()
+    {
+        std::lock_guard<decltype(m_read_cache_mutex)> _lock(m_read_cache_mutex);
+        m_read_cache.clear();
+        m_read_cache_lookup.clear();
+        m_read_cache_size = 0;
+    }
+
+    void prefetch_thread()
+    {
+        for (;;) {
+            u32 namehash;
+            {
+                std::unique_lock<decltype(m_read_cache_mutex)> lock(m_read_cache_mutex);
+                m_prefetch_condition.wait(lock, [this] { return (m_prefetch_shutdown || !m_prefetch_queue.empty()); });
+                if (m_prefetch_shutdown) return;
+
+                namehash = m_prefetch_queue.front();
+                m_prefetch_queue.pop_front();
+                if (m_read_cache_lookup.count(namehash) != 0) {
+                    m_prefetch_pending.erase(namehash);
+                    continue;
+                }
+            }
+
+            ByteArray  buffer;
+            const bool read = read_uncached(namehash, &buffer, E_READ_FLAG_QUIET);
+
+            {
+                std::lock_guard<decltype(m_read_cache_mutex)> _lock(m_read_cache_mutex);
+                if (read) add_to_cache(namehash, std::move(buffer));
+                m_prefetch_pending.erase(namehash);
+            }
+
+            m_prefetch_done_condition.notify_all();
+        }
     }
 
     bool read_archive_table(const std::filesystem::path& filename, TabEntries* out_entries,
@@ -214,26 +635,6 @@ struct ResourceManagerImpl final : ResourceManager {
         return true;
     }
 
-    bool read_archive_table_entry(const std::filesystem::path& filename, u32 namehash,
-                                  ava::ArchiveTable::TabEntry* out_entry, CompressionBlocks* out_compression_blocks)
-    {
-        TabEntries entries;
-        if (!read_archive_table(filename, &entries, out_compression_blocks)) {
-            return false;
-        }
-
-        auto it = std::find_if(entries.begin(), entries.end(), [namehash](const ava::ArchiveTable::TabEntry& entry) {
-            return entry.m_NameHash == namehash;
-        });
-
-        if (it == entries.end()) {
-            return false;
-        }
-
-        *out_entry = (*it);
-        return true;
-    }
-
   private:
     using FileListDictionary = std::unordered_map<u32, std::pair<std::string, std::vector<std::string>>>;
 
@@ -242,6 +643,23 @@ struct ResourceManagerImpl final : ResourceManager {
     u32                   m_flags = 0;
     FileListDictionary    m_dictionary;
     DirectoryList         m_dictionary_tree;
+
+    std::mutex                                         m_archive_tables_mutex;
+    std::unordered_map<std::string, ArchiveTableCache> m_archive_tables;
+
+    using ReadCache = std::list<std::pair<u32, std::shared_ptr<const ByteArray>>>; // most recently used first
+
+    std::unique_ptr<DependencyGraph>             m_dependency_graph;
+    std::mutex                                   m_read_cache_mutex; // also guards the prefetch queue
+    ReadCache                                    m_read_cache;
+    std::unordered_map<u32, ReadCache::iterator> m_read_cache_lookup;
+    u64                                          m_read_cache_size = 0;
+    std::deque<u32>                              m_prefetch_queue;
+    std::unordered_set<u32>                      m_prefetch_pending; // queued and in flight
+    std::condition_variable                      m_prefetch_condition;
+    std::condition_variable                      m_prefetch_done_condition; // a prefetch finished reading
+    std::thread                                  m_prefetch_thread;
+    bool                                         m_prefetch_shutdown = false;
 };
 
 ResourceManager* ResourceManager::create(App& app)
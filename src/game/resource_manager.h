@@ -6,10 +6,12 @@
 namespace jcmr
 {
 struct App;
+struct DependencyGraph;
 struct DirectoryList;
 
 struct ResourceManager {
     using DecompressCallback_t = std::function<void(const ByteArray&)>;
+    using EnumerateCallback_t  = std::function<void(u32 namehash, const std::string& filename)>;
 
     struct AsyncHandle {
         u32 value;
@@ -27,6 +29,24 @@ struct ResourceManager {
         E_FLAG_LEGACY_ARCHIVE_TABLE = (1 << 0),
     };
 
+    enum ReadFlags : u32 {
+        E_READ_FLAG_NONE  = 0,
+        E_READ_FLAG_QUIET = (1 << 0), // don't log or profile the read, used by bulk jobs
+    };
+
+    // a file's bytes, either in the mapped archive or in a buffer the caller owns
+    struct FileView {
+        const u8* m_Data = nullptr;
+        u64       m_Size = 0;
+    };
+
+    // where a file is stored in the archives, data derived from a file can use it to notice the file changed
+    struct EntryInfo {
+        u32 m_ArchiveHash = 0;
+        u32 m_Offset      = 0;
+        u32 m_Size        = 0;
+    };
+
     static ResourceManager* create(App& app);
     static void             destroy(ResourceManager* instance);
 
@@ -37,12 +57,37 @@ struct ResourceManager {
     virtual void           load_dictionary(i32 resource_id)                      = 0;
     virtual DirectoryList& get_dictionary_tree()                                 = 0;
 
+    // NOTE : safe to call from worker threads once the dictionary is loaded
+    virtual void enumerate_dictionary(EnumerateCallback_t callback) const = 0;
+
     // virtual void        process_callbacks()                                                    = 0;
     // virtual AsyncHandle decompress(const std::string& filename, DecompressCallback_t callback) = 0;
 
-    virtual bool read(u32 namehash, ByteArray* out_buffer)                          = 0;
-    virtual bool read(const std::string& filename, ByteArray* out_buffer)           = 0;
-    virtual bool read_from_disk(const std::string& filename, ByteArray* out_buffer) = 0;
+    // NOTE : reading by namehash is thread safe, reading by filename is not as it goes through the file read handlers
+    virtual bool read(u32 namehash, ByteArray* out_buffer, u32 read_flags = E_READ_FLAG_NONE) = 0;
+    virtual bool read(const std::string& filename, ByteArray* out_buffer)                     = 0;
+    virtual bool read_from_disk(const std::string& filename, ByteArray* out_buffer)           = 0;
+
+    // doesn't copy files the archive stores uncompressed, the view points into the mapped archive and stays valid until
+    // the base path or flags change. compressed (and cached) files are read into scratch_buffer and viewed there.
+    // NOTE : thread safe
+    virtual bool read_view(u32 namehash, ByteArray* scratch_buffer, FileView* out_view,
+                           u32 read_flags = E_READ_FLAG_NONE) = 0;
+
+    // one pass for many files, every archive is read front to back from its mapping. compressed files are decompressed
+    // across the job workers, straight from the mapping where the compression library allows it. out_buffers lines up
+    // with namehashes, the ones which couldn't be read are empty. returns the number which were read.
+    // NOTE : thread safe
+    virtual u32 read_batch(const std::vector<u32>& namehashes, std::vector<ByteArray>* out_buffers) = 0;
+
+    // NOTE : thread safe, the entry in the first archive which has the file (the one read() uses)
+    virtual bool get_entry_info(u32 namehash, EntryInfo* out_info) = 0;
+
+    // reads the files on a background thread into a bounded cache which read() checks first. opening a file by
+    // filename prefetches its dependencies when a dependency graph is loaded, unless the file was prefetched itself.
+    virtual void                   prefetch(const std::vector<u32>& namehashes)                 = 0;
+    virtual bool                   load_dependency_graph(const std::filesystem::path& filename) = 0;
+    virtual const DependencyGraph* get_dependency_graph() const                                 = 0;
 };
 } // namespace jcmr
 
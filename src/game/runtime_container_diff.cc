@@ -0,0 +1,597 @@
+#include "pch.h"
+
+#include "runtime_container_diff.h"
+
+#include "app/profile.h"
+
+namespace jcmr::runtime_container_diff
+{
+using namespace ava::RuntimePropertyContainer;
+
+static constexpr u32 INVALID_INDEX = 0xFFFFFFFF;
+
+enum EOperation : u8 {
+    OP_SET_NAMEHASH = 0,    // u32 namehash
+    OP_ENTER,               // u32 namehash, u16 occurrence
+    OP_LEAVE,               //
+    OP_SET_VARIANT,         // u32 namehash, u16 occurrence, u8 type, value
+    OP_ADD_VARIANT,         // u32 index, u32 namehash, u8 type, value
+    OP_REMOVE_VARIANT,      // u32 namehash, u16 occurrence
+    OP_ADD_CONTAINER,       // u32 index, container
+    OP_REMOVE_CONTAINER,    // u32 namehash, u16 occurrence
+};
+
+struct PatchHeader {
+    u32 m_Magic;
+    u32 m_Version;
+    u64 m_BaseHash;
+    u64 m_TargetHash;
+};
+
+// subtree hash and size (number of containers, including itself) of every container in pre-order
+struct HashedNode {
+    u64 m_Hash;
+    u32 m_Size;
+};
+
+template <typename T> static void put(ByteArray* buffer, const T& value)
+{
+    const auto offset = buffer->size();
+    buffer->resize(offset + sizeof(T));
+    std::memcpy(buffer->data() + offset, &value, sizeof(T));
+}
+
+static void put_bytes(ByteArray* buffer, const void* data, u64 size)
+{
+    auto* bytes = static_cast<const u8*>(data);
+    buffer->insert(buffer->end(), bytes, (bytes + size));
+}
+
+template <typename T> static void put_vector(ByteArray* buffer, const std::vector<T>& values)
+{
+    put<u32>(buffer, static_cast<u32>(values.size()));
+    put_bytes(buffer, values.data(), (values.size() * sizeof(T)));
+}
+
+struct Reader {
+    const ByteArray& m_buffer;
+    u64              m_offset = 0;
+
+    bool eof() const { return m_offset >= m_buffer.size(); }
+
+    template <typename T> bool get(T* out_value)
+    {
+        if (sizeof(T) > (m_buffer.size() - m_offset)) return false;
+        std::memcpy(out_value, m_buffer.data() + m_offset, sizeof(T));
+        m_offset += sizeof(T);
+        return true;
+    }
+
+    bool get_bytes(void* out_data, u64 size)
+    {
+        if (size > (m_buffer.size() - m_offset)) return false;
+        std::memcpy(out_data, m_buffer.data() + m_offset, size);
+        m_offset += size;
+        return true;
+    }
+
+    template <typename T> bool get_vector(std::vector<T>* out_values)
+    {
+        u32 count = 0;
+        if (!get(&count) || (static_cast<u64>(count) * sizeof(T)) > (m_buffer.size() - m_offset)) return false;
+        out_values->resize(count);
+        return get_bytes(out_values->data(), (count * sizeof(T)));
+    }
+};
+
+static void write_value(const Variant& variant, ByteArray* buffer)
+{
+    switch (variant.m_Type) {
+        case T_VARIANT_INTEGER: put(buffer, variant.as<i32>()); break;
+        case T_VARIANT_FLOAT: put(buffer, variant.as<float>()); break;
+        case T_VARIANT_STRING: {
+            const auto& value = variant.as<std::string>();
+            put<u32>(buffer, static_cast<u32>(value.size()));
+            put_bytes(buffer, value.data(), value.size());
+            break;
+        }
+        case T_VARIANT_VEC2: put(buffer, variant.as<std::array<float, 2>>()); break;
+        case T_VARIANT_VEC3: put(buffer, variant.as<std::array<float, 3>>()); break;
+        case T_VARIANT_VEC4: put(buffer, variant.as<std::array<float, 4>>()); break;
+        case T_VARIANT_MAT4x4: put(buffer, variant.as<std::array<float, 16>>()); break;
+        case T_VARIANT_VEC_INTS: put_vector(buffer, variant.as<std::vector<i32>>()); break;
+        case T_VARIANT_VEC_FLOATS: put_vector(buffer, variant.as<std::vector<float>>()); break;
+        case T_VARIANT_VEC_BYTES: put_vector(buffer, variant.as<std::vector<u8>>()); break;
+        case T_VARIANT_OBJECTID: put(buffer, variant.as<ava::SObjectID>().to_uint64()); break;
+        case T_VARIANT_VEC_EVENTS: {
+            const auto& events = variant.as<std::vector<ava::SObjectID>>();
+            put<u32>(buffer, static_cast<u32>(events.size()));
+            for (const auto& event : events) {
+                put(buffer, event.to_uint64());
+            }
+
+            break;
+        }
+
+        default: break;
+    }
+}
+
+template <typename T> static bool read_value(Reader& reader, Variant* variant)
+{
+    T value;
+    if (!reader.get(&value)) return false;
+    variant->m_Value = value;
+    return true;
+}
+
+template <typename T> static bool read_vector_value(Reader& reader, Variant* variant)
+{
+    std::vector<T> values;
+    if (!reader.get_vector(&values)) return false;
+    variant->m_Value = std::move(values);
+    return true;
+}
+
+static bool read_value(Reader& reader, u8 type, Variant* variant)
+{
+    variant->m_Type = static_cast<EVariantType>(type);
+
+    switch (type) {
+        case T_VARIANT_UNASSIGNED: return true;
+        case T_VARIANT_INTEGER: return read_value<i32>(reader, variant);
+        case T_VARIANT_FLOAT: return read_value<float>(reader, variant);
+        case T_VARIANT_STRING: {
+            std::vector<char> chars;
+            if (!reader.get_vector(&chars)) return false;
+            variant->m_Value = std::string(chars.begin(), chars.end());
+            return true;
+        }
+        case T_VARIANT_VEC2: return read_value<std::array<float, 2>>(reader, variant);
+        case T_VARIANT_VEC3: return read_value<std::array<float, 3>>(reader, variant);
+        case T_VARIANT_VEC4: return read_value<std::array<float, 4>>(reader, variant);
+        case T_VARIANT_MAT4x4: return read_value<std::array<float, 16>>(reader, variant);
+        case T_VARIANT_VEC_INTS: return read_vector_value<i32>(reader, variant);
+        case T_VARIANT_VEC_FLOATS: return read_vector_value<float>(reader, variant);
+        case T_VARIANT_VEC_BYTES: return read_vector_value<u8>(reader, variant);
+        case T_VARIANT_OBJECTID: {
+            u64 value;
+            if (!reader.get(&value)) return false;
+            variant->m_Value = ava::SObjectID(value);
+            return true;
+        }
+        case T_VARIANT_VEC_EVENTS: {
+            std::vector<u64> values;
+            if (!reader.get_vector(&values)) return false;
+
+            std::vector<ava::SObjectID> events;
+            events.reserve(values.size());
+            for (auto value : values) {
+                events.emplace_back(value);
+            }
+
+            variant->m_Value = std::move(events);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static u64 hash_bytes(const u8* data, u64 size)
+{
+    // fnv-1a
+    u64 result = 0xCBF29CE484222325;
+    for (u64 i = 0; i < size; ++i) {
+        result = ((result ^ data[i]) * 0x100000001B3);
+    }
+
+    return result;
+}
+
+static u64 hash_combine(u64 seed, u64 value)
+{
+    return (seed ^ (value + 0x9E3779B97F4A7C15 + (seed << 6) + (seed >> 2)));
+}
+
+// scratch is reused between variants to avoid allocating
+static u64 hash_variant(const Variant& variant, ByteArray* scratch)
+{
+    scratch->clear();
+    put(scratch, variant.m_NameHash);
+    put<u8>(scratch, variant.m_Type);
+    write_value(variant, scratch);
+    return hash_bytes(scratch->data(), scratch->size());
+}
+
+// siblings are summed so the hash doesn't depend on their order, which matches how they are looked up in game
+static u64 hash_tree(const Container& container, ByteArray* scratch, std::vector<HashedNode>* out_nodes)
+{
+    const auto index = out_nodes->size();
+    out_nodes->push_back({});
+
+    u64 variants = 0;
+    for (const auto& variant : container.m_Variants) {
+        variants += hash_variant(variant, scratch);
+    }
+
+    u64 children = 0;
+    for (const auto& child : container.m_Containers) {
+        children += hash_tree(child, scratch, out_nodes);
+    }
+
+    const u64 result = hash_combine(hash_combine(hash_combine(0, container.m_NameHash), variants), children);
+
+    (*out_nodes)[index] = {result, static_cast<u32>(out_nodes->size() - index)};
+    return result;
+}
+
+u64 hash(const Container& container)
+{
+    ByteArray               scratch;
+    std::vector<HashedNode> nodes;
+    return hash_tree(container, &scratch, &nodes);
+}
+
+// calls callback(namehash, occurrence, base index, target index) for every namehash occurrence in either list. the
+// index is INVALID_INDEX if the occurrence only exists on the other side.
+template <typename T, typename F>
+static void match_by_namehash(const std::vector<T>& base, const std::vector<T>& target, F&& callback)
+{
+    auto sorted_keys = [](const std::vector<T>& items) {
+        std::vector<std::pair<u32, u32>> result(items.size());
+        for (u32 i = 0; i < items.size(); ++i) {
+            result[i] = {items[i].m_NameHash, i};
+        }
+
+        // index is the tie-breaker, so duplicates keep their original order
+        std::sort(result.begin(), result.end());
+        return result;
+    };
+
+    const auto base_keys   = sorted_keys(base);
+    const auto target_keys = sorted_keys(target);
+
+    u64 i = 0;
+    u64 j = 0;
+    while (i < base_keys.size() || j < target_keys.size()) {
+        u32 namehash;
+        if (j == target_keys.size() || (i < base_keys.size() && base_keys[i].first < target_keys[j].first)) {
+            namehash = base_keys[i].first;
+        } else {
+            namehash = target_keys[j].first;
+        }
+
+        const auto base_end   = std::find_if(base_keys.begin() + i, base_keys.end(),
+                                             [&](const std::pair<u32, u32>& key) { return key.first != namehash; });
+        const auto target_end = std::find_if(target_keys.begin() + j, target_keys.end(),
+                                             [&](const std::pair<u32, u32>& key) { return key.first != namehash; });
+
+        const u64 base_count   = ((base_end - base_keys.begin()) - i);
+        const u64 target_count = ((target_end - target_keys.begin()) - j);
+
+        for (u64 k = 0; k < std::max(base_count, target_count); ++k) {
+            callback(namehash, static_cast<u16>(k), (k < base_count ? base_keys[i + k].second : INVALID_INDEX),
+                     (k < target_count ? target_keys[j + k].second : INVALID_INDEX));
+        }
+
+        i += base_count;
+        j += target_count;
+    }
+}
+
+struct DiffContext {
+    std::vector<HashedNode> m_base_nodes;
+    std::vector<HashedNode> m_target_nodes;
+    ByteArray               m_scratch;
+    ByteArray*              m_patch;
+    Stats                   m_stats;
+};
+
+static void write_reference(ByteArray* patch, EOperation op, u32 namehash, u16 occurrence)
+{
+    put<u8>(patch, op);
+    put(patch, namehash);
+    put(patch, occurrence);
+}
+
+static void write_container(const Container& container, ByteArray* patch)
+{
+    put(patch, container.m_NameHash);
+    put<u32>(patch, static_cast<u32>(container.m_Variants.size()));
+    for (const auto& variant : container.m_Variants) {
+        put(patch, variant.m_NameHash);
+        put<u8>(patch, variant.m_Type);
+        write_value(variant, patch);
+    }
+
+    put<u32>(patch, static_cast<u32>(container.m_Containers.size()));
+    for (const auto& child : container.m_Containers) {
+        write_container(child, patch);
+    }
+}
+
+static bool read_container(Reader& reader, Container* container, u32 depth = 0)
+{
+    // guards against malformed patches recursing forever
+    if (depth > 256) return false;
+
+    u32 num_variants = 0;
+    if (!reader.get(&container->m_NameHash) || !reader.get(&num_variants)) return false;
+
+    container->m_Variants.resize(num_variants);
+    for (auto& variant : container->m_Variants) {
+        u8 type;
+        if (!reader.get(&variant.m_NameHash) || !reader.get(&type) || !read_value(reader, type, &variant)) {
+            return false;
+        }
+    }
+
+    u32 num_containers = 0;
+    if (!reader.get(&num_containers)) return false;
+
+    container->m_Containers.resize(num_containers);
+    for (auto& child : container->m_Containers) {
+        if (!read_container(reader, &child, (depth + 1))) return false;
+    }
+
+    return true;
+}
+
+// pre-order indices of the direct children of the container at node
+static std::vector<u32> get_child_nodes(const std::vector<HashedNode>& nodes, u32 node, u64 count)
+{
+    std::vector<u32> result(count);
+
+    u32 index = (node + 1);
+    for (u64 i = 0; i < count; ++i) {
+        result[i] = index;
+        index += nodes[index].m_Size;
+    }
+
+    return result;
+}
+
+static void diff_container(DiffContext& context, const Container& base, u32 base_node, const Container& target,
+                           u32 target_node)
+{
+    auto* patch = context.m_patch;
+
+    if (base.m_NameHash != target.m_NameHash) {
+        put<u8>(patch, OP_SET_NAMEHASH);
+        put(patch, target.m_NameHash);
+    }
+
+    // variants. removes are written in reverse so earlier occurrences of the same namehash don't move, adds are written
+    // in target order with their target index so matched entries keep their place.
+    std::vector<std::pair<u32, u16>> removed;
+    std::vector<u32>                 added;
+
+    match_by_namehash(base.m_Variants, target.m_Variants, [&](u32 namehash, u16 occurrence, u32 lhs, u32 rhs) {
+        if (rhs == INVALID_INDEX) {
+            removed.emplace_back(namehash, occurrence);
+        } else if (lhs == INVALID_INDEX) {
+            added.push_back(rhs);
+        } else {
+            const auto& base_variant   = base.m_Variants[lhs];
+            const auto& target_variant = target.m_Variants[rhs];
+            if (hash_variant(base_variant, &context.m_scratch) != hash_variant(target_variant, &context.m_scratch)) {
+                write_reference(patch, OP_SET_VARIANT, namehash, occurrence);
+                put<u8>(patch, target_variant.m_Type);
+                write_value(target_variant, patch);
+                ++context.m_stats.m_NumChangedVariants;
+            }
+        }
+    });
+
+    for (auto it = removed.rbegin(); it != removed.rend(); ++it) {
+        write_reference(patch, OP_REMOVE_VARIANT, (*it).first, (*it).second);
+    }
+
+    std::sort(added.begin(), added.end());
+    for (auto index : added) {
+        const auto& variant = target.m_Variants[index];
+        put<u8>(patch, OP_ADD_VARIANT);
+        put(patch, index);
+        put(patch, variant.m_NameHash);
+        put<u8>(patch, variant.m_Type);
+        write_value(variant, patch);
+    }
+
+    context.m_stats.m_NumRemovedVariants += static_cast<u32>(removed.size());
+    context.m_stats.m_NumAddedVariants += static_cast<u32>(added.size());
+
+    // containers
+    removed.clear();
+    added.clear();
+
+    const auto base_children   = get_child_nodes(context.m_base_nodes, base_node, base.m_Containers.size());
+    const auto target_children = get_child_nodes(context.m_target_nodes, target_node, target.m_Containers.size());
+
+    match_by_namehash(base.m_Containers, target.m_Containers, [&](u32 namehash, u16 occurrence, u32 lhs, u32 rhs) {
+        if (rhs == INVALID_INDEX) {
+            removed.emplace_back(namehash, occurrence);
+        } else if (lhs == INVALID_INDEX) {
+            added.push_back(rhs);
+        } else if (context.m_base_nodes[base_children[lhs]].m_Hash
+                   != context.m_target_nodes[target_children[rhs]].m_Hash) {
+            write_reference(patch, OP_ENTER, namehash, occurrence);
+            diff_container(context, base.m_Containers[lhs], base_children[lhs], target.m_Containers[rhs],
+                           target_children[rhs]);
+            put<u8>(patch, OP_LEAVE);
+        }
+    });
+
+    for (auto it = removed.rbegin(); it != removed.rend(); ++it) {
+        write_reference(patch, OP_REMOVE_CONTAINER, (*it).first, (*it).second);
+    }
+
+    std::sort(added.begin(), added.end());
+    for (auto index : added) {
+        put<u8>(patch, OP_ADD_CONTAINER);
+        put(patch, index);
+        write_container(target.m_Containers[index], patch);
+    }
+
+    context.m_stats.m_NumRemovedContainers += static_cast<u32>(removed.size());
+    context.m_stats.m_NumAddedContainers += static_cast<u32>(added.size());
+}
+
+bool diff(const Container& base, const Container& target, ByteArray* out_patch, Stats* out_stats)
+{
+    ProfileBlock _("RuntimeContainer diff");
+
+    DiffContext context;
+    context.m_patch = out_patch;
+
+    PatchHeader header{};
+    header.m_Magic      = PATCH_MAGIC;
+    header.m_Version    = PATCH_VERSION;
+    header.m_BaseHash   = hash_tree(base, &context.m_scratch, &context.m_base_nodes);
+    header.m_TargetHash = hash_tree(target, &context.m_scratch, &context.m_target_nodes);
+
+    out_patch->clear();
+    put(out_patch, header);
+
+    if (header.m_BaseHash != header.m_TargetHash) {
+        diff_container(context, base, 0, target, 0);
+    }
+
+    if (out_stats) *out_stats = context.m_stats;
+    return true;
+}
+
+template <typename T> static T* find_occurrence(std::vector<T>& items, u32 namehash, u16 occurrence)
+{
+    for (auto& item : items) {
+        if (item.m_NameHash == namehash && occurrence-- == 0) {
+            return &item;
+        }
+    }
+
+    return nullptr;
+}
+
+template <typename T> static bool remove_occurrence(std::vector<T>& items, u32 namehash, u16 occurrence)
+{
+    auto* item = find_occurrence(items, namehash, occurrence);
+    if (!item) return false;
+
+    items.erase(items.begin() + (item - items.data()));
+    return true;
+}
+
+static bool apply_operation(Reader& reader, u8 op, std::vector<Container*>* stack)
+{
+    auto* container = stack->back();
+
+    u32 namehash   = 0;
+    u16 occurrence = 0;
+
+    switch (op) {
+        case OP_SET_NAMEHASH: return reader.get(&container->m_NameHash);
+
+        case OP_ENTER: {
+            if (!reader.get(&namehash) || !reader.get(&occurrence)) return false;
+
+            auto* child = find_occurrence(container->m_Containers, namehash, occurrence);
+            if (!child) return false;
+
+            stack->push_back(child);
+            return true;
+        }
+
+        case OP_LEAVE: {
+            if (stack->size() == 1) return false;
+            stack->pop_back();
+            return true;
+        }
+
+        case OP_SET_VARIANT: {
+            u8 type;
+            if (!reader.get(&namehash) || !reader.get(&occurrence) || !reader.get(&type)) return false;
+
+            auto* variant = find_occurrence(container->m_Variants, namehash, occurrence);
+            return (variant && read_value(reader, type, variant));
+        }
+
+        case OP_ADD_VARIANT: {
+            Variant variant;
+            u32     index;
+            u8      type;
+            if (!reader.get(&index) || !reader.get(&variant.m_NameHash) || !reader.get(&type)
+                || !read_value(reader, type, &variant)) {
+                return false;
+            }
+
+            auto& variants = container->m_Variants;
+            variants.insert(variants.begin() + std::min<u64>(index, variants.size()), std::move(variant));
+            return true;
+        }
+
+        case OP_REMOVE_VARIANT: {
+            if (!reader.get(&namehash) || !reader.get(&occurrence)) return false;
+            return remove_occurrence(container->m_Variants, namehash, occurrence);
+        }
+
+        case OP_ADD_CONTAINER: {
+            Container child;
+            u32       index;
+            if (!reader.get(&index) || !read_container(reader, &child)) return false;
+
+            auto& children = container->m_Containers;
+            children.insert(children.begin() + std::min<u64>(index, children.size()), std::move(child));
+            return true;
+        }
+
+        case OP_REMOVE_CONTAINER: {
+            if (!reader.get(&namehash) || !reader.get(&occurrence)) return false;
+            return remove_occurrence(container->m_Containers, namehash, occurrence);
+        }
+    }
+
+    return false;
+}
+
+bool apply(const ByteArray& patch, Container* base)
+{
+    ProfileBlock _("RuntimeContainer apply patch");
+
+    Reader      reader{patch};
+    PatchHeader header{};
+    if (!reader.get(&header) || header.m_Magic != PATCH_MAGIC) {
+        LOG_ERROR("RuntimeContainer : input is not a runtime container patch.");
+        return false;
+    }
+
+    if (header.m_Version != PATCH_VERSION) {
+        LOG_ERROR("RuntimeContainer : unsupported patch version {}.", header.m_Version);
+        return false;
+    }
+
+    if (hash(*base) != header.m_BaseHash) {
+        LOG_ERROR("RuntimeContainer : patch was not made against this container.");
+        return false;
+    }
+
+    std::vector<Container*> stack{base};
+    while (!reader.eof()) {
+        const auto offset = reader.m_offset;
+
+        u8 op;
+        reader.get(&op);
+
+        if (!apply_operation(reader, op, &stack)) {
+            LOG_ERROR("RuntimeContainer : patch is malformed (operation {} at offset {}).", op, offset);
+            return false;
+        }
+    }
+
+    if (hash(*base) != header.m_TargetHash) {
+        LOG_ERROR("RuntimeContainer : patched container doesn't match the patch target.");
+        return false;
+    }
+
+    return true;
+}
+} // namespace jcmr::runtime_container_diff
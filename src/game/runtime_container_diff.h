@@ -0,0 +1,42 @@
+#ifndef JCMR_GAME_RUNTIME_CONTAINER_DIFF_H_HEADER_GUARD
+#define JCMR_GAME_RUNTIME_CONTAINER_DIFF_H_HEADER_GUARD
+
+#include "platform.h"
+
+namespace ava::RuntimePropertyContainer
+{
+struct Container;
+}
+
+// structural diff of two runtime containers. containers and variants are matched by namehash (the n-th occurrence of
+// a namehash in the base matches the n-th occurrence in the target), and every subtree is hashed first so unchanged
+// branches are skipped without being visited.
+//
+// the patch is a flat list of operations which is applied to the parsed base container, the result can then be saved
+// with RuntimePropertyContainer::Write. sibling order isn't part of the comparison, added variants and containers are
+// inserted at their index in the target.
+namespace jcmr::runtime_container_diff
+{
+static constexpr u32 PATCH_MAGIC   = 0x54415052; // RPAT
+static constexpr u32 PATCH_VERSION = 1;
+
+struct Stats {
+    u32 m_NumChangedVariants   = 0;
+    u32 m_NumAddedVariants     = 0;
+    u32 m_NumRemovedVariants   = 0;
+    u32 m_NumAddedContainers   = 0;
+    u32 m_NumRemovedContainers = 0;
+};
+
+// hash of a container, its variants and all of its children (independent of sibling order)
+u64 hash(const ava::RuntimePropertyContainer::Container& container);
+
+bool diff(const ava::RuntimePropertyContainer::Container& base, const ava::RuntimePropertyContainer::Container& target,
+          ByteArray* out_patch, Stats* out_stats = nullptr);
+
+// fails if the patch was made against a different base, the base is left in an undefined state if the patch is
+// malformed.
+bool apply(const ByteArray& patch, ava::RuntimePropertyContainer::Container* base);
+} // namespace jcmr::runtime_container_diff
+
+#endif // JCMR_GAME_RUNTIME_CONTAINER_DIFF_H_HEADER_GUARD
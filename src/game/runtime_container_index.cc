@@ -0,0 +1,366 @@
+#include "pch.h"
+
+#include "runtime_container_index.h"
+
+#include "app/jobs.h"
+#include "app/profile.h"
+#include "app/utils.h"
+
+#include "game/name_hash_lookup.h"
+#include "game/resource_manager.h"
+
+#include <atomic>
+#include <fstream>
+#include <numeric>
+
+namespace jcmr
+{
+static constexpr std::array RUNTIME_CONTAINER_EXTENSIONS{"blo", "epe"};
+
+struct IndexHeader {
+    u32 m_Magic;
+    u32 m_Version;
+    u32 m_NumFiles;
+    u32 m_NumContainers;
+    u32 m_NumRecords;
+    u32 m_StringTableSize;
+};
+
+// containers and records for a single file, container indices are local to the file until they are merged
+struct IndexedFile {
+    std::vector<RuntimeContainerIndex::Container> m_Containers;
+    std::vector<RuntimeContainerIndex::Record>    m_Records;
+};
+
+static u32 digest_bytes(const void* data, u64 size)
+{
+    // fnv-1a
+    auto* bytes  = static_cast<const u8*>(data);
+    u32   result = 0x811C9DC5;
+    for (u64 i = 0; i < size; ++i) {
+        result = ((result ^ bytes[i]) * 0x01000193);
+    }
+
+    return result;
+}
+
+template <typename T> static u32 digest_vector(const std::vector<T>& values)
+{
+    return digest_bytes(values.data(), (values.size() * sizeof(T)));
+}
+
+// ints are stored as-is and strings are hashed with hashlittle so both forms of a name reference (string path or
+// precomputed namehash) have the same digest.
+static u32 digest(const ava::RuntimePropertyContainer::Variant& variant)
+{
+    using namespace ava::RuntimePropertyContainer;
+
+    switch (variant.m_Type) {
+        case T_VARIANT_INTEGER: return static_cast<u32>(variant.as<i32>());
+        case T_VARIANT_FLOAT: {
+            auto value = variant.as<float>();
+            return digest_bytes(&value, sizeof(value));
+        }
+        case T_VARIANT_STRING: return ava::hashlittle(variant.as<std::string>().c_str());
+        case T_VARIANT_VEC2: return digest_bytes(variant.as<std::array<float, 2>>().data(), sizeof(float) * 2);
+        case T_VARIANT_VEC3: return digest_bytes(variant.as<std::array<float, 3>>().data(), sizeof(float) * 3);
+        case T_VARIANT_VEC4: return digest_bytes(variant.as<std::array<float, 4>>().data(), sizeof(float) * 4);
+        case T_VARIANT_MAT4x4: return digest_bytes(variant.as<std::array<float, 16>>().data(), sizeof(float) * 16);
+        case T_VARIANT_VEC_INTS: return digest_vector(variant.as<std::vector<i32>>());
+        case T_VARIANT_VEC_FLOATS: return digest_vector(variant.as<std::vector<float>>());
+        case T_VARIANT_VEC_BYTES: return digest_vector(variant.as<std::vector<u8>>());
+        case T_VARIANT_OBJECTID: {
+            auto value = variant.as<ava::SObjectID>().to_uint64();
+            return digest_bytes(&value, sizeof(value));
+        }
+        case T_VARIANT_VEC_EVENTS: {
+            u32 result = 0;
+            for (const auto& event : variant.as<std::vector<ava::SObjectID>>()) {
+                auto value = event.to_uint64();
+                result ^= (digest_bytes(&value, sizeof(value)) + 0x9E3779B9 + (result << 6) + (result >> 2));
+            }
+
+            return result;
+        }
+    }
+
+    return 0;
+}
+
+static void index_container(const ava::RuntimePropertyContainer::Container& container, u32 parent, u32 file,
+                            IndexedFile* out_file)
+{
+    const auto index = static_cast<u32>(out_file->m_Containers.size());
+    out_file->m_Containers.push_back({parent, container.m_NameHash});
+
+    for (const auto& variant : container.m_Variants) {
+        if (variant.m_Type == ava::RuntimePropertyContainer::T_VARIANT_UNASSIGNED) continue;
+
+        RuntimeContainerIndex::Record record{};
+        record.m_NameHash  = variant.m_NameHash;
+        record.m_Value     = digest(variant);
+        record.m_File      = file;
+        record.m_Container = index;
+        record.m_Type      = static_cast<u8>(variant.m_Type);
+        out_file->m_Records.push_back(record);
+    }
+
+    for (const auto& child : container.m_Containers) {
+        index_container(child, index, file, out_file);
+    }
+}
+
+static bool is_runtime_container(const std::string& filename)
+{
+    const auto extension = utils::get_extension(filename);
+    return std::find_if(RUNTIME_CONTAINER_EXTENSIONS.begin(), RUNTIME_CONTAINER_EXTENSIONS.end(),
+                        [&](const char* ext) { return extension == ext; })
+           != RUNTIME_CONTAINER_EXTENSIONS.end();
+}
+
+bool RuntimeContainerIndex::build(ResourceManager& resource_manager)
+{
+    ProfileBlock _("RuntimeContainerIndex build");
+
+    std::vector<std::pair<u32, std::string>> files;
+    resource_manager.enumerate_dictionary([&](u32 namehash, const std::string& filename) {
+        if (is_runtime_container(filename)) {
+            files.emplace_back(namehash, filename);
+        }
+    });
+
+    // keep the output stable between builds
+    std::sort(files.begin(), files.end(), [](const auto& lhs, const auto& rhs) { return lhs.second < rhs.second; });
+
+    LOG_INFO("RuntimeContainerIndex : indexing {} runtime containers...", files.size());
+
+    std::vector<IndexedFile> indexed_files(files.size());
+    std::atomic<u32>         num_failed = 0;
+
+    jobs::parallel_for(static_cast<u32>(files.size()), [&](u32 index, u32) {
+        ByteArray buffer;
+        if (!resource_manager.read(files[index].first, &buffer, ResourceManager::E_READ_FLAG_QUIET)) {
+            ++num_failed;
+            return;
+        }
+
+        ava::RuntimePropertyContainer::Container container{};
+        if (!AVA_FL_SUCCEEDED(ava::RuntimePropertyContainer::Parse(buffer, &container))) {
+            ++num_failed;
+            return;
+        }
+
+        index_container(container, INVALID_INDEX, index, &indexed_files[index]);
+    });
+
+    if (num_failed > 0) {
+        LOG_WARNING("RuntimeContainerIndex : {} files failed to read or parse.", num_failed.load());
+    }
+
+    // merge the per-file results, container indices are offset into the global container list
+    m_files.clear();
+    m_containers.clear();
+    m_records.clear();
+    m_strings.clear();
+
+    m_files.reserve(files.size());
+    for (u32 i = 0; i < files.size(); ++i) {
+        const auto& [namehash, filename] = files[i];
+        m_files.push_back({namehash, static_cast<u32>(m_strings.size())});
+        m_strings.insert(m_strings.end(), filename.begin(), filename.end());
+        m_strings.push_back('\0');
+
+        auto&     indexed_file     = indexed_files[i];
+        const u32 container_offset = static_cast<u32>(m_containers.size());
+
+        for (auto container : indexed_file.m_Containers) {
+            if (container.m_Parent != INVALID_INDEX) container.m_Parent += container_offset;
+            m_containers.push_back(container);
+        }
+
+        for (auto record : indexed_file.m_Records) {
+            record.m_Container += container_offset;
+            m_records.push_back(record);
+        }
+
+        // free as we go, the full set of parsed files can be large
+        indexed_file = {};
+    }
+
+    std::sort(m_records.begin(), m_records.end(), [](const Record& lhs, const Record& rhs) {
+        return std::tie(lhs.m_NameHash, lhs.m_Value, lhs.m_File, lhs.m_Container)
+               < std::tie(rhs.m_NameHash, rhs.m_Value, rhs.m_File, rhs.m_Container);
+    });
+
+    m_records_by_value.resize(m_records.size());
+    std::iota(m_records_by_value.begin(), m_records_by_value.end(), 0);
+    std::stable_sort(m_records_by_value.begin(), m_records_by_value.end(),
+                     [&](u32 lhs, u32 rhs) { return m_records[lhs].m_Value < m_records[rhs].m_Value; });
+
+    LOG_INFO("RuntimeContainerIndex : indexed {} files, {} containers, {} variants.", m_files.size(),
+             m_containers.size(), m_records.size());
+    return true;
+}
+
+template <typename T> static void write_vector(std::ofstream& stream, const std::vector<T>& values)
+{
+    stream.write(reinterpret_cast<const char*>(values.data()), (values.size() * sizeof(T)));
+}
+
+template <typename T> static bool read_vector(std::ifstream& stream, u32 count, std::vector<T>* out_values)
+{
+    out_values->resize(count);
+    stream.read(reinterpret_cast<char*>(out_values->data()), (count * sizeof(T)));
+    return !stream.fail();
+}
+
+bool RuntimeContainerIndex::load(const std::filesystem::path& filename)
+{
+    std::ifstream stream(filename, std::ios::binary);
+    if (stream.fail()) {
+        return false;
+    }
+
+    IndexHeader header{};
+    stream.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (stream.fail() || header.m_Magic != INDEX_MAGIC) {
+        LOG_ERROR("RuntimeContainerIndex : \"{}\" is not a runtime container index.", filename.generic_string());
+        return false;
+    }
+
+    if (header.m_Version != INDEX_VERSION) {
+        LOG_ERROR("RuntimeContainerIndex : \"{}\" is out of date (version {}), it needs to be rebuilt.",
+                  filename.generic_string(), header.m_Version);
+        return false;
+    }
+
+    if (!read_vector(stream, header.m_NumFiles, &m_files) || !read_vector(stream, header.m_NumContainers, &m_containers)
+        || !read_vector(stream, header.m_NumRecords, &m_records)
+        || !read_vector(stream, header.m_NumRecords, &m_records_by_value)
+        || !read_vector(stream, header.m_StringTableSize, &m_strings)) {
+        LOG_ERROR("RuntimeContainerIndex : \"{}\" is truncated.", filename.generic_string());
+        return false;
+    }
+
+    if (!validate()) {
+        LOG_ERROR("RuntimeContainerIndex : \"{}\" is corrupt, it needs to be rebuilt.", filename.generic_string());
+        return false;
+    }
+
+    return true;
+}
+
+// every offset and index read from disk is used without a bounds check afterwards
+bool RuntimeContainerIndex::validate() const
+{
+    if (!m_files.empty() && (m_strings.empty() || m_strings.back() != '\0')) {
+        return false;
+    }
+
+    for (const auto& file : m_files) {
+        if (file.m_NameOffset >= m_strings.size()) return false;
+    }
+
+    // parents are always added before their children, which also rules out cycles
+    for (u32 i = 0; i < m_containers.size(); ++i) {
+        if (m_containers[i].m_Parent != INVALID_INDEX && m_containers[i].m_Parent >= i) return false;
+    }
+
+    for (const auto& record : m_records) {
+        if (record.m_File >= m_files.size() || record.m_Container >= m_containers.size()) return false;
+    }
+
+    return std::all_of(m_records_by_value.begin(), m_records_by_value.end(),
+                       [&](u32 index) { return index < m_records.size(); });
+}
+
+bool RuntimeContainerIndex::save(const std::filesystem::path& filename) const
+{
+    if (filename.has_parent_path()) {
+        std::filesystem::create_directories(filename.parent_path());
+    }
+
+    std::ofstream stream(filename, std::ios::binary);
+    if (stream.fail()) {
+        return false;
+    }
+
+    IndexHeader header{};
+    header.m_Magic           = INDEX_MAGIC;
+    header.m_Version         = INDEX_VERSION;
+    header.m_NumFiles        = static_cast<u32>(m_files.size());
+    header.m_NumContainers   = static_cast<u32>(m_containers.size());
+    header.m_NumRecords      = static_cast<u32>(m_records.size());
+    header.m_StringTableSize = static_cast<u32>(m_strings.size());
+
+    stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    write_vector(stream, m_files);
+    write_vector(stream, m_containers);
+    write_vector(stream, m_records);
+    write_vector(stream, m_records_by_value);
+    write_vector(stream, m_strings);
+    return !stream.fail();
+}
+
+std::vector<const RuntimeContainerIndex::Record*> RuntimeContainerIndex::query(const Query& query) const
+{
+    std::vector<const Record*> result;
+
+    auto add_result = [&](const Record& record) {
+        if (query.m_Limit != 0 && result.size() >= query.m_Limit) return false;
+        result.push_back(&record);
+        return true;
+    };
+
+    if (query.m_NameHash.has_value()) {
+        // records are sorted by namehash then value so both lookups are a single range
+        const auto key   = std::make_pair(query.m_NameHash.value(), query.m_Value.value_or(0));
+        auto       begin = std::lower_bound(m_records.begin(), m_records.end(), key,
+                                            [](const Record& record, const std::pair<u32, u32>& key) {
+                                                return std::make_pair(record.m_NameHash, record.m_Value) < key;
+                                            });
+
+        for (auto it = begin; it != m_records.end() && (*it).m_NameHash == query.m_NameHash.value(); ++it) {
+            if (query.m_Value.has_value() && (*it).m_Value != query.m_Value.value()) break;
+            if (!add_result(*it)) break;
+        }
+    } else if (query.m_Value.has_value()) {
+        auto begin = std::lower_bound(m_records_by_value.begin(), m_records_by_value.end(), query.m_Value.value(),
+                                      [&](u32 index, u32 value) { return m_records[index].m_Value < value; });
+
+        for (auto it = begin; it != m_records_by_value.end() && m_records[*it].m_Value == query.m_Value.value(); ++it) {
+            if (!add_result(m_records[*it])) break;
+        }
+    }
+
+    return result;
+}
+
+std::string_view RuntimeContainerIndex::get_filename(const Record& record) const
+{
+    ASSERT(record.m_File < m_files.size());
+    const u32 offset = m_files[record.m_File].m_NameOffset;
+    if (offset >= m_strings.size()) {
+        return {};
+    }
+
+    // the table is null terminated, but don't rely on it
+    const char* name = &m_strings[offset];
+    const auto* end  = static_cast<const char*>(std::memchr(name, '\0', (m_strings.size() - offset)));
+    return std::string_view(name, (end ? (end - name) : (m_strings.size() - offset)));
+}
+
+std::string RuntimeContainerIndex::get_container_path(const Record& record) const
+{
+    std::vector<std::string> parts;
+    for (u32 index = record.m_Container; index != INVALID_INDEX; index = m_containers[index].m_Parent) {
+        const auto namehash = m_containers[index].m_NameHash;
+
+        std::string name(find_in_namehash_lookup_table(namehash));
+        parts.push_back(name.empty() ? fmt::format("0x{:X}", namehash) : std::move(name));
+    }
+
+    std::reverse(parts.begin(), parts.end());
+    return utils::join(parts, "/");
+}
+} // namespace jcmr
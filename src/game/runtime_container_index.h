@@ -0,0 +1,68 @@
+#ifndef JCMR_GAME_RUNTIME_CONTAINER_INDEX_H_HEADER_GUARD
+#define JCMR_GAME_RUNTIME_CONTAINER_INDEX_H_HEADER_GUARD
+
+#include "platform.h"
+
+#include <string_view>
+
+namespace jcmr
+{
+struct ResourceManager;
+
+// index of every variant in every runtime container across the game archives. used to answer "which files set
+// variant X" or "which containers use hash Y" without opening every file.
+struct RuntimeContainerIndex {
+    static constexpr u32 INDEX_MAGIC   = 0x58444952; // RIDX
+    static constexpr u32 INDEX_VERSION = 1;
+    static constexpr u32 INVALID_INDEX = 0xFFFFFFFF;
+
+    struct File {
+        u32 m_NameHash;
+        u32 m_NameOffset; // offset into the string table
+    };
+
+    struct Container {
+        u32 m_Parent; // index of the parent container, INVALID_INDEX for the root container
+        u32 m_NameHash;
+    };
+
+    struct Record {
+        u32 m_NameHash; // variant namehash
+        u32 m_Value;    // value digest, see RuntimeContainerIndex::digest
+        u32 m_File;
+        u32 m_Container;
+        u8  m_Type;
+        u8  _padding[3];
+    };
+
+    struct Query {
+        std::optional<u32> m_NameHash;
+        std::optional<u32> m_Value;
+        u32                m_Limit = 0; // 0 for no limit
+    };
+
+    bool build(ResourceManager& resource_manager);
+    bool load(const std::filesystem::path& filename);
+    bool save(const std::filesystem::path& filename) const;
+
+    std::vector<const Record*> query(const Query& query) const;
+
+    std::string_view get_filename(const Record& record) const;
+    std::string      get_container_path(const Record& record) const;
+
+    u32 get_num_files() const { return static_cast<u32>(m_files.size()); }
+    u32 get_num_records() const { return static_cast<u32>(m_records.size()); }
+
+  private:
+    bool validate() const;
+
+  private:
+    std::vector<File>      m_files;
+    std::vector<Container> m_containers;
+    std::vector<Record>    m_records;          // sorted by variant namehash, then value
+    std::vector<u32>       m_records_by_value; // record indices sorted by value
+    std::vector<char>      m_strings;
+};
+} // namespace jcmr
+
+#endif // JCMR_GAME_RUNTIME_CONTAINER_INDEX_H_HEADER_GUARD
@@ -0,0 +1,340 @@
+#include "pch.h"
+
+#include "texture_export.h"
+
+#include "app/jobs.h"
+#include "app/texture_decoder.h"
+
+#include "game/avtx.h"
+#include "game/dependency_graph.h"
+#include "game/resource_manager.h"
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <unordered_set>
+
+namespace jcmr::texture_export
+{
+using Clock = std::chrono::high_resolution_clock;
+
+static double get_elapsed_ms(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+static std::string get_source_filename(const std::string& filename)
+{
+    static constexpr std::string_view extension = ".ddsc";
+
+    const std::string_view view(filename);
+    if (view.size() < extension.size() || view.substr(view.size() - extension.size()) != extension) {
+        return {};
+    }
+
+    return (filename.substr(0, (filename.size() - extension.size())) + ".hmddsc");
+}
+
+static bool decode_buffer(const std::string& filename, const ByteArray& buffer, const ByteArray& source_buffer,
+                          DecodedTexture* out_texture)
+{
+    avtx::StreamView stream;
+    if (!avtx::get_best_stream(buffer, source_buffer, &stream)) {
+        LOG_ERROR("TextureExport : failed to read texture entry from \"{}\"", filename);
+        return false;
+    }
+
+    if (!texture_decoder::is_supported(stream.m_Format)) {
+        LOG_ERROR("TextureExport : \"{}\" uses unsupported format {}", filename, stream.m_Format);
+        return false;
+    }
+
+    out_texture->m_Width  = stream.m_Width;
+    out_texture->m_Height = stream.m_Height;
+    out_texture->m_Format = stream.m_Format;
+    out_texture->m_Pixels.resize(static_cast<u64>(stream.m_Width) * stream.m_Height * 4);
+
+    if (!texture_decoder::decode(stream.m_Format, stream.m_Data, stream.m_Size, stream.m_Width, stream.m_Height,
+                                 out_texture->m_Pixels.data())) {
+        LOG_ERROR("TextureExport : failed to decode \"{}\" ({}x{} {}, {} bytes)", filename, stream.m_Width,
+                  stream.m_Height, texture_decoder::get_format_name(stream.m_Format), stream.m_Size);
+        return false;
+    }
+
+    return true;
+}
+
+// archive paths come from the files being exported, anything which would be written outside of out_directory is skipped
+static bool is_safe_relative_path(const std::string& filename)
+{
+    const auto path = std::filesystem::path(filename).lexically_normal();
+    if (path.empty() || path == "." || path.has_root_name() || path.has_root_directory()) {
+        return false;
+    }
+
+    return std::none_of(path.begin(), path.end(), [](const std::filesystem::path& part) { return part == ".."; });
+}
+
+static bool write_file(const std::filesystem::path& filename, const ByteArray& buffer)
+{
+    if (filename.has_parent_path()) {
+        std::error_code error;
+        std::filesystem::create_directories(filename.parent_path(), error);
+    }
+
+    std::ofstream stream(filename, std::ios::binary);
+    if (stream.fail()) {
+        LOG_ERROR("TextureExport : failed to write \"{}\"", filename.generic_string());
+        return false;
+    }
+
+    stream.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+    return true;
+}
+
+bool decode(ResourceManager& resource_manager, const std::string& filename, DecodedTexture* out_texture)
+{
+    ByteArray buffer;
+    if (!resource_manager.read(ava::hashlittle(filename.c_str()), &buffer)) {
+        LOG_ERROR("TextureExport : failed to read \"{}\"", filename);
+        return false;
+    }
+
+    // the high resolution source is optional, not every texture has one
+    ByteArray  source_buffer;
+    const auto source_filename = get_source_filename(filename);
+    if (!source_filename.empty()) {
+        resource_manager.read(ava::hashlittle(source_filename.c_str()), &source_buffer,
+                              ResourceManager::E_READ_FLAG_QUIET);
+    }
+
+    return decode_buffer(filename, buffer, source_buffer, out_texture);
+}
+
+bool export_to(ResourceManager& resource_manager, const std::string& filename,
+               const std::filesystem::path& out_filename, image_writer::EImageType type)
+{
+    DecodedTexture texture;
+    if (!decode(resource_manager, filename, &texture)) {
+        return false;
+    }
+
+    ByteArray buffer;
+    if (!image_writer::encode(type, texture.m_Pixels.data(), texture.m_Width, texture.m_Height, &buffer)) {
+        LOG_ERROR("TextureExport : failed to encode \"{}\"", filename);
+        return false;
+    }
+
+    return write_file(out_filename, buffer);
+}
+
+bool export_batch(ResourceManager& resource_manager, const std::vector<std::string>& filenames,
+                  const std::filesystem::path& out_directory, image_writer::EImageType type, BatchStats* out_stats)
+{
+    struct Texture {
+        const std::string* m_Filename;
+        u32                m_Buffer;
+        u32                m_SourceBuffer; // INVALID_BUFFER if there's no .hmddsc
+    };
+
+    static constexpr u32 INVALID_BUFFER = 0xFFFFFFFF;
+
+    *out_stats = {};
+
+    // unique textures, the sources which exist are read in the same batch
+    auto start = Clock::now();
+
+    std::vector<Texture>       textures;
+    std::vector<u32>           namehashes;
+    std::unordered_set<u32>    seen;
+    ResourceManager::EntryInfo entry;
+    for (const auto& filename : filenames) {
+        const u32 namehash = ava::hashlittle(filename.c_str());
+        if (!seen.insert(namehash).second) continue;
+
+        if (!is_safe_relative_path(filename)) {
+            LOG_WARNING("TextureExport : skipping \"{}\", it isn't a relative path", filename);
+            continue;
+        }
+
+        Texture texture{&filename, static_cast<u32>(namehashes.size()), INVALID_BUFFER};
+        namehashes.push_back(namehash);
+
+        const auto source_filename = get_source_filename(filename);
+        if (!source_filename.empty()) {
+            const u32 source_namehash = ava::hashlittle(source_filename.c_str());
+            if (resource_manager.get_entry_info(source_namehash, &entry)) {
+                texture.m_SourceBuffer = static_cast<u32>(namehashes.size());
+                namehashes.push_back(source_namehash);
+                ++out_stats->m_NumSources;
+            }
+        }
+
+        textures.push_back(texture);
+    }
+
+    out_stats->m_NumTextures = static_cast<u32>(textures.size());
+    out_stats->m_GatherMs    = get_elapsed_ms(start);
+
+    start = Clock::now();
+
+    std::vector<ByteArray> buffers;
+    resource_manager.read_batch(namehashes, &buffers);
+    for (const auto& buffer : buffers) {
+        out_stats->m_ReadSize += buffer.size();
+    }
+
+    out_stats->m_ReadMs = get_elapsed_ms(start);
+
+    // a texture per item, the buffers are released as soon as they're decoded
+    std::atomic<u32> num_exported = 0;
+    std::atomic<u64> decode_us    = 0;
+    std::atomic<u64> encode_us    = 0;
+    std::atomic<u64> write_us     = 0;
+
+    const auto to_us = [](Clock::time_point from) {
+        return static_cast<u64>(std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - from).count());
+    };
+
+    start = Clock::now();
+    jobs::parallel_for(static_cast<u32>(textures.size()), [&](u32 index, u32) {
+        const auto& texture  = textures[index];
+        const auto& filename = *texture.m_Filename;
+
+        auto& buffer = buffers[texture.m_Buffer];
+        if (buffer.empty()) {
+            LOG_ERROR("TextureExport : failed to read \"{}\"", filename);
+            return;
+        }
+
+        ByteArray  no_source;
+        const bool has_source  = (texture.m_SourceBuffer != INVALID_BUFFER);
+        auto&      source      = (has_source ? buffers[texture.m_SourceBuffer] : no_source);
+        auto       stage_start = Clock::now();
+
+        DecodedTexture decoded;
+        const bool     success = decode_buffer(filename, buffer, source, &decoded);
+
+        buffer = {};
+        if (has_source) source = {};
+
+        decode_us += to_us(stage_start);
+        if (!success) return;
+
+        stage_start = Clock::now();
+
+        ByteArray  image;
+        const bool encoded = image_writer::encode(type, decoded.m_Pixels.data(), decoded.m_Width, decoded.m_Height,
+                                                  &image);
+        encode_us += to_us(stage_start);
+        if (!encoded) {
+            LOG_ERROR("TextureExport : failed to encode \"{}\"", filename);
+            return;
+        }
+
+        stage_start = Clock::now();
+
+        auto out_filename = (out_directory / filename);
+        out_filename.replace_extension(image_writer::get_extension(type));
+        const bool written = write_file(out_filename, image);
+
+        write_us += to_us(stage_start);
+        if (written) ++num_exported;
+    });
+
+    out_stats->m_ProcessMs   = get_elapsed_ms(start);
+    out_stats->m_DecodeMs    = (decode_us / 1000.0);
+    out_stats->m_EncodeMs    = (encode_us / 1000.0);
+    out_stats->m_WriteMs     = (write_us / 1000.0);
+    out_stats->m_NumExported = num_exported;
+    return (out_stats->m_NumExported == out_stats->m_NumTextures);
+}
+
+bool export_model(ResourceManager& resource_manager, const std::string& filename,
+                  const std::filesystem::path& out_directory, image_writer::EImageType type, BatchStats* out_stats)
+{
+    *out_stats       = {};
+    const auto start = Clock::now();
+
+    if (!is_safe_relative_path(filename)) {
+        LOG_ERROR("TextureExport : can't export \"{}\", it isn't a relative path", filename);
+        return false;
+    }
+
+    ByteArray buffer;
+    if (!resource_manager.read(ava::hashlittle(filename.c_str()), &buffer)) {
+        LOG_ERROR("TextureExport : failed to read \"{}\"", filename);
+        return false;
+    }
+
+    std::vector<std::string> textures;
+    if (!DependencyGraph::get_texture_paths(filename, buffer, &textures)) {
+        LOG_ERROR("TextureExport : failed to find the textures in \"{}\"", filename);
+        return false;
+    }
+
+    if (!write_file((out_directory / filename), buffer)) {
+        return false;
+    }
+
+    // only the .ddsc paths, export_batch finds their .hmddsc
+    textures.erase(std::remove_if(textures.begin(), textures.end(),
+                                  [](const std::string& texture) { return get_source_filename(texture).empty(); }),
+                   textures.end());
+
+    const double model_ms = get_elapsed_ms(start);
+    const bool   success  = export_batch(resource_manager, textures, out_directory, type, out_stats);
+    out_stats->m_GatherMs += model_ms;
+    return success;
+}
+
+void log_batch_stats(const BatchStats& stats)
+{
+    static constexpr double MEGABYTE = (1024.0 * 1024.0);
+
+    const double read_seconds = (stats.m_ReadMs / 1000.0);
+    LOG_INFO("TextureExport : gather {:.1f}ms - {} textures, {} with a .hmddsc", stats.m_GatherMs, stats.m_NumTextures,
+             stats.m_NumSources);
+    LOG_INFO("TextureExport : read {:.1f}ms - {:.1f} MB ({:.1f} MB/s)", stats.m_ReadMs, (stats.m_ReadSize / MEGABYTE),
+             (read_seconds > 0.0 ? ((stats.m_ReadSize / MEGABYTE) / read_seconds) : 0.0));
+    LOG_INFO("TextureExport : process {:.1f}ms on {} workers - decode {:.1f}ms, encode {:.1f}ms, write {:.1f}ms",
+             stats.m_ProcessMs, jobs::get_worker_count(), stats.m_DecodeMs, stats.m_EncodeMs, stats.m_WriteMs);
+    LOG_INFO("TextureExport : exported {} of {} textures in {:.1f}ms", stats.m_NumExported, stats.m_NumTextures,
+             (stats.m_GatherMs + stats.m_ReadMs + stats.m_ProcessMs));
+}
+
+AsyncModelExport::~AsyncModelExport()
+{
+    wait();
+}
+
+bool AsyncModelExport::start(ResourceManager& resource_manager, const std::string& filename,
+                             const std::filesystem::path& out_directory, image_writer::EImageType type)
+{
+    if (m_running) {
+        return false;
+    }
+
+    // the last export has finished, its thread still has to be joined
+    wait();
+
+    m_filename = filename;
+    m_running  = true;
+    m_thread   = std::thread([this, &resource_manager, out_directory, type] {
+        BatchStats stats;
+        export_model(resource_manager, m_filename, out_directory, type, &stats);
+        log_batch_stats(stats);
+
+        m_running = false;
+    });
+
+    return true;
+}
+
+void AsyncModelExport::wait()
+{
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+} // namespace jcmr::texture_export
@@ -0,0 +1,84 @@
+#ifndef JCMR_GAME_TEXTURE_EXPORT_H_HEADER_GUARD
+#define JCMR_GAME_TEXTURE_EXPORT_H_HEADER_GUARD
+
+#include "platform.h"
+
+#include "app/image_writer.h"
+
+#include <atomic>
+#include <thread>
+
+namespace jcmr
+{
+struct ResourceManager;
+
+// decodes .ddsc textures (with the .hmddsc high resolution source when there is one) to rgba8 on the cpu, so they
+// can be exported and previewed without a d3d device.
+// NOTE : files are read by namehash, so these are safe to call from worker threads
+namespace texture_export
+{
+    struct DecodedTexture {
+        u32       m_Width  = 0;
+        u32       m_Height = 0;
+        u32       m_Format = 0; // dxgi format of the source
+        ByteArray m_Pixels;     // rgba8, top row first
+    };
+
+    // only the first slice of volume textures is decoded
+    bool decode(ResourceManager& resource_manager, const std::string& filename, DecodedTexture* out_texture);
+
+    bool export_to(ResourceManager& resource_manager, const std::string& filename,
+                   const std::filesystem::path& out_filename, image_writer::EImageType type);
+
+    // decode, encode and write run on every job worker at once, their times are summed across the workers
+    struct BatchStats {
+        u32    m_NumTextures = 0;
+        u32    m_NumSources  = 0; // .hmddsc files read with the textures
+        u32    m_NumExported = 0;
+        u64    m_ReadSize    = 0;
+        double m_GatherMs    = 0;
+        double m_ReadMs      = 0;
+        double m_ProcessMs   = 0; // wall time of decode, encode and write
+        double m_DecodeMs    = 0;
+        double m_EncodeMs    = 0;
+        double m_WriteMs     = 0;
+    };
+
+    // the unique textures (and their .hmddsc sources) are read in one ResourceManager::read_batch, then every texture
+    // is decoded, encoded and written on the job workers. the archive paths are kept under out_directory.
+    bool export_batch(ResourceManager& resource_manager, const std::vector<std::string>& filenames,
+                      const std::filesystem::path& out_directory, image_writer::EImageType type,
+                      BatchStats* out_stats);
+
+    // a .rbm or .modelc as it is in the archives, and every texture it uses with export_batch
+    bool export_model(ResourceManager& resource_manager, const std::string& filename,
+                      const std::filesystem::path& out_directory, image_writer::EImageType type,
+                      BatchStats* out_stats);
+
+    void log_batch_stats(const BatchStats& stats);
+
+    // runs export_model() on a background thread and logs the stats when it's done, used by the ui so the frame isn't
+    // held up. one export at a time.
+    struct AsyncModelExport {
+        ~AsyncModelExport();
+
+        // returns false if an export is already running. the resource manager must outlive the export (or wait() for
+        // it)
+        bool start(ResourceManager& resource_manager, const std::string& filename,
+                   const std::filesystem::path& out_directory, image_writer::EImageType type);
+
+        // blocks until the worker thread exits
+        void wait();
+
+        bool               is_running() const { return m_running; }
+        const std::string& get_filename() const { return m_filename; } // the last model which was started
+
+      private:
+        std::thread       m_thread;
+        std::atomic<bool> m_running = false;
+        std::string       m_filename;
+    };
+} // namespace texture_export
+} // namespace jcmr
+
+#endif // JCMR_GAME_TEXTURE_EXPORT_H_HEADER_GUARD
@@ -0,0 +1,141 @@
+#include "pch.h"
+
+#include "texture_import.h"
+
+#include "game/avtx.h"
+
+#include <cstring>
+#include <fstream>
+
+namespace jcmr::texture_import
+{
+using namespace avtx;
+
+static void append_aligned(ByteArray* buffer, const ByteArray& data)
+{
+    buffer->resize((buffer->size() + AVTX_STREAM_ALIGNMENT - 1) & ~static_cast<u64>(AVTX_STREAM_ALIGNMENT - 1));
+    buffer->insert(buffer->end(), data.begin(), data.end());
+}
+
+static bool write_file(const std::filesystem::path& filename, const ByteArray& buffer)
+{
+    std::ofstream stream(filename, std::ios::binary);
+    if (stream.fail()) {
+        LOG_ERROR("TextureImport : failed to write \"{}\"", filename.generic_string());
+        return false;
+    }
+
+    stream.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+    return true;
+}
+
+bool build(const image_reader::Image& image, const Options& options, ByteArray* out_buffer,
+           ByteArray* out_source_buffer)
+{
+    if (!texture_encoder::is_supported(options.m_Format)) {
+        LOG_ERROR("TextureImport : can't encode format {}", options.m_Format);
+        return false;
+    }
+
+    if (image.m_Width > 0xFFFF || image.m_Height > 0xFFFF) {
+        LOG_ERROR("TextureImport : {}x{} is too big", image.m_Width, image.m_Height);
+        return false;
+    }
+
+    std::vector<texture_encoder::Surface> mips;
+    texture_encoder::generate_mips(image.m_Pixels.data(), image.m_Width, image.m_Height, options.m_MipFilter, 0,
+                                   &mips);
+
+    std::vector<ByteArray> encoded;
+    if (!texture_encoder::encode_mips(options.m_Format, mips, options.m_Quality, &encoded)) {
+        LOG_ERROR("TextureImport : failed to encode {}x{} {}", image.m_Width, image.m_Height,
+                  texture_decoder::get_format_name(options.m_Format));
+        return false;
+    }
+
+    const u32 num_mips = static_cast<u32>(encoded.size());
+
+    // every source mip is a stream of its own and the rest share the .ddsc stream. the readers size streams by how
+    // many are bigger, so the .ddsc stream has to be smaller than the last source mip.
+    u32 num_source_mips = std::min(options.m_NumSourceMips, std::min((num_mips - 1), (AVTX_MAX_STREAMS - 1)));
+    const auto get_stream_size = [&](u32 first_mip) {
+        u64 size = 0;
+        for (u32 i = first_mip; i < num_mips; ++i) size += encoded[i].size();
+        return size;
+    };
+
+    while (num_source_mips > 0 && get_stream_size(num_source_mips) >= encoded[num_source_mips - 1].size()) {
+        --num_source_mips;
+    }
+
+    AvtxHeader header{};
+    header.m_Magic        = ava::AvalancheTexture::AVTX_MAGIC;
+    header.m_Version      = 1;
+    header.m_Dimension    = 2;
+    header.m_Format       = options.m_Format;
+    header.m_Width        = static_cast<u16>(image.m_Width);
+    header.m_Height       = static_cast<u16>(image.m_Height);
+    header.m_Depth        = 1;
+    header.m_Mips         = static_cast<u8>(num_mips);
+    header.m_MipsRedisent = static_cast<u8>(num_mips - num_source_mips);
+
+    // the .ddsc stream first, then the source mips largest first
+    ByteArray data;
+    header.m_Streams[0].m_Offset    = sizeof(AvtxHeader);
+    header.m_Streams[0].m_Size      = static_cast<u32>(get_stream_size(num_source_mips));
+    header.m_Streams[0].m_Alignment = AVTX_STREAM_ALIGNMENT;
+    for (u32 i = num_source_mips; i < num_mips; ++i) {
+        data.insert(data.end(), encoded[i].begin(), encoded[i].end());
+    }
+
+    out_source_buffer->clear();
+    for (u32 i = 0; i < num_source_mips; ++i) {
+        append_aligned(out_source_buffer, encoded[i]);
+
+        auto& stream       = header.m_Streams[i + 1];
+        stream.m_Offset    = static_cast<u32>(out_source_buffer->size() - encoded[i].size());
+        stream.m_Size      = static_cast<u32>(encoded[i].size());
+        stream.m_Alignment = AVTX_STREAM_ALIGNMENT;
+        stream.m_Source    = 1;
+    }
+
+    out_buffer->resize(sizeof(AvtxHeader));
+    std::memcpy(out_buffer->data(), &header, sizeof(AvtxHeader));
+    out_buffer->insert(out_buffer->end(), data.begin(), data.end());
+    return true;
+}
+
+bool import_file(const std::filesystem::path& filename, const std::filesystem::path& out_filename,
+                 const Options& options)
+{
+    image_reader::Image image;
+    if (!image_reader::read(filename, &image)) {
+        return false;
+    }
+
+    ByteArray buffer;
+    ByteArray source_buffer;
+    if (!build(image, options, &buffer, &source_buffer)) {
+        return false;
+    }
+
+    if (out_filename.has_parent_path()) {
+        std::filesystem::create_directories(out_filename.parent_path());
+    }
+
+    if (!write_file(out_filename, buffer)) {
+        return false;
+    }
+
+    // a stale .hmddsc from an earlier import would be read with the new header
+    auto source_filename = out_filename;
+    source_filename.replace_extension(".hmddsc");
+    if (source_buffer.empty()) {
+        std::error_code error;
+        std::filesystem::remove(source_filename, error);
+        return true;
+    }
+
+    return write_file(source_filename, source_buffer);
+}
+} // namespace jcmr::texture_import
@@ -0,0 +1,34 @@
+#ifndef JCMR_GAME_TEXTURE_IMPORT_H_HEADER_GUARD
+#define JCMR_GAME_TEXTURE_IMPORT_H_HEADER_GUARD
+
+#include "platform.h"
+
+#include "app/image_reader.h"
+#include "app/texture_decoder.h"
+#include "app/texture_encoder.h"
+
+namespace jcmr
+{
+// builds .ddsc textures (and the .hmddsc with the high resolution mips) from png, tga and dds images. the full mip
+// chain is generated and block compressed, the smallest mips go in the .ddsc and the largest in the .hmddsc so the
+// game can stream them like the textures it ships with.
+namespace texture_import
+{
+    struct Options {
+        u32                         m_Format        = texture_decoder::FORMAT_BC7_UNORM;
+        texture_encoder::EQuality   m_Quality       = texture_encoder::E_QUALITY_NORMAL;
+        texture_encoder::EMipFilter m_MipFilter     = texture_encoder::E_MIP_FILTER_BOX;
+        u32                         m_NumSourceMips = 1; // largest mips which go in the .hmddsc, 0 for none
+    };
+
+    // out_source_buffer is empty when every mip fits in the .ddsc
+    bool build(const image_reader::Image& image, const Options& options, ByteArray* out_buffer,
+               ByteArray* out_source_buffer);
+
+    // writes out_filename (.ddsc) and the .hmddsc next to it when there is one
+    bool import_file(const std::filesystem::path& filename, const std::filesystem::path& out_filename,
+                     const Options& options);
+} // namespace texture_import
+} // namespace jcmr
+
+#endif // JCMR_GAME_TEXTURE_IMPORT_H_HEADER_GUARD
@@ -0,0 +1,292 @@
+#include "pch.h"
+
+#include "texture_streamer.h"
+
+#include "app/app.h"
+#include "app/settings.h"
+
+#include "game/resource_manager.h"
+
+#include "render/dds_texture_loader.h"
+#include "render/renderer.h"
+#include "render/texture.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace jcmr
+{
+static constexpr u32 MAX_IN_FLIGHT = 2;  // reads queued on the thread, keeps the priorities fresh
+static constexpr u64 RECENT_FRAMES = 60; // about a second, textures drawn since then still want the upgrade
+
+struct TextureStreamerImpl final : TextureStreamer {
+    struct Request {
+        std::weak_ptr<Texture> m_Texture;
+        ByteArray              m_Header; // the avtx header from the .ddsc
+        u32                    m_SourceNameHash = 0;
+        u64                    m_Size           = 0;     // the source stream, what it takes from the budget
+        bool                   m_WasDemoted     = false; // only streamed in again once it's drawn
+        avtx::Quality          m_Quality;
+    };
+
+    struct Result {
+        Request   m_Request;
+        ByteArray m_SourceBuffer; // empty if the read failed
+    };
+
+    TextureStreamerImpl(App& app, ResourceManager& resource_manager)
+        : m_app(app)
+        , m_resource_manager(resource_manager)
+    {
+        m_budget = (static_cast<u64>(m_app.get_settings().get<u32>("texture_stream_budget_mb", DEFAULT_BUDGET_MB))
+                    * 1024 * 1024);
+        m_thread = std::thread([this] { read_thread(); });
+    }
+
+    ~TextureStreamerImpl()
+    {
+        {
+            std::lock_guard<decltype(m_mutex)> _lock(m_mutex);
+            m_shutdown = true;
+        }
+
+        m_condition.notify_one();
+        if (m_thread.joinable()) m_thread.join();
+
+        // the textures can outlive the game in the renderer's cache
+        for (const auto& resident : m_resident) {
+            if (auto texture = resident.m_Texture.lock(); texture) texture->set_demote_callback(nullptr);
+        }
+    }
+
+    void add(const std::shared_ptr<Texture>& texture, const std::string& source_filename, const ByteArray& buffer,
+             const avtx::Quality& quality) override
+    {
+        Request request;
+        request.m_Size = avtx::get_source_stream_size(buffer, quality);
+        if (!texture || request.m_Size == 0) {
+            return;
+        }
+
+        request.m_Quality        = quality;
+        request.m_Texture        = texture;
+        request.m_Header         = ByteArray(buffer.begin(), (buffer.begin() + sizeof(avtx::AvtxHeader)));
+        request.m_SourceNameHash = ava::hashlittle(source_filename.c_str());
+        m_pending.emplace_back(std::move(request));
+    }
+
+    void update() override
+    {
+        // released textures give their budget back
+        m_resident.erase(std::remove_if(m_resident.begin(), m_resident.end(),
+                                        [this](const Request& resident) {
+                                            if (!resident.m_Texture.expired()) return false;
+                                            m_used_size -= resident.m_Size;
+                                            return true;
+                                        }),
+                         m_resident.end());
+
+        std::vector<Result> results;
+        {
+            std::lock_guard<decltype(m_mutex)> _lock(m_mutex);
+            std::swap(results, m_results);
+        }
+
+        for (auto& result : results) {
+            --m_num_in_flight;
+            if (!upload(result)) {
+                m_used_size -= result.m_Request.m_Size;
+            }
+        }
+
+        queue_requests();
+    }
+
+    u64 get_budget() const override { return m_budget; }
+    u64 get_used_size() const override { return m_used_size; }
+    u32 get_num_pending() const override { return static_cast<u32>(m_pending.size()) + m_num_in_flight; }
+
+  private:
+    bool upload(const Result& result)
+    {
+        auto texture = result.m_Request.m_Texture.lock();
+        if (!texture || result.m_SourceBuffer.empty()) {
+            return false;
+        }
+
+        avtx::StreamView stream;
+        if (!avtx::get_best_stream(result.m_Request.m_Header, result.m_SourceBuffer, &stream,
+                                   result.m_Request.m_Quality)) {
+            LOG_ERROR("TextureStreamer : failed to read source stream for \"{}\"", texture->get_filename());
+            return false;
+        }
+
+        DDS_HEADER       header;
+        DDS_HEADER_DXT10 dxt10_header;
+        avtx::get_dds_header(stream, &header, &dxt10_header);
+        if (!texture->load(header, &dxt10_header, stream.m_Data, stream.m_Size)) {
+            return false;
+        }
+
+        // the TextureCache drops back to the .ddsc mip when it's over budget
+        texture->set_demote_callback([this](Texture& texture) { return demote(texture); });
+        m_resident.push_back(result.m_Request);
+        return true;
+    }
+
+    bool demote(Texture& texture)
+    {
+        auto iter = std::find_if(m_resident.begin(), m_resident.end(), [&texture](const Request& resident) {
+            return (resident.m_Texture.lock().get() == &texture);
+        });
+
+        if (iter == m_resident.end()) {
+            return false;
+        }
+
+        ByteArray buffer;
+        if (!m_resource_manager.read(ava::hashlittle(texture.get_filename().c_str()), &buffer,
+                                     ResourceManager::E_READ_FLAG_QUIET)) {
+            return false;
+        }
+
+        avtx::StreamView stream;
+        if (!avtx::get_best_stream(buffer, {}, &stream, iter->m_Quality)) {
+            return false;
+        }
+
+        DDS_HEADER       header;
+        DDS_HEADER_DXT10 dxt10_header;
+        avtx::get_dds_header(stream, &header, &dxt10_header);
+        if (!texture.load(header, &dxt10_header, stream.m_Data, stream.m_Size)) {
+            return false;
+        }
+
+        auto request         = std::move(*iter);
+        request.m_WasDemoted = true;
+        m_used_size -= request.m_Size;
+        m_resident.erase(iter);
+        m_pending.emplace_back(std::move(request));
+        return true;
+    }
+
+    void queue_requests()
+    {
+        m_pending.erase(std::remove_if(m_pending.begin(), m_pending.end(),
+                                       [](const Request& request) { return request.m_Texture.expired(); }),
+                        m_pending.end());
+
+        if (m_pending.empty() || m_num_in_flight >= MAX_IN_FLIGHT) {
+            return;
+        }
+
+        // drawn last frame first, then the biggest
+        const u64  frame      = m_app.get_renderer().get_context().frame;
+        const auto is_visible = [frame](const Request& request) {
+            const u64 last_used_frame = request.m_Texture.lock()->get_last_used_frame();
+            return (last_used_frame != 0 && (last_used_frame + 1) >= frame);
+        };
+
+        std::vector<std::pair<bool, u32>> order;
+        order.reserve(m_pending.size());
+        for (u32 i = 0; i < m_pending.size(); ++i) {
+            order.emplace_back(is_visible(m_pending[i]), i);
+        }
+
+        std::sort(order.begin(), order.end(), [this](const auto& lhs, const auto& rhs) {
+            if (lhs.first != rhs.first) return lhs.first;
+            return (m_pending[lhs.second].m_Size > m_pending[rhs.second].m_Size);
+        });
+
+        // only the TextureCache holds textures nothing has open, they wait in m_pending until they're drawn again
+        const auto is_wanted = [frame](const Request& request) {
+            if (request.m_Texture.use_count() > 1) return true;
+            const u64 last_used_frame = request.m_Texture.lock()->get_last_used_frame();
+            return (last_used_frame != 0 && (last_used_frame + RECENT_FRAMES) >= frame);
+        };
+
+        std::vector<u32> queued;
+        for (const auto& [visible, index] : order) {
+            if (m_num_in_flight >= MAX_IN_FLIGHT) break;
+
+            // skip the ones which don't fit, a smaller one still might
+            const auto& request = m_pending[index];
+            if ((m_used_size + request.m_Size) > m_budget || (request.m_WasDemoted && !visible)) continue;
+            if (!visible && !is_wanted(request)) continue;
+
+            m_used_size += request.m_Size;
+            ++m_num_in_flight;
+            queued.push_back(index);
+
+            std::lock_guard<decltype(m_mutex)> _lock(m_mutex);
+            m_queue.push_back(request);
+        }
+
+        if (queued.empty()) {
+            return;
+        }
+
+        m_condition.notify_one();
+
+        // remove from the back so the indices stay valid
+        std::sort(queued.begin(), queued.end(), std::greater<u32>());
+        for (auto index : queued) {
+            m_pending.erase(m_pending.begin() + index);
+        }
+    }
+
+    void read_thread()
+    {
+        for (;;) {
+            Result result;
+            {
+                std::unique_lock<decltype(m_mutex)> lock(m_mutex);
+                m_condition.wait(lock, [this] { return (m_shutdown || !m_queue.empty()); });
+                if (m_shutdown) return;
+
+                result.m_Request = std::move(m_queue.front());
+                m_queue.pop_front();
+            }
+
+            // the texture could have been released while it was queued
+            if (!result.m_Request.m_Texture.expired()) {
+                m_resource_manager.read(result.m_Request.m_SourceNameHash, &result.m_SourceBuffer,
+                                        ResourceManager::E_READ_FLAG_QUIET);
+            }
+
+            std::lock_guard<decltype(m_mutex)> _lock(m_mutex);
+            m_results.emplace_back(std::move(result));
+        }
+    }
+
+  private:
+    App&             m_app;
+    ResourceManager& m_resource_manager;
+    u64              m_budget        = 0;
+    u64              m_used_size     = 0; // resident and in flight
+    u32              m_num_in_flight = 0;
+
+    // main thread only
+    std::vector<Request> m_pending;
+    std::vector<Request> m_resident; // streamed in, the budget they use
+
+    std::mutex              m_mutex; // guards the queue, results and shutdown
+    std::deque<Request>     m_queue;
+    std::vector<Result>     m_results;
+    std::condition_variable m_condition;
+    std::thread             m_thread;
+    bool                    m_shutdown = false;
+};
+
+TextureStreamer* TextureStreamer::create(App& app, ResourceManager& resource_manager)
+{
+    return new TextureStreamerImpl(app, resource_manager);
+}
+
+void TextureStreamer::destroy(TextureStreamer* instance)
+{
+    delete instance;
+}
+} // namespace jcmr
@@ -0,0 +1,42 @@
+#ifndef JCMR_GAME_TEXTURE_STREAMER_H_HEADER_GUARD
+#define JCMR_GAME_TEXTURE_STREAMER_H_HEADER_GUARD
+
+#include "platform.h"
+
+#include "game/avtx.h"
+
+namespace jcmr
+{
+struct App;
+struct ResourceManager;
+struct Texture;
+
+// textures are created from the small mips in the .ddsc so they can be drawn straight away, the streamer reads the
+// .hmddsc on a background thread and swaps the high resolution mip into the same Texture when it's ready. upgrades
+// share a budget for the session (the "texture_stream_budget_mb" setting). textures drawn last frame go first and then
+// the biggest, textures which haven't been drawn recently and are only held by the TextureCache wait until they are.
+// textures which are released give their share of the budget back. when the TextureCache is over its budget it can
+// demote an upgraded texture, which goes back to the .ddsc mip until it's drawn again.
+struct TextureStreamer {
+    static constexpr u32 DEFAULT_BUDGET_MB = 1024; // "texture_stream_budget_mb" setting
+
+    static TextureStreamer* create(App& app, ResourceManager& resource_manager);
+    static void             destroy(TextureStreamer* instance);
+
+    virtual ~TextureStreamer() = default;
+
+    // buffer is the .ddsc the texture was created from, only the header is kept. textures which don't need a source
+    // stream at this quality are ignored.
+    virtual void add(const std::shared_ptr<Texture>& texture, const std::string& source_filename,
+                     const ByteArray& buffer, const avtx::Quality& quality) = 0;
+
+    // uploads finished reads and queues the next ones, call once per frame from the main thread
+    virtual void update() = 0;
+
+    virtual u64 get_budget() const      = 0;
+    virtual u64 get_used_size() const   = 0;
+    virtual u32 get_num_pending() const = 0;
+};
+} // namespace jcmr
+
+#endif // JCMR_GAME_TEXTURE_STREAMER_H_HEADER_GUARD
@@ -0,0 +1,438 @@
+#include "pch.h"
+
+#include "thumbnail_cache.h"
+
+#include "app/app.h"
+#include "app/os.h"
+#include "app/settings.h"
+#include "app/texture_decoder.h"
+#include "app/texture_encoder.h"
+#include "app/utils.h"
+
+#include "game/avtx.h"
+#include "game/resource_manager.h"
+
+#include "render/dds_texture_loader.h"
+#include "render/renderer.h"
+#include "render/texture.h"
+
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+namespace jcmr
+{
+static constexpr u32 CACHE_MAGIC    = 0x4D4E4854; // "THNM"
+static constexpr u32 CACHE_VERSION  = 1;
+static constexpr u32 MAX_PROBES     = 16; // slots a file can go in, starting at namehash % num_slots
+static constexpr u32 MAX_QUEUED     = 64; // prefetches past this are dropped, they're queued again while visible
+static constexpr u32 SLOT_DATA_SIZE = (ThumbnailCache::THUMBNAIL_SIZE * ThumbnailCache::THUMBNAIL_SIZE); // bc3
+
+struct CacheHeader {
+    u32 m_Magic;
+    u32 m_Version;
+    u32 m_NumSlots;
+    u32 m_ThumbnailSize;
+    u64 m_Clock; // bumped every time a slot is used, for the lru order
+};
+
+struct CacheSlot {
+    u32 m_NameHash; // 0 if the slot is empty
+    u32 m_ArchiveHash;
+    u32 m_Offset;
+    u32 m_Size;
+    u64 m_LastUsed;
+    u16 m_Width;
+    u16 m_Height;
+    u32 m_Format; // 0 if a thumbnail couldn't be made from the file
+    u32 m_DataSize;
+    u32 m_Padding;
+};
+
+static_assert(sizeof(CacheHeader) == 0x18, "CacheHeader alignment is wrong!");
+static_assert(sizeof(CacheSlot) == 0x28, "CacheSlot alignment is wrong!");
+
+static u64 get_data_offset(u32 num_slots)
+{
+    const u64 offset = (sizeof(CacheHeader) + (static_cast<u64>(num_slots) * sizeof(CacheSlot)));
+    return ((offset + 15) & ~15ull);
+}
+
+static bool is_srgb(u32 format)
+{
+    using namespace texture_decoder;
+    switch (format) {
+        case FORMAT_BC1_UNORM_SRGB:
+        case FORMAT_BC2_UNORM_SRGB:
+        case FORMAT_BC3_UNORM_SRGB:
+        case FORMAT_B8G8R8A8_UNORM_SRGB:
+        case FORMAT_BC7_UNORM_SRGB: return true;
+    }
+
+    return false;
+}
+
+struct ThumbnailCacheImpl final : ThumbnailCache {
+    struct Request {
+        u32         m_NameHash;
+        std::string m_Filename;
+    };
+
+    struct EncodedThumbnail {
+        u32       m_Width  = 0;
+        u32       m_Height = 0;
+        u32       m_Format = 0;
+        ByteArray m_Data;
+    };
+
+    ThumbnailCacheImpl(App& app, ResourceManager& resource_manager, const std::filesystem::path& filename)
+        : m_app(app)
+        , m_resource_manager(resource_manager)
+    {
+        const u32 num_slots = std::max(m_app.get_settings().get<u32>("thumbnail_cache_slots", DEFAULT_NUM_SLOTS), 1u);
+        const u64 size      = (get_data_offset(num_slots) + (static_cast<u64>(num_slots) * SLOT_DATA_SIZE));
+
+        if (filename.has_parent_path()) {
+            std::error_code error;
+            std::filesystem::create_directories(filename.parent_path(), error);
+        }
+
+        // thumbnails still work for the session if the file can't be used
+        u8* data = nullptr;
+        if (os::map_file(filename.string().c_str(), size, &m_file)) {
+            data = m_file.data;
+        } else {
+            LOG_ERROR("ThumbnailCache : failed to map \"{}\", thumbnails won't be saved", filename.generic_string());
+            m_memory.resize(size);
+            data = m_memory.data();
+        }
+
+        m_header = reinterpret_cast<CacheHeader*>(data);
+        m_slots  = reinterpret_cast<CacheSlot*>(data + sizeof(CacheHeader));
+        m_data   = (data + get_data_offset(num_slots));
+
+        if (m_header->m_Magic != CACHE_MAGIC || m_header->m_Version != CACHE_VERSION
+            || m_header->m_NumSlots != num_slots || m_header->m_ThumbnailSize != THUMBNAIL_SIZE) {
+            std::memset(data, 0, get_data_offset(num_slots));
+            m_header->m_Magic         = CACHE_MAGIC;
+            m_header->m_Version       = CACHE_VERSION;
+            m_header->m_NumSlots      = num_slots;
+            m_header->m_ThumbnailSize = THUMBNAIL_SIZE;
+        }
+
+        m_thread = std::thread([this] { generate_thread(); });
+    }
+
+    ~ThumbnailCacheImpl()
+    {
+        {
+            std::lock_guard<decltype(m_mutex)> _lock(m_mutex);
+            m_shutdown = true;
+        }
+
+        m_condition.notify_one();
+        if (m_thread.joinable()) m_thread.join();
+
+        os::unmap_file(&m_file);
+    }
+
+    EState get(const std::string& filename, Thumbnail* out_thumbnail) override
+    {
+        if (!is_supported(filename)) {
+            return E_STATE_FAILED;
+        }
+
+        collect_results();
+
+        const u32 namehash = ava::hashlittle(filename.c_str());
+        auto      iter     = m_states.find(namehash);
+        if (iter != m_states.end() && iter->second == E_STATE_FAILED) {
+            return E_STATE_FAILED;
+        }
+
+        if (iter != m_states.end() && iter->second == E_STATE_READY && get_texture(namehash, filename, out_thumbnail)) {
+            return E_STATE_READY;
+        }
+
+        // not made yet, or the slot was given to another file since
+        queue(namehash, filename, true);
+        return E_STATE_PENDING;
+    }
+
+    void prefetch(const std::string& filename) override
+    {
+        if (!is_supported(filename)) {
+            return;
+        }
+
+        const u32 namehash = ava::hashlittle(filename.c_str());
+        if (m_states.find(namehash) == m_states.end()) {
+            queue(namehash, filename, false);
+        }
+    }
+
+  private:
+    void queue(u32 namehash, const std::string& filename, bool front)
+    {
+        m_states[namehash] = E_STATE_PENDING;
+
+        {
+            std::lock_guard<decltype(m_mutex)> _lock(m_mutex);
+            if (namehash == m_generating) return;
+
+            auto iter = std::find_if(m_queue.begin(), m_queue.end(),
+                                     [namehash](const Request& request) { return request.m_NameHash == namehash; });
+            if (iter != m_queue.end()) {
+                if (!front || iter == m_queue.begin()) return;
+                m_queue.erase(iter);
+            }
+
+            if (front) {
+                m_queue.push_front({namehash, filename});
+            } else {
+                m_queue.push_back({namehash, filename});
+            }
+
+            while (m_queue.size() > MAX_QUEUED) {
+                m_states.erase(m_queue.back().m_NameHash);
+                m_queue.pop_back();
+            }
+        }
+
+        m_condition.notify_one();
+    }
+
+    void collect_results()
+    {
+        std::vector<std::pair<u32, EState>> results;
+        {
+            std::lock_guard<decltype(m_mutex)> _lock(m_mutex);
+            std::swap(results, m_results);
+        }
+
+        for (const auto& [namehash, state] : results) {
+            m_states[namehash] = state;
+        }
+    }
+
+    bool get_texture(u32 namehash, const std::string& filename, Thumbnail* out_thumbnail)
+    {
+        std::lock_guard<decltype(m_mutex)> _lock(m_mutex);
+
+        auto* slot = find_slot(namehash);
+        if (!slot || slot->m_Format == 0) {
+            return false;
+        }
+
+        // the renderer keeps the texture until its cache needs the memory
+        const auto texture_name = (filename + "#thumbnail");
+        auto       texture      = m_app.get_renderer().get_texture(texture_name);
+        if (!texture) {
+            avtx::StreamView view;
+            view.m_Data   = get_slot_data(*slot);
+            view.m_Size   = slot->m_DataSize;
+            view.m_Width  = slot->m_Width;
+            view.m_Height = slot->m_Height;
+            view.m_Depth  = 1;
+            view.m_Format = slot->m_Format;
+
+            DDS_HEADER       header;
+            DDS_HEADER_DXT10 dxt10_header;
+            avtx::get_dds_header(view, &header, &dxt10_header);
+            texture = m_app.get_renderer().create_texture(texture_name, header, &dxt10_header, view.m_Data,
+                                                          view.m_Size);
+        }
+
+        if (!texture) {
+            return false;
+        }
+
+        slot->m_LastUsed         = ++m_header->m_Clock;
+        out_thumbnail->m_Texture = std::move(texture);
+        out_thumbnail->m_Width   = slot->m_Width;
+        out_thumbnail->m_Height  = slot->m_Height;
+        return true;
+    }
+
+    // slots are never emptied, so the search can stop at the first empty one
+    CacheSlot* find_slot(u32 namehash)
+    {
+        const u32 num_probes = std::min(MAX_PROBES, m_header->m_NumSlots);
+        for (u32 i = 0; i < num_probes; ++i) {
+            auto& slot = m_slots[(namehash + i) % m_header->m_NumSlots];
+            if (slot.m_NameHash == namehash) return &slot;
+            if (slot.m_NameHash == 0) break;
+        }
+
+        return nullptr;
+    }
+
+    // the file's own slot, the first empty one or the least recently used
+    CacheSlot* allocate_slot(u32 namehash)
+    {
+        const u32  num_probes = std::min(MAX_PROBES, m_header->m_NumSlots);
+        CacheSlot* oldest     = nullptr;
+        for (u32 i = 0; i < num_probes; ++i) {
+            auto& slot = m_slots[(namehash + i) % m_header->m_NumSlots];
+            if (slot.m_NameHash == namehash || slot.m_NameHash == 0) return &slot;
+            if (!oldest || slot.m_LastUsed < oldest->m_LastUsed) oldest = &slot;
+        }
+
+        return oldest;
+    }
+
+    u8* get_slot_data(const CacheSlot& slot) { return (m_data + (static_cast<u64>(&slot - m_slots) * SLOT_DATA_SIZE)); }
+
+    bool make_thumbnail(const Request& request, EncodedThumbnail* out_thumbnail)
+    {
+        ByteArray buffer;
+        if (!m_resource_manager.read(request.m_NameHash, &buffer, ResourceManager::E_READ_FLAG_QUIET)) {
+            return false;
+        }
+
+        // the .hmddsc is never read, the .ddsc mips are big enough for a thumbnail
+        avtx::Quality quality;
+        quality.m_MaxDimension = THUMBNAIL_SIZE;
+
+        avtx::StreamView stream;
+        if (!avtx::get_best_stream(buffer, {}, &stream, quality) || !texture_decoder::is_supported(stream.m_Format)) {
+            return false;
+        }
+
+        ByteArray pixels(static_cast<u64>(stream.m_Width) * stream.m_Height * 4);
+        if (!texture_decoder::decode(stream.m_Format, stream.m_Data, stream.m_Size, stream.m_Width, stream.m_Height,
+                                     pixels.data())) {
+            LOG_ERROR("ThumbnailCache : failed to decode \"{}\"", request.m_Filename);
+            return false;
+        }
+
+        // textures without small enough mips are filtered down the rest of the way
+        u32 num_mips = 1;
+        while (std::max((stream.m_Width >> (num_mips - 1)), (stream.m_Height >> (num_mips - 1))) > THUMBNAIL_SIZE) {
+            ++num_mips;
+        }
+
+        std::vector<texture_encoder::Surface> mips;
+        texture_encoder::generate_mips(pixels.data(), stream.m_Width, stream.m_Height,
+                                       texture_encoder::E_MIP_FILTER_BOX, num_mips, &mips);
+
+        const auto& mip = mips.back();
+        const u32   format =
+            (is_srgb(stream.m_Format) ? texture_decoder::FORMAT_BC3_UNORM_SRGB : texture_decoder::FORMAT_BC3_UNORM);
+        if (!texture_encoder::encode(format, mip.m_Pixels.data(), mip.m_Width, mip.m_Height,
+                                     texture_encoder::E_QUALITY_FAST, &out_thumbnail->m_Data)) {
+            return false;
+        }
+
+        out_thumbnail->m_Width  = mip.m_Width;
+        out_thumbnail->m_Height = mip.m_Height;
+        out_thumbnail->m_Format = format;
+        return (out_thumbnail->m_Data.size() <= SLOT_DATA_SIZE);
+    }
+
+    EState generate(const Request& request)
+    {
+        ResourceManager::EntryInfo entry;
+        if (!m_resource_manager.get_entry_info(request.m_NameHash, &entry)) {
+            return E_STATE_FAILED;
+        }
+
+        const auto is_current = [&entry](const CacheSlot& slot) {
+            return (slot.m_ArchiveHash == entry.m_ArchiveHash && slot.m_Offset == entry.m_Offset
+                    && slot.m_Size == entry.m_Size);
+        };
+
+        // made in a previous session, and the file hasn't changed since
+        {
+            std::lock_guard<decltype(m_mutex)> _lock(m_mutex);
+            if (auto* slot = find_slot(request.m_NameHash); slot && is_current(*slot)) {
+                slot->m_LastUsed = ++m_header->m_Clock;
+                return (slot->m_Format != 0 ? E_STATE_READY : E_STATE_FAILED);
+            }
+        }
+
+        EncodedThumbnail thumbnail;
+        const bool       success = make_thumbnail(request, &thumbnail);
+
+        // failures are stored too, so they aren't tried again every session
+        std::lock_guard<decltype(m_mutex)> _lock(m_mutex);
+
+        auto& slot         = *allocate_slot(request.m_NameHash);
+        slot.m_NameHash    = request.m_NameHash;
+        slot.m_ArchiveHash = entry.m_ArchiveHash;
+        slot.m_Offset      = entry.m_Offset;
+        slot.m_Size        = entry.m_Size;
+        slot.m_LastUsed    = ++m_header->m_Clock;
+        slot.m_Width       = static_cast<u16>(thumbnail.m_Width);
+        slot.m_Height      = static_cast<u16>(thumbnail.m_Height);
+        slot.m_Format      = (success ? thumbnail.m_Format : 0);
+        slot.m_DataSize    = (success ? static_cast<u32>(thumbnail.m_Data.size()) : 0);
+
+        if (success) {
+            std::memcpy(get_slot_data(slot), thumbnail.m_Data.data(), thumbnail.m_Data.size());
+        }
+
+        return (success ? E_STATE_READY : E_STATE_FAILED);
+    }
+
+    void generate_thread()
+    {
+        for (;;) {
+            Request request;
+            {
+                std::unique_lock<decltype(m_mutex)> lock(m_mutex);
+                m_condition.wait(lock, [this] { return (m_shutdown || !m_queue.empty()); });
+                if (m_shutdown) return;
+
+                request = std::move(m_queue.front());
+                m_queue.pop_front();
+                m_generating = request.m_NameHash;
+            }
+
+            const auto state = generate(request);
+
+            std::lock_guard<decltype(m_mutex)> _lock(m_mutex);
+            m_results.emplace_back(request.m_NameHash, state);
+            m_generating = 0;
+        }
+    }
+
+  private:
+    App&             m_app;
+    ResourceManager& m_resource_manager;
+    os::MappedFile   m_file;
+    ByteArray        m_memory; // used instead of the file when it can't be mapped
+
+    // main thread only, the state of every file asked for this session
+    std::unordered_map<u32, EState> m_states;
+
+    std::mutex                          m_mutex; // guards the slots, the queue, results and shutdown
+    CacheHeader*                        m_header = nullptr;
+    CacheSlot*                          m_slots  = nullptr;
+    u8*                                 m_data   = nullptr;
+    std::deque<Request>                 m_queue;
+    std::vector<std::pair<u32, EState>> m_results;
+    u32                                 m_generating = 0; // namehash the thread is working on
+    std::condition_variable             m_condition;
+    std::thread                         m_thread;
+    bool                                m_shutdown = false;
+};
+
+ThumbnailCache* ThumbnailCache::create(App& app, ResourceManager& resource_manager,
+                                       const std::filesystem::path& filename)
+{
+    return new ThumbnailCacheImpl(app, resource_manager, filename);
+}
+
+void ThumbnailCache::destroy(ThumbnailCache* instance)
+{
+    delete instance;
+}
+
+bool ThumbnailCache::is_supported(const std::string& filename)
+{
+    return (utils::get_extension(filename) == "ddsc");
+}
+} // namespace jcmr
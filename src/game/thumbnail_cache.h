@@ -0,0 +1,48 @@
+#ifndef JCMR_GAME_THUMBNAIL_CACHE_H_HEADER_GUARD
+#define JCMR_GAME_THUMBNAIL_CACHE_H_HEADER_GUARD
+
+#include "platform.h"
+
+namespace jcmr
+{
+struct App;
+struct ResourceManager;
+struct Texture;
+
+// small previews of .ddsc textures for the file tree tooltips. they're made on a background thread from the smallest
+// .ddsc mip which still covers the thumbnail (decoded on the cpu, box filtered down the rest of the way and encoded
+// to bc3) and kept between sessions in a memory mapped file. thumbnails are keyed by the file's archive entry, so one
+// is only made again when the file changes. the file has a fixed number of slots, when the slots a file can go in are
+// all used the least recently used one is replaced.
+struct ThumbnailCache {
+    static constexpr u32 THUMBNAIL_SIZE    = 128;
+    static constexpr u32 DEFAULT_NUM_SLOTS = 2048; // "thumbnail_cache_slots" setting, a slot is 16kb
+
+    enum EState : u8 {
+        E_STATE_PENDING = 0,
+        E_STATE_READY,
+        E_STATE_FAILED, // not a texture the decoder supports, it's not tried again until the file changes
+    };
+
+    struct Thumbnail {
+        std::shared_ptr<Texture> m_Texture;
+        u32                      m_Width  = 0;
+        u32                      m_Height = 0;
+    };
+
+    static ThumbnailCache* create(App& app, ResourceManager& resource_manager, const std::filesystem::path& filename);
+    static void            destroy(ThumbnailCache* instance);
+
+    static bool is_supported(const std::string& filename);
+
+    virtual ~ThumbnailCache() = default;
+
+    // the hovered file, it's queued ahead of everything else when the thumbnail isn't ready
+    virtual EState get(const std::string& filename, Thumbnail* out_thumbnail) = 0;
+
+    // files visible in the tree, the thumbnail is made in the background in case they're hovered
+    virtual void prefetch(const std::string& filename) = 0;
+};
+} // namespace jcmr
+
+#endif // JCMR_GAME_THUMBNAIL_CACHE_H_HEADER_GUARD
@@ -1,16 +1,25 @@
 #include "pch.h"
 
 #include "app/app.h"
+#include "app/cli.h"
 #include "app/os.h"
 
 #include <backends/imgui_impl_win32.h>
 
 int main(int argc, char** argv)
 {
-    ImGui_ImplWin32_EnableDpiAwareness();
-
     using namespace jcmr;
 
+    // command line tools run without creating the window or renderer
+    if (argc > 1) {
+        auto* app    = App::create();
+        auto  result = cli::run(*app, argc, const_cast<const char**>(argv));
+        App::destroy(app);
+        return result;
+    }
+
+    ImGui_ImplWin32_EnableDpiAwareness();
+
     auto* app = App::create();
     os::init(*app);
     App::destroy(app);
@@ -1342,4 +1342,63 @@ _Use_decl_annotations_ HRESULT DirectX::CreateDDSTextureFromFileEx(
     }
 
     return hr;
-}
\ No newline at end of file
+}
+
+//--------------------------------------------------------------------------------------
+_Use_decl_annotations_ HRESULT DirectX::CreateDDSTextureFromHeaderEx(
+    ID3D11Device* d3dDevice, ID3D11DeviceContext* d3dContext, const DDS_HEADER* header,
+    const DDS_HEADER_DXT10* dxt10Header, const uint8_t* bitData, size_t bitSize, size_t maxsize, D3D11_USAGE usage,
+    unsigned int bindFlags, unsigned int cpuAccessFlags, unsigned int miscFlags, bool forceSRGB,
+    ID3D11Resource** texture, ID3D11ShaderResourceView** textureView, DDS_ALPHA_MODE* alphaMode)
+{
+    if (texture) {
+        *texture = nullptr;
+    }
+    if (textureView) {
+        *textureView = nullptr;
+    }
+    if (alphaMode) {
+        *alphaMode = DDS_ALPHA_MODE_UNKNOWN;
+    }
+
+    if (!d3dDevice || !header || !bitData || (!texture && !textureView)) {
+        return E_INVALIDARG;
+    }
+
+    if (header->size != sizeof(DDS_HEADER) || header->ddspf.size != sizeof(DDS_PIXELFORMAT)) {
+        return E_FAIL;
+    }
+
+    // CreateTextureFromDDS reads the DX10 extension from directly after the header
+#pragma pack(push, 1)
+    struct {
+        DDS_HEADER       header;
+        DDS_HEADER_DXT10 dxt10Header;
+    } headers{};
+#pragma pack(pop)
+
+    headers.header = *header;
+    if ((header->ddspf.flags & DDS_FOURCC) && (MAKEFOURCC('D', 'X', '1', '0') == header->ddspf.fourCC)) {
+        if (!dxt10Header) {
+            return E_INVALIDARG;
+        }
+
+        headers.dxt10Header = *dxt10Header;
+    }
+
+    HRESULT hr = CreateTextureFromDDS(d3dDevice, d3dContext, &headers.header, bitData, bitSize, maxsize, usage,
+                                      bindFlags, cpuAccessFlags, miscFlags, forceSRGB, texture, textureView);
+    if (SUCCEEDED(hr)) {
+        if (texture != 0 && *texture != 0) {
+            SetDebugObjectName(*texture, "DDSTextureLoader");
+        }
+
+        if (textureView != 0 && *textureView != 0) {
+            SetDebugObjectName(*textureView, "DDSTextureLoader");
+        }
+
+        if (alphaMode) *alphaMode = GetAlphaMode(&headers.header);
+    }
+
+    return hr;
+}
@@ -186,4 +186,15 @@ HRESULT CreateDDSTextureFromFileEx(_In_ ID3D11Device* d3dDevice, _In_opt_ ID3D11
                                    _Outptr_opt_ ID3D11Resource**           texture,
                                    _Outptr_opt_ ID3D11ShaderResourceView** textureView,
                                    _Out_opt_ DDS_ALPHA_MODE*               alphaMode = nullptr);
+
+// Header and pixel data supplied separately, the pixels are uploaded straight from bitData without being copied
+// into a .dds image first. dxt10Header is only read when the header's fourCC is DX10.
+HRESULT CreateDDSTextureFromHeaderEx(_In_ ID3D11Device* d3dDevice, _In_opt_ ID3D11DeviceContext* d3dContext,
+                                     _In_ const DDS_HEADER* header, _In_opt_ const DDS_HEADER_DXT10* dxt10Header,
+                                     _In_reads_bytes_(bitSize) const uint8_t* bitData, _In_ size_t bitSize,
+                                     _In_ size_t maxsize, _In_ D3D11_USAGE usage, _In_ unsigned int bindFlags,
+                                     _In_ unsigned int cpuAccessFlags, _In_ unsigned int miscFlags, _In_ bool forceSRGB,
+                                     _Outptr_opt_ ID3D11Resource**           texture,
+                                     _Outptr_opt_ ID3D11ShaderResourceView** textureView,
+                                     _Out_opt_ DDS_ALPHA_MODE*               alphaMode = nullptr);
 } // namespace DirectX
\ No newline at end of file
@@ -4,6 +4,7 @@
 
 #include "app/app.h"
 #include "app/directory_list.h"
+#include "app/settings.h"
 
 #include "game/game.h"
 #include "game/render_block.h"
@@ -13,6 +14,7 @@
 #include "render/dds_texture_loader.h"
 #include "render/shader.h"
 #include "render/texture.h"
+#include "render/texture_cache.h"
 #include "render/ui.h"
 
 #include <d3d11.h>
@@ -33,6 +35,9 @@ struct RendererImpl final : Renderer {
         m_ui     = UI::create(app, *this);
         m_camera = Camera::create(*this);
 
+        const u64 budget_mb = m_app.get_settings().get<u32>("texture_budget_mb", TextureCache::DEFAULT_BUDGET_MB);
+        m_texture_cache     = TextureCache::create(budget_mb * 1024 * 1024);
+
         // render output buffer
         m_ui->on_render([&](RenderContext&) {
             auto dock_id = m_ui->get_dockspace_id(UI::E_DOCKSPACE_RIGHT);
@@ -54,6 +59,7 @@ struct RendererImpl final : Renderer {
 
     ~RendererImpl()
     {
+        TextureCache::destroy(m_texture_cache);
         Camera::destroy(m_camera);
         UI::destroy(m_ui);
     }
@@ -79,6 +85,9 @@ struct RendererImpl final : Renderer {
     {
         m_ui->shutdown();
 
+        // textures still held elsewhere outlive the cache, but the unused ones are released with the device
+        m_texture_cache->clear();
+
         m_context.device         = nullptr;
         m_context.device_context = nullptr;
 
@@ -129,45 +138,49 @@ struct RendererImpl final : Renderer {
             return texture;
         }
 
-        auto texture = m_texture_cache[filename].lock();
-        if (!texture) {
-            texture = std::shared_ptr<Texture>(Texture::create(filename, *this));
-            // TODO : should a texture load fail prevent us caching? probably..
-            texture->load(buffer);
-            m_texture_cache[filename] = texture;
+        auto texture = std::shared_ptr<Texture>(Texture::create(filename, *this));
+        // TODO : should a texture load fail prevent us caching? probably..
+        texture->load(buffer);
+        m_texture_cache->add(ava::hashlittle(filename.c_str()), texture, m_context.frame);
+        return texture;
+    }
+
+    std::shared_ptr<Texture> create_texture(const std::string& filename, const DDS_HEADER& header,
+                                            const DDS_HEADER_DXT10* dxt10_header, const u8* data, u64 size) override
+    {
+        if (auto texture = get_texture(filename); texture) {
+            return texture;
         }
 
+        auto texture = std::shared_ptr<Texture>(Texture::create(filename, *this));
+        texture->load(header, dxt10_header, data, size);
+        m_texture_cache->add(ava::hashlittle(filename.c_str()), texture, m_context.frame);
         return texture;
     }
 
     std::shared_ptr<Texture> get_texture(const std::string& filename) override
     {
-        auto texture = m_texture_cache[filename];
-        return texture.lock();
+        return m_texture_cache->get(ava::hashlittle(filename.c_str()), m_context.frame);
     }
 
-    std::shared_ptr<Shader> create_shader(const std::string& filename, u8 shader_type, const ByteArray& buffer) override
+    std::shared_ptr<Shader> create_shader(const std::string& filename, u8 shader_type,
+                                          const ShaderBytecode& bytecode) override
     {
-        auto filename_with_extension = (filename + Shader::shader_extensions[shader_type]);
-        if (auto shader = get_shader(filename_with_extension); shader) {
+        if (auto shader = get_shader(filename, shader_type); shader) {
             return shader;
         }
 
-        auto shader = m_shader_cache[filename_with_extension].lock();
-        if (!shader) {
-            shader = std::shared_ptr<Shader>(Shader::create(filename, (Shader::ShaderType)shader_type, *this));
-            // TODO : should a shader load fail prevent us caching? probably..
-            shader->load(buffer);
-            m_shader_cache[filename_with_extension] = shader;
-        }
-
+        auto shader = std::shared_ptr<Shader>(Shader::create(filename, (Shader::ShaderType)shader_type, *this));
+        // TODO : should a shader load fail prevent us caching? probably..
+        shader->load(bytecode);
+        m_shader_cache[Shader::get_key(ava::hashlittle(filename.c_str()), shader_type)] = shader;
         return shader;
     }
 
-    std::shared_ptr<Shader> get_shader(const std::string& filename) override
+    std::shared_ptr<Shader> get_shader(const std::string& filename, u8 shader_type) override
     {
-        auto shader = m_shader_cache[filename].lock();
-        return shader;
+        auto iter = m_shader_cache.find(Shader::get_key(ava::hashlittle(filename.c_str()), shader_type));
+        return (iter != m_shader_cache.end() ? iter->second.lock() : nullptr);
     }
 
     ID3D11Texture2D* create_texture(u32 width, u32 height, u32 format, u32 bind_flags, const char* debug_name) override
@@ -320,7 +333,10 @@ struct RendererImpl final : Renderer {
     void set_texture(Texture* texture, i32 slot, Sampler* sampler) override
     {
         ID3D11ShaderResourceView* srv = nullptr;
-        if (texture) srv = texture->get_srv();
+        if (texture) {
+            srv = texture->get_srv();
+            texture->set_last_used_frame(m_context.frame);
+        }
 
         m_device_context->PSSetShaderResources(slot, 1, &srv);
         if (sampler) m_device_context->PSSetSamplers(slot, 1, &sampler);
@@ -407,6 +423,7 @@ struct RendererImpl final : Renderer {
         }
 
         // m_context.dt = dt;
+        ++m_context.frame;
 
         m_ui->start_frame();
 
@@ -455,11 +472,14 @@ struct RendererImpl final : Renderer {
         }
 
         m_swap_chain->Present(1, 0);
+
+        m_texture_cache->update(m_context.frame);
     }
 
     const RenderContext& get_context() const override { return m_context; }
     UI&                  get_ui() override { return *m_ui; }
     Camera&              get_camera() override { return *m_camera; }
+    TextureCache&        get_texture_cache() override { return *m_texture_cache; }
 
   private:
     void create_device(const InitRendererArgs& init_renderer_args)
@@ -753,8 +773,8 @@ struct RendererImpl final : Renderer {
     ID3D11Debug* m_debugger = nullptr;
 #endif
 
-    std::unordered_map<std::string, std::weak_ptr<Texture>> m_texture_cache;
-    std::unordered_map<std::string, std::weak_ptr<Shader>>  m_shader_cache;
+    TextureCache*                                  m_texture_cache = nullptr;
+    std::unordered_map<u64, std::weak_ptr<Shader>> m_shader_cache; // Shader::get_key
 
     std::vector<game::IRenderBlock*> m_render_list;
 };
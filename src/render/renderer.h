@@ -11,6 +11,8 @@ struct ID3D11DeviceContext;
 struct ID3D11Texture2D;
 struct ID3D11SamplerState;
 struct DDS_PIXELFORMAT;
+struct DDS_HEADER;
+struct DDS_HEADER_DXT10;
 struct D3D11_SAMPLER_DESC;
 enum D3D11_BLEND : int;
 enum D3D11_BLEND_OP : int;
@@ -22,7 +24,9 @@ namespace jcmr
 struct App;
 struct Renderer;
 struct Texture;
+struct TextureCache;
 struct Shader;
+struct ShaderBytecode;
 struct UI;
 struct Camera;
 
@@ -33,6 +37,7 @@ namespace game
 
 struct RenderContext {
     float                dt             = 0.0f;
+    u64                  frame          = 0; // incremented every frame, textures remember the last one they were bound
     Renderer*            renderer       = nullptr;
     ID3D11Device*        device         = nullptr;
     ID3D11DeviceContext* device_context = nullptr;
@@ -93,11 +98,14 @@ struct Renderer {
     virtual void resize(u32 width, u32 height) = 0;
 
     virtual std::shared_ptr<Texture> create_texture(const std::string& filename, const ByteArray& buffer) = 0;
+    virtual std::shared_ptr<Texture> create_texture(const std::string& filename, const DDS_HEADER& header,
+                                                    const DDS_HEADER_DXT10* dxt10_header, const u8* data,
+                                                    u64 size)                                             = 0;
     virtual std::shared_ptr<Texture> get_texture(const std::string& filename)                             = 0;
 
     virtual std::shared_ptr<Shader> create_shader(const std::string& filename, u8 shader_type,
-                                                  const ByteArray& buffer)  = 0;
-    virtual std::shared_ptr<Shader> get_shader(const std::string& filename) = 0;
+                                                  const ShaderBytecode& bytecode)           = 0;
+    virtual std::shared_ptr<Shader> get_shader(const std::string& filename, u8 shader_type) = 0;
 
     virtual ID3D11Texture2D* create_texture(u32 width, u32 height, u32 format, u32 bind_flags,
                                             const char* debug_name = "") = 0;
@@ -149,6 +157,7 @@ struct Renderer {
     virtual const RenderContext& get_context() const = 0;
     virtual UI&                  get_ui()            = 0;
     virtual Camera&              get_camera()        = 0;
+    virtual TextureCache&        get_texture_cache() = 0;
 };
 } // namespace jcmr
 
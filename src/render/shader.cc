@@ -27,13 +27,13 @@ struct ShaderImpl final : Shader {
         if (m_pixel_shader) m_pixel_shader->Release();
     }
 
-    bool load(const ByteArray& buffer) override
+    bool load(const ShaderBytecode& bytecode) override
     {
         auto& context = m_renderer.get_context();
 
         // vertex shader
         if (m_shader_type == E_SHADER_TYPE_VERTEX) {
-            auto hr = context.device->CreateVertexShader(buffer.data(), buffer.size(), nullptr, &m_vertex_shader);
+            auto hr = context.device->CreateVertexShader(bytecode.m_Data, bytecode.m_Size, nullptr, &m_vertex_shader);
             if (FAILED(hr)) {
                 LOG_ERROR("Shader : failed to load vertex shader \"{}\"", m_filename);
                 return false;
@@ -46,7 +46,7 @@ struct ShaderImpl final : Shader {
         }
         // pixel shader
         else if (m_shader_type == E_SHADER_TYPE_PIXEL) {
-            auto hr = context.device->CreatePixelShader(buffer.data(), buffer.size(), nullptr, &m_pixel_shader);
+            auto hr = context.device->CreatePixelShader(bytecode.m_Data, bytecode.m_Size, nullptr, &m_pixel_shader);
             if (FAILED(hr)) {
                 LOG_ERROR("Shader : failed to load pixel shader \"{}\"", m_filename);
                 return false;
@@ -57,7 +57,7 @@ struct ShaderImpl final : Shader {
 #endif
         }
 
-        m_buffer = buffer;
+        m_bytecode = bytecode;
         return true;
     }
 
@@ -81,8 +81,8 @@ struct ShaderImpl final : Shader {
         }
 
         auto& context = m_renderer.get_context();
-        auto  hr      = context.device->CreateInputLayout(descs.data(), descs.size(), m_buffer.data(), m_buffer.size(),
-                                                          &m_input_layout);
+        auto  hr      = context.device->CreateInputLayout(descs.data(), descs.size(), m_bytecode.m_Data,
+                                                          m_bytecode.m_Size, &m_input_layout);
         ASSERT(SUCCEEDED(hr));
 
 #ifdef RENDERER_REPORT_LIVE_OBJECTS
@@ -98,7 +98,7 @@ struct ShaderImpl final : Shader {
     Renderer&           m_renderer;
     std::string         m_filename;
     ShaderType          m_shader_type;
-    ByteArray           m_buffer;
+    ShaderBytecode      m_bytecode;
     ID3D11VertexShader* m_vertex_shader = nullptr;
     ID3D11PixelShader*  m_pixel_shader  = nullptr;
     ID3D11InputLayout*  m_input_layout  = nullptr;
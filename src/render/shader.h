@@ -13,6 +13,14 @@ namespace jcmr
 {
 struct Renderer;
 
+// a view of shader bytecode owned by something else (the game's shader bundle). the owner is kept alive for as long
+// as a shader needs the bytecode, which is whenever an input layout is created.
+struct ShaderBytecode {
+    std::shared_ptr<const void> m_Owner;
+    const u8*                   m_Data = nullptr;
+    u64                         m_Size = 0;
+};
+
 struct Shader {
     enum ShaderType : u8 {
         E_SHADER_TYPE_VERTEX = 0,
@@ -41,12 +49,15 @@ struct Shader {
         u32         slot = 0;
     };
 
+    // what shaders are cached by, the same name can be both a vertex and a pixel shader
+    static u64 get_key(u32 namehash, u8 shader_type) { return ((static_cast<u64>(namehash) << 8) | shader_type); }
+
     static Shader* create(const std::string& filename, ShaderType shader_type, Renderer& renderer);
     static void    destroy(Shader* instance);
 
     virtual ~Shader() = default;
 
-    virtual bool load(const ByteArray& buffer) = 0;
+    virtual bool load(const ShaderBytecode& bytecode) = 0;
 
     virtual void set_vertex_layout(std::initializer_list<VertexLayoutDesc> layout_desc,
                                    const char*                             debug_name = nullptr) = 0;
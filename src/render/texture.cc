@@ -32,6 +32,31 @@ struct TextureImpl final : Texture {
             return false;
         }
 
+        m_size = buffer.size();
+        return true;
+    }
+
+    bool load(const DDS_HEADER& header, const DDS_HEADER_DXT10* dxt10_header, const u8* data, u64 size) override
+    {
+        auto& context = m_renderer.get_context();
+
+        ID3D11Resource*           texture = nullptr;
+        ID3D11ShaderResourceView* srv     = nullptr;
+
+        auto result = DirectX::CreateDDSTextureFromHeaderEx(context.device, nullptr, &header, dxt10_header, data, size,
+                                                            0, D3D11_USAGE_DEFAULT, D3D11_BIND_SHADER_RESOURCE, 0, 0,
+                                                            false, &texture, &srv);
+        if (FAILED(result)) {
+            LOG_ERROR("Texture : failed to load texture. (GetLastError={})", GetLastError());
+            return false;
+        }
+
+        if (m_srv) m_srv->Release();
+        if (m_texture) m_texture->Release();
+
+        m_texture = texture;
+        m_srv     = srv;
+        m_size    = size;
         return true;
     }
 
@@ -39,11 +64,42 @@ struct TextureImpl final : Texture {
     ID3D11Resource*           get_texture() const override { return m_texture; }
     ID3D11ShaderResourceView* get_srv() const override { return m_srv; }
 
+    void set_last_used_frame(u64 frame) override { m_last_used_frame = frame; }
+    u64  get_last_used_frame() const override { return m_last_used_frame; }
+
+    u64 get_size() const override { return m_size; }
+
+    void set_demote_callback(DemoteCallback_t callback) override { m_demote_callback = std::move(callback); }
+    bool can_demote() const override { return static_cast<bool>(m_demote_callback); }
+
+    bool demote() override
+    {
+        if (!m_demote_callback) {
+            return false;
+        }
+
+        auto callback     = std::move(m_demote_callback);
+        m_demote_callback = nullptr;
+        if (callback(*this)) {
+            return true;
+        }
+
+        // keep it so the cache can try again later, unless the callback set a new one
+        if (!m_demote_callback) {
+            m_demote_callback = std::move(callback);
+        }
+
+        return false;
+    }
+
   private:
     Renderer&                 m_renderer;
     std::string               m_filename;
-    ID3D11Resource*           m_texture = nullptr;
-    ID3D11ShaderResourceView* m_srv     = nullptr;
+    ID3D11Resource*           m_texture         = nullptr;
+    ID3D11ShaderResourceView* m_srv             = nullptr;
+    u64                       m_last_used_frame = 0;
+    u64                       m_size            = 0;
+    DemoteCallback_t          m_demote_callback;
 };
 
 Texture* Texture::create(const std::string& filename, Renderer& renderer)
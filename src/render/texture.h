@@ -4,6 +4,8 @@
 #include "platform.h"
 
 struct ID3D11Resource;
+struct DDS_HEADER;
+struct DDS_HEADER_DXT10;
 struct ID3D11ShaderResourceView;
 
 namespace jcmr
@@ -11,16 +13,36 @@ namespace jcmr
 struct Renderer;
 
 struct Texture {
+    // reloads the texture with less memory (a lower mip), returns false if it couldn't
+    using DemoteCallback_t = std::function<bool(Texture& texture)>;
+
     static Texture* create(const std::string& filename, Renderer& renderer);
     static void     destroy(Texture* instance);
 
     virtual ~Texture() = default;
 
     virtual bool load(const ByteArray& buffer) = 0;
+    // pixels are uploaded from data in place, dxt10_header is only needed when the header's fourCC is DX10.
+    // can be called again to replace the texture (streaming in the high resolution mips), the old one is kept if it
+    // fails.
+    virtual bool load(const DDS_HEADER& header, const DDS_HEADER_DXT10* dxt10_header, const u8* data, u64 size) = 0;
 
     virtual const std::string&        get_filename() const = 0;
     virtual ID3D11Resource*           get_texture() const  = 0;
     virtual ID3D11ShaderResourceView* get_srv() const      = 0;
+
+    // RenderContext::frame the texture was last bound for drawing
+    virtual void set_last_used_frame(u64 frame) = 0;
+    virtual u64  get_last_used_frame() const    = 0;
+
+    // estimated from the size of the data the texture was loaded from
+    virtual u64 get_size() const = 0;
+
+    // set by whatever streamed in the high resolution mip, the TextureCache calls it when it's over budget. the
+    // callback is cleared once it has demoted the texture, it's kept if it fails.
+    virtual void set_demote_callback(DemoteCallback_t callback) = 0;
+    virtual bool can_demote() const                             = 0;
+    virtual bool demote()                                       = 0;
 };
 } // namespace jcmr
 
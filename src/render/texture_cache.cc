@@ -0,0 +1,136 @@
+#include "pch.h"
+
+#include "texture_cache.h"
+
+#include "render/texture.h"
+
+namespace jcmr
+{
+struct TextureCacheImpl final : TextureCache {
+    struct Entry {
+        std::shared_ptr<Texture> m_Texture;
+        u64                      m_LastAccess = 0;
+    };
+
+    TextureCacheImpl(u64 budget)
+        : m_budget(budget)
+    {
+    }
+
+    std::shared_ptr<Texture> get(u32 namehash, u64 frame) override
+    {
+        auto iter = m_entries.find(namehash);
+        if (iter == m_entries.end()) {
+            return nullptr;
+        }
+
+        iter->second.m_LastAccess = frame;
+        return iter->second.m_Texture;
+    }
+
+    void add(u32 namehash, const std::shared_ptr<Texture>& texture, u64 frame) override
+    {
+        m_entries[namehash] = {texture, frame};
+    }
+
+    void clear() override { m_entries.clear(); }
+
+    void update(u64 frame) override
+    {
+        // only the cache holds these
+        u64                              size = 0;
+        std::vector<std::pair<u64, u32>> candidates;
+        for (const auto& [namehash, entry] : m_entries) {
+            size += entry.m_Texture->get_size();
+            if (entry.m_Texture.use_count() == 1) {
+                candidates.emplace_back(get_last_used(entry), namehash);
+            }
+        }
+
+        std::sort(candidates.begin(), candidates.end());
+
+        // nothing has drawn these for a while, they go even when the cache is within the budget
+        auto first = candidates.begin();
+        for (; first != candidates.end() && (first->first + IDLE_FRAMES) <= frame; ++first) {
+            auto iter = m_entries.find(first->second);
+            size -= iter->second.m_Texture->get_size();
+            m_entries.erase(iter);
+            ++m_num_evicted;
+        }
+
+        if (size <= m_budget) {
+            return;
+        }
+
+        // drop the high resolution mips first, they're most of the memory and the texture can still be drawn
+        for (auto iter = first; iter != candidates.end(); ++iter) {
+            if (size <= m_budget) return;
+
+            auto& texture = *m_entries[iter->second].m_Texture;
+            if (!texture.can_demote()) continue;
+
+            const u64 previous_size = texture.get_size();
+            if (texture.demote()) {
+                size -= (previous_size - std::min(previous_size, texture.get_size()));
+                ++m_num_demoted;
+            }
+        }
+
+        for (auto iter = first; iter != candidates.end(); ++iter) {
+            if (size <= m_budget) return;
+
+            auto entry = m_entries.find(iter->second);
+            size -= entry->second.m_Texture->get_size();
+            m_entries.erase(entry);
+            ++m_num_evicted;
+        }
+    }
+
+    void set_budget(u64 budget) override { m_budget = budget; }
+
+    Stats get_stats() const override
+    {
+        Stats stats;
+        stats.m_NumTextures = static_cast<u32>(m_entries.size());
+        stats.m_Budget      = m_budget;
+        stats.m_NumDemoted  = m_num_demoted;
+        stats.m_NumEvicted  = m_num_evicted;
+
+        for (const auto& [namehash, entry] : m_entries) {
+            const u64 size = entry.m_Texture->get_size();
+            stats.m_Size += size;
+
+            if (entry.m_Texture.use_count() > 1) {
+                ++stats.m_NumReferenced;
+                stats.m_ReferencedSize += size;
+            } else if (entry.m_Texture->can_demote()) {
+                ++stats.m_NumDemotable;
+            }
+        }
+
+        return stats;
+    }
+
+  private:
+    static u64 get_last_used(const Entry& entry)
+    {
+        return std::max(entry.m_LastAccess, entry.m_Texture->get_last_used_frame());
+    }
+
+  private:
+    std::unordered_map<u32, Entry> m_entries;
+    u64                            m_budget      = 0;
+    u32                            m_num_demoted = 0;
+    u32                            m_num_evicted = 0;
+};
+
+TextureCache* TextureCache::create(u64 budget)
+{
+    return new TextureCacheImpl(budget);
+}
+
+void TextureCache::destroy(TextureCache* instance)
+{
+    delete instance;
+}
+} // namespace jcmr
@@ -0,0 +1,48 @@
+#ifndef JCMR_RENDER_TEXTURE_CACHE_H_HEADER_GUARD
+#define JCMR_RENDER_TEXTURE_CACHE_H_HEADER_GUARD
+
+#include "platform.h"
+
+namespace jcmr
+{
+struct Texture;
+
+// every texture the renderer created, by namehash, with its estimated size. the cache holds a reference so textures
+// stay loaded after the last render block releases them, until they've been idle for IDLE_FRAMES or the budget needs
+// the memory back. then textures which nothing else references are demoted (the streamed in high resolution mip is
+// dropped) and after that evicted, least recently used first.
+struct TextureCache {
+    static constexpr u32 DEFAULT_BUDGET_MB = 2048;      // "texture_budget_mb" setting
+    static constexpr u64 IDLE_FRAMES       = (60 * 60); // about a minute, the renderer presents with vsync
+
+    struct Stats {
+        u32 m_NumTextures    = 0;
+        u32 m_NumReferenced  = 0; // held outside the cache, these are never demoted or evicted
+        u32 m_NumDemotable   = 0;
+        u64 m_Size           = 0;
+        u64 m_ReferencedSize = 0;
+        u64 m_Budget         = 0;
+        u32 m_NumDemoted     = 0; // for the session
+        u32 m_NumEvicted     = 0; // for the session
+    };
+
+    static TextureCache* create(u64 budget);
+    static void          destroy(TextureCache* instance);
+
+    virtual ~TextureCache() = default;
+
+    // frame is RenderContext::frame, it's the last access for the lru order
+    virtual std::shared_ptr<Texture> get(u32 namehash, u64 frame)                                          = 0;
+    virtual void                     add(u32 namehash, const std::shared_ptr<Texture>& texture, u64 frame) = 0;
+    virtual void                     clear()                                                               = 0;
+
+    // evicts the idle textures, then demotes and evicts until the size is within the budget (or everything left is in
+    // use), once per frame
+    virtual void update(u64 frame) = 0;
+
+    virtual void  set_budget(u64 budget) = 0;
+    virtual Stats get_stats() const      = 0;
+};
+} // namespace jcmr
+
+#endif // JCMR_RENDER_TEXTURE_CACHE_H_HEADER_GUARD
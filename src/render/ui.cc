@@ -5,9 +5,14 @@
 #include "app/app.h"
 #include "app/os.h"
 #include "app/settings.h"
+#include "app/utils.h"
 
+#include "game/content_search.h"
 #include "game/format.h"
 #include "game/game.h"
+#include "game/resource_manager.h"
+#include "game/texture_export.h"
+#include "game/texture_streamer.h"
 
 #include "render/fonts/fa_solid_900.h"
 #include "render/fonts/icons.h"
@@ -15,6 +20,7 @@
 #include "render/imguiex.h"
 #include "render/renderer.h"
 #include "render/texture.h"
+#include "render/texture_cache.h"
 
 #include <backends/imgui_impl_dx11.h>
 #include <backends/imgui_impl_win32.h>
@@ -77,6 +83,9 @@ struct UIImpl final : UI {
 
     void shutdown() override
     {
+        m_content_search.cancel();
+        m_model_export.wait();
+
         ImGui_ImplDX11_Shutdown();
         ImGui_ImplWin32_Shutdown();
         ImGui::DestroyContext();
@@ -95,6 +104,10 @@ struct UIImpl final : UI {
 
         if (m_change_game_next_frame) {
             m_change_game_next_frame = false;
+
+            // the search and the export read through the resource manager of the current game
+            m_content_search.cancel();
+            m_model_export.wait();
             m_app.change_game(EGame::EGAME_COUNT);
         }
 
@@ -106,6 +119,8 @@ struct UIImpl final : UI {
             // TODO : move elsewhere
             //        would be nice to have a "widgets" directory where we can house small things like this.
             draw_hash_generator_widget();
+            draw_content_search_widget();
+            draw_texture_memory_widget();
 
             // render callbacks
             for (auto& callback : m_render_callbacks) {
@@ -117,6 +132,18 @@ struct UIImpl final : UI {
         ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData());
     }
 
+    bool export_model(const std::string& filename, const std::filesystem::path& out_directory) override
+    {
+        if (!m_model_export.start(*m_app.get_game()->get_resource_manager(), filename, out_directory,
+                                  image_writer::E_IMAGE_TYPE_PNG)) {
+            LOG_WARNING("UI : can't export \"{}\" while \"{}\" is still exporting.", filename,
+                        m_model_export.get_filename());
+            return false;
+        }
+
+        return true;
+    }
+
     void draw_context_menu(const std::string& filename, game::IFormat* format, u32 flags) override
     {
         // TODO : how do we get the base colour without any PushStyleColor() overriding?
@@ -333,9 +360,21 @@ struct UIImpl final : UI {
                     m_show_hash_generator = !m_show_hash_generator;
                 }
 
+                if (ImGui::MenuItem("Content Search")) {
+                    m_show_content_search = !m_show_content_search;
+                }
+
+                if (ImGui::MenuItem("Texture Memory")) {
+                    m_show_texture_memory = !m_show_texture_memory;
+                }
+
                 ImGui::EndMenu();
             }
 
+            if (m_model_export.is_running()) {
+                ImGui::TextDisabled(ICON_FA_SPINNER " exporting \"%s\"...", m_model_export.get_filename().c_str());
+            }
+
             ImGui::EndMainMenuBar();
         }
     }
@@ -424,6 +463,180 @@ struct UIImpl final : UI {
         }
     }
 
+    void draw_texture_memory_widget()
+    {
+        static constexpr double MEGABYTE = (1024.0 * 1024.0);
+
+        if (!m_show_texture_memory) {
+            return;
+        }
+
+        ImGui::SetNextWindowDockID(m_dockspace_right_bottom, ImGuiCond_Appearing);
+
+        if (ImGui::Begin("Texture Memory", &m_show_texture_memory)) {
+            auto&      texture_cache = m_renderer.get_texture_cache();
+            const auto stats         = texture_cache.get_stats();
+
+            i32 budget_mb = static_cast<i32>(stats.m_Budget / (1024 * 1024));
+            if (ImGui::InputInt("Budget (MB)", &budget_mb, 64, 512) && budget_mb > 0) {
+                texture_cache.set_budget(static_cast<u64>(budget_mb) * 1024 * 1024);
+                m_app.get_settings().set<u32>("texture_budget_mb", static_cast<u32>(budget_mb));
+            }
+
+            const auto overlay =
+                fmt::format("{:.1f} / {:.1f} MB", (stats.m_Size / MEGABYTE), (stats.m_Budget / MEGABYTE));
+            const auto fraction = static_cast<float>(stats.m_Size / std::max(static_cast<double>(stats.m_Budget), 1.0));
+            ImGui::ProgressBar(fraction, ImVec2(-1, 0), overlay.c_str());
+
+            ImGui::Text("Textures: %u (%u in use, %.1f MB)", stats.m_NumTextures, stats.m_NumReferenced,
+                        (stats.m_ReferencedSize / MEGABYTE));
+            ImGui::Text("Demotable: %u", stats.m_NumDemotable);
+            ImGui::Text("Demoted: %u, Evicted: %u", stats.m_NumDemoted, stats.m_NumEvicted);
+
+            if (auto* streamer = m_app.get_game()->get_texture_streamer(); streamer) {
+                ImGui::Separator();
+                ImGui::Text("Streamed: %.1f / %.1f MB", (streamer->get_used_size() / MEGABYTE),
+                            (streamer->get_budget() / MEGABYTE));
+                ImGui::Text("Waiting to stream: %u", streamer->get_num_pending());
+            }
+        }
+
+        ImGui::End();
+    }
+
+    void draw_content_search_widget()
+    {
+        static constexpr float kWidgetTableLabelWidth = 0.2f;
+        static constexpr u32   kMaxMatches            = 100000;
+
+        if (!m_show_content_search) {
+            return;
+        }
+
+        ImGui::SetNextWindowDockID(m_dockspace_right_bottom, ImGuiCond_Appearing);
+
+        if (ImGui::Begin("Content Search", &m_show_content_search)) {
+            static char text[1024]    = {0};
+            static char hash[256]     = {0};
+            static char bytes[1024]   = {0};
+            static char extension[32] = {0};
+            static bool ignore_case   = true;
+            const bool  running       = m_content_search.is_running();
+            const auto& progress      = m_content_search.get_progress();
+
+            ImGui::PushStyleColor(ImGuiCol_Text, {0.53f, 0.53f, 0.53f, 1.0f});
+            ImGui::TextWrapped("Search the contents of every file in the game archives. Files are matched if they "
+                               "contain any of the patterns.");
+            ImGui::PopStyleColor();
+
+            if (ImGuiEx::BeginWidgetTableLayout(kWidgetTableLabelWidth)) {
+                ImGuiEx::WidgetTableLayoutColumn("Text", [&] {
+                    ImGui::InputText("##content_search_text", text, lengthOf(text));
+                    ImGui::SameLine();
+                    ImGui::Checkbox("Ignore case", &ignore_case);
+                });
+
+                ImGuiEx::WidgetTableLayoutColumn("Hash", [&] {
+                    ImGui::InputTextWithHint("##content_search_hash", "name or 0x value", hash, lengthOf(hash));
+                });
+
+                ImGuiEx::WidgetTableLayoutColumn("Bytes", [&] {
+                    ImGui::InputTextWithHint("##content_search_bytes", "DE AD BE EF", bytes, lengthOf(bytes));
+                });
+
+                ImGuiEx::WidgetTableLayoutColumn("Extension", [&] {
+                    ImGui::InputTextWithHint("##content_search_extension", "all files", extension,
+                                             lengthOf(extension));
+                });
+            }
+
+            ImGuiEx::EndWidgetTableLayout();
+
+            if (running) {
+                if (ImGui::Button(ICON_FA_TIMES " Cancel")) {
+                    m_content_search.cancel();
+                }
+            } else if (ImGui::Button(ICON_FA_SEARCH " Search")) {
+                content_search::Options options;
+                options.m_Extension  = extension;
+                options.m_MaxMatches = kMaxMatches;
+                m_content_search_labels.clear();
+
+                if (text[0] != '\0') {
+                    options.m_Patterns.push_back(content_search::make_string_pattern(text, ignore_case));
+                    m_content_search_labels.push_back(fmt::format("\"{}\"", text));
+                }
+
+                if (hash[0] != '\0') {
+                    // "0x" prefixed values are used as-is, anything else is a name which is hashed
+                    const bool is_value = (hash[0] == '0' && (hash[1] == 'x' || hash[1] == 'X'));
+                    const u32  namehash =
+                        (is_value ? static_cast<u32>(std::strtoul(hash + 2, nullptr, 16)) : ava::hashlittle(hash));
+
+                    options.m_Patterns.push_back(content_search::make_u32_pattern(namehash));
+                    m_content_search_labels.push_back(fmt::format("0x{:08X}", namehash));
+                }
+
+                content_search::Pattern pattern;
+                if (bytes[0] != '\0' && content_search::parse_hex_pattern(bytes, &pattern)) {
+                    options.m_Patterns.push_back(std::move(pattern));
+                    m_content_search_labels.push_back(bytes);
+                }
+
+                if (!options.m_Patterns.empty()) {
+                    m_content_search_matches.clear();
+                    m_content_search.start(*m_app.get_game()->get_resource_manager(), std::move(options));
+                }
+            }
+
+            // progress
+            m_content_search.take_matches(&m_content_search_matches);
+
+            const u32 num_files    = progress.m_NumFiles;
+            const u32 num_searched = progress.m_NumFilesSearched;
+
+            const auto fraction = (num_files > 0 ? (num_searched / static_cast<float>(num_files)) : 0.0f);
+            const auto overlay =
+                fmt::format("{} / {} files, {} matches", num_searched, num_files, m_content_search_matches.size());
+
+            ImGui::SameLine();
+            ImGui::ProgressBar(fraction, ImVec2(-1, 0), overlay.c_str());
+
+            // matches
+            if (ImGui::BeginChild("##content_search_matches", ImVec2(0, 0), true)) {
+                ImGuiListClipper clipper;
+                clipper.Begin(static_cast<i32>(m_content_search_matches.size()));
+                while (clipper.Step()) {
+                    for (i32 i = clipper.DisplayStart; i < clipper.DisplayEnd; ++i) {
+                        const auto& match = m_content_search_matches[i];
+
+                        ImGui::PushID(i);
+                        if (ImGui::Selectable(match.m_Filename.c_str())) {
+                            // try the extension first, then the file header magic
+                            const auto extension = utils::get_extension(match.m_Filename);
+                            auto*      format    = m_app.get_format_handler(ava::hashlittle(extension.c_str()));
+                            if (!format) format = m_app.get_format_handler_for_file(match.m_Filename);
+                            if (format) format->load(match.m_Filename);
+                        }
+
+                        draw_context_menu(match.m_Filename, nullptr, E_CONTEXT_FILE);
+
+                        ImGui::SameLine();
+                        ImGui::TextDisabled("@ 0x%llX  %s", match.m_Offset,
+                                            m_content_search_labels[match.m_Pattern].c_str());
+                        ImGui::PopID();
+                    }
+                }
+
+                clipper.End();
+            }
+
+            ImGui::EndChild();
+        }
+
+        ImGui::End();
+    }
+
     game::IFormat* context_menu_get_format_handler_for_file(const std::string& path)
     {
         if (m_context_format_handler) return m_context_format_handler;
@@ -438,6 +651,8 @@ struct UIImpl final : UI {
     ImFont*                       m_base_font              = nullptr;
     ImFont*                       m_large_font             = nullptr;
     bool                          m_show_hash_generator    = false;
+    bool                          m_show_content_search    = false;
+    bool                          m_show_texture_memory    = false;
     game::IFormat*                m_context_format_handler = nullptr;
     ImGuiID                       m_dockspace_left         = -1;
     ImGuiID                       m_dockspace_right        = -1;
@@ -445,6 +660,12 @@ struct UIImpl final : UI {
     std::shared_ptr<Texture>      m_jc3_icon_texture;
     std::shared_ptr<Texture>      m_jc4_icon_texture;
     bool                          m_change_game_next_frame = false;
+
+    content_search::AsyncSearch                     m_content_search;
+    std::vector<content_search::AsyncSearch::Match> m_content_search_matches;
+    std::vector<std::string>                        m_content_search_labels; // per pattern
+
+    texture_export::AsyncModelExport m_model_export;
 };
 
 UI* UI::create(App& app, Renderer& renderer)
@@ -43,6 +43,10 @@ struct UI {
 
     virtual void draw_context_menu(const std::string& filename, game::IFormat* format, u32 flags) = 0;
 
+    // exports a model and its textures in the background, the main menu bar shows it's busy until it's done. returns
+    // false if an export is already running.
+    virtual bool export_model(const std::string& filename, const std::filesystem::path& out_directory) = 0;
+
     virtual void          on_render(RenderCallback_t callback) = 0;
     virtual const ImFont* get_large_font() const               = 0;
 